@@ -1,5 +1,30 @@
 // Conway's Game of Life implementācija
 
+// Life tipa likums un robeža tiek doti kompilēšanas laikā ar -D opcijām (main.cpp golBuildOptions), tāpēc katram
+// likumam un robežas veidam programma tiek kompilēta atsevišķi un likums kodolos ir konstante
+// GOL_BIRTH un GOL_SURVIVAL ir kaimiņu skaitu bitu maskas, GOL_WRAP 1 - režģa pretējās malas ir kaimiņi (tors)
+#ifndef GOL_BIRTH
+#define GOL_BIRTH 0x008
+#endif
+#ifndef GOL_SURVIVAL
+#define GOL_SURVIVAL 0x00C
+#endif
+#ifndef GOL_WRAP
+#define GOL_WRAP 0
+#endif
+
+#define GOL_CONWAY (GOL_BIRTH == 0x008 && GOL_SURVIVAL == 0x00C)
+
+// Conway likumam tiek lietots tieši tas pats izteiksmes veids, kas pirms likumu ieviešanas, tāpēc tas neko nemaksā
+inline uchar lifeRule(const uchar cell, const int neighbors)
+{
+#if GOL_CONWAY
+	return neighbors == 3 || (cell == 1 && neighbors == 2);
+#else
+	return ((cell ? GOL_SURVIVAL : GOL_BIRTH) >> neighbors) & 1;
+#endif
+}
+
 inline int neighborCount(const size_t x, const size_t y, const ulong width, const ulong height,
 						 __global const uchar *grid)
 {
@@ -36,6 +61,25 @@ inline int neighborCount(const size_t x, const size_t y, const ulong width, cons
 	return neighbors;
 }
 
+// toroidālā režģī pretējās malas ir kaimiņi, tāpēc kaimiņu koordinātes tiek ņemtas pēc moduļa
+inline int wrappedNeighborCount(const size_t x, const size_t y, const ulong width, const ulong height,
+								__global const uchar *grid)
+{
+	const size_t left = x > 0 ? x - 1 : width - 1;
+	const size_t right = x + 1 < width ? x + 1 : 0;
+	const size_t above = (y > 0 ? y - 1 : height - 1) * width;
+	const size_t row = y * width;
+	const size_t below = (y + 1 < height ? y + 1 : 0) * width;
+
+	return grid[above + left] + grid[above + x] + grid[above + right] + grid[row + left] + grid[row + right] +
+		   grid[below + left] + grid[below + x] + grid[below + right];
+}
+
+inline long wrapCoordinate(const long v, const ulong size)
+{
+	return ((v % (long)size) + (long)size) % (long)size;
+}
+
 __kernel void gol(__global const uchar *input, __global uchar *output, ulong width, ulong height)
 {
 	const int x = get_global_id(0);
@@ -46,19 +90,635 @@ __kernel void gol(__global const uchar *input, __global uchar *output, ulong wid
 
 	const size_t flatIdx = y * width + x;
 
+#if GOL_WRAP
+	int neighbors = wrappedNeighborCount(x, y, width, height, input);
+#else
 	int neighbors = neighborCount(x, y, width, height, input);
+#endif
+
+	output[flatIdx] = lifeRule(input[flatIdx], neighbors);
+}
 
-	uchar cell = 0;
-	if (input[flatIdx] == 1)
+// ansambļa režģa novietojums kopīgajā buferī: pirmās šūnas nobīde un izmēri, jāsakrīt ar EnsembleExtent main.cpp
+typedef struct
+{
+	ulong offset;
+	int width;
+	int height;
+} EnsembleExtent;
+
+// ansambļa režīms: NDRange trešā dimensija ir režģa indekss, pirmās divas nosedz lielāko no režģiem, tāpēc viens
+// izsaukums izrēķina paaudzi visiem režģiem; darba vienumi ārpus sava režģa neko nedara
+__kernel void gol_ensemble(__global const uchar *input, __global uchar *output, __global const EnsembleExtent *extents)
+{
+	const EnsembleExtent extent = extents[get_global_id(2)];
+
+	const int x = get_global_id(0);
+	const int y = get_global_id(1);
+
+	if (x >= extent.width || y >= extent.height)
+		return;
+
+	__global const uchar *grid = input + extent.offset;
+
+	int neighbors = 0;
+	for (int dy = -1; dy <= 1; dy++)
 	{
-		if (neighbors == 2 || neighbors == 3)
-			cell = 1;
+		for (int dx = -1; dx <= 1; dx++)
+		{
+			int nx = x + dx;
+			int ny = y + dy;
+
+			if (dx == 0 && dy == 0)
+				continue;
+
+#if GOL_WRAP
+			nx = (nx + extent.width) % extent.width;
+			ny = (ny + extent.height) % extent.height;
+#else
+			if (nx < 0 || nx >= extent.width || ny < 0 || ny >= extent.height)
+				continue;
+#endif
+
+			neighbors += grid[ny * extent.width + nx];
+		}
+	}
+
+	const size_t flatIdx = (size_t)y * extent.width + x;
+	output[extent.offset + flatIdx] = lifeRule(grid[flatIdx], neighbors);
+}
+
+// laika bloķēšanas (temporal blocking) kodola vienas darba grupas izejas apgabala izmērs šūnās,
+// tam jāsakrīt ar TEMPORAL_TILE_W un TEMPORAL_TILE_H vērtībām main.cpp
+#define TEMPORAL_TILE_W 64
+#define TEMPORAL_TILE_H 32
+
+inline bool insideGrid(const long x, const long y, const ulong width, const ulong height)
+{
+	return x >= 0 && y >= 0 && (ulong)x < width && (ulong)y < height;
+}
+
+// ielādē darba grupas apgabalu kopā ar 'gens' šūnu platu apmali lokālajā atmiņā, izrēķina tur 'gens' paaudzes
+// un globālajā atmiņā ieraksta tikai apgabala iekšpusi, tādējādi globālā atmiņa tiek lietota 'gens' reizes retāk
+// ar katru paaudzi korekto šūnu apgabals sarūk par vienu šūnu no katras malas, tāpēc apmalei jābūt 'gens' platai
+// 'current' un 'next' katrs ir (TEMPORAL_TILE_W + 2 * gens) * (TEMPORAL_TILE_H + 2 * gens) baitus liels
+__kernel void gol_temporal(__global const uchar *input, __global uchar *output, ulong width, ulong height, int gens,
+						   __local uchar *current, __local uchar *next)
+{
+	const int tileW = TEMPORAL_TILE_W + 2 * gens;
+	const int tileH = TEMPORAL_TILE_H + 2 * gens;
+
+	const int localX = get_local_id(0);
+	const int localY = get_local_id(1);
+	const int localW = get_local_size(0);
+	const int localH = get_local_size(1);
+
+	// apgabala (ieskaitot apmali) kreisā augšējā stūra globālās koordinātes, var būt negatīvas
+	const long originX = (long)get_group_id(0) * TEMPORAL_TILE_W - gens;
+	const long originY = (long)get_group_id(1) * TEMPORAL_TILE_H - gens;
+
+	for (int ty = localY; ty < tileH; ty += localH)
+	{
+		for (int tx = localX; tx < tileW; tx += localW)
+		{
+			const long gx = originX + tx;
+			const long gy = originY + ty;
+
+			// toroidālā režģī apgabals ar apmali ir režģa periodisks turpinājums
+#if GOL_WRAP
+			current[ty * tileW + tx] = input[wrapCoordinate(gy, height) * width + wrapCoordinate(gx, width)];
+#else
+			current[ty * tileW + tx] = insideGrid(gx, gy, width, height) ? input[gy * width + gx] : 0;
+#endif
+		}
+	}
+
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for (int gen = 1; gen <= gens; gen++)
+	{
+		for (int ty = gen + localY; ty < tileH - gen; ty += localH)
+		{
+			for (int tx = gen + localX; tx < tileW - gen; tx += localW)
+			{
+				__local const uchar *above = current + (ty - 1) * tileW + tx;
+				__local const uchar *row = current + ty * tileW + tx;
+				__local const uchar *below = current + (ty + 1) * tileW + tx;
+
+				const int neighbors =
+					above[-1] + above[0] + above[1] + row[-1] + row[1] + below[-1] + below[0] + below[1];
+
+				const uchar cell = lifeRule(row[0], neighbors);
+
+				// šūnas ārpus režģa vienmēr paliek mirušas, citādi tās ietekmētu režģa malas
+				next[ty * tileW + tx] = GOL_WRAP || insideGrid(originX + tx, originY + ty, width, height) ? cell : 0;
+			}
+		}
+
+		barrier(CLK_LOCAL_MEM_FENCE);
+
+		__local uchar *tmp = current;
+		current = next;
+		next = tmp;
+	}
+
+	for (int ty = localY; ty < TEMPORAL_TILE_H; ty += localH)
+	{
+		for (int tx = localX; tx < TEMPORAL_TILE_W; tx += localW)
+		{
+			const long gx = originX + gens + tx;
+			const long gy = originY + gens + ty;
+
+			if (insideGrid(gx, gy, width, height))
+				output[gy * width + gx] = current[(ty + gens) * tileW + tx + gens];
+		}
+	}
+}
+
+// vektorizētā kodola šūnu skaits vienam darba vienumam, tam jāsakrīt ar VEC_CELLS vērtību main.cpp
+#define VEC_CELLS 16
+
+// šūna, kas var atrasties ārpus režģa: mirusi vai toroidālā režģī ņemta no pretējās malas
+inline uchar cellOrBorder(__global const uchar *grid, const long x, const long y, const ulong width,
+						  const ulong height)
+{
+#if GOL_WRAP
+	return grid[wrapCoordinate(y, height) * width + wrapCoordinate(x, width)];
+#else
+	return insideGrid(x, y, width, height) ? grid[y * width + x] : 0;
+#endif
+}
+
+// lifeRule 16 šūnām vienlaikus
+inline uchar16 lifeRule16(const uchar16 cells, const uchar16 neighbors)
+{
+#if GOL_CONWAY
+	return as_uchar16((neighbors == (uchar16)(3)) | ((cells == (uchar16)(1)) & (neighbors == (uchar16)(2)))) &
+		   (uchar16)(1);
+#else
+	const ushort16 masks =
+		select((ushort16)(GOL_BIRTH), (ushort16)(GOL_SURVIVAL), convert_ushort16(cells) != (ushort16)(0));
+	return convert_uchar16((masks >> convert_ushort16(neighbors)) & (ushort16)(1));
+#endif
+}
+
+// gol variants, kurā katrs darba vienums izrēķina VEC_CELLS blakus esošas vienas rindas šūnas ar uchar16
+// darba grupa vienreiz ielādē savu apgabalu (get_local_size(0) * VEC_CELLS x get_local_size(1) šūnas) ar vienas
+// šūnas apmali lokālajā atmiņā, tāpēc katra šūna no globālās atmiņas tiek nolasīta vienreiz, nevis deviņas reizes
+// katras kolonnas trīs šūnu summa tiek izrēķināta vienreiz un izmantota visām trim šūnām, kuru kaimiņos tā ir
+// 'tile' ir (get_local_size(1) + 2) rindas pa (get_local_size(0) + 2) * VEC_CELLS baitiem, apgabala rinda sākas ar
+// nobīdi VEC_CELLS, lai vload16 būtu izlīdzināti, kreisās apmales šūna ir tieši pirms tās, labās - tieši pēc tās
+// šūnas aiz režģa malas apgabalā ir mirušas vai toroidālā režģī ņemtas no pretējās malas, tāpēc nepilnām
+// darba grupām pie labās un apakšējās malas nav vajadzīgi atsevišķi zari
+__kernel void gol_vec16(__global const uchar *input, __global uchar *output, ulong width, ulong height,
+						__local uchar *tile)
+{
+	const int localX = get_local_id(0);
+	const int localY = get_local_id(1);
+	const int localW = get_local_size(0);
+	const int localH = get_local_size(1);
+
+	const int stride = (localW + 2) * VEC_CELLS;
+
+	// apgabala (bez apmales) kreisā augšējā stūra globālās koordinātes
+	const long originX = (long)get_group_id(0) * localW * VEC_CELLS;
+	const long originY = (long)get_group_id(1) * localH;
+
+	const long x = originX + localX * VEC_CELLS;
+	const long y = originY + localY;
+
+	// apgabala rinda 0 ir apmale virs tā, rinda localH + 1 - zem tā, tās ielādē pirmo divu rindu darba vienumi
+	for (int ty = localY; ty < localH + 2; ty += localH)
+	{
+		const long gy = originY + ty - 1;
+		__local uchar *row = tile + ty * stride + VEC_CELLS;
+
+#if GOL_WRAP
+		const bool rowInside = true;
+		const long rowOffset = wrapCoordinate(gy, height) * width;
+#else
+		const bool rowInside = gy >= 0 && gy < (long)height;
+		const long rowOffset = gy * width;
+#endif
+
+		if (rowInside && x + VEC_CELLS <= (long)width)
+		{
+			vstore16(vload16(0, input + rowOffset + x), localX, row);
+		}
+		else if (!rowInside)
+		{
+			vstore16((uchar16)(0), localX, row);
+		}
+		else
+		{
+			for (int i = 0; i < VEC_CELLS; i++)
+				row[localX * VEC_CELLS + i] = cellOrBorder(input, x + i, gy, width, height);
+		}
+
+		if (localX == 0)
+			row[-1] = cellOrBorder(input, originX - 1, gy, width, height);
+
+		if (localX == localW - 1)
+			row[localW * VEC_CELLS] = cellOrBorder(input, originX + localW * VEC_CELLS, gy, width, height);
+	}
+
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	if (x >= (long)width || y >= (long)height)
+		return;
+
+	__local const uchar *above = tile + localY * stride + VEC_CELLS + localX * VEC_CELLS;
+	__local const uchar *row = above + stride;
+	__local const uchar *below = row + stride;
+
+	const uchar16 cells = vload16(0, row);
+
+	// kolonnu summas šūnām x .. x + 15 un abām blakus kolonnām
+	const uchar16 columns = vload16(0, above) + cells + vload16(0, below);
+	const uchar leftColumn = above[-1] + row[-1] + below[-1];
+	const uchar rightColumn = above[VEC_CELLS] + row[VEC_CELLS] + below[VEC_CELLS];
+
+	// kolonnu summas, nobīdītas par vienu šūnu pa labi un pa kreisi
+	const uchar16 leftColumns = shuffle2((uchar16)(leftColumn), columns,
+										 (uchar16)(0, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30));
+	const uchar16 rightColumns = shuffle2(columns, (uchar16)(rightColumn),
+										  (uchar16)(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16));
+
+	const uchar16 next = lifeRule16(cells, leftColumns + columns + rightColumns - cells);
+
+	if (x + VEC_CELLS <= (long)width)
+	{
+		vstore16(next, 0, output + y * width + x);
 	}
 	else
 	{
-		if (neighbors == 3)
-			cell = 1;
+		uchar nextCells[VEC_CELLS];
+		vstore16(next, 0, nextCells);
+
+		for (int i = 0; i < (long)width - x; i++)
+			output[y * width + x + i] = nextCells[i];
 	}
+}
+
+// viena paaudze horizontālai joslai, kas satur 'rows' režģa rindas, sākot ar 'firstRow' (var būt ārpus režģa)
+// rindas ārpus režģa paliek mirušas, tāpēc josla, kas sniedzas pāri režģa malai, dod tādu pašu rezultātu kā režģis
+// joslas pirmās un pēdējās rindas kaimiņi nav zināmi, tāpēc ar katru paaudzi kļūdaina kļūst vēl viena rinda no malas
+// tiek rēķinātas tikai joslas rindas [rowBegin, rowEnd), lai malas un iekšpusi varētu palaist atsevišķi
+__kernel void gol_strip(__global const uchar *input, __global uchar *output, ulong width, ulong height, long firstRow,
+						int rows, int rowBegin, int rowEnd)
+{
+	const int x = get_global_id(0);
+	const int y = rowBegin + get_global_id(1);
+
+	if (x >= width || y >= rowEnd)
+		return;
+
+	const size_t flatIdx = (size_t)y * width + x;
+
+	if (!insideGrid(x, firstRow + y, width, height))
+	{
+		output[flatIdx] = 0;
+		return;
+	}
+
+	int neighbors = 0;
+
+	for (int dy = -1; dy <= 1; dy++)
+	{
+		const int ny = y + dy;
+
+		if (ny < 0 || ny >= rows)
+			continue;
+
+		for (int dx = -1; dx <= 1; dx++)
+		{
+			const int nx = x + dx;
+
+			if ((dx == 0 && dy == 0) || nx < 0 || nx >= width)
+				continue;
+
+			neighbors += input[(size_t)ny * width + nx];
+		}
+	}
+
+	const uchar cell = lifeRule(input[flatIdx], neighbors);
 
 	output[flatIdx] = cell;
 }
+
+// aktīvo flīžu režīmā viena flīze ir vienas darba grupas apstrādātais apgabals šūnās,
+// tam jāsakrīt ar ACTIVE_TILE_W un ACTIVE_TILE_H vērtībām main.cpp
+#define ACTIVE_TILE_W 32
+#define ACTIVE_TILE_H 8
+
+// flīze ir aktīva, ja tā pati vai kāda no 8 kaimiņu flīzēm iepriekšējā paaudzē mainījās, pārējās flīzes nemainīsies
+// aktīvās flīzes tiek saspiestas darba sarakstā, un 'nextChanged' tiek notīrīts, lai gol_active_tile to aizpilda
+__kernel void build_tile_worklist(__global const uchar *changed, __global uchar *nextChanged, __global uint *worklist,
+								  __global uint *workCount, int tilesX, int tilesY)
+{
+	const int tx = get_global_id(0);
+	const int ty = get_global_id(1);
+
+	if (tx >= tilesX || ty >= tilesY)
+		return;
+
+	bool active = false;
+
+	for (int ny = max(ty - 1, 0); ny <= min(ty + 1, tilesY - 1); ny++)
+	{
+		for (int nx = max(tx - 1, 0); nx <= min(tx + 1, tilesX - 1); nx++)
+		{
+			active |= changed[ny * tilesX + nx] != 0;
+		}
+	}
+
+	const uint tileIdx = ty * tilesX + tx;
+	nextChanged[tileIdx] = 0;
+
+	if (active)
+		worklist[atomic_inc(workCount)] = tileIdx;
+}
+
+// viena paaudze vienai darba saraksta flīzei uz darba grupu, flīzei tiek atzīmēts, vai tajā mainījās kāda šūna
+// izlaistās flīzes izejas buferī jau ir pareizas: tur ir aizpagājušās paaudzes šūnas, kas sakrīt ar pašreizējām
+__kernel __attribute__((reqd_work_group_size(ACTIVE_TILE_W, ACTIVE_TILE_H, 1))) void gol_active_tile(
+	__global const uchar *input, __global uchar *output, ulong width, ulong height, __global const uint *worklist,
+	__global uchar *changed, int tilesX)
+{
+	__local int tileChanged;
+
+	const uint tileIdx = worklist[get_group_id(0)];
+
+	const int x = (tileIdx % tilesX) * ACTIVE_TILE_W + get_local_id(0);
+	const int y = (tileIdx / tilesX) * ACTIVE_TILE_H + get_local_id(1);
+
+	if (get_local_id(0) == 0 && get_local_id(1) == 0)
+		tileChanged = 0;
+
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	// ārpus režģa esošie darba vienumi neatgriežas, jo visiem darba grupas vienumiem jāsasniedz barjera
+	if (x < width && y < height)
+	{
+		const size_t flatIdx = y * width + x;
+		const int neighbors = neighborCount(x, y, width, height, input);
+
+		const uchar cell = lifeRule(input[flatIdx], neighbors);
+
+		output[flatIdx] = cell;
+
+		if (cell != input[flatIdx])
+			tileChanged = 1;
+	}
+
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	if (get_local_id(0) == 0 && get_local_id(1) == 0 && tileChanged)
+		changed[tileIdx] = 1;
+}
+
+// režģa paraksta kodolu darba grupas izmērs, jāsakrīt ar SIGNATURE_GROUP_SIZE main.cpp
+#define SIGNATURE_GROUP_SIZE 256
+
+// splitmix64 nobeigums, lai katram režģa elementam būtu neatkarīga 64 bitu jaucējvērtība
+inline ulong mixHash(ulong h)
+{
+	h ^= h >> 30;
+	h *= 0xBF58476D1CE4E5B9ul;
+	h ^= h >> 27;
+	h *= 0x94D049BB133111EBul;
+	return h ^ (h >> 31);
+}
+
+// reducē darba grupas summas lokālajā atmiņā un ieraksta grupas rezultātu 'partials' (divi vārdi katrai grupai)
+inline void reduceSignature(__local ulong *hashes, __local ulong *populations, __global ulong *partials)
+{
+	const int lid = get_local_id(0);
+
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for (int stride = SIGNATURE_GROUP_SIZE / 2; stride > 0; stride /= 2)
+	{
+		if (lid < stride)
+		{
+			hashes[lid] += hashes[lid + stride];
+			populations[lid] += populations[lid + stride];
+		}
+
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+
+	if (lid == 0)
+	{
+		partials[2 * get_group_id(0)] = hashes[0];
+		partials[2 * get_group_id(0) + 1] = populations[0];
+	}
+}
+
+// režģa paraksta pirmā daļa: dzīvo šūnu jaucējvērtību summa un dzīvo šūnu skaits katrai darba grupai
+// summa nav atkarīga no secības, tāpēc darba grupu rezultātus pēc tam saskaita grid_signature_final
+__kernel __attribute__((reqd_work_group_size(SIGNATURE_GROUP_SIZE, 1, 1))) void grid_signature(
+	__global const uchar *grid, ulong count, __global ulong *partials)
+{
+	__local ulong hashes[SIGNATURE_GROUP_SIZE];
+	__local ulong populations[SIGNATURE_GROUP_SIZE];
+
+	ulong hash = 0;
+	ulong population = 0;
+
+	for (size_t i = get_global_id(0); i < count; i += get_global_size(0))
+	{
+		if (grid[i] != 0)
+		{
+			hash += mixHash(i * 0x9E3779B97F4A7C15ul ^ grid[i]);
+			population += grid[i];
+		}
+	}
+
+	hashes[get_local_id(0)] = hash;
+	populations[get_local_id(0)] = population;
+
+	reduceSignature(hashes, populations, partials);
+}
+
+// tas pats bitu pakotajam režģim, jaucējvērtība tiek rēķināta katram vārdam
+__kernel __attribute__((reqd_work_group_size(SIGNATURE_GROUP_SIZE, 1, 1))) void grid_signature_packed(
+	__global const ulong *grid, ulong count, __global ulong *partials)
+{
+	__local ulong hashes[SIGNATURE_GROUP_SIZE];
+	__local ulong populations[SIGNATURE_GROUP_SIZE];
+
+	ulong hash = 0;
+	ulong population = 0;
+
+	for (size_t i = get_global_id(0); i < count; i += get_global_size(0))
+	{
+		if (grid[i] != 0)
+		{
+			hash += mixHash(i * 0x9E3779B97F4A7C15ul ^ grid[i]);
+			population += popcount(grid[i]);
+		}
+	}
+
+	hashes[get_local_id(0)] = hash;
+	populations[get_local_id(0)] = population;
+
+	reduceSignature(hashes, populations, partials);
+}
+
+// saskaita 'partialCount' darba grupu rezultātus vienā darba grupā, 'signature' ir GridSignature (divi vārdi)
+__kernel __attribute__((reqd_work_group_size(SIGNATURE_GROUP_SIZE, 1, 1))) void grid_signature_final(
+	__global const ulong *partials, uint partialCount, __global ulong *signature)
+{
+	__local ulong hashes[SIGNATURE_GROUP_SIZE];
+	__local ulong populations[SIGNATURE_GROUP_SIZE];
+
+	ulong hash = 0;
+	ulong population = 0;
+
+	for (uint i = get_local_id(0); i < partialCount; i += SIGNATURE_GROUP_SIZE)
+	{
+		hash += partials[2 * i];
+		population += partials[2 * i + 1];
+	}
+
+	hashes[get_local_id(0)] = hash;
+	populations[get_local_id(0)] = population;
+
+	reduceSignature(hashes, populations, signature);
+}
+
+// bitu pakotā režģa kaimiņu skaitīšana: katrs bits vārdā ir atsevišķa šūna, tāpēc summēšana notiek
+// ar bitu operāciju summatoriem visām 64 šūnām reizē (bit-sliced saskaitīšana)
+// 'above', 'row', 'below' ir šūnas vārds un tā kaimiņu vārdi pa kreisi un pa labi no attiecīgās rindas
+inline ulong golPackedWord(const ulong above[3], const ulong row[3], const ulong below[3])
+{
+	// kaimiņš pa kreisi šūnai x ir šūna x - 1, tātad bitus bīdām uz augšu un pirmajā bitā ieliekam
+	// kreisā vārda pēdējo bitu, kaimiņam pa labi otrādi
+	const ulong aW = (above[1] << 1) | (above[0] >> 63);
+	const ulong aE = (above[1] >> 1) | (above[2] << 63);
+	const ulong rW = (row[1] << 1) | (row[0] >> 63);
+	const ulong rE = (row[1] >> 1) | (row[2] << 63);
+	const ulong bW = (below[1] << 1) | (below[0] >> 63);
+	const ulong bE = (below[1] >> 1) | (below[2] << 63);
+
+	// katras rindas kaimiņu summa divos bitos (augšējai un apakšējai rindai 0..3, vidējai 0..2)
+	const ulong a0 = aW ^ above[1] ^ aE;
+	const ulong a1 = (aW & above[1]) | (aE & (aW ^ above[1]));
+	const ulong r0 = rW ^ rE;
+	const ulong r1 = rW & rE;
+	const ulong b0 = bW ^ below[1] ^ bE;
+	const ulong b1 = (bW & below[1]) | (bE & (bW ^ below[1]));
+
+	// visu trīs rindu summa četros bitos s0..s3 (0..8)
+	const ulong s0 = a0 ^ r0 ^ b0;
+	const ulong c0 = (a0 & r0) | (b0 & (a0 ^ r0));
+	const ulong x1 = a1 ^ r1 ^ b1;
+	const ulong y1 = (a1 & r1) | (b1 & (a1 ^ r1));
+	const ulong s1 = x1 ^ c0;
+	const ulong c1 = x1 & c0;
+	const ulong s2 = y1 ^ c1;
+	const ulong s3 = y1 & c1;
+
+#if GOL_CONWAY
+	// šūna ir dzīva, ja kaimiņu ir 3, vai ja kaimiņu ir 2 un šūna jau bija dzīva
+	return ~s3 & ~s2 & s1 & (s0 | row[1]);
+#else
+	// katram likumā minētajam kaimiņu skaitam n bitu maska, kurās šūnās summa s0..s3 ir tieši n
+	ulong born = 0;
+	ulong survives = 0;
+
+#pragma unroll
+	for (uint n = 0; n <= 8; n++)
+	{
+		if ((((GOL_BIRTH | GOL_SURVIVAL) >> n) & 1) == 0)
+			continue;
+
+		const ulong count = (n & 1 ? s0 : ~s0) & (n & 2 ? s1 : ~s1) & (n & 4 ? s2 : ~s2) & (n & 8 ? s3 : ~s3);
+
+		if ((GOL_BIRTH >> n) & 1)
+			born |= count;
+		if ((GOL_SURVIVAL >> n) & 1)
+			survives |= count;
+	}
+
+	return (row[1] & survives) | (~row[1] & born);
+#endif
+}
+
+// ielādē rindas 'rowIdx' vārdu 'wordX' ar kaimiņu vārdiem, ārpus režģa esošie vārdi ir nulles (mirušas šūnas)
+// toroidālā režģī kreisā kaimiņa 63. bits ir rindas pēdējā šūna, bet rindas pirmā šūna tiek ielikta bitā tieši aiz
+// pēdējās šūnas (vai nākamā vārda 0. bitā, ja platums dalās ar 64), kur to kā kaimiņu nolasa golPackedWord
+inline void loadPackedRow(__global const ulong *input, const size_t rowIdx, const size_t wordX, const ulong width,
+						  const ulong wordsPerRow, ulong words[3])
+{
+	const size_t rowStart = rowIdx * wordsPerRow;
+	const bool hasLeft = wordX > 0;
+	const bool hasRight = wordX < wordsPerRow - 1;
+
+	words[0] = hasLeft ? input[rowStart + wordX - 1] : 0;
+	words[1] = input[rowStart + wordX];
+	words[2] = hasRight ? input[rowStart + wordX + 1] : 0;
+
+#if GOL_WRAP
+	if (!hasLeft)
+	{
+		const ulong lastBit = (width - 1) % 64;
+		words[0] = ((input[rowStart + wordsPerRow - 1] >> lastBit) & 1) << 63;
+	}
+
+	if (!hasRight)
+	{
+		const ulong firstCell = input[rowStart] & 1;
+		const ulong tailBits = width % 64;
+
+		if (tailBits != 0)
+			words[1] |= firstCell << tailBits;
+		else
+			words[2] = firstCell;
+	}
+#endif
+}
+
+// bitu pakotais variants, viens darba vienums apstrādā vienu vārdu (64 šūnas)
+__kernel void gol_packed(__global const ulong *input, __global ulong *output, ulong width, ulong height,
+						 ulong wordsPerRow)
+{
+	const size_t wordX = get_global_id(0);
+	const size_t y = get_global_id(1);
+
+	if (wordX >= wordsPerRow || y >= height)
+		return;
+
+	const size_t flatIdx = y * wordsPerRow + wordX;
+
+	const bool hasRight = wordX < wordsPerRow - 1;
+
+	// ārpus režģa esošie vārdi ir nulles, tas atbilst mirušām šūnām aiz robežas
+	ulong above[3] = {0, 0, 0};
+	ulong row[3] = {0, 0, 0};
+	ulong below[3] = {0, 0, 0};
+
+	if (y > 0)
+		loadPackedRow(input, y - 1, wordX, width, wordsPerRow, above);
+	else if (GOL_WRAP)
+		loadPackedRow(input, height - 1, wordX, width, wordsPerRow, above);
+
+	loadPackedRow(input, y, wordX, width, wordsPerRow, row);
+
+	if (y < height - 1)
+		loadPackedRow(input, y + 1, wordX, width, wordsPerRow, below);
+	else if (GOL_WRAP)
+		loadPackedRow(input, 0, wordX, width, wordsPerRow, below);
+
+	ulong cells = golPackedWord(above, row, below);
+
+	// pēdējā vārda neizmantotajiem bitiem jāpaliek nullēm, citādi tie ietekmētu kaimiņus nākamajā solī
+	const ulong tailBits = width % 64;
+	if (!hasRight && tailBits != 0)
+	{
+		cells &= ((ulong)1 << tailBits) - 1;
+	}
+
+	output[flatIdx] = cells;
+}
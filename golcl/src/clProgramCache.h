@@ -0,0 +1,35 @@
+#pragma once
+
+#include <CL/cl.h>
+#include <string>
+#include <vector>
+
+// OpenCL programmu bināro failu kešatmiņa diskā: programma tiek kompilēta no pirmkoda tikai pirmajā palaišanā,
+// nākamajās tā tiek ielādēta ar clCreateProgramWithBinary
+// atslēga ir ierīču nosaukumi, draivera versijas, kompilēšanas opcijas un pirmkoda jaucējvērtība, tāpēc pēc draivera
+// atjaunināšanas vai kodola izmaiņām programma tiek kompilēta no jauna
+// katrā failā glabājas arī pilna atslēga, kas tiek salīdzināta ielādējot, tāpēc jaucējvērtību sakritības nav bīstamas
+class ProgramCache
+{
+  public:
+	// tukšs 'directory' atslēdz kešatmiņu
+	explicit ProgramCache(std::string directory);
+
+	// direktorija no vides mainīgā CL_PROGRAM_CACHE_DIR (tukša vērtība atslēdz kešatmiņu), citādi "kernel_cache"
+	static std::string defaultDirectory();
+
+	// atgriež uzbūvētu programmu visām 'devices' ierīcēm, 'cacheHit' norāda, vai tā ielādēta no kešatmiņas
+	// kompilēšanas kļūdas gadījumā atgriež nullptr un 'clResult' satur kļūdas kodu
+	cl_program buildProgram(cl_context context, const std::vector<cl_device_id> &devices, const std::string &source,
+							const std::string &buildOptions, bool &cacheHit, cl_int &clResult);
+
+  private:
+	std::string directory;
+
+	std::string cacheKey(const std::vector<cl_device_id> &devices, const std::string &source,
+						 const std::string &buildOptions) const;
+	std::string cacheFileName(const std::string &key) const;
+
+	bool loadBinaries(const std::string &key, std::vector<std::vector<unsigned char>> &binaries) const;
+	void storeBinaries(const std::string &key, cl_program program, size_t deviceCount) const;
+};
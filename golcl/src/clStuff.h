@@ -1,8 +1,11 @@
 #pragma once
 
-#include "clBenchmark.h"
+#include "benchmarkLogger.h"
+#include "clProgramCache.h"
 #include <CL/cl.h>
+#include <algorithm>
 #include <string>
+#include <vector>
 
 // makro assertam ar ziņojumu
 // ņemts no: https://stackoverflow.com/questions/3767869/adding-message-to-assert
@@ -35,6 +38,20 @@ class ClStuffContainer
 {
   private:
 	BenchmarkLogger &logger;
+	ProgramCache programCache;
+
+	// programmas iegūšana no bināro failu kešatmiņas vai kompilēšana no pirmkoda
+	cl_program buildProgram(const std::string &fileName, const std::string &buildOptions)
+	{
+		bool cacheHit;
+		cl_program program = programCache.buildProgram(context, {device}, readKernelFile(fileName),
+														"-cl-std=CL3.0 " + buildOptions, cacheHit, clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		logger.log("program cache hit", cacheHit ? 1 : 0);
+
+		return program;
+	}
 
   public:
 	cl_int clResult; // paredzēts openCL funkciju izsaukumu rezultātu saglabāšanai un pārbaudei
@@ -45,12 +62,18 @@ class ClStuffContainer
 	cl_context context;
 	cl_command_queue queue;
 
-	ClStuffContainer(BenchmarkLogger &logger) : logger(logger)
+	ClStuffContainer(BenchmarkLogger &logger) : logger(logger), programCache(ProgramCache::defaultDirectory())
 	{
 		clResult = clGetPlatformIDs(1, &platform, &numPlatforms);
 		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
 		clResult = clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU, 1, &device, &numDevices);
+
+		// ja GPU nav (piemēram, CPU OpenCL implementācija PoCL), izmanto jebkuru platformas ierīci
+		if (clResult == CL_DEVICE_NOT_FOUND)
+		{
+			clResult = clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, 1, &device, &numDevices);
+		}
 		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
 		context = clCreateContext(nullptr, 1, &device, nullptr, nullptr, &clResult);
@@ -72,20 +95,13 @@ class ClStuffContainer
 		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 	}
 
-	cl_kernel loadAndCreateKernel(const std::string &fileName, const std::string &kernelName)
+	// 'buildOptions' tiek pievienotas kompilatora opcijām, piemēram, -D makro definīcijas
+	cl_kernel loadAndCreateKernel(const std::string &fileName, const std::string &kernelName,
+								  const std::string &buildOptions = "")
 	{
-		std::string kernelSource = readKernelFile(fileName);
-
-		const char *kernelSourceCstring = kernelSource.c_str();
-		size_t kernelSize = kernelSource.length();
-
 		auto start = std::chrono::steady_clock::now();
 
-		cl_program program = clCreateProgramWithSource(context, 1, &kernelSourceCstring, &kernelSize, &clResult);
-		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
-
-		clResult = clBuildProgram(program, 1, &device, "-cl-std=CL3.0", nullptr, nullptr);
-		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		cl_program program = buildProgram(fileName, buildOptions);
 
 		cl_kernel kernel = clCreateKernel(program, kernelName.c_str(), &clResult);
 		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
@@ -97,6 +113,21 @@ class ClStuffContainer
 		return kernel;
 	}
 
+	// uzbūvē programmu un saglabā tās bināro failu kešatmiņā, lai nākamās palaišanas to nekompilētu
+	void prewarmProgram(const std::string &fileName, const std::string &buildOptions = "")
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		cl_program program = buildProgram(fileName, buildOptions);
+
+		auto end = std::chrono::steady_clock::now();
+
+		logger.chronoLog("program prewarm time", start, end);
+
+		clResult = clReleaseProgram(program);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	}
+
 	void getOptimalWorkGroupSize(cl_kernel kernel, size_t localSize[2])
 	{
 		size_t maxWorkGroupSize;
@@ -142,3 +173,146 @@ class ClStuffContainer
 		}
 	}
 };
+
+// vairāku ierīču konteiners: pirmās platformas ierīces vienā kopīgā kontekstā, katrai ierīcei skaitļošanas un apmaļu
+// komandu rinda, lai apmaļu pārsūtīšana varētu notikt vienlaikus ar skaitļošanu
+// ja ierīču ir mazāk nekā pieprasīts (piemēram, viena CPU ierīce PoCL), pirmā ierīce tiek sadalīta apakšierīcēs
+class ClDeviceGroup
+{
+  private:
+	BenchmarkLogger &logger;
+	ProgramCache programCache;
+	bool subDevices = false; // ierīces ir izveidotas ar clCreateSubDevices un ir jāatbrīvo
+
+  public:
+	cl_int clResult;
+	cl_platform_id platform;
+	std::vector<cl_device_id> devices;
+	cl_context context;
+	std::vector<cl_command_queue> computeQueues;
+	std::vector<cl_command_queue> haloQueues;
+
+	// 'requestedDevices' 0 nozīmē visas pieejamās ierīces
+	ClDeviceGroup(BenchmarkLogger &logger, size_t requestedDevices)
+		: logger(logger), programCache(ProgramCache::defaultDirectory())
+	{
+		clResult = clGetPlatformIDs(1, &platform, nullptr);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		cl_device_type deviceType = CL_DEVICE_TYPE_GPU;
+		cl_uint numDevices;
+		clResult = clGetDeviceIDs(platform, deviceType, 0, nullptr, &numDevices);
+
+		// ja GPU nav (piemēram, CPU OpenCL implementācija PoCL), izmanto jebkuras platformas ierīces
+		if (clResult == CL_DEVICE_NOT_FOUND)
+		{
+			deviceType = CL_DEVICE_TYPE_ALL;
+			clResult = clGetDeviceIDs(platform, deviceType, 0, nullptr, &numDevices);
+		}
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		devices.resize(numDevices);
+		clResult = clGetDeviceIDs(platform, deviceType, numDevices, devices.data(), nullptr);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		if (requestedDevices > numDevices)
+		{
+			partitionFirstDevice(requestedDevices);
+		}
+
+		if (requestedDevices > 0 && requestedDevices < devices.size())
+		{
+			devices.resize(requestedDevices);
+		}
+
+		context = clCreateContext(nullptr, static_cast<cl_uint>(devices.size()), devices.data(), nullptr, nullptr,
+								  &clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		const cl_queue_properties properties[] = {CL_QUEUE_PROPERTIES, CL_QUEUE_PROFILING_ENABLE, 0};
+
+		for (cl_device_id device : devices)
+		{
+			computeQueues.push_back(clCreateCommandQueueWithProperties(context, device, properties, &clResult));
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			haloQueues.push_back(clCreateCommandQueueWithProperties(context, device, properties, &clResult));
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		}
+	}
+
+	~ClDeviceGroup()
+	{
+		for (size_t i = 0; i < devices.size(); i++)
+		{
+			clResult = clReleaseCommandQueue(computeQueues[i]);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			clResult = clReleaseCommandQueue(haloQueues[i]);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		}
+
+		clResult = clReleaseContext(context);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		if (subDevices)
+		{
+			for (cl_device_id device : devices)
+			{
+				clReleaseDevice(device);
+			}
+		}
+	}
+
+	// sadala pirmo ierīci vienādās apakšierīcēs ar vienādu skaitļošanas vienību skaitu
+	// ja ierīce sadalīšanu neatbalsta, paliek sākotnējās ierīces
+	void partitionFirstDevice(size_t requestedDevices)
+	{
+		cl_uint computeUnits;
+		clResult = clGetDeviceInfo(devices[0], CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(cl_uint), &computeUnits, nullptr);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		const cl_device_partition_property unitsPerDevice =
+			std::max<cl_device_partition_property>(1, computeUnits / requestedDevices);
+		const cl_device_partition_property properties[] = {CL_DEVICE_PARTITION_EQUALLY, unitsPerDevice, 0};
+
+		cl_uint numSubDevices;
+		if (clCreateSubDevices(devices[0], properties, 0, nullptr, &numSubDevices) != CL_SUCCESS ||
+			numSubDevices <= devices.size())
+		{
+			std::cout << "Device partitioning is not available, using " << devices.size() << " devices\n";
+			return;
+		}
+
+		std::vector<cl_device_id> partitioned(numSubDevices);
+		clResult = clCreateSubDevices(devices[0], properties, numSubDevices, partitioned.data(), nullptr);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		devices = std::move(partitioned);
+		subDevices = true;
+	}
+
+	// programma tiek kompilēta visām grupas ierīcēm, viens kodols der visām komandu rindām
+	// 'buildOptions' tiek pievienotas kompilatora opcijām, piemēram, -D makro definīcijas
+	cl_kernel loadAndCreateKernel(const std::string &fileName, const std::string &kernelName,
+								  const std::string &buildOptions = "")
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		bool cacheHit;
+		cl_program program = programCache.buildProgram(context, devices, readKernelFile(fileName),
+														"-cl-std=CL3.0 " + buildOptions, cacheHit, clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		logger.log("program cache hit", cacheHit ? 1 : 0);
+
+		cl_kernel kernel = clCreateKernel(program, kernelName.c_str(), &clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		auto end = std::chrono::steady_clock::now();
+
+		logger.chronoLog("kernel compile time", start, end);
+
+		return kernel;
+	}
+};
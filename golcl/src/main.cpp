@@ -1,6 +1,14 @@
-#include "clBenchmark.h"
+#include "benchmarkLogger.h"
 #include "clStuff.h"
+#include "cycleDetector.h"
+#include "golBackend.h"
+#include "golHost.h"
+#include "golOptions.h"
+#include "gridIO.h"
+#include "launchTuning.h"
+#include "snapshotWriter.h"
 #include <CL/cl.h>
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <cstddef>
@@ -9,151 +17,1640 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <ostream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
-// izveido flat grid masīvu, automātiski nosakot width, height
-// met ārā kļūdas ja nav atbilstošu simbolu (1, 0) vai ja kāda rindiņa nesatur tādu pašu simbolu skaitu kā pirmā
-std::vector<cl_uchar> loadGridFromFile(const std::string &fileName, size_t &width, size_t &height)
+// golcompare šo failu kompilē vienā programmā ar CUDA vai HIP versiju, kurā ir tāda paša nosaukuma klases
+// (SnapshotRing, EnsembleExtent u.c.), tāpēc viss, izņemot makeClGolBackend un main, ir nosaukumu telpā bez vārda
+namespace
 {
-	// ejam uz faila beigām uzreiz ar 'ate', lai noteiktu faila izmēru, pēc tam iesim uz sākumu
-	std::ifstream file(fileName, std::ios::ate | std::ios::binary);
 
-	if (!file.is_open())
+// laika bloķēšanas kodola vienas darba grupas izejas apgabala izmērs šūnās, jāsakrīt ar kernels/gol.cl
+constexpr size_t TEMPORAL_TILE_W = 64;
+constexpr size_t TEMPORAL_TILE_H = 32;
+
+// vektorizētā kodola gol_vec16 šūnu skaits vienam darba vienumam, jāsakrīt ar kernels/gol.cl
+constexpr size_t VEC_CELLS = 16;
+
+// aktīvo flīžu režīmā vienas flīzes (darba grupas) izmērs šūnās, jāsakrīt ar kernels/gol.cl
+constexpr size_t ACTIVE_TILE_W = 32;
+constexpr size_t ACTIVE_TILE_H = 8;
+
+// režģa paraksta kodolu darba grupas izmērs, jāsakrīt ar kernels/gol.cl, un lielākais darba grupu skaits
+constexpr size_t SIGNATURE_GROUP_SIZE = 256;
+constexpr size_t SIGNATURE_MAX_GROUPS = 1024;
+
+// -D opcijas, ar kurām kernels/gol.cl tiek kompilēts --rule likumam un --wrap robežai
+std::string golBuildOptions(const GolOptions &options)
+{
+	return "-DGOL_BIRTH=" + std::to_string(options.birthMask) + " -DGOL_SURVIVAL=" +
+		   std::to_string(options.survivalMask) + " -DGOL_WRAP=" + (options.wrap ? "1" : "0");
+}
+
+// izvades nolasīšanas daļas izmērs baitos, daļas tiek rakstītas failā, kamēr nākamās vēl tiek kopētas
+constexpr size_t READBACK_CHUNK_BYTES = 4 << 20;
+
+// asinhronajā režīmā notikumu skaits vienā kopā, pēc kuras aizpildīšanas tiek nolasīti iepriekšējās kopas laiki
+constexpr size_t ASYNC_EVENT_POOL_SIZE = 256;
+
+// aktīvo flīžu režīms: katrā solī vispirms tiek sastādīts aktīvo flīžu darba saraksts, no ierīces tiek nolasīts
+// tikai tā garums (tas nosaka darba grupu skaitu), un tad tiek pārrēķinātas tikai saraksta flīzes
+// sākumā visas flīzes ir atzīmētas kā mainījušās, tāpēc pirmais solis aizpilda visu izejas buferi
+// 'totalTime' tiek papildināts nanosekundēs, tāpat kā GameOfLifeStep
+void runStepsActiveTiles(ClStuffContainer &clStuffContainer, cl_mem &input, cl_mem &output, cl_ulong width,
+						 cl_ulong height, size_t steps, const std::string &buildOptions, double &totalTime,
+						 BenchmarkLogger &logger)
+{
+	cl_int clResult;
+
+	const cl_int tilesX = static_cast<cl_int>((width + ACTIVE_TILE_W - 1) / ACTIVE_TILE_W);
+	const cl_int tilesY = static_cast<cl_int>((height + ACTIVE_TILE_H - 1) / ACTIVE_TILE_H);
+	const size_t tileCount = static_cast<size_t>(tilesX) * tilesY;
+
+	cl_mem changed = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE, tileCount, nullptr, &clResult);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+	cl_mem nextChanged = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE, tileCount, nullptr, &clResult);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+	cl_mem worklist = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE, tileCount * sizeof(cl_uint),
+									 nullptr, &clResult);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+	cl_mem workCount =
+		clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE, sizeof(cl_uint), nullptr, &clResult);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+	const cl_uchar one = 1;
+	clResult = clEnqueueFillBuffer(clStuffContainer.queue, changed, &one, sizeof(one), 0, tileCount, 0, nullptr,
+								   nullptr);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+	cl_kernel worklistKernel = clStuffContainer.loadAndCreateKernel("kernels/gol.cl", "build_tile_worklist");
+	cl_kernel tileKernel = clStuffContainer.loadAndCreateKernel("kernels/gol.cl", "gol_active_tile", buildOptions);
+
+	size_t worklistLocalSize[2];
+	clStuffContainer.getOptimalWorkGroupSize(worklistKernel, worklistLocalSize);
+
+	size_t worklistGlobalSize[2] = {
+		((tilesX + worklistLocalSize[0] - 1) / worklistLocalSize[0]) * worklistLocalSize[0],
+		((tilesY + worklistLocalSize[1] - 1) / worklistLocalSize[1]) * worklistLocalSize[1]};
+
+	// gol_active_tile darba grupas izmērs ir fiksēts ar reqd_work_group_size
+	size_t tileLocalSize[2] = {ACTIVE_TILE_W, ACTIVE_TILE_H};
+
+	clResult = clSetKernelArg(worklistKernel, 2, sizeof(cl_mem), &worklist);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	clResult = clSetKernelArg(worklistKernel, 3, sizeof(cl_mem), &workCount);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	clResult = clSetKernelArg(worklistKernel, 4, sizeof(cl_int), &tilesX);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	clResult = clSetKernelArg(worklistKernel, 5, sizeof(cl_int), &tilesY);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+	clResult = clSetKernelArg(tileKernel, 2, sizeof(cl_ulong), &width);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	clResult = clSetKernelArg(tileKernel, 3, sizeof(cl_ulong), &height);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	clResult = clSetKernelArg(tileKernel, 4, sizeof(cl_mem), &worklist);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	clResult = clSetKernelArg(tileKernel, 6, sizeof(cl_int), &tilesX);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+	double activeTileSum = 0;
+
+	for (size_t step = 0; step < steps; step++)
+	{
+		const cl_uint zero = 0;
+		clResult = clEnqueueFillBuffer(clStuffContainer.queue, workCount, &zero, sizeof(zero), 0, sizeof(zero), 0,
+									   nullptr, nullptr);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		clResult = clSetKernelArg(worklistKernel, 0, sizeof(cl_mem), &changed);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(worklistKernel, 1, sizeof(cl_mem), &nextChanged);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		cl_event worklistEvent;
+		clResult = clEnqueueNDRangeKernel(clStuffContainer.queue, worklistKernel, 2, nullptr, worklistGlobalSize,
+										  worklistLocalSize, 0, nullptr, &worklistEvent);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		cl_uint activeTiles = 0;
+		clResult = clEnqueueReadBuffer(clStuffContainer.queue, workCount, CL_TRUE, 0, sizeof(cl_uint), &activeTiles, 0,
+									   nullptr, nullptr);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		cl_ulong kernelStart, kernelEnd;
+		clGetEventProfilingInfo(worklistEvent, CL_PROFILING_COMMAND_START, sizeof(kernelStart), &kernelStart, nullptr);
+		clGetEventProfilingInfo(worklistEvent, CL_PROFILING_COMMAND_END, sizeof(kernelEnd), &kernelEnd, nullptr);
+		double kernelExecTime = static_cast<double>(kernelEnd - kernelStart);
+		clReleaseEvent(worklistEvent);
+
+		if (activeTiles > 0)
+		{
+			clResult = clSetKernelArg(tileKernel, 0, sizeof(cl_mem), &input);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(tileKernel, 1, sizeof(cl_mem), &output);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(tileKernel, 5, sizeof(cl_mem), &nextChanged);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			// katra darba grupa apstrādā vienu darba saraksta flīzi
+			size_t tileGlobalSize[2] = {activeTiles * ACTIVE_TILE_W, ACTIVE_TILE_H};
+
+			cl_event tileEvent;
+			clResult = clEnqueueNDRangeKernel(clStuffContainer.queue, tileKernel, 2, nullptr, tileGlobalSize,
+											  tileLocalSize, 0, nullptr, &tileEvent);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			clWaitForEvents(1, &tileEvent);
+
+			clGetEventProfilingInfo(tileEvent, CL_PROFILING_COMMAND_START, sizeof(kernelStart), &kernelStart, nullptr);
+			clGetEventProfilingInfo(tileEvent, CL_PROFILING_COMMAND_END, sizeof(kernelEnd), &kernelEnd, nullptr);
+			kernelExecTime += static_cast<double>(kernelEnd - kernelStart);
+			clReleaseEvent(tileEvent);
+		}
+
+		logger.log("kernel exec time", kernelExecTime / 1e6);
+		totalTime += kernelExecTime;
+
+		const double activeFraction = static_cast<double>(activeTiles) / tileCount;
+		logger.log("active tile fraction", activeFraction);
+		activeTileSum += activeFraction;
+
+		std::swap(input, output);
+		std::swap(changed, nextChanged);
+	}
+
+	if (steps > 0)
+	{
+		logger.log("mean active tile fraction", activeTileSum / steps);
+	}
+
+	clReleaseKernel(worklistKernel);
+	clReleaseKernel(tileKernel);
+	clReleaseMemObject(changed);
+	clReleaseMemObject(nextChanged);
+	clReleaseMemObject(worklist);
+	clReleaseMemObject(workCount);
+}
+
+// momentuzņēmumu gredzens: režģis tiek kopēts piespraustās atmiņas ligzdā atsevišķā komandu rindā, kamēr kodoli
+// turpina darbu, un failā to ieraksta SnapshotWriter fona pavediens
+// ierīces buferi, no kura vēl notiek kopēšana, nedrīkst pārrakstīt, tāpēc pirms katra izsaukuma galvenajā rindā
+// tiek ierindota barjera, kas sagaida attiecīgās kopēšanas notikumu (beforeLaunch)
+template <typename Cell>
+class SnapshotRing
+{
+  public:
+	SnapshotRing(ClStuffContainer &clStuffContainer, const std::string &pathTemplate, size_t width, size_t height,
+				 size_t gridSize)
+		: clStuffContainer(clStuffContainer), gridSize(gridSize)
+	{
+		cl_int clResult;
+
+		copyQueue = clCreateCommandQueueWithProperties(clStuffContainer.context, clStuffContainer.device, nullptr,
+													   &clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		std::vector<Cell *> slotPointers(SNAPSHOT_SLOTS);
+
+		for (size_t slot = 0; slot < SNAPSHOT_SLOTS; slot++)
+		{
+			slotBuffers[slot] = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
+											   gridSize * sizeof(Cell), nullptr, &clResult);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			slotPointers[slot] = static_cast<Cell *>(clEnqueueMapBuffer(copyQueue, slotBuffers[slot], CL_TRUE,
+																		CL_MAP_READ | CL_MAP_WRITE, 0,
+																		gridSize * sizeof(Cell), 0, nullptr, nullptr,
+																		&clResult));
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			copyEvents[slot] = nullptr;
+			slotSources[slot] = nullptr;
+		}
+
+		writer = std::make_unique<SnapshotWriter<Cell>>(pathTemplate, width, height, gridSize, slotPointers);
+		pointers = std::move(slotPointers);
+	}
+
+	~SnapshotRing()
+	{
+		// rakstītājs izmanto ligzdas un notikumus, tāpēc tas jāaptur pirms to atbrīvošanas
+		writer.reset();
+
+		for (size_t slot = 0; slot < SNAPSHOT_SLOTS; slot++)
+		{
+			clEnqueueUnmapMemObject(copyQueue, slotBuffers[slot], pointers[slot], 0, nullptr, nullptr);
+			if (copyEvents[slot] != nullptr)
+			{
+				clReleaseEvent(copyEvents[slot]);
+			}
+		}
+
+		clFinish(copyQueue);
+
+		for (cl_mem buffer : slotBuffers)
+		{
+			clReleaseMemObject(buffer);
+		}
+		clReleaseCommandQueue(copyQueue);
+	}
+
+	SnapshotRing(const SnapshotRing &) = delete;
+	SnapshotRing &operator=(const SnapshotRing &) = delete;
+
+	// galvenā rinda gaida, līdz beidzas visas kopēšanas no 'output', pirms kodols to pārraksta
+	void beforeLaunch(cl_mem output)
+	{
+		for (size_t slot = 0; slot < SNAPSHOT_SLOTS; slot++)
+		{
+			if (slotSources[slot] == output)
+			{
+				cl_int clResult =
+					clEnqueueBarrierWithWaitList(clStuffContainer.queue, 1, &copyEvents[slot], nullptr);
+				ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+				slotSources[slot] = nullptr;
+			}
+		}
+	}
+
+	// 'grid' jau jābūt izrēķinātam, ja visas ligzdas ir aizņemtas, momentuzņēmums tiek izlaists
+	void capture(cl_mem grid, size_t generation)
+	{
+		size_t slot;
+		if (!writer->acquireSlot(slot))
+		{
+			return;
+		}
+
+		// brīvas ligzdas iepriekšējo notikumu rakstītājs vairs negaida
+		if (copyEvents[slot] != nullptr)
+		{
+			clReleaseEvent(copyEvents[slot]);
+		}
+
+		cl_int clResult = clEnqueueReadBuffer(copyQueue, grid, CL_FALSE, 0, gridSize * sizeof(Cell), pointers[slot], 0,
+											  nullptr, &copyEvents[slot]);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clFlush(copyQueue);
+
+		slotSources[slot] = grid;
+
+		cl_event copyEvent = copyEvents[slot];
+		writer->submit(slot, generation, [copyEvent]() {
+			cl_int clResult = clWaitForEvents(1, &copyEvent);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		});
+	}
+
+	// sagaida visu momentuzņēmumu ierakstīšanu un ielogo to aizkavi un izlaisto momentuzņēmumu skaitu
+	void finish(BenchmarkLogger &logger)
+	{
+		writer->finish();
+
+		for (double lag : writer->lags())
+		{
+			logger.log("snapshot lag", lag);
+		}
+		logger.log("dropped snapshots", static_cast<double>(writer->dropped()));
+	}
+
+  private:
+	ClStuffContainer &clStuffContainer;
+	const size_t gridSize;
+	cl_command_queue copyQueue;
+	cl_mem slotBuffers[SNAPSHOT_SLOTS];
+	std::vector<Cell *> pointers;
+	cl_event copyEvents[SNAPSHOT_SLOTS];
+	cl_mem slotSources[SNAPSHOT_SLOTS]; // ierīces buferis, no kura ligzdā vēl var notikt kopēšana
+	std::unique_ptr<SnapshotWriter<Cell>> writer;
+};
+
+// ierīces apzīmējums darba grupu izmēru kešatmiņai
+std::string tuningDeviceName(cl_device_id device)
+{
+	char name[256] = {};
+	char driverVersion[256] = {};
+	clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(name) - 1, name, nullptr);
+	clGetDeviceInfo(device, CL_DRIVER_VERSION, sizeof(driverVersion) - 1, driverVersion, nullptr);
+
+	return std::string(name) + " " + driverVersion;
+}
+
+// vidējais viena kodola izsaukuma laiks milisekundēs pēc viena iesildīšanas izsaukuma, kodola argumentiem jābūt
+// iestatītiem; ja ierīce vai kodols darba grupas izmēru nepieņem, atgriež -1
+double timeKernelLaunches(ClStuffContainer &clStuffContainer, cl_kernel kernel, const size_t globalSize[2],
+						  const size_t localSize[2])
+{
+	size_t maxWorkGroupSize;
+	cl_int clResult = clGetKernelWorkGroupInfo(kernel, clStuffContainer.device, CL_KERNEL_WORK_GROUP_SIZE,
+											   sizeof(size_t), &maxWorkGroupSize, nullptr);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+	size_t maxWorkItemDims[3];
+	clResult = clGetDeviceInfo(clStuffContainer.device, CL_DEVICE_MAX_WORK_ITEM_SIZES, sizeof(maxWorkItemDims),
+							   maxWorkItemDims, nullptr);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+	if (localSize[0] * localSize[1] > maxWorkGroupSize || localSize[0] > maxWorkItemDims[0] ||
+		localSize[1] > maxWorkItemDims[1])
+	{
+		return -1;
+	}
+
+	// piemēram, par daudz lokālās atmiņas šim izmēram
+	if (clEnqueueNDRangeKernel(clStuffContainer.queue, kernel, 2, nullptr, globalSize, localSize, 0, nullptr,
+							   nullptr) != CL_SUCCESS)
+	{
+		return -1;
+	}
+
+	cl_event firstEvent = nullptr;
+	cl_event lastEvent = nullptr;
+
+	for (size_t i = 0; i < AUTOTUNE_LAUNCHES; i++)
+	{
+		cl_event *event = i == 0 ? &firstEvent : (i + 1 == AUTOTUNE_LAUNCHES ? &lastEvent : nullptr);
+
+		clResult = clEnqueueNDRangeKernel(clStuffContainer.queue, kernel, 2, nullptr, globalSize, localSize, 0,
+										  nullptr, event);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	}
+
+	clResult = clFinish(clStuffContainer.queue);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+	cl_ulong start;
+	cl_ulong end;
+	clGetEventProfilingInfo(firstEvent, CL_PROFILING_COMMAND_START, sizeof(start), &start, nullptr);
+	clGetEventProfilingInfo(lastEvent != nullptr ? lastEvent : firstEvent, CL_PROFILING_COMMAND_END, sizeof(end),
+							&end, nullptr);
+
+	clReleaseEvent(firstEvent);
+	if (lastEvent != nullptr)
+	{
+		clReleaseEvent(lastEvent);
+	}
+
+	return static_cast<double>(end - start) / 1e6 / AUTOTUNE_LAUNCHES;
+}
+
+// viena režģa buferi OpenCL ierīcē un kodolu izsaukumi pa soļiem (golBackend.h saskarne)
+// 'Cell' ir cl_uchar (viena šūna baitā) vai cl_ulong (bitu pakots režģis, 64 šūnas vārdā)
+// GameOfLifeStep izmanto šos pašus buferus un izsaukumus, bet savos režīmos kodolus izsauc pats
+template <typename Cell>
+class ClGolGrid : public GolBackend
+{
+  public:
+	static constexpr bool packed = std::is_same<Cell, cl_ulong>::value;
+
+	// piespraustie buferi ir attēloti resursdatora atmiņā, no tās ievade tiek pārsūtīta un tajā izvade tiek nolasīta
+	Cell *hostPinnedInput = nullptr;
+	Cell *hostPinnedOutput = nullptr;
+
+	// pēc katra izsaukuma buferi tiek samainīti, tāpēc pēdējais rezultāts vienmēr atrodas 'currentInput'
+	cl_mem currentInput = nullptr;
+	cl_mem currentOutput = nullptr;
+
+	ClGolGrid(ClStuffContainer &clStuffContainer, BenchmarkLogger &logger)
+		: clStuffContainer(clStuffContainer), logger(logger)
+	{
+	}
+
+	~ClGolGrid() override
+	{
+		if (hostPinnedInputBuffer == nullptr)
+		{
+			return;
+		}
+
+		clResult = clEnqueueUnmapMemObject(clStuffContainer.queue, hostPinnedInputBuffer, hostPinnedInput, 0, nullptr,
+										   nullptr);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		clResult = clEnqueueUnmapMemObject(clStuffContainer.queue, hostPinnedOutputBuffer, hostPinnedOutput, 0, nullptr,
+										   nullptr);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		clReleaseMemObject(hostPinnedInputBuffer);
+		clReleaseMemObject(hostPinnedOutputBuffer);
+		clReleaseMemObject(currentInput);
+		clReleaseMemObject(currentOutput);
+		if (kernel != nullptr)
+		{
+			clReleaseKernel(kernel);
+		}
+		if (temporalKernel != nullptr)
+		{
+			clReleaseKernel(temporalKernel);
+		}
+	}
+
+	ClGolGrid(const ClGolGrid &) = delete;
+	ClGolGrid &operator=(const ClGolGrid &) = delete;
+
+	const char *platform() const override
+	{
+		return "OpenCL";
+	}
+
+	void allocate(size_t width, size_t height, const GolOptions &options) override
+	{
+		this->width = width;
+		this->height = height;
+		this->options = options;
+
+		// pakotā režģī rindas elementi ir vārdi, nevis šūnas
+		rowElements = packed ? packedWordsPerRow(width) : width;
+		gridSize = rowElements * height;
+
+		auto start = std::chrono::steady_clock::now();
+
+		hostPinnedInputBuffer = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
+											   gridSize * sizeof(Cell), nullptr, &clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		hostPinnedOutputBuffer = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
+												gridSize * sizeof(Cell), nullptr, &clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		// ievades buferis tiks pilnībā pārrakstīts, tāpēc tā iepriekšējais saturs nav jāsaglabā
+		hostPinnedInput = static_cast<Cell *>(
+			clEnqueueMapBuffer(clStuffContainer.queue, hostPinnedInputBuffer, CL_TRUE, CL_MAP_WRITE_INVALIDATE_REGION,
+							   0, gridSize * sizeof(Cell), 0, nullptr, nullptr, &clResult));
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		hostPinnedOutput = static_cast<Cell *>(clEnqueueMapBuffer(clStuffContainer.queue, hostPinnedOutputBuffer,
+																  CL_TRUE, CL_MAP_WRITE, 0, gridSize * sizeof(Cell),
+																  0, nullptr, nullptr, &clResult));
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		currentInput =
+			clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE, gridSize * sizeof(Cell), nullptr, &clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		currentOutput =
+			clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE, gridSize * sizeof(Cell), nullptr, &clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		auto end = std::chrono::steady_clock::now();
+		logger.chronoLog("buffer creation time", start, end);
+	}
+
+	size_t gridElements() const
+	{
+		return gridSize;
+	}
+
+	// 'cells' var būt arī pats 'hostPinnedInput', tad šūnas netiek kopētas
+	void upload(const void *cells) override
+	{
+		if (cells != hostPinnedInput)
+		{
+			std::memcpy(hostPinnedInput, cells, gridSize * sizeof(Cell));
+		}
+
+		cl_event transferEvent;
+
+		clResult = clEnqueueWriteBuffer(clStuffContainer.queue, currentInput, CL_TRUE, 0, gridSize * sizeof(Cell),
+										hostPinnedInput, 0, nullptr, &transferEvent);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		clWaitForEvents(1, &transferEvent);
+
+		const double transferTime = eventMs(transferEvent, transferEvent);
+		logger.log("host-to-device transfer time", transferTime);
+
+		timings.uploadMs += transferTime;
+
+		clReleaseEvent(transferEvent);
+	}
+
+	// darba grupas izmērs pēc noklusējuma nāk no getOptimalWorkGroupSize, --autotune izmēra kandidātus uz
+	// augšupielādētā režģa un saglabā ātrāko, mērījumu izsaukumi tikai lasa ievades buferi, tāpēc režģa stāvoklis
+	// nemainās; step to izsauc pirms pirmā izsaukuma, ja tas nav izsaukts jau iepriekš
+	void tune()
+	{
+		const std::string buildOptions = golBuildOptions(options);
+
+		// --vectorized ir pieejams tikai baitu režģim, to jau pārbaudīja parseGolOptions
+		const bool vectorized = !packed && options.vectorized;
+		const char *kernelName = packed ? "gol_packed" : (vectorized ? "gol_vec16" : "gol");
+
+		kernel = clStuffContainer.loadAndCreateKernel("kernels/gol.cl", kernelName, buildOptions);
+
+		// vektorizētajā kodolā katrs darba vienums apstrādā VEC_CELLS rindas šūnas
+		const cl_ulong kernelColumns = vectorized ? (width + VEC_CELLS - 1) / VEC_CELLS : rowElements;
+
+		const cl_ulong kernelWidth = width;
+		const cl_ulong kernelHeight = height;
+		const cl_ulong kernelRowElements = rowElements;
+
+		clResult = clSetKernelArg(kernel, 2, sizeof(cl_ulong), &kernelWidth);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(kernel, 3, sizeof(cl_ulong), &kernelHeight);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		if constexpr (packed)
+		{
+			clResult = clSetKernelArg(kernel, 4, sizeof(cl_ulong), &kernelRowElements);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		}
+
+		auto start = std::chrono::steady_clock::now();
+
+		TuningCache tuningCache(TuningCache::defaultFileName());
+		const std::string tuningDevice = tuningDeviceName(clStuffContainer.device);
+
+		// 'globalSizeFor' aprēķina globālo izmēru konkrētam darba grupas izmēram, 'setLocalArgs' iestata no tā
+		// atkarīgos lokālās atmiņas argumentus
+		auto tunedLocalSize = [&](cl_kernel tunedKernel, const std::string &tunedKernelName, size_t tunedLocal[2],
+								  auto globalSizeFor, auto setLocalArgs) {
+			size_t heuristicSize[2];
+			clStuffContainer.getOptimalWorkGroupSize(tunedKernel, heuristicSize);
+
+			clResult = clSetKernelArg(tunedKernel, 0, sizeof(cl_mem), &currentInput);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(tunedKernel, 1, sizeof(cl_mem), &currentOutput);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			const LaunchShape shape = resolveLaunchShape(
+				tuningCache, tuningDevice, tunedKernelName, options.autotune,
+				LaunchShape{heuristicSize[0], heuristicSize[1]},
+				[&](LaunchShape candidate) {
+					const size_t candidateLocalSize[2] = {candidate.x, candidate.y};
+					size_t candidateGlobalSize[2];
+					globalSizeFor(candidateLocalSize, candidateGlobalSize);
+					setLocalArgs(candidateLocalSize);
+
+					return timeKernelLaunches(clStuffContainer, tunedKernel, candidateGlobalSize, candidateLocalSize);
+				},
+				logger);
+
+			tunedLocal[0] = shape.x;
+			tunedLocal[1] = shape.y;
+			setLocalArgs(tunedLocal);
+
+			logger.log(tunedKernelName + " work group width", static_cast<double>(shape.x));
+			logger.log(tunedKernelName + " work group height", static_cast<double>(shape.y));
+		};
+
+		auto noLocalArgs = [](const size_t *) {};
+
+		auto roundedGlobalSize = [&](const size_t local[2], size_t global[2]) {
+			global[0] = ((kernelColumns + local[0] - 1) / local[0]) * local[0];
+			global[1] = ((height + local[1] - 1) / local[1]) * local[1];
+		};
+
+		// katra laika bloķēšanas darba grupa apstrādā TEMPORAL_TILE_W x TEMPORAL_TILE_H apgabalu neatkarīgi no tās
+		// izmēra
+		auto temporalGlobalSizeFor = [&](const size_t local[2], size_t global[2]) {
+			global[0] = ((width + TEMPORAL_TILE_W - 1) / TEMPORAL_TILE_W) * local[0];
+			global[1] = ((height + TEMPORAL_TILE_H - 1) / TEMPORAL_TILE_H) * local[1];
+		};
+
+		// gol_vec16 apgabals ar apmali: (lokālais augstums + 2) rindas pa (lokālais platums + 2) * VEC_CELLS šūnām
+		auto setTileArg = [&](const size_t local[2]) {
+			if (vectorized)
+			{
+				clResult = clSetKernelArg(kernel, 4, (local[1] + 2) * (local[0] + 2) * VEC_CELLS, nullptr);
+				ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			}
+		};
+
+		tunedLocalSize(kernel, kernelName, localSize, roundedGlobalSize, setTileArg);
+		roundedGlobalSize(localSize, globalSize);
+
+		if (options.blockSteps > 1)
+		{
+			temporalKernel = clStuffContainer.loadAndCreateKernel("kernels/gol.cl", "gol_temporal", buildOptions);
+
+			clResult = clSetKernelArg(temporalKernel, 2, sizeof(cl_ulong), &kernelWidth);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(temporalKernel, 3, sizeof(cl_ulong), &kernelHeight);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			// lokālās atmiņas apjoms atkarīgs no paaudžu skaita, tāpēc tas ir daļa no kešatmiņas atslēgas
+			setTemporalArgs(options.blockSteps);
+
+			tunedLocalSize(temporalKernel, "gol_temporal k" + std::to_string(options.blockSteps), temporalLocalSize,
+						   temporalGlobalSizeFor, noLocalArgs);
+			temporalGlobalSizeFor(temporalLocalSize, temporalGlobalSize);
+		}
+
+		tuned = true;
+
+		auto end = std::chrono::steady_clock::now();
+		logger.chronoLog("launch tuning time", start, end);
+	}
+
+	// ierinda vienu kodola izsaukumu, kas izrēķina 'launchSteps' paaudzes, un samaina buferus
+	void enqueueGenerations(size_t launchSteps, cl_event *event)
+	{
+		const bool temporal = launchSteps > 1;
+
+		cl_kernel launchKernel = temporal ? temporalKernel : kernel;
+
+		clResult = clSetKernelArg(launchKernel, 0, sizeof(cl_mem), &currentInput);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(launchKernel, 1, sizeof(cl_mem), &currentOutput);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		if (temporal)
+		{
+			setTemporalArgs(launchSteps);
+		}
+
+		clResult = clEnqueueNDRangeKernel(clStuffContainer.queue, launchKernel, 2, nullptr,
+										  temporal ? temporalGlobalSize : globalSize,
+										  temporal ? temporalLocalSize : localSize, 0, nullptr, event);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		std::swap(currentInput, currentOutput);
+	}
+
+	// katrs izsaukums tiek sagaidīts un tā laiks ielogots, pēdējais var izrēķināt mazāk par options.blockSteps paaudzēm
+	void step(size_t generations) override
+	{
+		if (!tuned)
+		{
+			tune();
+		}
+
+		for (size_t step = 0; step < generations;)
+		{
+			const size_t launchSteps = std::min(options.blockSteps, generations - step);
+
+			cl_event event;
+			enqueueGenerations(launchSteps, &event);
+			clFinish(clStuffContainer.queue);
+
+			clResult = clWaitForEvents(1, &event);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			const double kernelExecTime = eventMs(event, event, CL_PROFILING_COMMAND_COMPLETE);
+			logger.log("kernel exec time", kernelExecTime);
+			timings.kernelMs += kernelExecTime;
+
+			clReleaseEvent(event);
+
+			step += launchSteps;
+		}
+	}
+
+	void download(void *cells) override
+	{
+		cl_event transferEvent;
+
+		clResult = clEnqueueReadBuffer(clStuffContainer.queue, currentInput, CL_TRUE, 0, gridSize * sizeof(Cell),
+									   hostPinnedOutput, 0, nullptr, &transferEvent);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		const double transferTime = eventMs(transferEvent, transferEvent);
+		logger.log("device-to-host transfer time", transferTime);
+
+		timings.downloadMs += transferTime;
+
+		clReleaseEvent(transferEvent);
+
+		std::memcpy(cells, hostPinnedOutput, gridSize * sizeof(Cell));
+	}
+
+	// izvade tiek nolasīta pa rindu daļām: visas nolasīšanas tiek ierindotas bez gaidīšanas, un, kamēr ierīce kopē
+	// nākamās daļas, resursdators jau formatē un raksta failā iepriekšējās tieši no piespraustā bufera
+	void downloadTo(GridFileWriter &writer)
+	{
+		const size_t rowsPerChunk = std::max<size_t>(1, READBACK_CHUNK_BYTES / (rowElements * sizeof(Cell)));
+		const size_t chunkCount = (height + rowsPerChunk - 1) / rowsPerChunk;
+
+		std::vector<cl_event> chunkEvents(chunkCount);
+
+		for (size_t chunk = 0; chunk < chunkCount; chunk++)
+		{
+			const size_t offset = chunk * rowsPerChunk * rowElements;
+			const size_t rows = std::min<size_t>(rowsPerChunk, height - chunk * rowsPerChunk);
+
+			clResult = clEnqueueReadBuffer(clStuffContainer.queue, currentInput, CL_FALSE, offset * sizeof(Cell),
+										   rows * rowElements * sizeof(Cell), hostPinnedOutput + offset, 0, nullptr,
+										   &chunkEvents[chunk]);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		}
+		clFlush(clStuffContainer.queue);
+
+		for (size_t chunk = 0; chunk < chunkCount; chunk++)
+		{
+			const size_t rowBegin = chunk * rowsPerChunk;
+
+			clResult = clWaitForEvents(1, &chunkEvents[chunk]);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			writer.writeRows(hostPinnedOutput + rowBegin * rowElements, rowBegin,
+							 std::min<size_t>(rowsPerChunk, height - rowBegin));
+		}
+
+		const double transferTime = eventMs(chunkEvents.front(), chunkEvents.back());
+		logger.log("device-to-host transfer time", transferTime);
+
+		timings.downloadMs += transferTime;
+
+		for (cl_event chunkEvent : chunkEvents)
+		{
+			clReleaseEvent(chunkEvent);
+		}
+	}
+
+	GolTiming timing() const override
+	{
+		return timings;
+	}
+
+  private:
+	ClStuffContainer &clStuffContainer;
+	BenchmarkLogger &logger;
+	GolOptions options;
+
+	cl_int clResult;
+
+	size_t width = 0;
+	size_t height = 0;
+	size_t rowElements = 0;
+	size_t gridSize = 0;
+
+	cl_mem hostPinnedInputBuffer = nullptr;
+	cl_mem hostPinnedOutputBuffer = nullptr;
+
+	bool tuned = false;
+	cl_kernel kernel = nullptr;
+	cl_kernel temporalKernel = nullptr;
+	size_t localSize[2] = {1, 1};
+	size_t globalSize[2] = {1, 1};
+	size_t temporalLocalSize[2] = {1, 1};
+	size_t temporalGlobalSize[2] = {1, 1};
+
+	GolTiming timings;
+
+	// laiks milisekundēs no 'first' sākuma līdz 'last' beigām
+	static double eventMs(cl_event first, cl_event last, cl_profiling_info endInfo = CL_PROFILING_COMMAND_END)
+	{
+		cl_ulong start;
+		cl_ulong end;
+
+		clGetEventProfilingInfo(first, CL_PROFILING_COMMAND_START, sizeof(start), &start, nullptr);
+		clGetEventProfilingInfo(last, endInfo, sizeof(end), &end, nullptr);
+
+		return static_cast<double>(end - start) / 1e6;
+	}
+
+	// laika bloķēšanas kodola paaudžu skaits un divi lokālās atmiņas apgabali, kuru izmērs atkarīgs no tā
+	void setTemporalArgs(size_t generations)
+	{
+		const cl_int gens = static_cast<cl_int>(generations);
+		const size_t tileBytes = (TEMPORAL_TILE_W + 2 * gens) * (TEMPORAL_TILE_H + 2 * gens);
+
+		clResult = clSetKernelArg(temporalKernel, 4, sizeof(cl_int), &gens);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(temporalKernel, 5, tileBytes, nullptr);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(temporalKernel, 6, tileBytes, nullptr);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	}
+};
+
+// režģis no faila tiek atkodēts tieši ClGolGrid piespraustajā buferī, no kura notiek pārsūtīšana
+// 'Cell' ir cl_uchar (viena šūna baitā) vai cl_ulong (bitu pakots režģis, 64 šūnas vārdā)
+// 'blockSteps' > 1 nozīmē, ka katrs kodola izsaukums izrēķina līdz 'blockSteps' paaudzēm (tikai baitu režģim)
+// rezultāts no piespraustā bufera tiek nodots 'writer' pa rindu daļām, 'writer.finish()' izsauc izsaucējs
+template <typename Cell>
+void GameOfLifeStep(ClStuffContainer &clStuffContainer, const MappedGridFile &gridFile, GridFileWriter &writer,
+					cl_ulong width, cl_ulong height, size_t steps, const GolOptions &options, BenchmarkLogger &logger)
+{
+	constexpr bool packed = std::is_same<Cell, cl_ulong>::value;
+
+	cl_int clResult;
+
+	ClGolGrid<Cell> grid(clStuffContainer, logger);
+	grid.allocate(width, height, options);
+
+	auto start = std::chrono::steady_clock::now();
+
+	if constexpr (packed)
+	{
+		gridFile.decodePackedInto(grid.hostPinnedInput);
+	}
+	else
+	{
+		gridFile.decodeInto(grid.hostPinnedInput);
+	}
+
+	auto end = std::chrono::steady_clock::now();
+	logger.chronoLog("grid decode time", start, end);
+
+	start = std::chrono::steady_clock::now();
+
+	grid.upload(grid.hostPinnedInput);
+
+	end = std::chrono::steady_clock::now();
+	logger.chronoLog("total host-to-device transfer time", start, end);
+
+	grid.tune();
+
+	// nanosekundēs, tāpat kā runStepsActiveTiles
+	double totalTime = 0;
+
+	// nolasa izpildīto kodolu laikus no notikumiem un tos atbrīvo
+	auto readBackEvents = [&](std::vector<cl_event> &events) {
+		if (events.empty())
+		{
+			return;
+		}
+
+		clResult = clWaitForEvents(static_cast<cl_uint>(events.size()), events.data());
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		for (cl_event event : events)
+		{
+			cl_ulong start;
+			cl_ulong end;
+
+			clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(start), &start, nullptr);
+			clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_COMPLETE, sizeof(end), &end, nullptr);
+
+			double kernelExecTime = static_cast<double>(end - start);
+			logger.log("kernel exec time", kernelExecTime / 1e6);
+			totalTime += kernelExecTime;
+
+			clReleaseEvent(event);
+		}
+
+		events.clear();
+	};
+
+	if (options.async)
+	{
+		// izsaukumi tiek ierindoti bez gaidīšanas, rinda ir secīga, tāpēc ping-pong buferu atkarības saglabājas
+		// divas notikumu kopas mainās pa kārtai: kamēr GPU izpilda vienu, tiek nolasīti otras laiki
+		std::vector<cl_event> eventPools[2];
+		eventPools[0].reserve(ASYNC_EVENT_POOL_SIZE);
+		eventPools[1].reserve(ASYNC_EVENT_POOL_SIZE);
+
+		size_t pool = 0;
+
+		for (size_t step = 0; step < steps;)
+		{
+			const size_t launchSteps = std::min(options.blockSteps, steps - step);
+
+			cl_event event;
+			grid.enqueueGenerations(launchSteps, &event);
+			eventPools[pool].push_back(event);
+
+			step += launchSteps;
+
+			if (eventPools[pool].size() == ASYNC_EVENT_POOL_SIZE)
+			{
+				clFlush(clStuffContainer.queue);
+
+				pool = 1 - pool;
+				readBackEvents(eventPools[pool]);
+			}
+		}
+
+		clFlush(clStuffContainer.queue);
+
+		readBackEvents(eventPools[1 - pool]);
+		readBackEvents(eventPools[pool]);
+	}
+	else if (options.activeTiles)
+	{
+		// aktīvo flīžu režīms ir pieejams tikai baitu režģim, to jau pārbaudīja parseGolOptions
+		if constexpr (!packed)
+		{
+			runStepsActiveTiles(clStuffContainer, grid.currentInput, grid.currentOutput, width, height, steps,
+								golBuildOptions(options), totalTime, logger);
+		}
+	}
+	else
+	{
+		// ciklu meklēšanas režīmā pēc katra izsaukuma no ierīces tiek nolasīts tikai 16 baitu režģa paraksts
+		const bool detectCycles = options.cyclePeriod > 0;
+		CycleDetector cycleDetector(options.cyclePeriod);
+
+		const size_t gridSize = grid.gridElements();
+
+		const size_t signatureGroups =
+			std::clamp<size_t>((gridSize + SIGNATURE_GROUP_SIZE - 1) / SIGNATURE_GROUP_SIZE, 1, SIGNATURE_MAX_GROUPS);
+
+		cl_kernel signatureKernel = nullptr;
+		cl_kernel signatureFinalKernel = nullptr;
+		cl_mem signaturePartials = nullptr;
+		cl_mem deviceSignature = nullptr;
+
+		auto readSignature = [&](cl_mem cells) {
+			clResult = clSetKernelArg(signatureKernel, 0, sizeof(cl_mem), &cells);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			size_t signatureLocalSize = SIGNATURE_GROUP_SIZE;
+			size_t signatureGlobalSize = signatureGroups * SIGNATURE_GROUP_SIZE;
+
+			clResult = clEnqueueNDRangeKernel(clStuffContainer.queue, signatureKernel, 1, nullptr, &signatureGlobalSize,
+											  &signatureLocalSize, 0, nullptr, nullptr);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			clResult = clEnqueueNDRangeKernel(clStuffContainer.queue, signatureFinalKernel, 1, nullptr,
+											  &signatureLocalSize, &signatureLocalSize, 0, nullptr, nullptr);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			GridSignature signature;
+			clResult = clEnqueueReadBuffer(clStuffContainer.queue, deviceSignature, CL_TRUE, 0, sizeof(GridSignature),
+										   &signature, 0, nullptr, nullptr);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			return signature;
+		};
+
+		if (detectCycles)
+		{
+			const char *signatureKernelName = packed ? "grid_signature_packed" : "grid_signature";
+
+			signatureKernel = clStuffContainer.loadAndCreateKernel("kernels/gol.cl", signatureKernelName);
+			signatureFinalKernel = clStuffContainer.loadAndCreateKernel("kernels/gol.cl", "grid_signature_final");
+
+			signaturePartials = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE,
+											   2 * signatureGroups * sizeof(cl_ulong), nullptr, &clResult);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			deviceSignature =
+				clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE, sizeof(GridSignature), nullptr, &clResult);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			const cl_ulong elementCount = gridSize;
+			const cl_uint partialCount = static_cast<cl_uint>(signatureGroups);
+
+			clResult = clSetKernelArg(signatureKernel, 1, sizeof(cl_ulong), &elementCount);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(signatureKernel, 2, sizeof(cl_mem), &signaturePartials);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(signatureFinalKernel, 0, sizeof(cl_mem), &signaturePartials);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(signatureFinalKernel, 1, sizeof(cl_uint), &partialCount);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(signatureFinalKernel, 2, sizeof(cl_mem), &deviceSignature);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			cycleDetector.push(0, readSignature(grid.currentInput));
+		}
+
+		std::unique_ptr<SnapshotRing<Cell>> snapshots;
+		if (options.snapshotEvery > 0)
+		{
+			snapshots = std::make_unique<SnapshotRing<Cell>>(clStuffContainer, options.snapshotPath, width, height,
+															 gridSize);
+		}
+
+		// atrodot ciklu, 'targetSteps' samazinās līdz paaudzei, kurā režģis ir tāds pats kā pēc 'steps' paaudzēm
+		size_t targetSteps = steps;
+
+		for (size_t step = 0; step < targetSteps;)
+		{
+			// pēdējais izsaukums var izrēķināt mazāk paaudžu, ja 'steps' nedalās ar 'blockSteps'
+			// vai ja līdz nākamajam momentuzņēmumam atlicis mazāk paaudžu
+			size_t launchSteps = std::min(options.blockSteps, targetSteps - step);
+
+			if (snapshots)
+			{
+				launchSteps = std::min(launchSteps, options.snapshotEvery - step % options.snapshotEvery);
+				snapshots->beforeLaunch(grid.currentOutput);
+			}
+
+			// ne vairāk par 'blockSteps' paaudzēm, tātad viens kodola izsaukums
+			grid.step(launchSteps);
+
+			step += launchSteps;
+
+			if (snapshots && step % options.snapshotEvery == 0)
+			{
+				snapshots->capture(grid.currentInput, step);
+			}
+
+			if (detectCycles && targetSteps == steps)
+			{
+				auto signatureStart = std::chrono::steady_clock::now();
+				const size_t period = cycleDetector.push(step, readSignature(grid.currentInput));
+				auto signatureEnd = std::chrono::steady_clock::now();
+
+				logger.chronoLog("grid signature time", signatureStart, signatureEnd);
+
+				if (period > 0)
+				{
+					// režģis atkārtojas ik pēc 'period' paaudzēm, tāpēc atlikušo soļu skaitu var ņemt pēc moduļa
+					targetSteps = step + (steps - step) % period;
+
+					logger.log("stabilized at generation", static_cast<double>(step));
+					logger.log("stabilization period", static_cast<double>(period));
+
+					std::cout << "Grid repeats with period " << period << " at generation " << step << ", running "
+							  << targetSteps - step << " more generations\n";
+				}
+			}
+		}
+
+		if (detectCycles)
+		{
+			clReleaseKernel(signatureKernel);
+			clReleaseKernel(signatureFinalKernel);
+			clReleaseMemObject(signaturePartials);
+			clReleaseMemObject(deviceSignature);
+		}
+
+		if (snapshots)
+		{
+			snapshots->finish(logger);
+		}
+
+		totalTime = grid.timing().kernelMs * 1e6;
+	}
+
+	logger.log("total kernel exec time", totalTime / 1e6);
+
+	start = std::chrono::steady_clock::now();
+
+	grid.downloadTo(writer);
+
+	end = std::chrono::steady_clock::now();
+	logger.chronoLog("total device-to-host transfer and write time", start, end);
+}
+
+// joslu skaits, kas vienlaikus atrodas ierīcē, katrai sava komandu rinda, piespraustie buferi un ierīces buferi
+constexpr size_t STREAM_SLOTS = 2;
+
+// straumēšanas režīms režģiem, kas neietilpst ierīces atmiņā: režģis glabājas resursdatora atmiņā un katrā
+// piegājienā tiek pa horizontālām joslām ar 'blockSteps' rindu apmali pārsūtīts uz ierīci, tur izrēķinātas līdz
+// 'blockSteps' paaudzēm un joslas iekšpuse pārsūtīta atpakaļ
+// kamēr viena josla tiek rēķināta, nākamā jau tiek kopēta citā komandu rindā
+// ar mazu --stream budžetu šo var pārbaudīt arī uz CPU OpenCL implementācijas (piemēram, PoCL)
+void GameOfLifeStreamed(ClStuffContainer &clStuffContainer, const MappedGridFile &gridFile,
+						std::vector<cl_uchar> &outputGrid, size_t steps, const GolOptions &options,
+						BenchmarkLogger &logger)
+{
+	cl_int clResult;
+
+	const cl_ulong width = gridFile.width();
+	const cl_ulong height = gridFile.height();
+	const size_t halo = options.blockSteps;
+
+	if (width == 0 || height == 0)
+	{
+		outputGrid.clear();
+		return;
+	}
+
+	// katrai joslai ierīcē ir divi buferi (ping-pong) ar stripRows + 2 * halo rindām
+	const size_t budgetRows = options.streamMiB * 1024 * 1024 / (STREAM_SLOTS * 2 * width);
+	if (budgetRows <= 2 * halo)
+	{
+		throw std::runtime_error("--stream memory budget is too small for a single strip of this grid");
+	}
+
+	const size_t stripRows = std::min<size_t>(budgetRows - 2 * halo, height);
+	const size_t bufferRows = stripRows + 2 * halo;
+	const size_t stripCount = (height + stripRows - 1) / stripRows;
+
+	std::cout << "Streaming " << stripCount << " strips of " << stripRows << " rows per pass\n";
+
+	auto start = std::chrono::steady_clock::now();
+
+	// pats režģis paliek parastajā resursdatora atmiņā, piesprausti ir tikai joslu starpbuferi
+	std::vector<cl_uchar> currentGrid(width * height);
+	std::vector<cl_uchar> nextGrid(width * height);
+
+	struct StripSlot
+	{
+		cl_command_queue queue;
+		cl_event done = nullptr; // pēdējās pārsūtīšanas atpakaļ notikums, nullptr, ja joslas rezultāts jau pārkopēts
+		cl_mem hostInputBuffer;
+		cl_mem hostOutputBuffer;
+		cl_uchar *hostInput;
+		cl_uchar *hostOutput;
+		cl_mem deviceBuffers[2];
+		size_t pendingStrip = 0;
+	};
+
+	StripSlot slots[STREAM_SLOTS];
+
+	const cl_queue_properties properties[] = {CL_QUEUE_PROPERTIES, CL_QUEUE_PROFILING_ENABLE, 0};
+
+	for (StripSlot &slot : slots)
+	{
+		slot.queue = clCreateCommandQueueWithProperties(clStuffContainer.context, clStuffContainer.device, properties,
+														&clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		slot.hostInputBuffer = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
+											  bufferRows * width, nullptr, &clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		slot.hostOutputBuffer = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
+											   stripRows * width, nullptr, &clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		slot.hostInput = static_cast<cl_uchar *>(clEnqueueMapBuffer(slot.queue, slot.hostInputBuffer, CL_TRUE,
+																	CL_MAP_WRITE, 0, bufferRows * width, 0, nullptr,
+																	nullptr, &clResult));
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		slot.hostOutput = static_cast<cl_uchar *>(clEnqueueMapBuffer(slot.queue, slot.hostOutputBuffer, CL_TRUE,
+																	 CL_MAP_READ, 0, stripRows * width, 0, nullptr,
+																	 nullptr, &clResult));
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		for (cl_mem &deviceBuffer : slot.deviceBuffers)
+		{
+			deviceBuffer = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE, bufferRows * width, nullptr,
+										  &clResult);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		}
+	}
+
+	auto end = std::chrono::steady_clock::now();
+	logger.chronoLog("buffer creation time", start, end);
+
+	start = std::chrono::steady_clock::now();
+	gridFile.decodeInto(currentGrid.data());
+	end = std::chrono::steady_clock::now();
+	logger.chronoLog("grid decode time", start, end);
+
+	cl_kernel kernel = clStuffContainer.loadAndCreateKernel("kernels/gol.cl", "gol_strip", golBuildOptions(options));
+
+	size_t localSize[2];
+	clStuffContainer.getOptimalWorkGroupSize(kernel, localSize);
+
+	size_t globalSize[2] = {((width + localSize[0] - 1) / localSize[0]) * localSize[0],
+							((bufferRows + localSize[1] - 1) / localSize[1]) * localSize[1]};
+
+	const cl_int kernelRows = static_cast<cl_int>(bufferRows);
+	const cl_int kernelRowBegin = 0;
+
+	clResult = clSetKernelArg(kernel, 2, sizeof(cl_ulong), &width);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	clResult = clSetKernelArg(kernel, 3, sizeof(cl_ulong), &height);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	clResult = clSetKernelArg(kernel, 5, sizeof(cl_int), &kernelRows);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	clResult = clSetKernelArg(kernel, 6, sizeof(cl_int), &kernelRowBegin);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	clResult = clSetKernelArg(kernel, 7, sizeof(cl_int), &kernelRows);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+	// sagaida joslas rezultātu un pārkopē to nākamās paaudzes režģī
+	auto finishStrip = [&](StripSlot &slot) {
+		if (slot.done == nullptr)
+		{
+			return;
+		}
+
+		clResult = clWaitForEvents(1, &slot.done);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clReleaseEvent(slot.done);
+		slot.done = nullptr;
+
+		const size_t rowBegin = slot.pendingStrip * stripRows;
+		const size_t rows = std::min<size_t>(stripRows, height - rowBegin);
+		std::memcpy(nextGrid.data() + rowBegin * width, slot.hostOutput, rows * width);
+	};
+
+	double totalTime = 0;
+
+	for (size_t step = 0; step < steps;)
+	{
+		const size_t passGens = std::min(halo, steps - step);
+
+		auto passStart = std::chrono::steady_clock::now();
+
+		for (size_t strip = 0; strip < stripCount; strip++)
+		{
+			StripSlot &slot = slots[strip % STREAM_SLOTS];
+			finishStrip(slot);
+
+			const size_t rowBegin = strip * stripRows;
+			const size_t rows = std::min<size_t>(stripRows, height - rowBegin);
+			const cl_long firstRow = static_cast<cl_long>(rowBegin) - static_cast<cl_long>(halo);
+
+			// joslas rindas kopā ar apmali, rindas ārpus režģa aizpilda ar nullēm
+			const size_t validBegin = static_cast<size_t>(std::max<cl_long>(firstRow, 0));
+			const size_t validEnd = std::min<size_t>(static_cast<size_t>(firstRow + bufferRows), height);
+			const size_t topPadding = validBegin - firstRow;
+			const size_t validRows = validEnd - validBegin;
+
+			std::memset(slot.hostInput, 0, topPadding * width);
+			std::memcpy(slot.hostInput + topPadding * width, currentGrid.data() + validBegin * width,
+						validRows * width);
+			std::memset(slot.hostInput + (topPadding + validRows) * width, 0,
+						(bufferRows - topPadding - validRows) * width);
+
+			clResult = clEnqueueWriteBuffer(slot.queue, slot.deviceBuffers[0], CL_FALSE, 0, bufferRows * width,
+											slot.hostInput, 0, nullptr, nullptr);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			// argumenti tiek nolasīti ierindošanas brīdī, tāpēc vienu kodolu var izmantot abās komandu rindās
+			int current = 0;
+			for (size_t gen = 0; gen < passGens; gen++)
+			{
+				clResult = clSetKernelArg(kernel, 0, sizeof(cl_mem), &slot.deviceBuffers[current]);
+				ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+				clResult = clSetKernelArg(kernel, 1, sizeof(cl_mem), &slot.deviceBuffers[1 - current]);
+				ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+				clResult = clSetKernelArg(kernel, 4, sizeof(cl_long), &firstRow);
+				ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+				clResult = clEnqueueNDRangeKernel(slot.queue, kernel, 2, nullptr, globalSize, localSize, 0, nullptr,
+												  nullptr);
+				ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+				current = 1 - current;
+			}
+
+			clResult = clEnqueueReadBuffer(slot.queue, slot.deviceBuffers[current], CL_FALSE, halo * width,
+										   rows * width, slot.hostOutput, 0, nullptr, &slot.done);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			clFlush(slot.queue);
+
+			slot.pendingStrip = strip;
+		}
+
+		for (StripSlot &slot : slots)
+		{
+			finishStrip(slot);
+		}
+
+		std::swap(currentGrid, nextGrid);
+		step += passGens;
+
+		auto passEnd = std::chrono::steady_clock::now();
+
+		std::chrono::duration<double, std::milli> passTime = passEnd - passStart;
+		logger.log("stream pass time", passTime.count());
+		totalTime += passTime.count();
+	}
+
+	logger.log("total kernel exec time", totalTime);
+
+	outputGrid = std::move(currentGrid);
+
+	for (StripSlot &slot : slots)
+	{
+		clResult = clEnqueueUnmapMemObject(slot.queue, slot.hostInputBuffer, slot.hostInput, 0, nullptr, nullptr);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clEnqueueUnmapMemObject(slot.queue, slot.hostOutputBuffer, slot.hostOutput, 0, nullptr, nullptr);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clFinish(slot.queue);
+
+		clReleaseMemObject(slot.hostInputBuffer);
+		clReleaseMemObject(slot.hostOutputBuffer);
+		clReleaseMemObject(slot.deviceBuffers[0]);
+		clReleaseMemObject(slot.deviceBuffers[1]);
+		clReleaseCommandQueue(slot.queue);
+	}
+
+	clReleaseKernel(kernel);
+}
+
+// vairāku ierīču režīms: režģis tiek sadalīts horizontālās joslās pa vienai katrai ierīcei, katras joslas buferī ir
+// 'blockSteps' rindu apmale no kaimiņu joslām, kas tiek atjaunota pēc katrām 'blockSteps' paaudzēm
+// piegājiena pēdējā paaudzē vispirms tiek izrēķinātas joslas malu rindas, un, kamēr skaitļošanas komandu rinda rēķina
+// joslas iekšpusi, apmaļu komandu rinda jau kopē malas uz kaimiņu joslu apmalēm
+// bez vairākiem GPU to var pārbaudīt ar CPU ierīci, kas tiek sadalīta apakšierīcēs, vai vairākām PoCL ierīcēm
+void GameOfLifeMultiDevice(const MappedGridFile &gridFile, std::vector<cl_uchar> &outputGrid, size_t steps,
+						   const GolOptions &options, BenchmarkLogger &logger)
+{
+	cl_int clResult;
+
+	const cl_ulong width = gridFile.width();
+	const cl_ulong height = gridFile.height();
+	const size_t halo = options.blockSteps;
+
+	if (width == 0 || height == 0)
 	{
-		throw std::runtime_error("Failed to open file: " + fileName);
+		outputGrid.clear();
+		return;
 	}
 
-	const size_t fileSize = file.tellg();
-	file.seekg(0, std::ios::beg);
+	auto start = std::chrono::steady_clock::now();
+
+	ClDeviceGroup deviceGroup(logger, options.devices);
 
-	std::vector<char> buffer(fileSize);
-	file.read(buffer.data(), fileSize);
-	file.close();
+	auto end = std::chrono::steady_clock::now();
+	logger.chronoLog("multi-device init time", start, end);
 
-	std::vector<cl_uchar> grid;
-	grid.reserve(fileSize);
+	// katrā joslā jābūt vismaz 'halo' rindām, lai apmale nāktu tikai no tiešajiem kaimiņiem
+	const size_t bandCount = std::max<size_t>(1, std::min<size_t>(deviceGroup.devices.size(), height / halo));
 
-	size_t lineStartPos = 0;
+	std::cout << "Splitting the grid into " << bandCount << " bands across " << deviceGroup.devices.size()
+			  << " devices\n";
 
-	width = 0;
-	height = 0;
+	start = std::chrono::steady_clock::now();
 
-	for (size_t i = 0; i <= buffer.size(); ++i)
+	struct DeviceBand
 	{
-		if (i == buffer.size() || buffer[i] == '\n')
+		cl_command_queue computeQueue;
+		cl_command_queue haloQueue;
+		size_t rowBegin; // pirmā joslai piederošā režģa rinda
+		size_t rows;
+		cl_event readyEvent; // pēdējās paaudzes izejas buferis vairs netiek rakstīts, kaimiņi var kopēt apmali
+		cl_event edgesEvent; // joslas malu rindas ir izrēķinātas
+		cl_mem deviceBuffers[2];
+	};
+
+	std::vector<DeviceBand> bands(bandCount);
+
+	for (size_t i = 0; i < bandCount; i++)
+	{
+		DeviceBand &band = bands[i];
+		band.computeQueue = deviceGroup.computeQueues[i];
+		band.haloQueue = deviceGroup.haloQueues[i];
+		band.rowBegin = i * height / bandCount;
+		band.rows = (i + 1) * height / bandCount - band.rowBegin;
+
+		for (cl_mem &deviceBuffer : band.deviceBuffers)
 		{
-			size_t lineLen = i - lineStartPos;
+			deviceBuffer = clCreateBuffer(deviceGroup.context, CL_MEM_READ_WRITE, (band.rows + 2 * halo) * width,
+										  nullptr, &clResult);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		}
+	}
 
-			if (lineLen == 0)
-			{
-				lineStartPos = i + 1;
-				continue;
-			}
+	end = std::chrono::steady_clock::now();
+	logger.chronoLog("buffer creation time", start, end);
+
+	start = std::chrono::steady_clock::now();
+	std::vector<cl_uchar> grid(width * height);
+	gridFile.decodeInto(grid.data());
+	end = std::chrono::steady_clock::now();
+	logger.chronoLog("grid decode time", start, end);
+
+	start = std::chrono::steady_clock::now();
+
+	// katras joslas rindas kopā ar apmali, rindas ārpus režģa aizpilda ar nullēm
+	for (DeviceBand &band : bands)
+	{
+		const size_t bufferRows = band.rows + 2 * halo;
+		const size_t validBegin = band.rowBegin >= halo ? band.rowBegin - halo : 0;
+		const size_t validEnd = std::min<size_t>(band.rowBegin + band.rows + halo, height);
+		const size_t topPadding = validBegin + halo - band.rowBegin;
+		const cl_uchar zero = 0;
+
+		for (cl_mem deviceBuffer : band.deviceBuffers)
+		{
+			clResult = clEnqueueFillBuffer(band.computeQueue, deviceBuffer, &zero, sizeof(zero), 0, bufferRows * width,
+										   0, nullptr, nullptr);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		}
+
+		clResult = clEnqueueWriteBuffer(band.computeQueue, band.deviceBuffers[0], CL_FALSE, topPadding * width,
+										(validEnd - validBegin) * width, grid.data() + validBegin * width, 0, nullptr,
+										nullptr);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	}
+
+	for (DeviceBand &band : bands)
+	{
+		clFinish(band.computeQueue);
+	}
+
+	end = std::chrono::steady_clock::now();
+	logger.chronoLog("total host-to-device transfer time", start, end);
+
+	cl_kernel kernel = deviceGroup.loadAndCreateKernel("kernels/gol.cl", "gol_strip", golBuildOptions(options));
 
-			if (width == 0)
+	clResult = clSetKernelArg(kernel, 2, sizeof(cl_ulong), &width);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	clResult = clSetKernelArg(kernel, 3, sizeof(cl_ulong), &height);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+	// ierindo gol_strip joslas bufera rindām [rowBegin, rowEnd), argumenti tiek nolasīti ierindošanas brīdī, tāpēc
+	// vienu kodolu var izmantot visu ierīču komandu rindās
+	// darba grupas izmēru izvēlas implementācija, jo dažādām ierīcēm tas var atšķirties
+	auto enqueueRows = [&](DeviceBand &band, int current, size_t rowBegin, size_t rowEnd) {
+		if (rowBegin >= rowEnd)
+		{
+			return;
+		}
+
+		const cl_long firstRow = static_cast<cl_long>(band.rowBegin) - static_cast<cl_long>(halo);
+		const cl_int kernelRows = static_cast<cl_int>(band.rows + 2 * halo);
+		const cl_int kernelRowBegin = static_cast<cl_int>(rowBegin);
+		const cl_int kernelRowEnd = static_cast<cl_int>(rowEnd);
+
+		clResult = clSetKernelArg(kernel, 0, sizeof(cl_mem), &band.deviceBuffers[current]);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(kernel, 1, sizeof(cl_mem), &band.deviceBuffers[1 - current]);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(kernel, 4, sizeof(cl_long), &firstRow);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(kernel, 5, sizeof(cl_int), &kernelRows);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(kernel, 6, sizeof(cl_int), &kernelRowBegin);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(kernel, 7, sizeof(cl_int), &kernelRowEnd);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		const size_t globalSize[2] = {width, rowEnd - rowBegin};
+
+		clResult = clEnqueueNDRangeKernel(band.computeQueue, kernel, 2, nullptr, globalSize, nullptr, 0, nullptr,
+										  nullptr);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	};
+
+	int current = 0;
+	double totalTime = 0;
+
+	for (size_t step = 0; step < steps;)
+	{
+		const size_t passGens = std::min(halo, steps - step);
+		const int output = (current + static_cast<int>(passGens)) % 2;
+
+		auto passStart = std::chrono::steady_clock::now();
+
+		for (DeviceBand &band : bands)
+		{
+			// piegājiena starpposma paaudzes rēķina visu buferi, apmales rindas ar katru paaudzi kļūst kļūdainas
+			int bandCurrent = current;
+			for (size_t gen = 0; gen + 1 < passGens; gen++)
 			{
-				width = lineLen;
+				enqueueRows(band, bandCurrent, 0, band.rows + 2 * halo);
+				bandCurrent = 1 - bandCurrent;
 			}
-			else if (lineLen != width)
+
+			clResult = clEnqueueMarkerWithWaitList(band.computeQueue, 0, nullptr, &band.readyEvent);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			// pēdējā paaudze rēķina tikai joslas rindas, malas pirms iekšpuses
+			const size_t edgeRows = std::min(halo, band.rows - halo);
+			enqueueRows(band, bandCurrent, halo, halo + edgeRows);
+			enqueueRows(band, bandCurrent, std::max(band.rows, halo + edgeRows), band.rows + halo);
+
+			clResult = clEnqueueMarkerWithWaitList(band.computeQueue, 0, nullptr, &band.edgesEvent);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			enqueueRows(band, bandCurrent, halo + edgeRows, std::max(band.rows, halo + edgeRows));
+
+			clFlush(band.computeQueue);
+		}
+
+		// joslas augšējās rindas kļūst par iepriekšējās joslas apakšējo apmali, apakšējās - par nākamās augšējo
+		for (size_t i = 0; i < bandCount; i++)
+		{
+			DeviceBand &band = bands[i];
+
+			if (i > 0)
 			{
-				throw std::runtime_error("Invalid line length at line idx: " + std::to_string(height));
+				DeviceBand &above = bands[i - 1];
+				const cl_event waitEvents[] = {band.edgesEvent, above.readyEvent};
+
+				clResult = clEnqueueCopyBuffer(band.haloQueue, band.deviceBuffers[output], above.deviceBuffers[output],
+											   halo * width, (above.rows + halo) * width, halo * width, 2, waitEvents,
+											   nullptr);
+				ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 			}
 
-			for (size_t j = 0; j < width; ++j)
+			if (i + 1 < bandCount)
 			{
-				cl_uchar val = static_cast<cl_uchar>(buffer[lineStartPos + j] - '0');
-				grid.push_back(val);
+				DeviceBand &below = bands[i + 1];
+				const cl_event waitEvents[] = {band.edgesEvent, below.readyEvent};
+
+				clResult = clEnqueueCopyBuffer(band.haloQueue, band.deviceBuffers[output], below.deviceBuffers[output],
+											   band.rows * width, 0, halo * width, 2, waitEvents, nullptr);
+				ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 			}
 
-			height++;
-			lineStartPos = i + 1;
+			clFlush(band.haloQueue);
 		}
-	}
 
-	return grid;
-}
+		for (DeviceBand &band : bands)
+		{
+			clFinish(band.computeQueue);
+			clFinish(band.haloQueue);
 
-void writeGridToFile(std::vector<cl_uchar> &grid, cl_ulong width, cl_ulong height, std::string fileName)
-{
-	std::ofstream file(fileName, std::ios::out | std::ios::binary);
-	if (!file.is_open())
-	{
-		throw std::runtime_error("Failed to open file: " + fileName);
+			clReleaseEvent(band.readyEvent);
+			clReleaseEvent(band.edgesEvent);
+		}
+
+		current = output;
+		step += passGens;
+
+		auto passEnd = std::chrono::steady_clock::now();
+
+		std::chrono::duration<double, std::milli> passTime = passEnd - passStart;
+		logger.log("multi-device pass time", passTime.count());
+		totalTime += passTime.count();
 	}
 
-	const size_t totalSize = (width + 1) * height; // +1, jo rindas beigās ir \n
+	logger.log("total kernel exec time", totalTime);
 
-	std::vector<char> buffer(totalSize);
+	start = std::chrono::steady_clock::now();
 
-	for (size_t h = 0; h < height; h++)
+	for (DeviceBand &band : bands)
 	{
-		size_t lineStart = h * (width + 1);
-		size_t gridRowStart = h * width;
+		clResult = clEnqueueReadBuffer(band.computeQueue, band.deviceBuffers[current], CL_TRUE, halo * width,
+									   band.rows * width, grid.data() + band.rowBegin * width, 0, nullptr, nullptr);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	}
 
-		for (size_t w = 0; w < width; w++)
-		{
-			buffer[lineStart + w] = '0' + grid[gridRowStart + w];
-		}
+	end = std::chrono::steady_clock::now();
+	logger.chronoLog("total device-to-host transfer time", start, end);
 
-		buffer[lineStart + width] = '\n';
-	}
+	outputGrid = std::move(grid);
 
-	file.write(buffer.data(), totalSize);
+	for (DeviceBand &band : bands)
+	{
+		clReleaseMemObject(band.deviceBuffers[0]);
+		clReleaseMemObject(band.deviceBuffers[1]);
+	}
 
-	file.close();
+	clReleaseKernel(kernel);
 }
 
-// funkcija, kas sakārto visu kodola izpildei un datu savākšanai
-// outputGrid izmēru saucēja fn var nenoteikt, jo šī pati funkcija sakārtos atmiņu
-void GameOfLifeStep(ClStuffContainer &clStuffContainer, std::vector<cl_uchar> &grid, std::vector<cl_uchar> &outputGrid,
-					cl_ulong width, cl_ulong height, size_t steps, BenchmarkLogger &logger)
+// ansambļa režģa novietojums kopīgajā ierīces buferī, jāsakrīt ar EnsembleExtent kernels/gol.cl
+struct EnsembleExtent
+{
+	cl_ulong offset;
+	cl_int width;
+	cl_int height;
+};
+
+// ansambļa režīms: visi režģi tiek saspiesti vienā piespraustajā un vienā ierīces buferī, un katra paaudze visiem
+// režģiem ir viens gol_ensemble izsaukums ar trīsdimensiju NDRange, kura trešā dimensija ir režģa indekss
+// ar --async izsaukumi tiek ierindoti bez gaidīšanas, tāpat kā GameOfLifeStep
+// rezultāts tiek ierakstīts atpakaļ 'boards' šūnās, 'totalTime' tiek skaitīts nanosekundēs
+void GameOfLifeEnsemble(ClStuffContainer &clStuffContainer, std::vector<EnsembleBoard> &boards, size_t steps,
+						const GolOptions &options, BenchmarkLogger &logger)
 {
 	cl_int clResult;
 
-	size_t gridSize = width * height;
-	outputGrid.resize(gridSize);
-
-	auto start = std::chrono::steady_clock::now();
+	std::vector<EnsembleExtent> extents(boards.size());
+	size_t totalCells = 0;
+	size_t maxWidth = 0;
+	size_t maxHeight = 0;
 
-	cl_mem hostPinnedInputBuffer = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
-												  gridSize * sizeof(cl_uchar), nullptr, &clResult);
-	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	for (size_t i = 0; i < boards.size(); i++)
+	{
+		extents[i] = {totalCells, static_cast<cl_int>(boards[i].width), static_cast<cl_int>(boards[i].height)};
+		totalCells += boards[i].cells.size();
+		maxWidth = std::max(maxWidth, boards[i].width);
+		maxHeight = std::max(maxHeight, boards[i].height);
+	}
 
-	cl_mem hostPinnedOutputBuffer = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
-												   gridSize * sizeof(cl_uchar), nullptr, &clResult);
-	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	auto start = std::chrono::steady_clock::now();
 
-	void *mappedInputPtr = clEnqueueMapBuffer(clStuffContainer.queue, hostPinnedInputBuffer, CL_TRUE, CL_MAP_WRITE, 0,
-											  gridSize * sizeof(cl_uchar), 0, nullptr, nullptr, &clResult);
+	cl_mem hostPinnedBuffer = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
+											 totalCells, nullptr, &clResult);
 	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
-	void *mappedOutputPtr = clEnqueueMapBuffer(clStuffContainer.queue, hostPinnedOutputBuffer, CL_TRUE, CL_MAP_WRITE, 0,
-											   gridSize * sizeof(cl_uchar), 0, nullptr, nullptr, &clResult);
+	void *mappedPtr = clEnqueueMapBuffer(clStuffContainer.queue, hostPinnedBuffer, CL_TRUE,
+										 CL_MAP_READ | CL_MAP_WRITE, 0, totalCells, 0, nullptr, nullptr, &clResult);
 	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
-	std::memcpy(mappedInputPtr, grid.data(), gridSize * sizeof(cl_uchar));
-
 	cl_mem deviceInputBuffer =
-		clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE, gridSize * sizeof(cl_uchar), nullptr, &clResult);
+		clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE, totalCells, nullptr, &clResult);
 	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
 	cl_mem deviceOutputBuffer =
-		clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE, gridSize * sizeof(cl_uchar), nullptr, &clResult);
+		clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE, totalCells, nullptr, &clResult);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+	cl_mem extentsBuffer =
+		clCreateBuffer(clStuffContainer.context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+					   extents.size() * sizeof(EnsembleExtent), extents.data(), &clResult);
 	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
 	auto end = std::chrono::steady_clock::now();
 	logger.chronoLog("buffer creation time", start, end);
 
+	start = std::chrono::steady_clock::now();
+
+	unsigned char *packedCells = static_cast<unsigned char *>(mappedPtr);
+	for (size_t i = 0; i < boards.size(); i++)
+	{
+		std::memcpy(packedCells + extents[i].offset, boards[i].cells.data(), boards[i].cells.size());
+	}
+
+	end = std::chrono::steady_clock::now();
+	logger.chronoLog("ensemble pack time", start, end);
+
 	cl_event transferEvent;
 
 	start = std::chrono::steady_clock::now();
 
-	clResult = clEnqueueWriteBuffer(clStuffContainer.queue, deviceInputBuffer, CL_TRUE, 0, gridSize * sizeof(cl_uchar),
-									mappedInputPtr, 0, nullptr, &transferEvent);
+	clResult = clEnqueueWriteBuffer(clStuffContainer.queue, deviceInputBuffer, CL_TRUE, 0, totalCells, mappedPtr, 0,
+									nullptr, &transferEvent);
 	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
 	clWaitForEvents(1, &transferEvent);
@@ -161,159 +1658,332 @@ void GameOfLifeStep(ClStuffContainer &clStuffContainer, std::vector<cl_uchar> &g
 	cl_ulong transferStart, transferEnd;
 	clGetEventProfilingInfo(transferEvent, CL_PROFILING_COMMAND_START, sizeof(transferStart), &transferStart, nullptr);
 	clGetEventProfilingInfo(transferEvent, CL_PROFILING_COMMAND_END, sizeof(transferEnd), &transferEnd, nullptr);
+	clReleaseEvent(transferEvent);
 
-	double transferTime = static_cast<double>(transferEnd - transferStart) / 1e6;
-
-	logger.log("host-to-device transfer time", transferTime);
+	logger.log("host-to-device transfer time", static_cast<double>(transferEnd - transferStart) / 1e6);
 
 	end = std::chrono::steady_clock::now();
-
 	logger.chronoLog("total host-to-device transfer time", start, end);
 
-	cl_kernel kernel = clStuffContainer.loadAndCreateKernel("kernels/gol.cl", "gol");
+	cl_kernel kernel = clStuffContainer.loadAndCreateKernel("kernels/gol.cl", "gol_ensemble", golBuildOptions(options));
 
-	size_t localSize[2];
+	clResult = clSetKernelArg(kernel, 2, sizeof(cl_mem), &extentsBuffer);
+	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+	// mazu režģu ansamblī darba grupa netiek ņemta lielāka par lielāko režģi, lai neaizņemtu tukšus darba vienumus
+	size_t localSize[3] = {1, 1, 1};
 	clStuffContainer.getOptimalWorkGroupSize(kernel, localSize);
 
-	size_t globalSize[2] = {((width + localSize[0] - 1) / localSize[0]) * localSize[0],
-							((height + localSize[1] - 1) / localSize[1]) * localSize[1]};
+	while (localSize[0] > 1 && localSize[0] / 2 >= maxWidth)
+	{
+		localSize[0] /= 2;
+	}
+	while (localSize[1] > 1 && localSize[1] / 2 >= maxHeight)
+	{
+		localSize[1] /= 2;
+	}
 
-	double totalTime = 0;
+	const size_t globalSize[3] = {((maxWidth + localSize[0] - 1) / localSize[0]) * localSize[0],
+								  ((maxHeight + localSize[1] - 1) / localSize[1]) * localSize[1], boards.size()};
 
-	cl_event profilingEvent;
+	logger.log("gol_ensemble work group width", static_cast<double>(localSize[0]));
+	logger.log("gol_ensemble work group height", static_cast<double>(localSize[1]));
+
+	double totalTime = 0;
 
 	cl_mem currentInput = deviceInputBuffer;
 	cl_mem currentOutput = deviceOutputBuffer;
 
-	clResult = clSetKernelArg(kernel, 2, sizeof(cl_ulong), &width);
-	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
-	clResult = clSetKernelArg(kernel, 3, sizeof(cl_ulong), &height);
-	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
-
-	for (size_t step = 0; step < steps; step++)
-	{
-
+	// ierinda vienas paaudzes izsaukumu visiem režģiem un samaina buferus
+	auto enqueueGeneration = [&](cl_event *event) {
 		clResult = clSetKernelArg(kernel, 0, sizeof(cl_mem), &currentInput);
 		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 		clResult = clSetKernelArg(kernel, 1, sizeof(cl_mem), &currentOutput);
 		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
-		clResult = clEnqueueNDRangeKernel(clStuffContainer.queue, kernel, 2, nullptr, globalSize, localSize, 0, nullptr,
-										  &profilingEvent);
+		clResult = clEnqueueNDRangeKernel(clStuffContainer.queue, kernel, 3, nullptr, globalSize, localSize, 0,
+										  nullptr, event);
 		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
-		clFinish(clStuffContainer.queue);
 
-		cl_ulong start;
-		cl_ulong end;
+		std::swap(currentInput, currentOutput);
+	};
 
-		clGetEventProfilingInfo(profilingEvent, CL_PROFILING_COMMAND_START, sizeof(start), &start, nullptr);
-		clGetEventProfilingInfo(profilingEvent, CL_PROFILING_COMMAND_COMPLETE, sizeof(end), &end, nullptr);
+	// nolasa izpildīto kodolu laikus no notikumiem un tos atbrīvo
+	auto readBackEvents = [&](std::vector<cl_event> &events) {
+		if (events.empty())
+		{
+			return;
+		}
 
-		double kernelExecTime = static_cast<double>(end - start);
-		logger.log("batch kernel exec time", kernelExecTime / 1e6);
-		totalTime += kernelExecTime;
+		clResult = clWaitForEvents(static_cast<cl_uint>(events.size()), events.data());
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
-		std::swap(currentInput, currentOutput);
+		for (cl_event event : events)
+		{
+			cl_ulong start;
+			cl_ulong end;
+
+			clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(start), &start, nullptr);
+			clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_COMPLETE, sizeof(end), &end, nullptr);
+
+			double kernelExecTime = static_cast<double>(end - start);
+			logger.log("kernel exec time", kernelExecTime / 1e6);
+			totalTime += kernelExecTime;
+
+			clReleaseEvent(event);
+		}
+
+		events.clear();
+	};
+
+	// sinhronajā režīmā pēc katra izsaukuma tiek gaidīts uz tā beigām, asinhronajā divas notikumu kopas mainās
+	// pa kārtai: kamēr ierīce izpilda vienu, tiek nolasīti otras laiki
+	std::vector<cl_event> eventPools[2];
+	const size_t poolSize = options.async ? ASYNC_EVENT_POOL_SIZE : 1;
+	size_t pool = 0;
+
+	for (size_t step = 0; step < steps; step++)
+	{
+		cl_event event;
+		enqueueGeneration(&event);
+		eventPools[pool].push_back(event);
+
+		if (!options.async)
+		{
+			clFinish(clStuffContainer.queue);
+			readBackEvents(eventPools[pool]);
+		}
+		else if (eventPools[pool].size() == poolSize)
+		{
+			clFlush(clStuffContainer.queue);
+
+			pool = 1 - pool;
+			readBackEvents(eventPools[pool]);
+		}
 	}
 
-	clReleaseEvent(profilingEvent);
+	clFlush(clStuffContainer.queue);
+
+	readBackEvents(eventPools[1 - pool]);
+	readBackEvents(eventPools[pool]);
 
 	logger.log("total kernel exec time", totalTime / 1e6);
 
+	// visi režģi tiek izrēķināti vienos un tajos pašos izsaukumos, tāpēc katra režģa ātrums ir tā šūnu skaits
+	// pret kopējo kodolu laiku, un kopējais ātrums ir visu režģu šūnu summa pret to pašu laiku
+	logger.log("ensemble boards", static_cast<double>(boards.size()));
+
+	if (totalTime > 0)
+	{
+		const double seconds = totalTime / 1e9;
+		logger.log("aggregate cells per second", static_cast<double>(totalCells) * steps / seconds);
+
+		for (const EnsembleBoard &board : boards)
+		{
+			logger.log(board.name + " cells per second", static_cast<double>(board.cells.size()) * steps / seconds);
+		}
+	}
+
 	start = std::chrono::steady_clock::now();
 
-	clResult = clEnqueueReadBuffer(clStuffContainer.queue, currentInput, CL_TRUE, 0, gridSize * sizeof(cl_uchar),
-								   mappedOutputPtr, 0, nullptr, &transferEvent);
+	clResult = clEnqueueReadBuffer(clStuffContainer.queue, currentInput, CL_TRUE, 0, totalCells, mappedPtr, 0,
+								   nullptr, &transferEvent);
 	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
 	clWaitForEvents(1, &transferEvent);
 
 	clGetEventProfilingInfo(transferEvent, CL_PROFILING_COMMAND_START, sizeof(transferStart), &transferStart, nullptr);
 	clGetEventProfilingInfo(transferEvent, CL_PROFILING_COMMAND_END, sizeof(transferEnd), &transferEnd, nullptr);
+	clReleaseEvent(transferEvent);
 
-	transferTime = static_cast<double>(transferEnd - transferStart) / 1e6;
-	logger.log("device-to-host transfer time", transferTime);
+	logger.log("device-to-host transfer time", static_cast<double>(transferEnd - transferStart) / 1e6);
 
-	std::memcpy(outputGrid.data(), mappedOutputPtr, gridSize * sizeof(cl_uchar));
+	for (size_t i = 0; i < boards.size(); i++)
+	{
+		std::memcpy(boards[i].cells.data(), packedCells + extents[i].offset, boards[i].cells.size());
+	}
 
 	end = std::chrono::steady_clock::now();
 	logger.chronoLog("total device-to-host transfer time", start, end);
 
-	clResult =
-		clEnqueueUnmapMemObject(clStuffContainer.queue, hostPinnedInputBuffer, mappedInputPtr, 0, nullptr, nullptr);
-	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
-
-	clResult =
-		clEnqueueUnmapMemObject(clStuffContainer.queue, hostPinnedOutputBuffer, mappedOutputPtr, 0, nullptr, nullptr);
+	clResult = clEnqueueUnmapMemObject(clStuffContainer.queue, hostPinnedBuffer, mappedPtr, 0, nullptr, nullptr);
 	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
-	clReleaseMemObject(hostPinnedInputBuffer);
-	clReleaseMemObject(hostPinnedOutputBuffer);
+	clReleaseMemObject(hostPinnedBuffer);
 	clReleaseMemObject(deviceInputBuffer);
 	clReleaseMemObject(deviceOutputBuffer);
+	clReleaseMemObject(extentsBuffer);
 	clReleaseKernel(kernel);
-	clReleaseEvent(transferEvent);
 }
 
-int main(int argc, char *argv[])
+// OpenCL versija kopīgajam resursdatora cauruļvadam (golHost.h)
+struct ClBackend
 {
-	if (argc == 5)
+	static constexpr const char *platform = "OpenCL";
+	using PackedWord = cl_ulong;
+
+	BenchmarkLogger &logger;
+	ClStuffContainer clStuffContainer;
+
+	explicit ClBackend(BenchmarkLogger &logger) : logger(logger), clStuffContainer(logger)
+	{
+	}
+
+	static bool validate(const GolOptions &)
 	{
-		const std::string inputFileName = argv[1];
-		const std::string outputFileName = argv[2];
-		const size_t gameSteps = std::stoll(argv[3]);
-		const std::string logFileName = argv[4];
+		return true;
+	}
 
-		BenchmarkLogger logger(logFileName, "OpenCL");
+	template <typename Cell>
+	void run(const MappedGridFile &gridFile, GridFileWriter &writer, std::vector<Cell> &outputGrid, size_t steps,
+			 const GolOptions &options)
+	{
+		constexpr bool packed = std::is_same<Cell, cl_ulong>::value;
 
-		auto start = std::chrono::steady_clock::now();
+		if (options.streamMiB > 0)
+		{
+			// straumēšana ir pieejama tikai baitu režģim, to jau pārbaudīja parseGolOptions
+			if constexpr (!packed)
+			{
+				GameOfLifeStreamed(clStuffContainer, gridFile, outputGrid, steps, options, logger);
+			}
+		}
+		else if (options.devices != 1)
+		{
+			// arī vairāku ierīču režīms ir pieejams tikai baitu režģim, tas izveido savu kontekstu visām ierīcēm
+			if constexpr (!packed)
+			{
+				GameOfLifeMultiDevice(gridFile, outputGrid, steps, options, logger);
+			}
+		}
+		else
+		{
+			GameOfLifeStep<Cell>(clStuffContainer, gridFile, writer, gridFile.width(), gridFile.height(), steps,
+								 options, logger);
+		}
+	}
+
+	void runEnsemble(std::vector<EnsembleBoard> &boards, size_t steps, const GolOptions &options)
+	{
+		GameOfLifeEnsemble(clStuffContainer, boards, steps, options, logger);
+	}
+};
 
-		size_t width;
-		size_t height;
-		std::vector<cl_uchar> grid = loadGridFromFile(inputFileName, width, height);
+// kompilē visas kernels/gol.cl programmas variācijas, kuras izmantotu palaišana ar 'options', un saglabā tās programmu
+// kešatmiņā, lai pirmā īstā palaišana uz šīs ierīces un draivera nekompilētu kodolus
+void prewarmProgramCache(const GolOptions &options, BenchmarkLogger &logger)
+{
+	ClStuffContainer clStuffContainer(logger);
 
-		auto end = std::chrono::steady_clock::now();
+	// paraksta un darba saraksta kodoli tiek kompilēti bez likuma opcijām
+	clStuffContainer.prewarmProgram("kernels/gol.cl");
+	clStuffContainer.prewarmProgram("kernels/gol.cl", golBuildOptions(options));
 
-		logger.chronoLog("grid load time", start, end);
+	// vairāku ierīču režīms kompilē programmu visām grupas ierīcēm, tai ir cita kešatmiņas atslēga
+	if (options.devices != 1)
+	{
+		ClDeviceGroup deviceGroup(logger, options.devices);
+		clReleaseKernel(deviceGroup.loadAndCreateKernel("kernels/gol.cl", "gol_strip", golBuildOptions(options)));
+	}
 
-		std::vector<cl_uchar> outputGrid;
+	std::cout << "Program cache is ready for rule " << ruleString(options.birthMask, options.survivalMask)
+			  << (options.wrap ? " on a torus\n" : "\n");
+}
 
-		auto clInitStart = std::chrono::steady_clock::now();
+// soļu saskarne salīdzināšanas programmai: režģa veids tiek izvēlēts allocate, kad zināmas opcijas
+class ClGolBackend : public GolBackend
+{
+  public:
+	explicit ClGolBackend(BenchmarkLogger &logger) : logger(logger), clStuffContainer(logger)
+	{
+	}
 
-		ClStuffContainer clStuffContainer(logger);
+	const char *platform() const override
+	{
+		return ClBackend::platform;
+	}
 
-		auto clInitEnd = std::chrono::steady_clock::now();
+	void allocate(size_t width, size_t height, const GolOptions &options) override
+	{
+		if (options.packed)
+		{
+			grid = std::make_unique<ClGolGrid<cl_ulong>>(clStuffContainer, logger);
+		}
+		else
+		{
+			grid = std::make_unique<ClGolGrid<cl_uchar>>(clStuffContainer, logger);
+		}
 
-		logger.chronoLog("opencl init time", clInitStart, clInitEnd);
+		grid->allocate(width, height, options);
+	}
 
-		size_t maxWorkItems;
-		clGetDeviceInfo(clStuffContainer.device, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(size_t), &maxWorkItems, nullptr);
+	void upload(const void *cells) override
+	{
+		grid->upload(cells);
+	}
 
-		cl_ulong w = static_cast<cl_ulong>(width);
-		cl_ulong h = static_cast<cl_ulong>(height);
+	void step(size_t generations) override
+	{
+		grid->step(generations);
+	}
 
-		std::cout << "Processing a " << width << "x" << height << " grid with " << gameSteps << " steps\n";
+	void download(void *cells) override
+	{
+		grid->download(cells);
+	}
 
-		auto GoLStart = std::chrono::steady_clock::now();
+	GolTiming timing() const override
+	{
+		return grid->timing();
+	}
 
-		GameOfLifeStep(clStuffContainer, grid, outputGrid, w, h, gameSteps, logger);
+  private:
+	BenchmarkLogger &logger;
+	ClStuffContainer clStuffContainer;
+	std::unique_ptr<GolBackend> grid;
+};
 
-		auto GoLEnd = std::chrono::steady_clock::now();
+} // namespace
 
-		logger.chronoLog("total game of life time", GoLStart, GoLEnd);
+std::unique_ptr<GolBackend> makeClGolBackend(BenchmarkLogger &logger)
+{
+	return std::make_unique<ClGolBackend>(logger);
+}
 
-		auto writeGridToFileStart = std::chrono::steady_clock::now();
+// salīdzināšanas programma golcompare šo failu kompilē ar GOL_BACKEND_LIBRARY un izmanto tikai makeClGolBackend
+#ifndef GOL_BACKEND_LIBRARY
+int main(int argc, char *argv[])
+{
+	if (argc >= 3 && std::string(argv[1]) == "--prewarm-cache")
+	{
+		GolOptions options;
 
-		writeGridToFile(outputGrid, width, height, outputFileName);
+		try
+		{
+			options = parseGolOptions(argc, argv, 3);
+		}
+		catch (const std::exception &e)
+		{
+			std::cerr << e.what() << '\n';
+			printGolUsage(argv[0]);
+			return -1;
+		}
 
-		auto writeGridToFileEnd = std::chrono::steady_clock::now();
+		BenchmarkLogger logger(argv[2], "OpenCL");
 
-		logger.chronoLog("write output grid to file time", writeGridToFileStart, writeGridToFileEnd);
+		prewarmProgramCache(options, logger);
+	}
+	else if (argc >= 5)
+	{
+		return runGolMain<ClBackend>(argc, argv);
 	}
 	else
 	{
-		std::cout << "Correct program usage:\n"
-				  << "\t\t" << argv[0] << " <grid file path> <output grid file path> <game steps> <log file path>\n";
+		printGolUsage(argv[0]);
+		std::cout << "\tCompiled kernels are cached in " << ProgramCache::defaultDirectory()
+				  << " (set CL_PROGRAM_CACHE_DIR to change it, empty to disable), to fill the cache ahead of time:\n"
+				  << "\t\t" << argv[0] << " --prewarm-cache <log file path> [options]\n";
 	}
 	return 0;
 }
+#endif
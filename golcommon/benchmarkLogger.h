@@ -13,7 +13,7 @@ class BenchmarkLogger
 {
   private:
 	std::shared_ptr<spdlog::logger> logger;
-	const std::string platform;
+	std::string platform;
 
   public:
 	BenchmarkLogger(const std::string &fileName, const std::string &platform) : platform(platform)
@@ -30,6 +30,12 @@ class BenchmarkLogger
 		}
 	}
 
+	// salīdzināšanas programma golcompare visu versiju ierakstus raksta vienā žurnālā, spdlog loggeris ir tikai viens
+	void setPlatform(const std::string &platform)
+	{
+		this->platform = platform;
+	}
+
 	void log(const std::string &description, double ms)
 	{
 		std::stringstream ss;
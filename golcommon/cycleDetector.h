@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+// režģa paraksts, ko aprēķina ierīce: dzīvo šūnu (vai pakoto vārdu) jaucējvērtību summa un dzīvo šūnu skaits
+// summa nav atkarīga no saskaitīšanas secības, tāpēc to var reducēt paralēli, izkārtojums sakrīt ar ierīces struktūru
+struct GridSignature
+{
+	uint64_t hash;
+	uint64_t population;
+};
+
+inline bool operator==(const GridSignature &a, const GridSignature &b)
+{
+	return a.hash == b.hash && a.population == b.population;
+}
+
+// glabā pēdējos 'maxPeriod' parakstus un atrod, vai jaunais paraksts atkārto kādu no tiem
+// sakritība nozīmē, ka režģis (ar niecīgu jaucējvērtību sadursmes varbūtību) ir nonācis ciklā
+class CycleDetector
+{
+  public:
+	explicit CycleDetector(size_t maxPeriod) : maxPeriod(maxPeriod)
+	{
+	}
+
+	// pievieno paaudzes 'generation' parakstu, atgriež atkārtojuma periodu paaudzēs vai 0, ja atkārtojuma nav
+	size_t push(size_t generation, const GridSignature &signature)
+	{
+		for (auto it = history.rbegin(); it != history.rend(); ++it)
+		{
+			if (it->signature == signature)
+			{
+				return generation - it->generation;
+			}
+		}
+
+		history.push_back({generation, signature});
+		if (history.size() > maxPeriod)
+		{
+			history.pop_front();
+		}
+
+		return 0;
+	}
+
+  private:
+	struct Entry
+	{
+		size_t generation;
+		GridSignature signature;
+	};
+
+	size_t maxPeriod;
+	std::deque<Entry> history;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "benchmarkLogger.h"
+#include "golOptions.h"
+#include <cstddef>
+#include <memory>
+
+// ierīces laiki milisekundēs kopš allocate, ierīces versijās tie nolasīti no notikumiem, CPU versijā - pulksteņa
+struct GolTiming
+{
+	double uploadMs = 0;   // resursdators -> ierīce
+	double kernelMs = 0;   // visi step izsaukumi kopā
+	double downloadMs = 0; // ierīce -> resursdators
+};
+
+// viena režģa spēle pa soļiem, kopīga visām versijām (CPU, CUDA, HIP, OpenCL), lai salīdzināšanas programma golcompare
+// varētu palaist tās pēc kārtas vienā procesā uz viena un tā paša režģa atmiņā
+// šūnas upload un download tiek nodotas rindu pa rindai: ar options.packed pa packedWordsPerRow(width) 64 bitu vārdiem
+// rindā (tāpat kā MappedGridFile::decodePackedInto), citādi pa vienai šūnai baitā
+// versijas programmas (golHost.h) izmanto to pašu režģi, bet savos režīmos (--async, --detect-cycles, --snapshot,
+// --active-tiles) izsauc kodolus pa vienam un izvadi nodod GridFileWriter pa daļām, kamēr tā vēl tiek nolasīta
+class GolBackend
+{
+  public:
+	virtual ~GolBackend() = default;
+
+	// platformas nosaukums žurnāla pirmajā kolonnā
+	virtual const char *platform() const = 0;
+
+	// izveido režģa buferus, met ārā kļūdu, ja versija kādu no 'options' neatbalsta
+	// izmanto options.packed, blockSteps, autotune, vectorized (OpenCL), threads (CPU), --rule un --wrap
+	virtual void allocate(size_t width, size_t height, const GolOptions &options) = 0;
+
+	virtual void upload(const void *cells) = 0;
+
+	// izrēķina 'generations' paaudzes, katrā kodola izsaukumā līdz options.blockSteps paaudzēm
+	virtual void step(size_t generations) = 0;
+
+	virtual void download(void *cells) = 0;
+
+	virtual GolTiming timing() const = 0;
+};
+
+// katra versija definē savu funkciju, salīdzināšanas programma izsauc tās, kuras ir iekompilētas
+std::unique_ptr<GolBackend> makeCpuGolBackend(BenchmarkLogger &logger);
+std::unique_ptr<GolBackend> makeCudaGolBackend(BenchmarkLogger &logger);
+std::unique_ptr<GolBackend> makeHipGolBackend(BenchmarkLogger &logger);
+std::unique_ptr<GolBackend> makeClGolBackend(BenchmarkLogger &logger);
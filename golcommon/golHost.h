@@ -0,0 +1,181 @@
+#pragma once
+
+#include "benchmarkLogger.h"
+#include "golOptions.h"
+#include "gridIO.h"
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// GPU versiju (CUDA, HIP, OpenCL) kopīgā resursdatora daļa: režģa ielāde, ierīces inicializācija, rezultāta
+// ierakstīšana un komandrindas apstrāde ir vienādas visām versijām, tāpēc sakrīt arī soļi un žurnāla ieraksti,
+// un versiju laikus var salīdzināt tieši
+// vienas spēles buferi un soļi (allocate/upload/step/download) katrā versijā ir GolBackend klase (golBackend.h), to
+// izmanto gan 'run', gan salīdzināšanas programma golcompare (scripts/gol_compare.py), kas visas iekompilētās versijas
+// izpilda vienā procesā uz viena un tā paša režģa
+//
+// versija šeit tiek padota kā klase 'Backend' ar šādu saskarni:
+//   static constexpr const char *platform;            - platformas nosaukums žurnāla pirmajā kolonnā
+//   using PackedWord = ...;                           - 64 bitu vārda tips bitu pakotajam režģim
+//   static bool validate(const GolOptions &options);  - versijas papildu opciju pārbaudes, kļūdu izvada pati
+//   explicit Backend(BenchmarkLogger &logger);        - ierīces inicializācija, tiek mērīta kā "device init time"
+//   template <typename Cell>
+//   void run(const MappedGridFile &gridFile, GridFileWriter &writer, std::vector<Cell> &outputGrid, size_t steps,
+//            const GolOptions &options);             - spēle, rezultāts tiek vai nu nodots 'writer' pa rindu daļām,
+//                                                        vai atgriezts visā 'outputGrid'
+//   void runEnsemble(std::vector<EnsembleBoard> &boards, size_t steps, const GolOptions &options);
+
+// ielādē režģi, izpilda spēli un ieraksta rezultātu failā, 'Cell' nosaka režģa glabāšanas veidu
+template <typename Backend, typename Cell>
+void runGameOfLife(const std::string &inputFileName, const std::string &outputFileName, size_t gameSteps,
+				   const GolOptions &options, BenchmarkLogger &logger)
+{
+	constexpr bool packed = !std::is_same<Cell, unsigned char>::value;
+
+	auto start = std::chrono::steady_clock::now();
+
+	// fails tiek tikai attēlots atmiņā un sadalīts rindās, šūnas atkodē versijas GameOfLifeStep
+	MappedGridFile gridFile(inputFileName);
+
+	const size_t width = gridFile.width();
+	const size_t height = gridFile.height();
+
+	auto end = std::chrono::steady_clock::now();
+
+	logger.chronoLog("grid load time", start, end);
+
+	std::vector<Cell> outputGrid;
+
+	// baitu un pakotajā režģī GameOfLifeStep raksta rezultātu failā pa daļām, kamēr tas vēl tiek nolasīts no ierīces
+	GridFileWriter writer(outputFileName, width, height, packed);
+
+	auto initStart = std::chrono::steady_clock::now();
+
+	Backend backend(logger);
+
+	auto initEnd = std::chrono::steady_clock::now();
+
+	logger.chronoLog("device init time", initStart, initEnd);
+
+	std::cout << "Processing a " << width << "x" << height << " grid with " << gameSteps << " steps, rule "
+			  << ruleString(options.birthMask, options.survivalMask) << (options.wrap ? " on a torus\n" : "\n");
+
+	auto GoLStart = std::chrono::steady_clock::now();
+
+	backend.template run<Cell>(gridFile, writer, outputGrid, gameSteps, options);
+
+	auto GoLEnd = std::chrono::steady_clock::now();
+
+	logger.chronoLog("total game of life time", GoLStart, GoLEnd);
+
+	auto writeGridToFileStart = std::chrono::steady_clock::now();
+
+	// straumēšanas un vairāku ierīču režīmi atgriež visu režģi 'outputGrid', tas tiek nodots rakstītājam vienā daļā
+	if (!outputGrid.empty())
+	{
+		writer.writeRows(outputGrid.data(), 0, height);
+	}
+	writer.finish();
+
+	auto writeGridToFileEnd = std::chrono::steady_clock::now();
+
+	logger.chronoLog("write output grid to file time", writeGridToFileStart, writeGridToFileEnd);
+}
+
+// ansambļa režīms: ielādē visus režģus no direktorijas vai apvienotā faila, izpilda spēli visiem kopā un ieraksta
+// katru rezultātu izejas direktorijā
+template <typename Backend>
+void runGameOfLifeEnsemble(const std::string &inputPath, const std::string &outputDir, size_t gameSteps,
+						   const GolOptions &options, BenchmarkLogger &logger)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<EnsembleBoard> boards = loadEnsemble(inputPath);
+
+	auto end = std::chrono::steady_clock::now();
+
+	logger.chronoLog("grid load time", start, end);
+
+	auto initStart = std::chrono::steady_clock::now();
+
+	Backend backend(logger);
+
+	auto initEnd = std::chrono::steady_clock::now();
+
+	logger.chronoLog("device init time", initStart, initEnd);
+
+	std::cout << "Processing an ensemble of " << boards.size() << " grids with " << gameSteps << " steps, rule "
+			  << ruleString(options.birthMask, options.survivalMask) << (options.wrap ? " on a torus\n" : "\n");
+
+	auto GoLStart = std::chrono::steady_clock::now();
+
+	backend.runEnsemble(boards, gameSteps, options);
+
+	auto GoLEnd = std::chrono::steady_clock::now();
+
+	logger.chronoLog("total game of life time", GoLStart, GoLEnd);
+
+	auto writeGridToFileStart = std::chrono::steady_clock::now();
+
+	writeEnsemble(boards, outputDir);
+
+	auto writeGridToFileEnd = std::chrono::steady_clock::now();
+
+	logger.chronoLog("write output grid to file time", writeGridToFileStart, writeGridToFileEnd);
+}
+
+// programmas galvenā daļa ar obligātajiem argumentiem <režģis> <izvade> <soļi> <žurnāls> [opcijas], argc >= 5
+template <typename Backend>
+int runGolMain(int argc, char *argv[])
+{
+	const std::string inputFileName = argv[1];
+	const std::string outputFileName = argv[2];
+	const size_t gameSteps = std::stoll(argv[3]);
+	const std::string logFileName = argv[4];
+
+	GolOptions options;
+
+	try
+	{
+		options = parseGolOptions(argc, argv, 5);
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << e.what() << '\n';
+		printGolUsage(argv[0]);
+		return -1;
+	}
+
+	if (options.threads != 0 || options.hashLife)
+	{
+		std::cerr << "--threads and --hashlife are only implemented by the CPU version\n";
+		return -1;
+	}
+
+	if (!Backend::validate(options))
+	{
+		return -1;
+	}
+
+	BenchmarkLogger logger(logFileName, Backend::platform);
+
+	if (options.ensemble)
+	{
+		runGameOfLifeEnsemble<Backend>(inputFileName, outputFileName, gameSteps, options, logger);
+	}
+	else if (options.packed)
+	{
+		runGameOfLife<Backend, typename Backend::PackedWord>(inputFileName, outputFileName, gameSteps, options,
+															 logger);
+	}
+	else
+	{
+		runGameOfLife<Backend, unsigned char>(inputFileName, outputFileName, gameSteps, options, logger);
+	}
+
+	return 0;
+}
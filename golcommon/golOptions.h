@@ -0,0 +1,287 @@
+#pragma once
+
+#include "gridIO.h"
+#include "launchTuning.h"
+#include <cctype>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// maksimālais paaudžu skaits vienā kodola izsaukumā laika bloķēšanas režīmā, ierobežo koplietojamās atmiņas apjomu
+constexpr size_t MAX_BLOCK_STEPS = 16;
+
+// Life tipa likuma bitu maskas: bits n nozīmē, ka šūna piedzimst (birth) vai izdzīvo (survival) ar n kaimiņiem
+constexpr unsigned CONWAY_BIRTH_MASK = 1u << 3;
+constexpr unsigned CONWAY_SURVIVAL_MASK = (1u << 2) | (1u << 3);
+
+// neobligātās CLI opcijas, kas seko pēc obligātajiem programmas argumentiem
+struct GolOptions
+{
+	bool packed = false;      // režģis glabājas pa 64 šūnām vienā 64 bitu vārdā
+	size_t blockSteps = 1;    // paaudžu skaits vienā kodola izsaukumā (laika bloķēšana)
+	bool async = false;       // soļi tiek ierindoti bez sinhronizācijas pēc katra soļa, laiki nolasīti beigās
+	size_t streamMiB = 0;     // ierīces atmiņas budžets joslu straumēšanai (MiB), 0 - viss režģis atrodas ierīcē
+	bool activeTiles = false; // pārrēķina tikai flīzes, kuru apkārtnē iepriekšējā paaudzē kaut kas mainījās
+	size_t cyclePeriod = 0;   // lielākais meklētā atkārtojuma periods kodola izsaukumos, 0 - cikli netiek meklēti
+	size_t snapshotEvery = 0; // momentuzņēmums ik pēc tik paaudzēm, 0 - momentuzņēmumi netiek rakstīti
+	std::string snapshotPath; // momentuzņēmumu faila nosaukuma šablons, paaudze tiek pievienota pirms paplašinājuma
+	size_t devices = 1;       // ierīču skaits, starp kurām režģis tiek sadalīts joslās, 0 - visas pieejamās ierīces
+	bool autotune = false;    // pirms spēles izmēra bloku izmērus un saglabā ātrāko, citādi ņem iepriekš saglabāto
+	bool vectorized = false;  // OpenCL: kodols ar 16 šūnām vienā darba vienumā un apgabalu lokālajā atmiņā
+	bool ensemble = false;    // ievade ir režģu direktorija vai fails, izvade - direktorija, visi režģi vienā izsaukumā
+
+	// Life tipa likums un režģa robeža, noklusējums ir Conway B3/S23 ar mirušām šūnām aiz režģa malas
+	unsigned birthMask = CONWAY_BIRTH_MASK;       // kaimiņu skaiti, ar kuriem mirusi šūna piedzimst
+	unsigned survivalMask = CONWAY_SURVIVAL_MASK; // kaimiņu skaiti, ar kuriem dzīva šūna izdzīvo
+	bool wrap = false;                            // režģa pretējās malas ir kaimiņi (tors)
+
+	// tikai CPU versijas opcijas
+	unsigned threads = 0;              // pavedienu skaits, 0 nozīmē visus pieejamos kodolus
+	bool hashLife = false;             // HashLife dzinējs pārlec 2^k paaudzes reizē
+	size_t hashLifeMiB = 1024;         // virsotņu keša budžets, pārsniedzot to starp lēcieniem tiek savākti atkritumi
+	unsigned hashLifeMaxJumpLog2 = 63; // lielākais lēciens ir 2^k paaudzes
+};
+
+// nolasa B/S likuma pierakstu (piemēram, B3/S23 vai B36/S23) un atgriež dzimšanas un izdzīvošanas maskas
+inline void parseRuleString(const std::string &rule, unsigned &birthMask, unsigned &survivalMask)
+{
+	const size_t slash = rule.find('/');
+	if (slash == std::string::npos || slash == 0 || slash + 1 >= rule.size() || std::toupper(rule[0]) != 'B' ||
+		std::toupper(rule[slash + 1]) != 'S')
+	{
+		throw std::runtime_error("--rule must be in the B/S notation, for example B3/S23");
+	}
+
+	auto parseCounts = [&](size_t begin, size_t end) {
+		unsigned mask = 0;
+		for (size_t i = begin; i < end; i++)
+		{
+			if (rule[i] < '0' || rule[i] > '8')
+			{
+				throw std::runtime_error("--rule neighbor counts must be digits from 0 to 8: " + rule);
+			}
+			mask |= 1u << (rule[i] - '0');
+		}
+		return mask;
+	};
+
+	birthMask = parseCounts(1, slash);
+	survivalMask = parseCounts(slash + 2, rule.size());
+}
+
+// likuma pieraksts B/S formā no maskām
+inline std::string ruleString(unsigned birthMask, unsigned survivalMask)
+{
+	std::string rule = "B";
+	for (unsigned n = 0; n <= 8; n++)
+	{
+		if (birthMask & (1u << n))
+			rule += static_cast<char>('0' + n);
+	}
+
+	rule += "/S";
+	for (unsigned n = 0; n <= 8; n++)
+	{
+		if (survivalMask & (1u << n))
+			rule += static_cast<char>('0' + n);
+	}
+
+	return rule;
+}
+
+inline GolOptions parseGolOptions(int argc, char *argv[], int firstOptionIdx)
+{
+	GolOptions options;
+
+	for (int i = firstOptionIdx; i < argc; i++)
+	{
+		const std::string arg = argv[i];
+
+		if (arg == "--packed")
+		{
+			options.packed = true;
+		}
+		else if (arg == "--async")
+		{
+			options.async = true;
+		}
+		else if (arg == "--block-steps" && i + 1 < argc)
+		{
+			options.blockSteps = std::stoull(argv[++i]);
+		}
+		else if (arg == "--active-tiles")
+		{
+			options.activeTiles = true;
+		}
+		else if (arg == "--detect-cycles" && i + 1 < argc)
+		{
+			options.cyclePeriod = std::stoull(argv[++i]);
+		}
+		else if (arg == "--snapshot" && i + 2 < argc)
+		{
+			options.snapshotEvery = std::stoull(argv[++i]);
+			options.snapshotPath = argv[++i];
+		}
+		else if (arg == "--stream" && i + 1 < argc)
+		{
+			options.streamMiB = std::stoull(argv[++i]);
+		}
+		else if (arg == "--devices" && i + 1 < argc)
+		{
+			options.devices = std::stoull(argv[++i]);
+		}
+		else if (arg == "--rule" && i + 1 < argc)
+		{
+			parseRuleString(argv[++i], options.birthMask, options.survivalMask);
+		}
+		else if (arg == "--wrap")
+		{
+			options.wrap = true;
+		}
+		else if (arg == "--autotune")
+		{
+			options.autotune = true;
+		}
+		else if (arg == "--vectorized")
+		{
+			options.vectorized = true;
+		}
+		else if (arg == "--ensemble")
+		{
+			options.ensemble = true;
+		}
+		else if (arg == "--threads" && i + 1 < argc)
+		{
+			options.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+		}
+		else if (arg == "--hashlife")
+		{
+			options.hashLife = true;
+		}
+		else if (arg == "--hashlife-mb" && i + 1 < argc)
+		{
+			options.hashLifeMiB = std::stoull(argv[++i]);
+		}
+		else if (arg == "--hashlife-jump" && i + 1 < argc)
+		{
+			options.hashLifeMaxJumpLog2 = static_cast<unsigned>(std::stoul(argv[++i]));
+
+			if (options.hashLifeMaxJumpLog2 > 63)
+			{
+				throw std::runtime_error("--hashlife-jump must be between 0 and 63");
+			}
+		}
+		else
+		{
+			throw std::runtime_error("Unknown option: " + arg);
+		}
+	}
+
+	if (options.blockSteps < 1 || options.blockSteps > MAX_BLOCK_STEPS)
+	{
+		throw std::runtime_error("--block-steps must be between 1 and " + std::to_string(MAX_BLOCK_STEPS));
+	}
+
+	if (options.packed && options.blockSteps > 1)
+	{
+		throw std::runtime_error("--block-steps is only supported for the byte-per-cell grid");
+	}
+
+	if (options.streamMiB > 0 && (options.packed || options.async))
+	{
+		throw std::runtime_error("--stream cannot be combined with --packed or --async");
+	}
+
+	if (options.activeTiles && (options.packed || options.async || options.streamMiB > 0 || options.blockSteps > 1))
+	{
+		throw std::runtime_error("--active-tiles cannot be combined with --packed, --async, --stream or --block-steps");
+	}
+
+	if (options.cyclePeriod > 0 && (options.async || options.streamMiB > 0 || options.activeTiles))
+	{
+		throw std::runtime_error("--detect-cycles cannot be combined with --async, --stream or --active-tiles");
+	}
+
+	if (options.snapshotEvery > 0 &&
+		(options.async || options.streamMiB > 0 || options.activeTiles || options.cyclePeriod > 0))
+	{
+		throw std::runtime_error(
+			"--snapshot cannot be combined with --async, --stream, --active-tiles or --detect-cycles");
+	}
+
+	if (options.devices != 1 && (options.packed || options.async || options.streamMiB > 0 || options.activeTiles ||
+								 options.cyclePeriod > 0 || options.snapshotEvery > 0))
+	{
+		throw std::runtime_error("--devices cannot be combined with --packed, --async, --stream, --active-tiles, "
+								 "--detect-cycles or --snapshot");
+	}
+
+	if (options.wrap && (options.streamMiB > 0 || options.activeTiles || options.devices != 1))
+	{
+		throw std::runtime_error("--wrap cannot be combined with --stream, --active-tiles or --devices");
+	}
+
+	if (options.autotune && (options.streamMiB > 0 || options.activeTiles || options.devices != 1))
+	{
+		throw std::runtime_error("--autotune cannot be combined with --stream, --active-tiles or --devices");
+	}
+
+	if (options.vectorized && (options.packed || options.streamMiB > 0 || options.activeTiles || options.devices != 1))
+	{
+		throw std::runtime_error(
+			"--vectorized cannot be combined with --packed, --stream, --active-tiles or --devices");
+	}
+
+	if (options.ensemble && (options.packed || options.blockSteps > 1 || options.streamMiB > 0 || options.activeTiles ||
+							 options.cyclePeriod > 0 || options.snapshotEvery > 0 || options.devices != 1 ||
+							 options.autotune || options.vectorized))
+	{
+		throw std::runtime_error("--ensemble can only be combined with --async, --rule and --wrap");
+	}
+
+	if (options.hashLife && options.packed)
+	{
+		throw std::runtime_error("--hashlife cannot be combined with --packed");
+	}
+
+	return options;
+}
+
+inline void printGolUsage(const char *programName)
+{
+	std::cout << "Correct program usage:\n"
+			  << "\t\t" << programName
+			  << " <grid file path> <output grid file path> <game steps> <log file path> [options]\n"
+			  << "\tGrid files are read as text or binary (detected automatically), output paths ending in "
+			  << BINARY_GRID_EXTENSION << " are written in the binary format\n"
+			  << "\tOptions:\n"
+			  << "\t\t--packed\t\tstore 64 cells per 64-bit word instead of one byte per cell\n"
+			  << "\t\t--block-steps <k>\tcompute k generations per kernel launch in shared memory (1-"
+			  << MAX_BLOCK_STEPS << ")\n"
+			  << "\t\t--async\t\t\tqueue all steps without waiting for each one, read step timings after the run\n"
+			  << "\t\t--stream <MiB>\t\tkeep the grid in host memory and stream it in horizontal strips through\n"
+			  << "\t\t\t\t\tat most MiB of device memory, --block-steps sets the generations per strip pass\n"
+			  << "\t\t--active-tiles\t\tonly recompute tiles that changed or border a tile that changed in the\n"
+			  << "\t\t\t\t\tprevious generation, logs the active tile fraction per step\n"
+			  << "\t\t--detect-cycles <P>\thash every generation on the device and stop early once the grid repeats\n"
+			  << "\t\t\t\t\twith a period of at most P kernel launches, the output grid is unchanged\n"
+			  << "\t\t--snapshot <N> <path>\twrite the grid every N generations in the background, the generation is\n"
+			  << "\t\t\t\t\tinserted before the extension of path (snap.golb -> snap_100.golb)\n"
+			  << "\t\t--devices <n>\t\tsplit the grid into row bands across n devices (0 - all devices), band edges\n"
+			  << "\t\t\t\t\tare exchanged every --block-steps generations while the band interiors compute\n"
+			  << "\t\t--rule <B../S..>\tLife-like rule in the B/S notation (default B3/S23, HighLife is B36/S23)\n"
+			  << "\t\t--wrap\t\t\tconnect opposite grid edges (torus) instead of keeping cells beyond them dead\n"
+			  << "\t\t--autotune\t\ttime candidate block shapes on the grid before the run and store the fastest\n"
+			  << "\t\t\t\t\tper device and kernel in " << TuningCache::defaultFileName()
+			  << " (GOL_AUTOTUNE_FILE), later runs reuse it\n"
+			  << "\t\t--vectorized\t\tOpenCL only: each work-item computes 16 cells with uchar16 from a work-group\n"
+			  << "\t\t\t\t\ttile staged in local memory, compare its kernel exec time with the default kernel\n"
+			  << "\t\t--ensemble\t\tthe grid path is a directory of grids or a file of grids separated by empty\n"
+			  << "\t\t\t\t\tlines, the output path is a directory, all grids advance together in one launch per step\n"
+			  << "\t\t--threads <n>\t\tCPU only: number of worker threads (default: all hardware threads)\n"
+			  << "\t\t--hashlife\t\tCPU only: use the memoized quadtree (HashLife) engine, jumping 2^k generations\n"
+			  << "\t\t\t\t\tat once\n"
+			  << "\t\t--hashlife-mb <MiB>\tCPU only: node cache budget checked between jumps (default: 1024)\n"
+			  << "\t\t--hashlife-jump <k>\tCPU only: largest jump of 2^k generations (default: 63)\n";
+}
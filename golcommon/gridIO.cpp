@@ -0,0 +1,872 @@
+// Game of Life režģa failu nolasīšana un ierakstīšana
+
+#include "gridIO.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#ifdef GOL_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+// mazākais darba apjoms (baiti vai šūnas) vienam pavedienam, mazākiem failiem pavedieni maksā vairāk nekā ietaupa
+constexpr size_t MIN_BYTES_PER_THREAD = 1 << 20;
+
+static unsigned loaderThreadCount(size_t work)
+{
+	const size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+	return static_cast<unsigned>(std::max<size_t>(1, std::min(hardwareThreads, work / MIN_BYTES_PER_THREAD)));
+}
+
+// izpilda 'fn(threadIdx, threadCount)' uz 'threadCount' pavedieniem (ieskaitot izsaucēju), pārsūta izņēmumus
+template <typename Fn>
+static void parallelFor(unsigned threadCount, Fn fn)
+{
+	std::vector<std::exception_ptr> errors(threadCount);
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount - 1);
+
+	auto run = [&](unsigned threadIdx) {
+		try
+		{
+			fn(threadIdx, threadCount);
+		}
+		catch (...)
+		{
+			errors[threadIdx] = std::current_exception();
+		}
+	};
+
+	for (unsigned t = 1; t < threadCount; t++)
+	{
+		threads.emplace_back(run, t);
+	}
+
+	run(0);
+
+	for (std::thread &thread : threads)
+	{
+		thread.join();
+	}
+
+	for (const std::exception_ptr &error : errors)
+	{
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+	}
+}
+
+// binārā režģa faila galvene, tai seko gabalu izmēru tabula (uint64 katram gabalam baitos) un paši gabali pēc kārtas
+// katrs gabals satur 'rowsPerChunk' rindas (pēdējais var saturēt mazāk) pa packedWordsPerRow(width) vārdiem,
+// kodētas ar 'encoding', visi skaitļi glabājas little-endian secībā, kā tos glabā x86 un ARM resursdatori
+struct BinaryGridHeader
+{
+	char magic[4];     // "GOLB"
+	uint16_t version;  // BINARY_GRID_VERSION
+	uint16_t encoding; // GridEncoding
+	uint64_t width;
+	uint64_t height;
+	uint64_t rowsPerChunk;
+	uint64_t chunkCount;
+};
+
+static_assert(sizeof(BinaryGridHeader) == 40, "BinaryGridHeader must not contain padding");
+
+constexpr char BINARY_GRID_MAGIC[4] = {'G', 'O', 'L', 'B'};
+constexpr uint16_t BINARY_GRID_VERSION = 1;
+
+// gabala izmērs pirms saspiešanas
+constexpr size_t BINARY_CHUNK_BYTES = 1 << 20;
+
+#ifdef GOL_WITH_ZSTD
+// ātrākais līmenis, režģi ar lieliem tukšiem apgabaliem saspiežas labi arī tā
+constexpr int ZSTD_LEVEL = 1;
+#endif
+
+bool isBinaryGridFileName(const std::string &fileName)
+{
+	const size_t extensionLen = std::strlen(BINARY_GRID_EXTENSION);
+
+	return fileName.size() >= extensionLen &&
+		   fileName.compare(fileName.size() - extensionLen, extensionLen, BINARY_GRID_EXTENSION) == 0;
+}
+
+// pēdējā vārda neizmantoto bitu maska, tiem vienmēr jābūt nullēm
+static uint64_t packedTailMask(size_t width)
+{
+	const size_t tailBits = width % CELLS_PER_WORD;
+	return tailBits == 0 ? ~uint64_t(0) : (uint64_t(1) << tailBits) - 1;
+}
+
+MappedGridFile::MappedGridFile(const std::string &fileName)
+{
+	const int fd = open(fileName.c_str(), O_RDONLY);
+
+	if (fd < 0)
+	{
+		throw std::runtime_error("Failed to open file: " + fileName);
+	}
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0)
+	{
+		close(fd);
+		throw std::runtime_error("Failed to stat file: " + fileName);
+	}
+
+	fileSize = static_cast<size_t>(fileStat.st_size);
+
+	// tukšu failu nevar attēlot, tam vienkārši nav rindu
+	if (fileSize > 0)
+	{
+		void *mapped = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (mapped == MAP_FAILED)
+		{
+			close(fd);
+			throw std::runtime_error("Failed to map file: " + fileName);
+		}
+
+		data = static_cast<const char *>(mapped);
+	}
+
+	// attēlojums paliek spēkā arī pēc faila deskriptora aizvēršanas
+	close(fd);
+
+	// teksta režģis nevar sākties ar burtiem, tāpēc signatūra viennozīmīgi atšķir bināro failu
+	binary = fileSize >= sizeof(BINARY_GRID_MAGIC) &&
+			 std::memcmp(data, BINARY_GRID_MAGIC, sizeof(BINARY_GRID_MAGIC)) == 0;
+
+	try
+	{
+		if (binary)
+		{
+			readBinaryHeader();
+		}
+		else
+		{
+			findLines();
+		}
+	}
+	catch (...)
+	{
+		munmap(const_cast<char *>(data), fileSize);
+		throw;
+	}
+}
+
+MappedGridFile::~MappedGridFile()
+{
+	if (data != nullptr)
+	{
+		munmap(const_cast<char *>(data), fileSize);
+	}
+}
+
+void MappedGridFile::findLines()
+{
+	// katrs pavediens apstrādā rindas, kas sākas tā baitu intervālā, un pārbauda, ka tās visas ir vienāda garuma
+	struct Chunk
+	{
+		std::vector<size_t> lineStarts;
+		size_t lineWidth = 0;
+		size_t badLineIdx = SIZE_MAX;
+	};
+
+	const unsigned threadCount = loaderThreadCount(fileSize);
+	std::vector<Chunk> chunks(threadCount);
+
+	parallelFor(threadCount, [&](unsigned threadIdx, unsigned threads) {
+		size_t pos = fileSize * threadIdx / threads;
+		const size_t end = fileSize * (threadIdx + 1) / threads;
+
+		// rinda, kas sākusies iepriekšējā intervālā, pieder iepriekšējam pavedienam
+		if (pos > 0 && data[pos - 1] != '\n')
+		{
+			const char *newline = static_cast<const char *>(std::memchr(data + pos, '\n', end - pos));
+			pos = newline != nullptr ? newline - data + 1 : end;
+		}
+
+		Chunk &chunk = chunks[threadIdx];
+
+		while (pos < end)
+		{
+			const char *newline = static_cast<const char *>(std::memchr(data + pos, '\n', fileSize - pos));
+			const size_t lineEnd = newline != nullptr ? newline - data : fileSize;
+			const size_t lineLen = lineEnd - pos;
+
+			if (lineLen > 0)
+			{
+				if (chunk.lineStarts.empty())
+				{
+					chunk.lineWidth = lineLen;
+				}
+				else if (lineLen != chunk.lineWidth && chunk.badLineIdx == SIZE_MAX)
+				{
+					chunk.badLineIdx = chunk.lineStarts.size();
+				}
+
+				chunk.lineStarts.push_back(pos);
+			}
+
+			pos = lineEnd + 1;
+		}
+	});
+
+	for (Chunk &chunk : chunks)
+	{
+		if (chunk.lineStarts.empty())
+		{
+			continue;
+		}
+
+		if (gridWidth == 0)
+		{
+			gridWidth = chunk.lineWidth;
+		}
+
+		if (chunk.lineWidth != gridWidth)
+		{
+			throw std::runtime_error("Invalid line length at line idx: " + std::to_string(gridHeight));
+		}
+
+		if (chunk.badLineIdx != SIZE_MAX)
+		{
+			throw std::runtime_error("Invalid line length at line idx: " +
+									 std::to_string(gridHeight + chunk.badLineIdx));
+		}
+
+		lineStarts.insert(lineStarts.end(), chunk.lineStarts.begin(), chunk.lineStarts.end());
+		gridHeight += chunk.lineStarts.size();
+	}
+}
+
+void MappedGridFile::readBinaryHeader()
+{
+	if (fileSize < sizeof(BinaryGridHeader))
+	{
+		throw std::runtime_error("Truncated binary grid header");
+	}
+
+	BinaryGridHeader header;
+	std::memcpy(&header, data, sizeof(header));
+
+	if (header.version != BINARY_GRID_VERSION)
+	{
+		throw std::runtime_error("Unsupported binary grid version: " + std::to_string(header.version));
+	}
+
+	encoding = static_cast<GridEncoding>(header.encoding);
+
+	if (encoding != GridEncoding::Raw && encoding != GridEncoding::Zstd)
+	{
+		throw std::runtime_error("Unknown binary grid encoding: " + std::to_string(header.encoding));
+	}
+
+#ifndef GOL_WITH_ZSTD
+	if (encoding == GridEncoding::Zstd)
+	{
+		throw std::runtime_error("zstd compressed grid files need a build with zstd support");
+	}
+#endif
+
+	gridWidth = header.width;
+	gridHeight = header.height;
+	rowsPerChunk = header.rowsPerChunk;
+
+	const size_t chunkCount = header.chunkCount;
+	const size_t chunkRowBytes = packedWordsPerRow(gridWidth) * sizeof(uint64_t);
+
+	if ((gridHeight > 0 && (gridWidth == 0 || rowsPerChunk == 0)) ||
+		chunkCount != (gridHeight == 0 ? 0 : (gridHeight + rowsPerChunk - 1) / rowsPerChunk))
+	{
+		throw std::runtime_error("Invalid binary grid chunk layout");
+	}
+
+	if ((fileSize - sizeof(BinaryGridHeader)) / sizeof(uint64_t) < chunkCount)
+	{
+		throw std::runtime_error("Truncated binary grid chunk table");
+	}
+
+	chunkOffsets.resize(chunkCount + 1);
+	chunkOffsets[0] = sizeof(BinaryGridHeader) + chunkCount * sizeof(uint64_t);
+
+	for (size_t chunk = 0; chunk < chunkCount; chunk++)
+	{
+		uint64_t chunkSize;
+		std::memcpy(&chunkSize, data + sizeof(BinaryGridHeader) + chunk * sizeof(uint64_t), sizeof(chunkSize));
+
+		const size_t rows = std::min(rowsPerChunk, gridHeight - chunk * rowsPerChunk);
+
+		if (encoding == GridEncoding::Raw && chunkSize != rows * chunkRowBytes)
+		{
+			throw std::runtime_error("Invalid size of binary grid chunk " + std::to_string(chunk));
+		}
+
+		if (chunkSize > fileSize - chunkOffsets[chunk])
+		{
+			throw std::runtime_error("Truncated binary grid chunk " + std::to_string(chunk));
+		}
+
+		chunkOffsets[chunk + 1] = chunkOffsets[chunk] + chunkSize;
+	}
+}
+
+void MappedGridFile::decodeBinary(unsigned char *cells, uint64_t *words) const
+{
+	const size_t wordsPerRow = packedWordsPerRow(gridWidth);
+	const uint64_t tailMask = packedTailMask(gridWidth);
+	const size_t chunkCount = chunkOffsets.size() - 1;
+
+	if (chunkCount == 0)
+	{
+		return;
+	}
+
+	const unsigned threadCount =
+		static_cast<unsigned>(std::min(chunkCount, size_t(loaderThreadCount(wordsPerRow * gridHeight * 8))));
+
+	parallelFor(threadCount, [&](unsigned threadIdx, unsigned threads) {
+		// baitu režģim gabals vispirms tiek atkodēts šeit un tikai tad izpakots pa šūnām
+		std::vector<uint64_t> scratch;
+
+		for (size_t chunk = chunkCount * threadIdx / threads; chunk < chunkCount * (threadIdx + 1) / threads; chunk++)
+		{
+			const size_t rowBegin = chunk * rowsPerChunk;
+			const size_t rows = std::min(rowsPerChunk, gridHeight - rowBegin);
+			const size_t chunkBytes = rows * wordsPerRow * sizeof(uint64_t);
+
+			const char *src = data + chunkOffsets[chunk];
+
+			uint64_t *packed = words + rowBegin * wordsPerRow;
+			if (words == nullptr)
+			{
+				scratch.resize(rows * wordsPerRow);
+				packed = scratch.data();
+			}
+
+			if (encoding == GridEncoding::Raw)
+			{
+				std::memcpy(packed, src, chunkBytes);
+			}
+#ifdef GOL_WITH_ZSTD
+			else
+			{
+				const size_t srcSize = chunkOffsets[chunk + 1] - chunkOffsets[chunk];
+				const size_t decodedSize = ZSTD_decompress(packed, chunkBytes, src, srcSize);
+
+				if (ZSTD_isError(decodedSize) || decodedSize != chunkBytes)
+				{
+					throw std::runtime_error("Corrupted zstd chunk " + std::to_string(chunk) + " in binary grid");
+				}
+			}
+#endif
+
+			for (size_t y = 0; y < rows; y++)
+			{
+				uint64_t *row = packed + y * wordsPerRow;
+				row[wordsPerRow - 1] &= tailMask;
+
+				if (cells != nullptr)
+				{
+					unsigned char *cellRow = cells + (rowBegin + y) * gridWidth;
+
+					for (size_t x = 0; x < gridWidth; x++)
+					{
+						cellRow[x] = (row[x / CELLS_PER_WORD] >> (x % CELLS_PER_WORD)) & 1;
+					}
+				}
+			}
+		}
+	});
+}
+
+void MappedGridFile::decodeInto(unsigned char *dst) const
+{
+	if (binary)
+	{
+		decodeBinary(dst, nullptr);
+		return;
+	}
+
+	parallelFor(loaderThreadCount(gridWidth * gridHeight), [&](unsigned threadIdx, unsigned threads) {
+		const size_t rowBegin = gridHeight * threadIdx / threads;
+		const size_t rowEnd = gridHeight * (threadIdx + 1) / threads;
+
+		for (size_t y = rowBegin; y < rowEnd; y++)
+		{
+			const char *line = data + lineStarts[y];
+			unsigned char *row = dst + y * gridWidth;
+
+			for (size_t x = 0; x < gridWidth; x++)
+			{
+				row[x] = static_cast<unsigned char>(line[x] - '0');
+			}
+		}
+	});
+}
+
+void MappedGridFile::decodePackedInto(uint64_t *dst) const
+{
+	if (binary)
+	{
+		decodeBinary(nullptr, dst);
+		return;
+	}
+
+	const size_t wordsPerRow = packedWordsPerRow(gridWidth);
+
+	parallelFor(loaderThreadCount(gridWidth * gridHeight), [&](unsigned threadIdx, unsigned threads) {
+		const size_t rowBegin = gridHeight * threadIdx / threads;
+		const size_t rowEnd = gridHeight * (threadIdx + 1) / threads;
+
+		for (size_t y = rowBegin; y < rowEnd; y++)
+		{
+			const char *line = data + lineStarts[y];
+			uint64_t *row = dst + y * wordsPerRow;
+
+			for (size_t wordX = 0; wordX < wordsPerRow; wordX++)
+			{
+				const size_t cellBegin = wordX * CELLS_PER_WORD;
+				const size_t cells = std::min(CELLS_PER_WORD, gridWidth - cellBegin);
+
+				uint64_t word = 0;
+				for (size_t bit = 0; bit < cells; bit++)
+				{
+					word |= static_cast<uint64_t>(line[cellBegin + bit] == '1') << bit;
+				}
+
+				row[wordX] = word;
+			}
+		}
+	});
+}
+
+std::vector<unsigned char> loadGridFromFile(const std::string &fileName, size_t &width, size_t &height)
+{
+	MappedGridFile file(fileName);
+
+	width = file.width();
+	height = file.height();
+
+	std::vector<unsigned char> grid(width * height);
+	file.decodeInto(grid.data());
+
+	return grid;
+}
+
+std::vector<uint64_t> loadPackedGridFromFile(const std::string &fileName, size_t &width, size_t &height)
+{
+	MappedGridFile file(fileName);
+
+	width = file.width();
+	height = file.height();
+
+	std::vector<uint64_t> grid(packedWordsPerRow(width) * height);
+	file.decodePackedInto(grid.data());
+
+	return grid;
+}
+
+// 'packRows(rowBegin, rows, dst)' ieraksta 'rows' pakotas rindas, sākot no 'rowBegin', buferī 'dst'
+// gabali tiek sagatavoti un saspiesti paralēli, pēc tam ierakstīti failā pēc kārtas
+template <typename PackRows>
+static void writeBinaryGridFile(const std::string &fileName, size_t width, size_t height, PackRows packRows)
+{
+	std::ofstream file(fileName, std::ios::out | std::ios::binary);
+	if (!file.is_open())
+	{
+		throw std::runtime_error("Failed to open file: " + fileName);
+	}
+
+	const size_t wordsPerRow = packedWordsPerRow(width);
+	const size_t rowBytes = wordsPerRow * sizeof(uint64_t);
+	const size_t rowsPerChunk = std::max<size_t>(1, BINARY_CHUNK_BYTES / std::max<size_t>(1, rowBytes));
+	const size_t chunkCount = (height + rowsPerChunk - 1) / rowsPerChunk;
+
+#ifdef GOL_WITH_ZSTD
+	const GridEncoding encoding = GridEncoding::Zstd;
+#else
+	const GridEncoding encoding = GridEncoding::Raw;
+#endif
+
+	std::vector<std::vector<char>> chunks(chunkCount);
+
+	const unsigned threadCount =
+		static_cast<unsigned>(std::max<size_t>(1, std::min(chunkCount, size_t(loaderThreadCount(rowBytes * height)))));
+
+	parallelFor(threadCount, [&](unsigned threadIdx, unsigned threads) {
+		std::vector<uint64_t> packed;
+
+		for (size_t chunk = chunkCount * threadIdx / threads; chunk < chunkCount * (threadIdx + 1) / threads; chunk++)
+		{
+			const size_t rowBegin = chunk * rowsPerChunk;
+			const size_t rows = std::min(rowsPerChunk, height - rowBegin);
+			const size_t chunkBytes = rows * rowBytes;
+
+			packed.resize(rows * wordsPerRow);
+			packRows(rowBegin, rows, packed.data());
+
+#ifdef GOL_WITH_ZSTD
+			std::vector<char> &compressed = chunks[chunk];
+			compressed.resize(ZSTD_compressBound(chunkBytes));
+
+			const size_t compressedSize =
+				ZSTD_compress(compressed.data(), compressed.size(), packed.data(), chunkBytes, ZSTD_LEVEL);
+
+			if (ZSTD_isError(compressedSize))
+			{
+				throw std::runtime_error(std::string("zstd compression failed: ") + ZSTD_getErrorName(compressedSize));
+			}
+
+			compressed.resize(compressedSize);
+#else
+			const char *bytes = reinterpret_cast<const char *>(packed.data());
+			chunks[chunk].assign(bytes, bytes + chunkBytes);
+#endif
+		}
+	});
+
+	BinaryGridHeader header;
+	std::memcpy(header.magic, BINARY_GRID_MAGIC, sizeof(header.magic));
+	header.version = BINARY_GRID_VERSION;
+	header.encoding = static_cast<uint16_t>(encoding);
+	header.width = width;
+	header.height = height;
+	header.rowsPerChunk = rowsPerChunk;
+	header.chunkCount = chunkCount;
+
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+	for (const std::vector<char> &chunk : chunks)
+	{
+		const uint64_t chunkSize = chunk.size();
+		file.write(reinterpret_cast<const char *>(&chunkSize), sizeof(chunkSize));
+	}
+
+	for (const std::vector<char> &chunk : chunks)
+	{
+		file.write(chunk.data(), chunk.size());
+	}
+
+	file.close();
+}
+
+// teksta faila rindu daļa, ko viens pavediens formatē un ieraksta vienā pwrite izsaukumā
+constexpr size_t TEXT_WRITE_BLOCK_BYTES = 1 << 20;
+
+GridFileWriter::GridFileWriter(const std::string &fileName, size_t width, size_t height, bool packed)
+	: fileName(fileName), gridWidth(width), gridHeight(height), packed(packed), binary(isBinaryGridFileName(fileName))
+{
+	if (binary)
+	{
+		binaryWords.resize(packedWordsPerRow(width) * height);
+		return;
+	}
+
+	fd = open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+	{
+		throw std::runtime_error("Failed to open file: " + fileName);
+	}
+
+	// rindas var pienākt jebkurā secībā, tāpēc fails uzreiz tiek izveidots pilnā garumā (+1, jo rindas beigās ir \n)
+	if (ftruncate(fd, static_cast<off_t>((width + 1) * height)) != 0)
+	{
+		close(fd);
+		throw std::runtime_error("Failed to resize file: " + fileName);
+	}
+}
+
+GridFileWriter::~GridFileWriter()
+{
+	if (fd >= 0)
+	{
+		close(fd);
+	}
+}
+
+void GridFileWriter::writeRows(const void *rows, size_t rowBegin, size_t rowCount)
+{
+	const size_t width = gridWidth;
+	const size_t wordsPerRow = packedWordsPerRow(width);
+
+	const unsigned char *cells = static_cast<const unsigned char *>(rows);
+	const uint64_t *words = static_cast<const uint64_t *>(rows);
+
+	if (binary)
+	{
+		uint64_t *dst = binaryWords.data() + rowBegin * wordsPerRow;
+
+		if (packed)
+		{
+			std::memcpy(dst, words, rowCount * wordsPerRow * sizeof(uint64_t));
+			return;
+		}
+
+		parallelFor(loaderThreadCount(rowCount * width), [&](unsigned threadIdx, unsigned threadCount) {
+			for (size_t y = rowCount * threadIdx / threadCount; y < rowCount * (threadIdx + 1) / threadCount; y++)
+			{
+				const unsigned char *row = cells + y * width;
+				uint64_t *rowWords = dst + y * wordsPerRow;
+				std::fill(rowWords, rowWords + wordsPerRow, 0);
+
+				for (size_t x = 0; x < width; x++)
+				{
+					rowWords[x / CELLS_PER_WORD] |= static_cast<uint64_t>(row[x] & 1) << (x % CELLS_PER_WORD);
+				}
+			}
+		});
+		return;
+	}
+
+	const size_t lineBytes = width + 1; // +1, jo rindas beigās ir \n
+	const size_t rowsPerBlock = std::max<size_t>(1, TEXT_WRITE_BLOCK_BYTES / lineBytes);
+	const size_t blockCount = (rowCount + rowsPerBlock - 1) / rowsPerBlock;
+
+	// katrs pavediens formatē savus blokus mazā buferī un ieraksta tos faila vietā, kur tie atrodas
+	const unsigned threadCount =
+		static_cast<unsigned>(std::max<size_t>(1, std::min(blockCount, size_t(loaderThreadCount(rowCount * width)))));
+
+	parallelFor(threadCount, [&](unsigned threadIdx, unsigned threads) {
+		std::vector<char> buffer;
+
+		for (size_t block = blockCount * threadIdx / threads; block < blockCount * (threadIdx + 1) / threads; block++)
+		{
+			const size_t blockRow = block * rowsPerBlock;
+			const size_t blockRows = std::min(rowsPerBlock, rowCount - blockRow);
+			buffer.resize(blockRows * lineBytes);
+
+			for (size_t y = 0; y < blockRows; y++)
+			{
+				char *line = buffer.data() + y * lineBytes;
+
+				if (packed)
+				{
+					const uint64_t *row = words + (blockRow + y) * wordsPerRow;
+
+					for (size_t x = 0; x < width; x++)
+					{
+						line[x] = '0' + ((row[x / CELLS_PER_WORD] >> (x % CELLS_PER_WORD)) & 1);
+					}
+				}
+				else
+				{
+					const unsigned char *row = cells + (blockRow + y) * width;
+
+					for (size_t x = 0; x < width; x++)
+					{
+						line[x] = '0' + row[x];
+					}
+				}
+
+				line[width] = '\n';
+			}
+
+			// pwrite var ierakstīt mazāk, nekā prasīts, tāpēc atlikums tiek rakstīts, līdz bloks ir pilns
+			off_t offset = static_cast<off_t>((rowBegin + blockRow) * lineBytes);
+			const char *data = buffer.data();
+			size_t remaining = buffer.size();
+
+			while (remaining > 0)
+			{
+				const ssize_t written = pwrite(fd, data, remaining, offset);
+				if (written < 0 && errno == EINTR)
+				{
+					continue;
+				}
+				if (written <= 0)
+				{
+					throw std::runtime_error("Failed to write file: " + fileName);
+				}
+
+				data += written;
+				remaining -= static_cast<size_t>(written);
+				offset += written;
+			}
+		}
+	});
+}
+
+void GridFileWriter::finish()
+{
+	if (binary)
+	{
+		const size_t wordsPerRow = packedWordsPerRow(gridWidth);
+
+		writeBinaryGridFile(fileName, gridWidth, gridHeight, [&](size_t rowBegin, size_t rows, uint64_t *dst) {
+			std::memcpy(dst, binaryWords.data() + rowBegin * wordsPerRow, rows * wordsPerRow * sizeof(uint64_t));
+		});
+		return;
+	}
+
+	const int result = close(fd);
+	fd = -1;
+
+	if (result != 0)
+	{
+		throw std::runtime_error("Failed to write file: " + fileName);
+	}
+}
+
+void writeGridToFile(std::vector<unsigned char> &grid, size_t width, size_t height, std::string fileName)
+{
+	if (isBinaryGridFileName(fileName))
+	{
+		writeBinaryGridFile(fileName, width, height, [&](size_t rowBegin, size_t rows, uint64_t *dst) {
+			const size_t wordsPerRow = packedWordsPerRow(width);
+			std::fill(dst, dst + rows * wordsPerRow, 0);
+
+			for (size_t y = 0; y < rows; y++)
+			{
+				const unsigned char *row = grid.data() + (rowBegin + y) * width;
+				uint64_t *words = dst + y * wordsPerRow;
+
+				for (size_t x = 0; x < width; x++)
+				{
+					words[x / CELLS_PER_WORD] |= static_cast<uint64_t>(row[x] & 1) << (x % CELLS_PER_WORD);
+				}
+			}
+		});
+		return;
+	}
+
+	GridFileWriter writer(fileName, width, height, false);
+	writer.writeRows(grid.data(), 0, height);
+	writer.finish();
+}
+
+void writePackedGridToFile(std::vector<uint64_t> &grid, size_t width, size_t height, std::string fileName)
+{
+	if (isBinaryGridFileName(fileName))
+	{
+		writeBinaryGridFile(fileName, width, height, [&](size_t rowBegin, size_t rows, uint64_t *dst) {
+			const size_t wordsPerRow = packedWordsPerRow(width);
+			std::memcpy(dst, grid.data() + rowBegin * wordsPerRow, rows * wordsPerRow * sizeof(uint64_t));
+		});
+		return;
+	}
+
+	GridFileWriter writer(fileName, width, height, true);
+	writer.writeRows(grid.data(), 0, height);
+	writer.finish();
+}
+
+// nolasa teksta failu ar režģiem, kas atdalīti ar vienu vai vairākām tukšām rindām
+static std::vector<EnsembleBoard> loadConcatenatedBoards(const std::string &fileName)
+{
+	std::ifstream file(fileName, std::ios::in | std::ios::binary);
+	if (!file.is_open())
+	{
+		throw std::runtime_error("Failed to open file: " + fileName);
+	}
+
+	std::vector<EnsembleBoard> boards;
+	bool boardOpen = false;
+	size_t lineIdx = 0;
+
+	for (std::string line; std::getline(file, line); lineIdx++)
+	{
+		if (line.empty())
+		{
+			boardOpen = false;
+			continue;
+		}
+
+		if (!boardOpen)
+		{
+			boards.emplace_back();
+			boards.back().name = "board_" + std::to_string(boards.size() - 1) + ".txt";
+			boards.back().width = line.size();
+			boardOpen = true;
+		}
+
+		EnsembleBoard &board = boards.back();
+
+		if (line.size() != board.width)
+		{
+			throw std::runtime_error("Invalid line length at line idx: " + std::to_string(lineIdx));
+		}
+
+		for (char c : line)
+		{
+			if (c != '0' && c != '1')
+			{
+				throw std::runtime_error("Invalid cell at line idx: " + std::to_string(lineIdx));
+			}
+			board.cells.push_back(static_cast<unsigned char>(c - '0'));
+		}
+
+		board.height++;
+	}
+
+	return boards;
+}
+
+std::vector<EnsembleBoard> loadEnsemble(const std::string &path)
+{
+	std::vector<EnsembleBoard> boards;
+
+	if (std::filesystem::is_directory(path))
+	{
+		std::vector<std::filesystem::path> files;
+		for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(path))
+		{
+			if (entry.is_regular_file())
+			{
+				files.push_back(entry.path());
+			}
+		}
+
+		// direktorijas secība nav noteikta, bet režģu secībai jābūt atkārtojamai starp palaišanām
+		std::sort(files.begin(), files.end());
+
+		for (const std::filesystem::path &file : files)
+		{
+			MappedGridFile gridFile(file.string());
+
+			EnsembleBoard board;
+			board.name = file.filename().string();
+			board.width = gridFile.width();
+			board.height = gridFile.height();
+			board.cells.resize(board.width * board.height);
+			gridFile.decodeInto(board.cells.data());
+
+			boards.push_back(std::move(board));
+		}
+	}
+	else
+	{
+		boards = loadConcatenatedBoards(path);
+	}
+
+	if (boards.empty())
+	{
+		throw std::runtime_error("No grids found in ensemble input: " + path);
+	}
+
+	return boards;
+}
+
+void writeEnsemble(std::vector<EnsembleBoard> &boards, const std::string &outputDir)
+{
+	std::filesystem::create_directories(outputDir);
+
+	for (EnsembleBoard &board : boards)
+	{
+		writeGridToFile(board.cells, board.width, board.height,
+						(std::filesystem::path(outputDir) / board.name).string());
+	}
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// bitu pakotā režģī vienā 64 bitu vārdā glabājas 64 blakus esošas vienas rindas šūnas,
+// šūna x atrodas vārdā x / 64, bitā x % 64 (mazākais bits ir kreisākā šūna)
+// katra rinda sākas ar jaunu vārdu, pēdējā vārda neizmantotie biti vienmēr ir nulles
+constexpr size_t CELLS_PER_WORD = 64;
+
+inline size_t packedWordsPerRow(size_t width)
+{
+	return (width + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+}
+
+// binārajā režģa failā ir galvene (platums, augstums, kodējums) un bitu pakotas rindas gabalos pa ~1 MiB,
+// gabali tiek atkodēti un kodēti paralēli, formāts aprakstīts gridIO.cpp
+// nolasot formāts tiek atpazīts pēc signatūras, ierakstot - pēc faila paplašinājuma
+constexpr const char *BINARY_GRID_EXTENSION = ".golb";
+
+enum class GridEncoding : uint16_t
+{
+	Raw = 0,  // gabali satur nesaspiestus vārdus
+	Zstd = 1, // katrs gabals saspiests ar zstd, pieejams tikai, ja kompilēts ar GOL_WITH_ZSTD
+};
+
+bool isBinaryGridFileName(const std::string &fileName);
+
+// režģa teksta fails, kas attēlots atmiņā ar mmap, kopā ar visu netukšo rindu sākuma pozīcijām
+// rindas tiek atrastas un to garumi pārbaudīti paralēli vairākos pavedienos, met ārā kļūdu, ja kāda rinda
+// nesatur tādu pašu simbolu skaitu kā pirmā
+// binārajam failam tiek nolasīta tikai galvene un gabalu tabula
+// decode* metodes ieraksta šūnas tieši izsaucēja buferī (piemēram, piesprausta atmiņa), bez starpposma vektoriem
+class MappedGridFile
+{
+  private:
+	const char *data = nullptr;
+	size_t fileSize = 0;
+	size_t gridWidth = 0;
+	size_t gridHeight = 0;
+	std::vector<size_t> lineStarts;
+
+	bool binary = false;
+	GridEncoding encoding = GridEncoding::Raw;
+	size_t rowsPerChunk = 0;
+	std::vector<size_t> chunkOffsets; // gabalu sākumi failā, pēdējais elements ir pēdējā gabala beigas
+
+	void findLines();
+	void readBinaryHeader();
+	// atkodē binārā faila gabalus, aizpildot vienu no 'cells' vai 'words' (otrs ir nullptr)
+	void decodeBinary(unsigned char *cells, uint64_t *words) const;
+
+  public:
+	explicit MappedGridFile(const std::string &fileName);
+	~MappedGridFile();
+
+	MappedGridFile(const MappedGridFile &) = delete;
+	MappedGridFile &operator=(const MappedGridFile &) = delete;
+
+	size_t width() const
+	{
+		return gridWidth;
+	}
+
+	size_t height() const
+	{
+		return gridHeight;
+	}
+
+	// 'dst' jābūt vismaz width * height baitiem, viena šūna vienā baitā
+	void decodeInto(unsigned char *dst) const;
+
+	// 'dst' jābūt vismaz packedWordsPerRow(width) * height vārdiem
+	void decodePackedInto(uint64_t *dst) const;
+};
+
+// izveido flat grid masīvu, automātiski nosakot width, height
+// met ārā kļūdas ja nav atbilstošu simbolu (1, 0) vai ja kāda rindiņa nesatur tādu pašu simbolu skaitu kā pirmā
+std::vector<unsigned char> loadGridFromFile(const std::string &fileName, size_t &width, size_t &height);
+
+// tas pats, kas loadGridFromFile, tikai šūnas uzreiz tiek sapakotas pa 64 vienā vārdā
+std::vector<uint64_t> loadPackedGridFromFile(const std::string &fileName, size_t &width, size_t &height);
+
+// režģa izvades fails, kuram rindas var nodot pa daļām jebkurā secībā, piemēram, tiklīdz tās ir nolasītas no ierīces
+// teksta failā katra daļa tiek formatēta paralēli un uzreiz ierakstīta savā vietā failā ar pwrite, tāpēc nav
+// vajadzīgs ne visa režģa kopijas vektors, ne visa faila formatēšanas buferis
+// binārajā failā gabalu izmēru tabula ir pirms datiem, tāpēc rindas tiek sapakotas un fails ierakstīts finish()
+// 'packed' nosaka, vai writeRows saņem šūnas pa vienai baitā vai packedWordsPerRow(width) vārdus rindā
+class GridFileWriter
+{
+  private:
+	std::string fileName;
+	size_t gridWidth;
+	size_t gridHeight;
+	bool packed;
+	bool binary;
+	int fd = -1;
+	std::vector<uint64_t> binaryWords; // tikai binārajam failam
+
+  public:
+	GridFileWriter(const std::string &fileName, size_t width, size_t height, bool packed);
+	~GridFileWriter();
+
+	GridFileWriter(const GridFileWriter &) = delete;
+	GridFileWriter &operator=(const GridFileWriter &) = delete;
+
+	// ieraksta 'rowCount' rindas, sākot ar 'rowBegin', 'rows' norāda uz pirmās no tām pirmo elementu
+	void writeRows(const void *rows, size_t rowBegin, size_t rowCount);
+
+	// pabeidz failu, met ārā kļūdu, ja to nevarēja ierakstīt
+	void finish();
+};
+
+// ja faila nosaukums beidzas ar BINARY_GRID_EXTENSION, režģis tiek ierakstīts binārajā formātā
+void writeGridToFile(std::vector<unsigned char> &grid, size_t width, size_t height, std::string fileName);
+
+void writePackedGridToFile(std::vector<uint64_t> &grid, size_t width, size_t height, std::string fileName);
+
+// viens ansambļa režģis: izejas faila nosaukums, izmēri un šūnas pa vienai baitā
+struct EnsembleBoard
+{
+	std::string name;
+	size_t width = 0;
+	size_t height = 0;
+	std::vector<unsigned char> cells;
+};
+
+// ja 'path' ir direktorija, katrs tās fails (teksta vai binārs) ir viens režģis, izejā tas saglabā faila nosaukumu
+// citādi 'path' ir teksta fails ar vairākiem režģiem, kas atdalīti ar tukšām rindām, tie saņem nosaukumus
+// board_<n>.txt; režģi var būt dažāda izmēra, met ārā kļūdu, ja neviena režģa nav
+std::vector<EnsembleBoard> loadEnsemble(const std::string &path);
+
+// ieraksta katru režģi direktorijā 'outputDir' (izveido, ja tās nav) ar tā nosaukumu
+void writeEnsemble(std::vector<EnsembleBoard> &boards, const std::string &outputDir);
@@ -0,0 +1,223 @@
+#include "launchTuning.h"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+// vienkāršs JSON lasītājs tieši tai apakškopai, ko raksta TuningCache::save - objekti, virknes un skaitļi
+class TuningJsonReader
+{
+  private:
+	const std::string &text;
+	size_t pos = 0;
+
+	void skipSpaces()
+	{
+		while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos])))
+			pos++;
+	}
+
+	void expect(char c)
+	{
+		skipSpaces();
+		if (pos >= text.size() || text[pos] != c)
+		{
+			throw std::runtime_error(std::string("expected '") + c + "'");
+		}
+		pos++;
+	}
+
+	bool consume(char c)
+	{
+		skipSpaces();
+		if (pos < text.size() && text[pos] == c)
+		{
+			pos++;
+			return true;
+		}
+		return false;
+	}
+
+  public:
+	explicit TuningJsonReader(const std::string &text) : text(text)
+	{
+	}
+
+	std::string readString()
+	{
+		expect('"');
+
+		std::string value;
+		while (pos < text.size() && text[pos] != '"')
+		{
+			// ierīču nosaukumos var būt tikai \" un \\, citas atsoļa secības save neraksta
+			if (text[pos] == '\\' && pos + 1 < text.size())
+				pos++;
+			value += text[pos++];
+		}
+
+		expect('"');
+		return value;
+	}
+
+	double readNumber()
+	{
+		skipSpaces();
+
+		const char *begin = text.c_str() + pos;
+		char *end = nullptr;
+		const double value = std::strtod(begin, &end);
+		if (end == begin)
+		{
+			throw std::runtime_error("expected a number");
+		}
+
+		pos += end - begin;
+		return value;
+	}
+
+	// izsauc 'member(atslēga)' katram objekta loceklim, kuram jānolasa sava vērtība
+	template <typename Member>
+	void readObject(Member member)
+	{
+		expect('{');
+		if (consume('}'))
+			return;
+
+		do
+		{
+			const std::string key = readString();
+			expect(':');
+			member(key);
+		} while (consume(','));
+
+		expect('}');
+	}
+};
+
+static std::string jsonString(const std::string &value)
+{
+	std::string quoted = "\"";
+	for (char c : value)
+	{
+		if (c == '"' || c == '\\')
+			quoted += '\\';
+		quoted += c;
+	}
+	return quoted + "\"";
+}
+
+TuningCache::TuningCache(std::string fileName) : fileName(std::move(fileName))
+{
+	load();
+}
+
+std::string TuningCache::defaultFileName()
+{
+	const char *fileName = std::getenv("GOL_AUTOTUNE_FILE");
+	return fileName != nullptr ? fileName : "autotune.json";
+}
+
+bool TuningCache::find(const std::string &device, const std::string &kernel, LaunchShape &shape) const
+{
+	auto deviceEntries = entries.find(device);
+	if (deviceEntries == entries.end())
+		return false;
+
+	auto entry = deviceEntries->second.find(kernel);
+	if (entry == deviceEntries->second.end())
+		return false;
+
+	shape = entry->second.shape;
+	return true;
+}
+
+void TuningCache::store(const std::string &device, const std::string &kernel, LaunchShape shape, double timeMs)
+{
+	entries[device][kernel] = Entry{shape, timeMs};
+	save();
+}
+
+void TuningCache::load()
+{
+	std::ifstream file(fileName);
+	if (!file.is_open())
+		return;
+
+	const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	try
+	{
+		TuningJsonReader reader(text);
+
+		reader.readObject([&](const std::string &device) {
+			reader.readObject([&](const std::string &kernel) {
+				Entry entry;
+				reader.readObject([&](const std::string &field) {
+					const double value = reader.readNumber();
+					if (field == "block_x")
+						entry.shape.x = static_cast<size_t>(value);
+					else if (field == "block_y")
+						entry.shape.y = static_cast<size_t>(value);
+					else if (field == "time_ms")
+						entry.timeMs = value;
+				});
+
+				if (entry.shape.x > 0 && entry.shape.y > 0)
+					entries[device][kernel] = entry;
+			});
+		});
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << "Ignoring autotune cache " << fileName << ": " << e.what() << '\n';
+		entries.clear();
+	}
+}
+
+void TuningCache::save() const
+{
+	std::ostringstream json;
+	json << "{\n";
+
+	for (auto device = entries.begin(); device != entries.end(); device++)
+	{
+		json << "\t" << jsonString(device->first) << ": {\n";
+
+		for (auto kernel = device->second.begin(); kernel != device->second.end(); kernel++)
+		{
+			const Entry &entry = kernel->second;
+			json << "\t\t" << jsonString(kernel->first) << ": {\"block_x\": " << entry.shape.x
+				 << ", \"block_y\": " << entry.shape.y << ", \"time_ms\": " << entry.timeMs << "}"
+				 << (std::next(kernel) != device->second.end() ? ",\n" : "\n");
+		}
+
+		json << "\t}" << (std::next(device) != entries.end() ? ",\n" : "\n");
+	}
+
+	json << "}\n";
+
+	// vispirms raksta pagaidu failā un tad pārsauc, lai pārtraukta rakstīšana nesabojātu iepriekšējos rezultātus
+	const std::string tempFileName = fileName + ".tmp";
+	{
+		std::ofstream file(tempFileName, std::ios::trunc);
+		if (!file.is_open())
+			return;
+		file << json.str();
+		if (!file)
+			return;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempFileName, fileName, error);
+	if (error)
+	{
+		std::filesystem::remove(tempFileName, error);
+	}
+}
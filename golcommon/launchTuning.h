@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+// kodola bloka (OpenCL darba grupas) izmērs pavedienos
+struct LaunchShape
+{
+	size_t x = 32;
+	size_t y = 8;
+};
+
+// bloku izmēri, kurus pārbauda --autotune, pirmais ir iepriekšējais noklusējums 32x8
+constexpr LaunchShape LAUNCH_SHAPE_CANDIDATES[] = {{32, 8},  {32, 4},  {32, 16}, {64, 2}, {64, 4},
+												   {64, 8},  {128, 1}, {128, 2}, {128, 4}, {256, 1},
+												   {16, 16}, {16, 8},  {32, 32}, {8, 8}};
+
+// viendimensiju kodolu (SHA-256 paroļu kodoli) bloku izmēri, pirmais ir iepriekšējais noklusējums 256
+// mazākais kandidāts nosaka, cik daļu var būt rindu sadalīšanas kodoliem, tāpēc tas nedrīkst būt mazāks par 64
+constexpr LaunchShape BLOCK_SIZE_CANDIDATES[] = {{256, 1}, {64, 1}, {128, 1}, {512, 1}, {1024, 1}};
+
+// kodola izsaukumu skaits vienam kandidātam, pirms tiem vēl viens iesildīšanas izsaukums netiek mērīts
+constexpr size_t AUTOTUNE_LAUNCHES = 16;
+
+// JSON fails ar ātrākajiem bloku izmēriem katrai ierīcei un kodolam:
+// {"<ierīce>": {"<kodols>": {"block_x": 32, "block_y": 8, "time_ms": 1.5}}}
+// fails nav obligāts, tāpēc bojāts vai neeksistējošs fails tiek uzskatīts par tukšu un kļūdas rakstot tiek ignorētas
+class TuningCache
+{
+  public:
+	explicit TuningCache(std::string fileName);
+
+	// fails no vides mainīgā GOL_AUTOTUNE_FILE, citādi "autotune.json"
+	static std::string defaultFileName();
+
+	bool find(const std::string &device, const std::string &kernel, LaunchShape &shape) const;
+
+	// saglabā rezultātu un pārraksta visu failu
+	void store(const std::string &device, const std::string &kernel, LaunchShape shape, double timeMs);
+
+  private:
+	struct Entry
+	{
+		LaunchShape shape;
+		double timeMs = 0;
+	};
+
+	std::string fileName;
+	std::map<std::string, std::map<std::string, Entry>> entries;
+
+	void load();
+	void save() const;
+};
+
+// bloka izmērs kodolam 'kernel': ar 'autotune' tiek izmērīti visi 'candidates' un ātrākais saglabāts kešatmiņā,
+// citādi tiek ņemts kešatmiņā esošais vai 'fallback'
+// 'measure' atgriež vidējo viena izsaukuma laiku milisekundēs vai negatīvu vērtību, ja ierīce izmēru neatbalsta
+template <typename Measure, typename Logger, size_t N>
+LaunchShape resolveLaunchShape(TuningCache &cache, const std::string &device, const std::string &kernel,
+							   bool autotune, LaunchShape fallback, const LaunchShape (&candidates)[N],
+							   Measure measure, Logger &logger)
+{
+	LaunchShape shape = fallback;
+
+	if (!autotune)
+	{
+		cache.find(device, kernel, shape);
+		return shape;
+	}
+
+	double bestTime = -1;
+
+	for (const LaunchShape &candidate : candidates)
+	{
+		const double time = measure(candidate);
+		if (time < 0)
+			continue;
+
+		logger.log("autotune " + kernel + " " + std::to_string(candidate.x) + "x" + std::to_string(candidate.y),
+				   time);
+
+		if (bestTime < 0 || time < bestTime)
+		{
+			bestTime = time;
+			shape = candidate;
+		}
+	}
+
+	if (bestTime >= 0)
+	{
+		cache.store(device, kernel, shape, bestTime);
+	}
+
+	return shape;
+}
+
+// 2D kodoliem (GoL kodoli) tiek pārbaudīti LAUNCH_SHAPE_CANDIDATES
+template <typename Measure, typename Logger>
+LaunchShape resolveLaunchShape(TuningCache &cache, const std::string &device, const std::string &kernel,
+							   bool autotune, LaunchShape fallback, Measure measure, Logger &logger)
+{
+	return resolveLaunchShape(cache, device, kernel, autotune, fallback, LAUNCH_SHAPE_CANDIDATES, measure, logger);
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#include "gridIO.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// piespraustās atmiņas buferu (ligzdu) skaits momentuzņēmumu gredzenā
+constexpr size_t SNAPSHOT_SLOTS = 3;
+
+// paaudzes numurs tiek ievietots pirms faila paplašinājuma, piemēram, snap.golb -> snap_100.golb
+inline std::string snapshotFileName(const std::string &pathTemplate, size_t generation)
+{
+	const size_t slash = pathTemplate.find_last_of("/\\");
+	const size_t dot = pathTemplate.find_last_of('.');
+
+	if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+	{
+		return pathTemplate + "_" + std::to_string(generation);
+	}
+
+	return pathTemplate.substr(0, dot) + "_" + std::to_string(generation) + pathTemplate.substr(dot);
+}
+
+// fona pavediens, kas raksta momentuzņēmumus failos, lai soļu cikls nekad negaidītu uz diska operācijām
+// ligzdu buferus (parasti piespraustā atmiņa) piešķir izsaucējs, tie jāatbrīvo tikai pēc finish()
+// 'Cell' ir unsigned char (viena šūna baitā) vai uint64_t (bitu pakots režģis)
+template <typename Cell>
+class SnapshotWriter
+{
+  public:
+	SnapshotWriter(const std::string &pathTemplate, size_t width, size_t height, size_t slotElements,
+				   std::vector<Cell *> slotBuffers)
+		: pathTemplate(pathTemplate), width(width), height(height), slotElements(slotElements),
+		  slotBuffers(std::move(slotBuffers)), slotBusy(this->slotBuffers.size(), false)
+	{
+		writerThread = std::thread(&SnapshotWriter::run, this);
+	}
+
+	~SnapshotWriter()
+	{
+		if (writerThread.joinable())
+		{
+			stop();
+		}
+	}
+
+	SnapshotWriter(const SnapshotWriter &) = delete;
+	SnapshotWriter &operator=(const SnapshotWriter &) = delete;
+
+	// atrod brīvu ligzdu; ja visas vēl tiek kopētas vai rakstītas, momentuzņēmums tiek izlaists un atgriež false
+	bool acquireSlot(size_t &slot)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for (size_t i = 0; i < slotBusy.size(); i++)
+		{
+			if (!slotBusy[i])
+			{
+				slotBusy[i] = true;
+				slot = i;
+				return true;
+			}
+		}
+
+		droppedCount++;
+		return false;
+	}
+
+	// 'waitForCopy' izpildās rakstītāja pavedienā un sagaida, kamēr ierīce pabeidz kopēt režģi ligzdā
+	void submit(size_t slot, size_t generation, std::function<void()> waitForCopy)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			jobs.push_back({slot, generation, std::move(waitForCopy), std::chrono::steady_clock::now()});
+		}
+
+		jobReady.notify_one();
+	}
+
+	// sagaida visu iesniegto momentuzņēmumu ierakstīšanu, pārmet rakstītāja pavediena kļūdu, ja tāda bija
+	void finish()
+	{
+		stop();
+
+		if (writerError)
+		{
+			std::rethrow_exception(writerError);
+		}
+	}
+
+	// laiks no iesniegšanas līdz faila ierakstīšanai katram momentuzņēmumam, derīgs pēc finish()
+	const std::vector<double> &lags() const
+	{
+		return lagTimes;
+	}
+
+	size_t dropped() const
+	{
+		return droppedCount;
+	}
+
+  private:
+	struct Job
+	{
+		size_t slot;
+		size_t generation;
+		std::function<void()> waitForCopy;
+		std::chrono::steady_clock::time_point submitted;
+	};
+
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+
+		jobReady.notify_one();
+		writerThread.join();
+	}
+
+	void run()
+	{
+		// writeGridToFile pieņem std::vector, tāpēc ligzda tiek nokopēta un uzreiz atbrīvota nākamajam kopējumam
+		std::vector<Cell> grid(slotElements);
+
+		for (;;)
+		{
+			Job job;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				jobReady.wait(lock, [this] { return !jobs.empty() || stopping; });
+
+				if (jobs.empty())
+				{
+					return;
+				}
+
+				job = std::move(jobs.front());
+				jobs.pop_front();
+			}
+
+			try
+			{
+				job.waitForCopy();
+				std::memcpy(grid.data(), slotBuffers[job.slot], slotElements * sizeof(Cell));
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					slotBusy[job.slot] = false;
+				}
+
+				const std::string fileName = snapshotFileName(pathTemplate, job.generation);
+
+				if constexpr (std::is_same<Cell, unsigned char>::value)
+				{
+					writeGridToFile(grid, width, height, fileName);
+				}
+				else
+				{
+					writePackedGridToFile(grid, width, height, fileName);
+				}
+
+				std::chrono::duration<double, std::milli> lag = std::chrono::steady_clock::now() - job.submitted;
+
+				std::lock_guard<std::mutex> lock(mutex);
+				lagTimes.push_back(lag.count());
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				slotBusy[job.slot] = false;
+
+				if (!writerError)
+				{
+					writerError = std::current_exception();
+				}
+			}
+		}
+	}
+
+	const std::string pathTemplate;
+	const size_t width;
+	const size_t height;
+	const size_t slotElements;
+	const std::vector<Cell *> slotBuffers;
+
+	std::mutex mutex;
+	std::condition_variable jobReady;
+	std::deque<Job> jobs;
+	std::vector<bool> slotBusy;
+	bool stopping = false;
+
+	std::vector<double> lagTimes;
+	size_t droppedCount = 0;
+	std::exception_ptr writerError;
+
+	std::thread writerThread;
+};
@@ -0,0 +1,253 @@
+// salīdzināšanas programma: visas iekompilētās Game of Life versijas pēc kārtas izpilda vienu un to pašu režģi, kas
+// atkodēts atmiņā tikai vienu reizi, pārbauda, ka visu versiju rezultāti sakrīt, un raksta vienu kopīgu žurnālu
+
+#include "benchmarkLogger.h"
+#include "golBackend.h"
+#include "golOptions.h"
+#include "gridIO.h"
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// versijas, kuras CMakeLists.txt iekompilēja šajā programmā, CPU versija ir vienmēr
+struct BackendEntry
+{
+	const char *name;
+	std::unique_ptr<GolBackend> (*make)(BenchmarkLogger &logger);
+};
+
+const BackendEntry BACKENDS[] = {
+	{"CPU", makeCpuGolBackend},
+#ifdef GOL_WITH_CUDA
+	{"CUDA", makeCudaGolBackend},
+#endif
+#ifdef GOL_WITH_HIP
+	{"HIP", makeHipGolBackend},
+#endif
+#ifdef GOL_WITH_OPENCL
+	{"OpenCL", makeClGolBackend},
+#endif
+};
+
+// vienas versijas rezultāts kopsavilkumam
+struct BackendResult
+{
+	std::string name;
+	bool ran = false;
+	bool matches = false;
+	GolTiming timing;
+	double totalMs = 0;
+};
+
+// režīmi, kuros versijas programmas izsauc kodolus pašas, soļu saskarnē nav pieejami
+bool validateCompareOptions(const GolOptions &options)
+{
+	if (options.async || options.streamMiB > 0 || options.activeTiles || options.cyclePeriod > 0 ||
+		options.snapshotEvery > 0 || options.devices != 1 || options.ensemble || options.hashLife)
+	{
+		std::cerr << "--async, --stream, --active-tiles, --detect-cycles, --snapshot, --devices, --ensemble and "
+					 "--hashlife are only implemented by the version executables\n";
+		return false;
+	}
+
+	return true;
+}
+
+// pirmās rindas numurs, kurā 'a' un 'b' atšķiras, vai 'height', ja tās sakrīt
+template <typename Cell>
+size_t firstDifferentRow(const std::vector<Cell> &a, const std::vector<Cell> &b, size_t rowElements, size_t height)
+{
+	for (size_t y = 0; y < height; y++)
+	{
+		if (std::memcmp(a.data() + y * rowElements, b.data() + y * rowElements, rowElements * sizeof(Cell)) != 0)
+		{
+			return y;
+		}
+	}
+
+	return height;
+}
+
+// 'Cell' ir unsigned char (viena šūna baitā) vai uint64_t (bitu pakots režģis, 64 šūnas vārdā)
+// katra versija saņem to pašu sākuma režģi, tās rezultāts tiek salīdzināts ar pirmās izpildītās versijas rezultātu
+template <typename Cell>
+std::vector<BackendResult> runBackends(const MappedGridFile &gridFile, size_t steps, const GolOptions &options,
+									   BenchmarkLogger &logger)
+{
+	constexpr bool packed = std::is_same<Cell, uint64_t>::value;
+
+	const size_t width = gridFile.width();
+	const size_t height = gridFile.height();
+	const size_t rowElements = packed ? packedWordsPerRow(width) : width;
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<Cell> initialGrid(rowElements * height);
+
+	if constexpr (packed)
+	{
+		gridFile.decodePackedInto(initialGrid.data());
+	}
+	else
+	{
+		gridFile.decodeInto(initialGrid.data());
+	}
+
+	auto end = std::chrono::steady_clock::now();
+	logger.chronoLog("grid decode time", start, end);
+
+	std::vector<Cell> referenceGrid;
+	std::vector<Cell> resultGrid(initialGrid.size());
+	std::string referenceName;
+
+	std::vector<BackendResult> results;
+
+	for (const BackendEntry &entry : BACKENDS)
+	{
+		BackendResult result;
+		result.name = entry.name;
+
+		logger.setPlatform(entry.name);
+
+		try
+		{
+			auto GoLStart = std::chrono::steady_clock::now();
+
+			std::unique_ptr<GolBackend> backend = entry.make(logger);
+			backend->allocate(width, height, options);
+			backend->upload(initialGrid.data());
+			backend->step(steps);
+			backend->download(resultGrid.data());
+
+			auto GoLEnd = std::chrono::steady_clock::now();
+
+			result.timing = backend->timing();
+			result.totalMs = std::chrono::duration<double, std::milli>(GoLEnd - GoLStart).count();
+			result.ran = true;
+
+			logger.log("total kernel exec time", result.timing.kernelMs);
+			logger.chronoLog("total game of life time", GoLStart, GoLEnd);
+		}
+		catch (const std::exception &e)
+		{
+			std::cerr << entry.name << " skipped: " << e.what() << '\n';
+			results.push_back(result);
+			continue;
+		}
+
+		if (referenceName.empty())
+		{
+			referenceGrid = resultGrid;
+			referenceName = entry.name;
+			result.matches = true;
+		}
+		else
+		{
+			const size_t row = firstDifferentRow(referenceGrid, resultGrid, rowElements, height);
+			result.matches = row == height;
+
+			if (!result.matches)
+			{
+				std::cerr << entry.name << " output differs from " << referenceName << " starting at row " << row
+						  << '\n';
+			}
+		}
+
+		results.push_back(result);
+	}
+
+	return results;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 4)
+	{
+		std::cout << "Correct program usage:\n"
+				  << "\t\t" << argv[0] << " <grid file path> <game steps> <log file path> [options]\n"
+				  << "\tRuns every compiled-in backend on the same grid and checks that their outputs match, "
+				  << "supports --packed, --block-steps, --rule, --wrap, --autotune, --vectorized and --threads\n";
+		return 0;
+	}
+
+	const std::string inputFileName = argv[1];
+	const size_t gameSteps = std::stoll(argv[2]);
+	const std::string logFileName = argv[3];
+
+	GolOptions options;
+
+	try
+	{
+		options = parseGolOptions(argc, argv, 4);
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << e.what() << '\n';
+		printGolUsage(argv[0]);
+		return -1;
+	}
+
+	if (!validateCompareOptions(options))
+	{
+		return -1;
+	}
+
+	BenchmarkLogger logger(logFileName, "host");
+
+	auto start = std::chrono::steady_clock::now();
+
+	MappedGridFile gridFile(inputFileName);
+
+	auto end = std::chrono::steady_clock::now();
+
+	logger.chronoLog("grid load time", start, end);
+
+	std::cout << "Processing a " << gridFile.width() << "x" << gridFile.height() << " grid with " << gameSteps
+			  << " steps, rule " << ruleString(options.birthMask, options.survivalMask)
+			  << (options.wrap ? " on a torus\n" : "\n");
+
+	const std::vector<BackendResult> results =
+		options.packed ? runBackends<uint64_t>(gridFile, gameSteps, options, logger)
+					   : runBackends<unsigned char>(gridFile, gameSteps, options, logger);
+
+	std::cout << std::left << std::setw(10) << "backend" << std::right << std::setw(14) << "upload ms"
+			  << std::setw(14) << "kernel ms" << std::setw(14) << "download ms" << std::setw(14) << "total ms"
+			  << std::setw(10) << "output" << '\n'
+			  << std::fixed << std::setprecision(3);
+
+	bool allMatch = true;
+	size_t ranCount = 0;
+
+	for (const BackendResult &result : results)
+	{
+		std::cout << std::left << std::setw(10) << result.name << std::right;
+
+		if (!result.ran)
+		{
+			std::cout << std::setw(66) << "skipped" << '\n';
+			continue;
+		}
+
+		std::cout << std::setw(14) << result.timing.uploadMs << std::setw(14) << result.timing.kernelMs
+				  << std::setw(14) << result.timing.downloadMs << std::setw(14) << result.totalMs << std::setw(10)
+				  << (result.matches ? "match" : "DIFFERS") << '\n';
+
+		allMatch = allMatch && result.matches;
+		ranCount++;
+	}
+
+	if (ranCount == 0)
+	{
+		std::cerr << "No backend could run with these options\n";
+		return 1;
+	}
+
+	return allMatch ? 0 : 1;
+}
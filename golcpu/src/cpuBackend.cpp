@@ -0,0 +1,232 @@
+// CPU versija soļu saskarnei (golBackend.h), to izmanto gan GameOfLifeStep main.cpp, gan salīdzināšanas programma
+
+#include "cpuKernels.h"
+#include "golBackend.h"
+#include "gridIO.h"
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+// 'Cell' ir unsigned char (viena šūna baitā) vai uint64_t (bitu pakots režģis, 64 šūnas vārdā)
+// režģis tiek sadalīts pa rindām starp pavedieniem, pēc katra soļa visi pavedieni sagaida viens otru pie barjeras
+template <typename Cell>
+class CpuGolGrid : public GolBackend
+{
+  public:
+	static constexpr bool packed = std::is_same<Cell, uint64_t>::value;
+
+	explicit CpuGolGrid(BenchmarkLogger &logger) : logger(logger)
+	{
+	}
+
+	const char *platform() const override
+	{
+		return "CPU";
+	}
+
+	void allocate(size_t width, size_t height, const GolOptions &options) override
+	{
+		this->width = width;
+		this->height = height;
+
+		const size_t rowElements = packed ? packedWordsPerRow(width) : width;
+		gridSize = rowElements * height;
+
+		// nav jēgas palaist vairāk pavedienu kā ir rindu
+		threadCount = options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+		threadCount = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threadCount, height)));
+
+		auto start = std::chrono::steady_clock::now();
+
+		// tāpat kā GPU versijās, divi buferi, kurus pēc katra soļa samainām vietām
+		inputBuffer.assign(gridSize, 0);
+		outputBuffer.assign(gridSize, 0);
+
+		auto end = std::chrono::steady_clock::now();
+
+		logger.chronoLog("buffer creation time", start, end);
+	}
+
+	// CPU versijā pārsūtīšanas nav, upload un download tikai kopē šūnas, tāpēc to laiki netiek logoti
+	void upload(const void *cells) override
+	{
+		auto start = std::chrono::steady_clock::now();
+		std::memcpy(inputBuffer.data(), cells, gridSize * sizeof(Cell));
+		auto end = std::chrono::steady_clock::now();
+
+		timings.uploadMs += std::chrono::duration<double, std::milli>(end - start).count();
+	}
+
+	void step(size_t generations) override
+	{
+		Cell *currentInput = inputBuffer.data();
+		Cell *currentOutput = outputBuffer.data();
+
+		auto stepStart = std::chrono::steady_clock::now();
+
+		// izpildās vienu reizi pēc tam, kad visi pavedieni pabeiguši soli, tāpēc logeris netiek izsaukts paralēli
+		auto onStepDone = [&]() noexcept {
+			auto stepEnd = std::chrono::steady_clock::now();
+
+			std::chrono::duration<double, std::milli> stepTime = stepEnd - stepStart;
+			logger.log("kernel exec time", stepTime.count());
+			timings.kernelMs += stepTime.count();
+
+			std::swap(currentInput, currentOutput);
+
+			stepStart = std::chrono::steady_clock::now();
+		};
+
+		std::barrier stepBarrier(threadCount, onStepDone);
+
+		auto worker = [&](unsigned threadIdx) {
+			const size_t rowBegin = height * threadIdx / threadCount;
+			const size_t rowEnd = height * (threadIdx + 1) / threadCount;
+
+			for (size_t step = 0; step < generations; step++)
+			{
+				if constexpr (packed)
+				{
+					golPackedRows(currentInput, currentOutput, width, height, rowBegin, rowEnd);
+				}
+				else
+				{
+					golByteRows(currentInput, currentOutput, width, height, rowBegin, rowEnd);
+				}
+
+				stepBarrier.arrive_and_wait();
+			}
+		};
+
+		std::vector<std::thread> threads;
+		threads.reserve(threadCount - 1);
+
+		stepStart = std::chrono::steady_clock::now();
+
+		for (unsigned t = 1; t < threadCount; t++)
+		{
+			threads.emplace_back(worker, t);
+		}
+
+		// galvenais pavediens apstrādā pirmo rindu intervālu
+		worker(0);
+
+		for (std::thread &thread : threads)
+		{
+			thread.join();
+		}
+
+		// ņemot vērā pēdējo std::swap ar buferiem, pēdējā izeja atrodas input buferī
+		if (currentInput != inputBuffer.data())
+		{
+			inputBuffer.swap(outputBuffer);
+		}
+	}
+
+	void download(void *cells) override
+	{
+		auto start = std::chrono::steady_clock::now();
+		std::memcpy(cells, inputBuffer.data(), gridSize * sizeof(Cell));
+		auto end = std::chrono::steady_clock::now();
+
+		timings.downloadMs += std::chrono::duration<double, std::milli>(end - start).count();
+	}
+
+	GolTiming timing() const override
+	{
+		return timings;
+	}
+
+  private:
+	BenchmarkLogger &logger;
+
+	size_t width = 0;
+	size_t height = 0;
+	size_t gridSize = 0;
+	unsigned threadCount = 1;
+
+	std::vector<Cell> inputBuffer;
+	std::vector<Cell> outputBuffer;
+
+	GolTiming timings;
+};
+
+// CPU versija izpilda tikai Conway B3/S23 ar mirušām šūnām aiz režģa malas, options.blockSteps tiek ignorēts, jo
+// katrs pavedienu solis izrēķina vienu paaudzi
+class CpuGolBackend : public GolBackend
+{
+  public:
+	explicit CpuGolBackend(BenchmarkLogger &logger) : logger(logger)
+	{
+	}
+
+	const char *platform() const override
+	{
+		return "CPU";
+	}
+
+	void allocate(size_t width, size_t height, const GolOptions &options) override
+	{
+		if (options.birthMask != CONWAY_BIRTH_MASK || options.survivalMask != CONWAY_SURVIVAL_MASK || options.wrap)
+		{
+			throw std::runtime_error("--rule and --wrap are only implemented by the GPU versions");
+		}
+
+		if (options.hashLife)
+		{
+			throw std::runtime_error("--hashlife does not run step by step");
+		}
+
+		if (options.packed)
+		{
+			grid = std::make_unique<CpuGolGrid<uint64_t>>(logger);
+		}
+		else
+		{
+			grid = std::make_unique<CpuGolGrid<unsigned char>>(logger);
+		}
+
+		grid->allocate(width, height, options);
+	}
+
+	void upload(const void *cells) override
+	{
+		grid->upload(cells);
+	}
+
+	void step(size_t generations) override
+	{
+		grid->step(generations);
+	}
+
+	void download(void *cells) override
+	{
+		grid->download(cells);
+	}
+
+	GolTiming timing() const override
+	{
+		return grid->timing();
+	}
+
+  private:
+	BenchmarkLogger &logger;
+	std::unique_ptr<GolBackend> grid;
+};
+
+} // namespace
+
+std::unique_ptr<GolBackend> makeCpuGolBackend(BenchmarkLogger &logger)
+{
+	return std::make_unique<CpuGolBackend>(logger);
+}
@@ -0,0 +1,175 @@
+// Game of Life soļa aprēķins uz CPU
+
+#include "cpuKernels.h"
+#include "gridIO.h"
+#include <cstring>
+#include <vector>
+
+// GCC/Clang vektoru paplašinājums: operatori &, |, ^, ~, <<, >> darbojas uz visām joslām reizē,
+// kompilators tos pārvērš AVX-512 / AVX2 / SSE2 instrukcijās atkarībā no mērķa arhitektūras
+#if defined(__AVX512F__)
+constexpr size_t SIMD_WORDS = 8;
+#elif defined(__AVX2__)
+constexpr size_t SIMD_WORDS = 4;
+#else
+constexpr size_t SIMD_WORDS = 2;
+#endif
+
+typedef uint64_t SimdWords __attribute__((vector_size(SIMD_WORDS * sizeof(uint64_t))));
+
+const char *golSimdName()
+{
+#if defined(__AVX512F__)
+	return "AVX-512";
+#elif defined(__AVX2__)
+	return "AVX2";
+#else
+	return "SSE2";
+#endif
+}
+
+static inline SimdWords loadWords(const uint64_t *ptr)
+{
+	SimdWords v;
+	std::memcpy(&v, ptr, sizeof(v));
+	return v;
+}
+
+static inline void storeWords(uint64_t *ptr, SimdWords v)
+{
+	std::memcpy(ptr, &v, sizeof(v));
+}
+
+// tāda pati bitu summatoru shēma kā GPU golPackedWord, tikai 'T' var būt gan viens vārds, gan SIMD vektors
+// xW, xC, xE ir attiecīgās rindas kaimiņi pa kreisi, pati kolonna un kaimiņi pa labi (jau nobīdīti)
+template <typename T>
+static inline T golPackedRule(T aW, T aC, T aE, T rW, T rC, T rE, T bW, T bC, T bE)
+{
+	// katras rindas kaimiņu summa divos bitos (augšējai un apakšējai rindai 0..3, vidējai 0..2)
+	const T a0 = aW ^ aC ^ aE;
+	const T a1 = (aW & aC) | (aE & (aW ^ aC));
+	const T r0 = rW ^ rE;
+	const T r1 = rW & rE;
+	const T b0 = bW ^ bC ^ bE;
+	const T b1 = (bW & bC) | (bE & (bW ^ bC));
+
+	// visu trīs rindu summa četros bitos s0..s3 (0..8)
+	const T s0 = a0 ^ r0 ^ b0;
+	const T c0 = (a0 & r0) | (b0 & (a0 ^ r0));
+	const T x1 = a1 ^ r1 ^ b1;
+	const T y1 = (a1 & r1) | (b1 & (a1 ^ r1));
+	const T s1 = x1 ^ c0;
+	const T c1 = x1 & c0;
+	const T s2 = y1 ^ c1;
+	const T s3 = y1 & c1;
+
+	// šūna ir dzīva, ja kaimiņu ir 3, vai ja kaimiņu ir 2 un šūna jau bija dzīva
+	return ~s3 & ~s2 & s1 & (s0 | rC);
+}
+
+// viena vārda aprēķins ar robežu pārbaudēm, izmanto rindas malās
+static inline uint64_t golPackedScalar(const uint64_t *above, const uint64_t *row, const uint64_t *below,
+									   size_t wordX, size_t wordsPerRow)
+{
+	const bool hasLeft = wordX > 0;
+	const bool hasRight = wordX < wordsPerRow - 1;
+
+	const uint64_t aL = hasLeft ? above[wordX - 1] : 0;
+	const uint64_t aR = hasRight ? above[wordX + 1] : 0;
+	const uint64_t rL = hasLeft ? row[wordX - 1] : 0;
+	const uint64_t rR = hasRight ? row[wordX + 1] : 0;
+	const uint64_t bL = hasLeft ? below[wordX - 1] : 0;
+	const uint64_t bR = hasRight ? below[wordX + 1] : 0;
+
+	const uint64_t aC = above[wordX];
+	const uint64_t rC = row[wordX];
+	const uint64_t bC = below[wordX];
+
+	return golPackedRule<uint64_t>((aC << 1) | (aL >> 63), aC, (aC >> 1) | (aR << 63), (rC << 1) | (rL >> 63), rC,
+								   (rC >> 1) | (rR << 63), (bC << 1) | (bL >> 63), bC, (bC >> 1) | (bR << 63));
+}
+
+void golPackedRows(const uint64_t *input, uint64_t *output, size_t width, size_t height, size_t rowBegin,
+				   size_t rowEnd)
+{
+	const size_t wordsPerRow = packedWordsPerRow(width);
+	const size_t tailBits = width % CELLS_PER_WORD;
+	const uint64_t tailMask = tailBits == 0 ? ~uint64_t(0) : (uint64_t(1) << tailBits) - 1;
+
+	// pirmās un pēdējās rindas kaimiņš ārpus režģa ir nulles rinda
+	const std::vector<uint64_t> zeroRow(wordsPerRow, 0);
+
+	for (size_t y = rowBegin; y < rowEnd; y++)
+	{
+		const uint64_t *row = input + y * wordsPerRow;
+		const uint64_t *above = y > 0 ? row - wordsPerRow : zeroRow.data();
+		const uint64_t *below = y < height - 1 ? row + wordsPerRow : zeroRow.data();
+		uint64_t *out = output + y * wordsPerRow;
+
+		out[0] = golPackedScalar(above, row, below, 0, wordsPerRow);
+
+		// iekšējie vārdi: kreisos un labos kaimiņus nolasa ar nobīdītu nelīdzinātu ielādi
+		size_t wordX = 1;
+		for (; wordX + SIMD_WORDS < wordsPerRow; wordX += SIMD_WORDS)
+		{
+			const SimdWords aC = loadWords(above + wordX);
+			const SimdWords rC = loadWords(row + wordX);
+			const SimdWords bC = loadWords(below + wordX);
+
+			const SimdWords aW = (aC << 1) | (loadWords(above + wordX - 1) >> 63);
+			const SimdWords aE = (aC >> 1) | (loadWords(above + wordX + 1) << 63);
+			const SimdWords rW = (rC << 1) | (loadWords(row + wordX - 1) >> 63);
+			const SimdWords rE = (rC >> 1) | (loadWords(row + wordX + 1) << 63);
+			const SimdWords bW = (bC << 1) | (loadWords(below + wordX - 1) >> 63);
+			const SimdWords bE = (bC >> 1) | (loadWords(below + wordX + 1) << 63);
+
+			storeWords(out + wordX, golPackedRule<SimdWords>(aW, aC, aE, rW, rC, rE, bW, bC, bE));
+		}
+
+		for (; wordX < wordsPerRow; wordX++)
+		{
+			out[wordX] = golPackedScalar(above, row, below, wordX, wordsPerRow);
+		}
+
+		// pēdējā vārda neizmantotajiem bitiem jāpaliek nullēm, citādi tie ietekmētu kaimiņus nākamajā solī
+		out[wordsPerRow - 1] &= tailMask;
+	}
+}
+
+static inline unsigned char golRule(unsigned char cell, int neighbors)
+{
+	return (neighbors == 3 || (cell == 1 && neighbors == 2)) ? 1 : 0;
+}
+
+void golByteRows(const unsigned char *input, unsigned char *output, size_t width, size_t height, size_t rowBegin,
+				 size_t rowEnd)
+{
+	const std::vector<unsigned char> zeroRow(width, 0);
+
+	for (size_t y = rowBegin; y < rowEnd; y++)
+	{
+		const unsigned char *row = input + y * width;
+		const unsigned char *above = y > 0 ? row - width : zeroRow.data();
+		const unsigned char *below = y < height - 1 ? row + width : zeroRow.data();
+		unsigned char *out = output + y * width;
+
+		if (width == 1)
+		{
+			out[0] = golRule(row[0], above[0] + below[0]);
+			continue;
+		}
+
+		out[0] = golRule(row[0], above[0] + above[1] + row[1] + below[0] + below[1]);
+
+		// iekšējās šūnas bez zarošanās, lai kompilators šo ciklu varētu vektorizēt
+		for (size_t x = 1; x < width - 1; x++)
+		{
+			const int neighbors = above[x - 1] + above[x] + above[x + 1] + row[x - 1] + row[x + 1] + below[x - 1] +
+								  below[x] + below[x + 1];
+			out[x] = golRule(row[x], neighbors);
+		}
+
+		const size_t last = width - 1;
+		out[last] = golRule(row[last], above[last - 1] + above[last] + row[last - 1] + below[last - 1] + below[last]);
+	}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// viena Game of Life soļa aprēķins rindām [rowBegin, rowEnd), katrs pavediens saņem savu rindu intervālu
+// ārpus režģa esošās šūnas uzskatām par mirušām, tāpat kā GPU kodolos
+
+// viena šūna vienā baitā
+void golByteRows(const unsigned char *input, unsigned char *output, size_t width, size_t height, size_t rowBegin,
+				 size_t rowEnd);
+
+// bitu pakots režģis, 64 šūnas vienā vārdā, apstrāde ar SIMD vektoriem pa vairākiem vārdiem reizē
+void golPackedRows(const uint64_t *input, uint64_t *output, size_t width, size_t height, size_t rowBegin,
+				   size_t rowEnd);
+
+// instrukciju kopa, ar kuru nokompilēts golPackedRows (logošanai)
+const char *golSimdName();
@@ -0,0 +1,416 @@
+#include "hashLife.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+constexpr size_t MIN_TABLE_SIZE = size_t(1) << 16;
+
+// 8x8 šūnu laukums vienā 64 bitu vārdā, šūna (x, y) atrodas bitā x + 8 * y
+constexpr uint64_t COLUMN_0 = 0x0101010101010101ull;
+constexpr uint64_t COLUMN_7 = 0x8080808080808080ull;
+
+uint64_t hashNode(unsigned level, uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se)
+{
+	uint64_t h = level;
+	h = h * 0x9E3779B97F4A7C15ull + nw;
+	h = h * 0x9E3779B97F4A7C15ull + ne;
+	h = h * 0x9E3779B97F4A7C15ull + sw;
+	h = h * 0x9E3779B97F4A7C15ull + se;
+
+	// splitmix64 nobeigums, lai arī zemākie biti būtu labi sajaukti
+	h ^= h >> 30;
+	h *= 0xBF58476D1CE4E5B9ull;
+	h ^= h >> 27;
+	h *= 0x94D049BB133111EBull;
+	return h ^ (h >> 31);
+}
+
+// viens solis 8x8 laukumā, malējās šūnas kļūst nepareizas, tāpēc pēc s soļiem derīgs ir tikai centrs bez s šūnu malas
+uint64_t lifeStep8x8(uint64_t alive, uint64_t inside)
+{
+	const uint64_t west = (alive << 1) & ~COLUMN_0; // šūnā (x, y) nonāk (x - 1, y)
+	const uint64_t east = (alive >> 1) & ~COLUMN_7; // šūnā (x, y) nonāk (x + 1, y)
+
+	const uint64_t neighbours[8] = {alive << 8, alive >> 8, west, east, west << 8, west >> 8, east << 8, east >> 8};
+
+	// kaimiņu skaits bitu slāņos pēc moduļa 8, 8 kaimiņi kļūst par 0, kas tāpat nav ne 2, ne 3
+	uint64_t s0 = 0, s1 = 0, s2 = 0;
+	for (uint64_t n : neighbours)
+	{
+		const uint64_t c0 = s0 & n;
+		s0 ^= n;
+		const uint64_t c1 = s1 & c0;
+		s1 ^= c0;
+		s2 ^= c1;
+	}
+
+	return inside & s1 & ~s2 & (s0 | alive);
+}
+
+// ievieto 4x4 lapas bitus 8x8 laukuma kvadrantā
+uint64_t placeLeaf(uint32_t leafBits, unsigned quadrant)
+{
+	const unsigned offset = (quadrant & 1) * 4 + (quadrant >> 1) * 32;
+
+	uint64_t board = 0;
+	for (unsigned row = 0; row < 4; row++)
+	{
+		board |= uint64_t((leafBits >> (row * 4)) & 0xF) << (offset + row * 8);
+	}
+	return board;
+}
+
+// 8x8 laukuma centrālais 4x4 kvadrāts lapas formātā
+uint16_t centerOf8x8(uint64_t board)
+{
+	uint16_t leafBits = 0;
+	for (unsigned row = 0; row < 4; row++)
+	{
+		leafBits |= uint16_t(((board >> ((row + 2) * 8 + 2)) & 0xF) << (row * 4));
+	}
+	return leafBits;
+}
+
+} // namespace
+
+HashLife::HashLife() : table(MIN_TABLE_SIZE, NO_NODE)
+{
+}
+
+void HashLife::growTable()
+{
+	table.assign(std::max(MIN_TABLE_SIZE, table.size() * 2), NO_NODE);
+
+	const size_t mask = table.size() - 1;
+	for (uint32_t idx = 0; idx < nodes.size(); idx++)
+	{
+		const Node &n = nodes[idx];
+
+		size_t slot = hashNode(n.level, n.children[0], n.children[1], n.children[2], n.children[3]) & mask;
+		while (table[slot] != NO_NODE)
+		{
+			slot = (slot + 1) & mask;
+		}
+		table[slot] = idx;
+	}
+}
+
+uint32_t HashLife::makeNode(unsigned level, uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se)
+{
+	// tabula tiek turēta ne vairāk kā pusē pilna
+	if ((nodes.size() + 1) * 2 > table.size())
+	{
+		growTable();
+	}
+
+	const size_t mask = table.size() - 1;
+	size_t slot = hashNode(level, nw, ne, sw, se) & mask;
+
+	while (table[slot] != NO_NODE)
+	{
+		const Node &node = nodes[table[slot]];
+		if (node.level == level && node.children[0] == nw && node.children[1] == ne && node.children[2] == sw &&
+			node.children[3] == se)
+		{
+			return table[slot];
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	if (nodes.size() >= NO_NODE)
+	{
+		throw std::runtime_error("HashLife node pool is full");
+	}
+
+	const uint32_t idx = static_cast<uint32_t>(nodes.size());
+	nodes.push_back(Node{{nw, ne, sw, se}, NO_NODE, static_cast<uint8_t>(level), 0});
+	table[slot] = idx;
+	return idx;
+}
+
+uint32_t HashLife::outsideNode(unsigned level)
+{
+	if (outsideNodes.size() <= level)
+	{
+		outsideNodes.resize(level + 1, NO_NODE);
+	}
+
+	if (outsideNodes[level] == NO_NODE)
+	{
+		if (level == LEAF_LEVEL)
+		{
+			outsideNodes[level] = makeLeaf(0, 0);
+		}
+		else
+		{
+			const uint32_t child = outsideNode(level - 1);
+			outsideNodes[level] = makeNode(level, child, child, child, child);
+		}
+	}
+
+	return outsideNodes[level];
+}
+
+uint32_t HashLife::centerNode(uint32_t node)
+{
+	// kopija, jo makeNode var pārvietot 'nodes' masīvu
+	const Node n = nodes[node];
+
+	if (n.level == LEAF_LEVEL + 1)
+	{
+		uint64_t alive = 0, inside = 0;
+		for (unsigned q = 0; q < 4; q++)
+		{
+			alive |= placeLeaf(nodes[n.children[q]].children[0], q);
+			inside |= placeLeaf(nodes[n.children[q]].children[1], q);
+		}
+		return makeLeaf(centerOf8x8(alive), centerOf8x8(inside));
+	}
+
+	return makeNode(n.level - 1, nodes[n.children[0]].children[3], nodes[n.children[1]].children[2],
+					nodes[n.children[2]].children[1], nodes[n.children[3]].children[0]);
+}
+
+uint32_t HashLife::padNode(uint32_t node)
+{
+	const Node n = nodes[node];
+	const unsigned level = n.level;
+	const uint32_t o = outsideNode(level - 1);
+
+	// virsotne nonāk par līmeni lielākas virsotnes centrā, apkārt ir tikai šūnas ārpus režģa
+	const uint32_t nw = makeNode(level, o, o, o, n.children[0]);
+	const uint32_t ne = makeNode(level, o, o, n.children[1], o);
+	const uint32_t sw = makeNode(level, o, n.children[2], o, o);
+	const uint32_t se = makeNode(level, n.children[3], o, o, o);
+	return makeNode(level + 1, nw, ne, sw, se);
+}
+
+uint32_t HashLife::leafSuccessor(const Node &node, unsigned stepLog2)
+{
+	uint64_t alive = 0, inside = 0;
+	for (unsigned q = 0; q < 4; q++)
+	{
+		alive |= placeLeaf(nodes[node.children[q]].children[0], q);
+		inside |= placeLeaf(nodes[node.children[q]].children[1], q);
+	}
+
+	// 3. līmenī stepLog2 ir 0 vai 1, tātad 1 vai 2 soļi, pēc kuriem centrs vēl ir derīgs
+	for (unsigned step = 0; step < (1u << stepLog2); step++)
+	{
+		alive = lifeStep8x8(alive, inside);
+	}
+
+	return makeLeaf(centerOf8x8(alive), centerOf8x8(inside));
+}
+
+// 'node' (līmenis k) centrālais 2^(k-1) kvadrāts pēc 2^stepLog2 paaudzēm, stepLog2 <= k - 2
+uint32_t HashLife::successor(uint32_t node, unsigned stepLog2)
+{
+	if (nodes[node].result != NO_NODE && nodes[node].resultLog2 == stepLog2)
+	{
+		hits++;
+		return nodes[node].result;
+	}
+
+	misses++;
+
+	const Node n = nodes[node];
+	uint32_t result;
+
+	if (n.level == LEAF_LEVEL + 1)
+	{
+		result = leafSuccessor(n, stepLog2);
+	}
+	else
+	{
+		const Node nw = nodes[n.children[0]];
+		const Node ne = nodes[n.children[1]];
+		const Node sw = nodes[n.children[2]];
+		const Node se = nodes[n.children[3]];
+
+		const unsigned level = n.level - 1;
+
+		// pilna soļa gadījumā abas fāzes katra pavirza laiku par pusi, citādi pirmā fāze tikai izgriež centru
+		const bool fullStep = stepLog2 + 2 == n.level;
+		const unsigned phaseLog2 = fullStep ? stepLog2 - 1 : stepLog2;
+
+		auto advance = [&](uint32_t sub) { return fullStep ? successor(sub, phaseLog2) : centerNode(sub); };
+
+		// 9 pārklājošās apakšvirsotnes 3x3 režģī
+		const uint32_t r00 = advance(n.children[0]);
+		const uint32_t r01 = advance(makeNode(level, nw.children[1], ne.children[0], nw.children[3], ne.children[2]));
+		const uint32_t r02 = advance(n.children[1]);
+		const uint32_t r10 = advance(makeNode(level, nw.children[2], nw.children[3], sw.children[0], sw.children[1]));
+		const uint32_t r11 = advance(makeNode(level, nw.children[3], ne.children[2], sw.children[1], se.children[0]));
+		const uint32_t r12 = advance(makeNode(level, ne.children[2], ne.children[3], se.children[0], se.children[1]));
+		const uint32_t r20 = advance(n.children[2]);
+		const uint32_t r21 = advance(makeNode(level, sw.children[1], se.children[0], sw.children[3], se.children[2]));
+		const uint32_t r22 = advance(n.children[3]);
+
+		const uint32_t rnw = successor(makeNode(level, r00, r01, r10, r11), phaseLog2);
+		const uint32_t rne = successor(makeNode(level, r01, r02, r11, r12), phaseLog2);
+		const uint32_t rsw = successor(makeNode(level, r10, r11, r20, r21), phaseLog2);
+		const uint32_t rse = successor(makeNode(level, r11, r12, r21, r22), phaseLog2);
+
+		result = makeNode(level, rnw, rne, rsw, rse);
+	}
+
+	nodes[node].result = result;
+	nodes[node].resultLog2 = static_cast<uint8_t>(stepLog2);
+	return result;
+}
+
+uint32_t HashLife::build(const std::vector<unsigned char> &grid, unsigned level, size_t x0, size_t y0)
+{
+	if (x0 >= gridWidth || y0 >= gridHeight)
+	{
+		return outsideNode(level);
+	}
+
+	if (level == LEAF_LEVEL)
+	{
+		uint16_t alive = 0, inside = 0;
+		for (size_t y = y0; y < std::min(y0 + 4, gridHeight); y++)
+		{
+			for (size_t x = x0; x < std::min(x0 + 4, gridWidth); x++)
+			{
+				const unsigned bit = static_cast<unsigned>((x - x0) + 4 * (y - y0));
+				inside |= uint16_t(1u << bit);
+				alive |= uint16_t((grid[y * gridWidth + x] ? 1u : 0u) << bit);
+			}
+		}
+		return makeLeaf(alive, inside);
+	}
+
+	const size_t half = size_t(1) << (level - 1);
+	const uint32_t nw = build(grid, level - 1, x0, y0);
+	const uint32_t ne = build(grid, level - 1, x0 + half, y0);
+	const uint32_t sw = build(grid, level - 1, x0, y0 + half);
+	const uint32_t se = build(grid, level - 1, x0 + half, y0 + half);
+	return makeNode(level, nw, ne, sw, se);
+}
+
+void HashLife::setGrid(const std::vector<unsigned char> &grid, size_t width, size_t height)
+{
+	nodes.clear();
+	table.assign(MIN_TABLE_SIZE, NO_NODE);
+	outsideNodes.clear();
+	hits = 0;
+	misses = 0;
+
+	gridWidth = width;
+	gridHeight = height;
+
+	// saknei jābūt vismaz 3. līmenī, lai to varētu sadalīt bērnos
+	rootLevel = LEAF_LEVEL + 1;
+	while ((size_t(1) << rootLevel) < std::max(width, height))
+	{
+		rootLevel++;
+	}
+
+	root = build(grid, rootLevel, 0, 0);
+}
+
+void HashLife::emit(uint32_t node, std::vector<unsigned char> &grid, size_t x0, size_t y0) const
+{
+	const Node &n = nodes[node];
+
+	if (x0 >= gridWidth || y0 >= gridHeight || (n.level < outsideNodes.size() && outsideNodes[n.level] == node))
+	{
+		return;
+	}
+
+	if (n.level == LEAF_LEVEL)
+	{
+		for (size_t y = y0; y < std::min(y0 + 4, gridHeight); y++)
+		{
+			for (size_t x = x0; x < std::min(x0 + 4, gridWidth); x++)
+			{
+				grid[y * gridWidth + x] = (n.children[0] >> ((x - x0) + 4 * (y - y0))) & 1;
+			}
+		}
+		return;
+	}
+
+	const size_t half = size_t(1) << (n.level - 1);
+	emit(n.children[0], grid, x0, y0);
+	emit(n.children[1], grid, x0 + half, y0);
+	emit(n.children[2], grid, x0, y0 + half);
+	emit(n.children[3], grid, x0 + half, y0 + half);
+}
+
+void HashLife::getGrid(std::vector<unsigned char> &grid) const
+{
+	grid.assign(gridWidth * gridHeight, 0);
+	emit(root, grid, 0, 0);
+}
+
+void HashLife::jump(unsigned stepLog2)
+{
+	// rezultāts ir saknes centrs, tāpēc režģi ieliek pietiekami lielā virsotnē ar ārējo šūnu apmali
+	uint32_t node = root;
+	unsigned level = rootLevel;
+
+	while (level < std::max(rootLevel + 1, stepLog2 + 2))
+	{
+		node = padNode(node);
+		level++;
+	}
+
+	node = successor(node, stepLog2);
+	level--;
+
+	// pēc katras padNode režģis atrodas tieši centrā, tāpēc to atgūst ar centerNode
+	while (level > rootLevel)
+	{
+		node = centerNode(node);
+		level--;
+	}
+
+	root = node;
+}
+
+uint32_t HashLife::copyReachable(uint32_t node, const std::vector<Node> &oldNodes, std::vector<uint32_t> &remap)
+{
+	if (remap[node] != NO_NODE)
+	{
+		return remap[node];
+	}
+
+	const Node &n = oldNodes[node];
+
+	if (n.level == LEAF_LEVEL)
+	{
+		remap[node] = makeNode(LEAF_LEVEL, n.children[0], n.children[1], 0, 0);
+	}
+	else
+	{
+		const uint32_t nw = copyReachable(n.children[0], oldNodes, remap);
+		const uint32_t ne = copyReachable(n.children[1], oldNodes, remap);
+		const uint32_t sw = copyReachable(n.children[2], oldNodes, remap);
+		const uint32_t se = copyReachable(n.children[3], oldNodes, remap);
+		remap[node] = makeNode(n.level, nw, ne, sw, se);
+	}
+
+	return remap[node];
+}
+
+void HashLife::collectGarbage()
+{
+	std::vector<Node> oldNodes;
+	oldNodes.swap(nodes);
+	std::vector<uint32_t> remap(oldNodes.size(), NO_NODE);
+
+	std::vector<uint32_t>(MIN_TABLE_SIZE, NO_NODE).swap(table);
+	outsideNodes.clear();
+
+	root = copyReachable(root, oldNodes, remap);
+}
+
+size_t HashLife::memoryBytes() const
+{
+	return nodes.capacity() * sizeof(Node) + table.capacity() * sizeof(uint32_t) +
+		   outsideNodes.capacity() * sizeof(uint32_t);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// HashLife dzinējs: režģis glabājas kā kvadrātkoks ar kopīgām (hešotām) virsotnēm, katras virsotnes
+// rezultāts pēc 2^k paaudzēm tiek kešots, tāpēc retiem vai periodiskiem rakstiem var pārlēkt milzīgu soļu skaitu
+//
+// lai rezultāts sakristu ar pārējām implementācijām, katrai šūnai papildus stāvoklim glabājas bits "šūna ir režģī",
+// šūnas ārpus režģa vienmēr paliek mirušas, tāpēc robežas uzvedība ir tāda pati kā GPU un CPU kodolos
+class HashLife
+{
+  public:
+	// mazākais koka līmenis ir 4x4 šūnu lapa
+	static constexpr unsigned LEAF_LEVEL = 2;
+	static constexpr uint32_t NO_NODE = UINT32_MAX;
+
+	HashLife();
+
+	void setGrid(const std::vector<unsigned char> &grid, size_t width, size_t height);
+	void getGrid(std::vector<unsigned char> &grid) const;
+
+	// pārlec 2^stepLog2 paaudzes uz priekšu
+	void jump(unsigned stepLog2);
+
+	// atstāj tikai virsotnes, kas pieder pašreizējam režģim, un izmet visus kešotos rezultātus
+	void collectGarbage();
+
+	size_t memoryBytes() const;
+	size_t nodeCount() const { return nodes.size(); }
+	uint64_t cacheHits() const { return hits; }
+	uint64_t cacheMisses() const { return misses; }
+
+  private:
+	struct Node
+	{
+		// nw, ne, sw, se bērni; lapām [0] ir dzīvās šūnas un [1] režģī esošās šūnas (bits x + 4 * y)
+		uint32_t children[4];
+		uint32_t result; // centrālais kvadrāts pēc 2^resultLog2 paaudzēm vai NO_NODE
+		uint8_t level;
+		uint8_t resultLog2;
+	};
+
+	uint32_t makeNode(unsigned level, uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se);
+	uint32_t makeLeaf(uint16_t alive, uint16_t inside) { return makeNode(LEAF_LEVEL, alive, inside, 0, 0); }
+	uint32_t outsideNode(unsigned level);
+	uint32_t centerNode(uint32_t node);
+	uint32_t padNode(uint32_t node);
+	uint32_t successor(uint32_t node, unsigned stepLog2);
+	uint32_t leafSuccessor(const Node &node, unsigned stepLog2);
+	uint32_t build(const std::vector<unsigned char> &grid, unsigned level, size_t x0, size_t y0);
+	void emit(uint32_t node, std::vector<unsigned char> &grid, size_t x0, size_t y0) const;
+	uint32_t copyReachable(uint32_t node, const std::vector<Node> &oldNodes, std::vector<uint32_t> &remap);
+	void growTable();
+
+	std::vector<Node> nodes;
+	std::vector<uint32_t> table; // atvērtās adresācijas heš tabula ar virsotņu indeksiem
+	std::vector<uint32_t> outsideNodes; // pilnībā ārpus režģa esošā virsotne katram līmenim
+
+	uint32_t root = NO_NODE;
+	unsigned rootLevel = 0;
+	size_t gridWidth = 0;
+	size_t gridHeight = 0;
+
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+};
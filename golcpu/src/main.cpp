@@ -0,0 +1,262 @@
+// Game Of Life implementācija uz CPU ar vairākiem pavedieniem un SIMD
+
+#include "benchmarkLogger.h"
+#include "cpuKernels.h"
+#include "golBackend.h"
+#include "golOptions.h"
+#include "gridIO.h"
+#include "hashLife.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// 'Cell' ir unsigned char (viena šūna baitā) vai uint64_t (bitu pakots režģis, 64 šūnas vārdā)
+// soļus izpilda makeCpuGolBackend (cpuBackend.cpp), tas pats režģis, ko izmanto salīdzināšanas programma golcompare
+template <typename Cell>
+void GameOfLifeStep(const MappedGridFile &gridFile, std::vector<Cell> &outputGrid, size_t steps,
+					const GolOptions &options, BenchmarkLogger &logger)
+{
+	constexpr bool packed = std::is_same<Cell, uint64_t>::value;
+
+	const size_t width = gridFile.width();
+	const size_t height = gridFile.height();
+
+	std::unique_ptr<GolBackend> grid = makeCpuGolBackend(logger);
+	grid->allocate(width, height, options);
+
+	// šūnas tiek atkodētas no atmiņā attēlotā faila izvades režģī un no tā nokopētas režģa ievades buferī
+	auto start = std::chrono::steady_clock::now();
+
+	outputGrid.resize((packed ? packedWordsPerRow(width) : width) * height);
+
+	if constexpr (packed)
+	{
+		gridFile.decodePackedInto(outputGrid.data());
+	}
+	else
+	{
+		gridFile.decodeInto(outputGrid.data());
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	logger.chronoLog("grid decode time", start, end);
+
+	grid->upload(outputGrid.data());
+	grid->step(steps);
+
+	logger.log("total kernel exec time", grid->timing().kernelMs);
+
+	grid->download(outputGrid.data());
+}
+
+// ielādē režģi, izpilda spēli un ieraksta rezultātu failā, 'Cell' nosaka režģa glabāšanas veidu
+template <typename Cell>
+void runGameOfLife(const std::string &inputFileName, const std::string &outputFileName, size_t gameSteps,
+				   const GolOptions &options, unsigned threadCount, BenchmarkLogger &logger)
+{
+	constexpr bool packed = std::is_same<Cell, uint64_t>::value;
+
+	auto start = std::chrono::steady_clock::now();
+
+	// fails tiek tikai attēlots atmiņā un sadalīts rindās, šūnas atkodē GameOfLifeStep
+	MappedGridFile gridFile(inputFileName);
+
+	const size_t width = gridFile.width();
+	const size_t height = gridFile.height();
+
+	auto end = std::chrono::steady_clock::now();
+
+	logger.chronoLog("grid load time", start, end);
+
+	std::vector<Cell> outputGrid;
+
+	std::cout << "Processing a " << width << "x" << height << " grid with " << gameSteps << " steps on "
+			  << threadCount << " threads (" << (packed ? golSimdName() : "bytes") << ")\n";
+
+	auto GoLStart = std::chrono::steady_clock::now();
+
+	GameOfLifeStep<Cell>(gridFile, outputGrid, gameSteps, options, logger);
+
+	auto GoLEnd = std::chrono::steady_clock::now();
+
+	logger.chronoLog("total game of life time", GoLStart, GoLEnd);
+
+	auto writeGridToFileStart = std::chrono::steady_clock::now();
+
+	if constexpr (packed)
+	{
+		writePackedGridToFile(outputGrid, width, height, outputFileName);
+	}
+	else
+	{
+		writeGridToFile(outputGrid, width, height, outputFileName);
+	}
+
+	auto writeGridToFileEnd = std::chrono::steady_clock::now();
+
+	logger.chronoLog("write output grid to file time", writeGridToFileStart, writeGridToFileEnd);
+}
+
+// HashLife dzinējs: soļu skaits tiek sadalīts lēcienos pa 2^k paaudzēm, k nepārsniedz options.hashLifeMaxJumpLog2
+void runHashLife(const std::string &inputFileName, const std::string &outputFileName, size_t gameSteps,
+				 const GolOptions &options, BenchmarkLogger &logger)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	size_t width = 0, height = 0;
+	std::vector<unsigned char> grid = loadGridFromFile(inputFileName, width, height);
+
+	auto end = std::chrono::steady_clock::now();
+
+	logger.chronoLog("grid load time", start, end);
+
+	std::cout << "Processing a " << width << "x" << height << " grid with " << gameSteps << " steps (HashLife)\n";
+
+	auto GoLStart = std::chrono::steady_clock::now();
+
+	HashLife hashLife;
+
+	start = std::chrono::steady_clock::now();
+	hashLife.setGrid(grid, width, height);
+	end = std::chrono::steady_clock::now();
+
+	logger.chronoLog("quadtree build time", start, end);
+
+	const size_t budgetBytes = options.hashLifeMiB << 20;
+	size_t peakMemory = hashLife.memoryBytes();
+	double totalTime = 0;
+
+	for (size_t remainingSteps = gameSteps; remainingSteps > 0;)
+	{
+		// kešu nevar tīrīt lēciena vidū, tāpēc budžetu pārbauda pirms katra lēciena
+		if (hashLife.memoryBytes() > budgetBytes)
+		{
+			start = std::chrono::steady_clock::now();
+			hashLife.collectGarbage();
+			end = std::chrono::steady_clock::now();
+
+			logger.chronoLog("hashlife garbage collection time", start, end);
+		}
+
+		const unsigned stepLog2 =
+			std::min(options.hashLifeMaxJumpLog2, static_cast<unsigned>(std::bit_width(remainingSteps)) - 1);
+
+		start = std::chrono::steady_clock::now();
+		hashLife.jump(stepLog2);
+		end = std::chrono::steady_clock::now();
+
+		std::chrono::duration<double, std::milli> jumpTime = end - start;
+		logger.log("kernel exec time", jumpTime.count());
+		totalTime += jumpTime.count();
+
+		peakMemory = std::max(peakMemory, hashLife.memoryBytes());
+		remainingSteps -= size_t(1) << stepLog2;
+	}
+
+	logger.log("total kernel exec time", totalTime);
+
+	const uint64_t lookups = hashLife.cacheHits() + hashLife.cacheMisses();
+	logger.log("hashlife cache hit rate %", lookups ? 100.0 * hashLife.cacheHits() / lookups : 0.0);
+	logger.log("hashlife peak node memory MiB", peakMemory / (1024.0 * 1024.0));
+
+	std::cout << "HashLife finished with " << hashLife.nodeCount() << " nodes\n";
+
+	hashLife.getGrid(grid);
+
+	auto GoLEnd = std::chrono::steady_clock::now();
+
+	logger.chronoLog("total game of life time", GoLStart, GoLEnd);
+
+	auto writeGridToFileStart = std::chrono::steady_clock::now();
+
+	writeGridToFile(grid, width, height, outputFileName);
+
+	auto writeGridToFileEnd = std::chrono::steady_clock::now();
+
+	logger.chronoLog("write output grid to file time", writeGridToFileStart, writeGridToFileEnd);
+}
+
+// CPU versija izpilda tikai Conway B3/S23 ar mirušām šūnām aiz režģa malas un bez GPU versiju režīmiem
+bool validateCpuOptions(const GolOptions &options)
+{
+	if (options.blockSteps > 1 || options.async || options.streamMiB > 0 || options.activeTiles ||
+		options.cyclePeriod > 0 || options.snapshotEvery > 0 || options.devices != 1 || options.autotune ||
+		options.vectorized || options.ensemble)
+	{
+		std::cerr << "--block-steps, --async, --stream, --active-tiles, --detect-cycles, --snapshot, --devices, "
+					 "--autotune, --vectorized and --ensemble are only implemented by the GPU versions\n";
+		return false;
+	}
+
+	if (options.birthMask != CONWAY_BIRTH_MASK || options.survivalMask != CONWAY_SURVIVAL_MASK || options.wrap)
+	{
+		std::cerr << "--rule and --wrap are only implemented by the GPU versions\n";
+		return false;
+	}
+
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc >= 5)
+	{
+		const std::string inputFileName = argv[1];
+		const std::string outputFileName = argv[2];
+		const size_t gameSteps = std::stoll(argv[3]);
+		const std::string logFileName = argv[4];
+
+		GolOptions options;
+
+		try
+		{
+			options = parseGolOptions(argc, argv, 5);
+		}
+		catch (const std::exception &e)
+		{
+			std::cerr << e.what() << '\n';
+			printGolUsage(argv[0]);
+			return -1;
+		}
+
+		if (!validateCpuOptions(options))
+		{
+			return -1;
+		}
+
+		unsigned threadCount = options.threads;
+		if (threadCount == 0)
+		{
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		BenchmarkLogger logger(logFileName, "CPU");
+
+		if (options.hashLife)
+		{
+			runHashLife(inputFileName, outputFileName, gameSteps, options, logger);
+		}
+		else if (options.packed)
+		{
+			runGameOfLife<uint64_t>(inputFileName, outputFileName, gameSteps, options, threadCount, logger);
+		}
+		else
+		{
+			runGameOfLife<unsigned char>(inputFileName, outputFileName, gameSteps, options, threadCount, logger);
+		}
+	}
+	else
+	{
+		printGolUsage(argv[0]);
+	}
+	return 0;
+}
@@ -1,6 +1,14 @@
 // Game Of Life implementācija CUDA vidē
 
 #include "benchmarkLogger.h"
+#include "cycleDetector.h"
+#include "golBackend.h"
+#include "golHost.h"
+#include "golOptions.h"
+#include "gridIO.h"
+#include "launchTuning.h"
+#include "snapshotWriter.h"
+#include <algorithm>
 #include <assert.h>
 #include <cassert>
 #include <chrono>
@@ -10,10 +18,13 @@
 #include <device_launch_parameters.h>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <memory>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -34,200 +45,1856 @@ inline void gpuAssert(cudaError_t code, const char *file, int line, bool abort =
 	}
 }
 
-// izveido flat grid masīvu, automātiski nosakot width, height
-// met ārā kļūdas ja nav atbilstošu simbolu (1, 0) vai ja kāda rindiņa nesatur tādu pašu simbolu skaitu kā pirmā
-std::vector<unsigned char> loadGridFromFile(const std::string &fileName, size_t &width, size_t &height)
+__constant__ size_t d_width;
+__constant__ size_t d_height;
+__constant__ size_t d_wordsPerRow; // tikai bitu pakotajam režģim
+
+inline __device__ int neighborCount(int x, int y, const unsigned char *grid)
+{
+	int neighbors = 0;
+
+	if (y > 0)
+	{
+		if (x > 0)
+			neighbors += grid[(y - 1) * d_width + (x - 1)];
+
+		neighbors += grid[(y - 1) * d_width + x];
+
+		if (x < d_width - 1)
+			neighbors += grid[(y - 1) * d_width + (x + 1)];
+	}
+
+	if (x > 0)
+		neighbors += grid[y * d_width + (x - 1)];
+
+	if (x < d_width - 1)
+		neighbors += grid[y * d_width + (x + 1)];
+
+	if (y < d_height - 1)
+	{
+		if (x > 0)
+			neighbors += grid[(y + 1) * d_width + (x - 1)];
+
+		neighbors += grid[(y + 1) * d_width + x];
+
+		if (x < d_width - 1)
+			neighbors += grid[(y + 1) * d_width + (x + 1)];
+	}
+
+	return neighbors;
+}
+
+// toroidālā režģī pretējās malas ir kaimiņi, tāpēc kaimiņu koordinātes tiek ņemtas pēc moduļa
+inline __device__ int wrappedNeighborCount(int x, int y, const unsigned char *grid)
+{
+	const size_t left = x > 0 ? x - 1 : d_width - 1;
+	const size_t right = x + 1 < d_width ? x + 1 : 0;
+	const size_t above = (y > 0 ? y - 1 : d_height - 1) * d_width;
+	const size_t row = static_cast<size_t>(y) * d_width;
+	const size_t below = (y + 1 < d_height ? y + 1 : 0) * d_width;
+
+	return grid[above + left] + grid[above + x] + grid[above + right] + grid[row + left] + grid[row + right] +
+		   grid[below + left] + grid[below + x] + grid[below + right];
+}
+
+inline __device__ long long wrapCoordinate(long long v, size_t size)
+{
+	const long long n = static_cast<long long>(size);
+	return ((v % n) + n) % n;
+}
+
+// Life tipa likums, kas zināms kompilēšanas laikā, tāpēc katram likumam un robežas veidam ir savs kodols
+// 'Birth' un 'Survival' ir kaimiņu skaitu bitu maskas, 'Wrap' - režģa pretējās malas ir kaimiņi (tors)
+// Conway likumam tiek lietots tieši tas pats izteiksmes veids, kas pirms likumu ieviešanas, tāpēc tas neko nemaksā
+template <unsigned Birth, unsigned Survival, bool Wrap>
+struct LifeRule
+{
+	static constexpr unsigned birth = Birth;
+	static constexpr unsigned survival = Survival;
+	static constexpr bool wrap = Wrap;
+	static constexpr bool conway = Birth == CONWAY_BIRTH_MASK && Survival == CONWAY_SURVIVAL_MASK;
+
+	static __device__ unsigned char next(unsigned char cell, int neighbors)
+	{
+		if constexpr (conway)
+		{
+			return neighbors == 3 || (cell == 1 && neighbors == 2);
+		}
+		else
+		{
+			return ((cell ? Survival : Birth) >> neighbors) & 1u;
+		}
+	}
+
+	static __device__ int neighbors(int x, int y, const unsigned char *grid)
+	{
+		if constexpr (Wrap)
+		{
+			return wrappedNeighborCount(x, y, grid);
+		}
+		else
+		{
+			return neighborCount(x, y, grid);
+		}
+	}
+};
+
+template <typename Rule>
+__global__ void golMultiStepKernel(const unsigned char *input, unsigned char *output)
+{
+	const int x = blockIdx.x * blockDim.x + threadIdx.x;
+	const int y = blockIdx.y * blockDim.y + threadIdx.y;
+
+	if (x >= d_width || y >= d_height)
+		return;
+
+	const size_t flatIdx = y * d_width + x;
+
+	int neighbors = Rule::neighbors(x, y, input);
+
+	output[flatIdx] = Rule::next(input[flatIdx], neighbors);
+}
+
+// ansambļa režģa novietojums kopīgajā ierīces buferī: pirmās šūnas nobīde un izmēri
+struct EnsembleExtent
+{
+	size_t offset;
+	int width;
+	int height;
+};
+
+// lielākais bloku skaits z dimensijā, vairāk režģu tiek sadalīti vairākos izsaukumos
+constexpr size_t ENSEMBLE_MAX_GRID_Z = 65535;
+
+// ansambļa režīms: bloku slānis z ir viens režģis, x un y nosedz lielāko no režģiem, tāpēc viens izsaukums izrēķina
+// paaudzi visiem režģiem; pavedieni ārpus sava režģa neko nedara, kaimiņi ārpus režģa ir miruši vai, ja
+// Rule::wrap, ņemti no pretējās malas
+template <typename Rule>
+__global__ void golEnsembleKernel(const unsigned char *input, unsigned char *output, const EnsembleExtent *extents,
+								  int firstBoard)
+{
+	const EnsembleExtent extent = extents[firstBoard + blockIdx.z];
+
+	const int x = blockIdx.x * blockDim.x + threadIdx.x;
+	const int y = blockIdx.y * blockDim.y + threadIdx.y;
+
+	if (x >= extent.width || y >= extent.height)
+		return;
+
+	const unsigned char *grid = input + extent.offset;
+
+	int neighbors = 0;
+	for (int dy = -1; dy <= 1; dy++)
+	{
+		for (int dx = -1; dx <= 1; dx++)
+		{
+			int nx = x + dx;
+			int ny = y + dy;
+
+			if (dx == 0 && dy == 0)
+				continue;
+
+			if constexpr (Rule::wrap)
+			{
+				nx = (nx + extent.width) % extent.width;
+				ny = (ny + extent.height) % extent.height;
+			}
+			else if (nx < 0 || nx >= extent.width || ny < 0 || ny >= extent.height)
+			{
+				continue;
+			}
+
+			neighbors += grid[ny * extent.width + nx];
+		}
+	}
+
+	const size_t flatIdx = static_cast<size_t>(y) * extent.width + x;
+	output[extent.offset + flatIdx] = Rule::next(grid[flatIdx], neighbors);
+}
+
+// laika bloķēšanas (temporal blocking) kodola viena bloka izejas apgabala izmērs šūnās
+constexpr int TEMPORAL_TILE_W = 64;
+constexpr int TEMPORAL_TILE_H = 32;
+
+inline __device__ bool insideGrid(long long x, long long y)
+{
+	return x >= 0 && y >= 0 && static_cast<size_t>(x) < d_width && static_cast<size_t>(y) < d_height;
+}
+
+// ielādē bloka apgabalu kopā ar 'gens' šūnu platu apmali koplietojamajā atmiņā, izrēķina tur 'gens' paaudzes
+// un globālajā atmiņā ieraksta tikai apgabala iekšpusi, tādējādi globālā atmiņa tiek lietota 'gens' reizes retāk
+// ar katru paaudzi korekto šūnu apgabals sarūk par vienu šūnu no katras malas, tāpēc apmalei jābūt 'gens' platai
+// toroidālā režģī apgabals ar apmali ir režģa periodisks turpinājums, tāpēc šūnas aiz malas netiek nullētas
+template <typename Rule>
+__global__ void golTemporalKernel(const unsigned char *input, unsigned char *output, int gens)
+{
+	extern __shared__ unsigned char tiles[];
+
+	const int tileW = TEMPORAL_TILE_W + 2 * gens;
+	const int tileH = TEMPORAL_TILE_H + 2 * gens;
+
+	unsigned char *current = tiles;
+	unsigned char *next = tiles + tileW * tileH;
+
+	// apgabala (ieskaitot apmali) kreisā augšējā stūra globālās koordinātes, var būt negatīvas
+	const long long originX = static_cast<long long>(blockIdx.x) * TEMPORAL_TILE_W - gens;
+	const long long originY = static_cast<long long>(blockIdx.y) * TEMPORAL_TILE_H - gens;
+
+	for (int ty = threadIdx.y; ty < tileH; ty += blockDim.y)
+	{
+		for (int tx = threadIdx.x; tx < tileW; tx += blockDim.x)
+		{
+			const long long gx = originX + tx;
+			const long long gy = originY + ty;
+
+			if constexpr (Rule::wrap)
+			{
+				current[ty * tileW + tx] = input[wrapCoordinate(gy, d_height) * d_width + wrapCoordinate(gx, d_width)];
+			}
+			else
+			{
+				current[ty * tileW + tx] = insideGrid(gx, gy) ? input[gy * d_width + gx] : 0;
+			}
+		}
+	}
+
+	__syncthreads();
+
+	for (int gen = 1; gen <= gens; gen++)
+	{
+		for (int ty = gen + threadIdx.y; ty < tileH - gen; ty += blockDim.y)
+		{
+			for (int tx = gen + threadIdx.x; tx < tileW - gen; tx += blockDim.x)
+			{
+				const unsigned char *above = current + (ty - 1) * tileW + tx;
+				const unsigned char *row = current + ty * tileW + tx;
+				const unsigned char *below = current + (ty + 1) * tileW + tx;
+
+				const int neighbors =
+					above[-1] + above[0] + above[1] + row[-1] + row[1] + below[-1] + below[0] + below[1];
+
+				const unsigned char cell = Rule::next(row[0], neighbors);
+
+				// šūnas ārpus režģa vienmēr paliek mirušas, citādi tās ietekmētu režģa malas
+				next[ty * tileW + tx] = Rule::wrap || insideGrid(originX + tx, originY + ty) ? cell : 0;
+			}
+		}
+
+		__syncthreads();
+
+		unsigned char *tmp = current;
+		current = next;
+		next = tmp;
+	}
+
+	for (int ty = threadIdx.y; ty < TEMPORAL_TILE_H; ty += blockDim.y)
+	{
+		for (int tx = threadIdx.x; tx < TEMPORAL_TILE_W; tx += blockDim.x)
+		{
+			const long long gx = originX + gens + tx;
+			const long long gy = originY + gens + ty;
+
+			if (insideGrid(gx, gy))
+				output[gy * d_width + gx] = current[(ty + gens) * tileW + tx + gens];
+		}
+	}
+}
+
+// viena paaudze horizontālai joslai, kas satur 'rows' režģa rindas, sākot ar 'firstRow' (var būt ārpus režģa)
+// rindas ārpus režģa paliek mirušas, tāpēc josla, kas sniedzas pāri režģa malai, dod tādu pašu rezultātu kā režģis
+// joslas pirmās un pēdējās rindas kaimiņi nav zināmi, tāpēc ar katru paaudzi kļūdaina kļūst vēl viena rinda no malas
+// tiek rēķinātas tikai joslas rindas [rowBegin, rowEnd), lai malas un iekšpusi varētu palaist atsevišķi
+template <typename Rule>
+__global__ void golStripKernel(const unsigned char *input, unsigned char *output, long long firstRow, int rows,
+							   int rowBegin, int rowEnd)
+{
+	const int x = blockIdx.x * blockDim.x + threadIdx.x;
+	const int y = rowBegin + blockIdx.y * blockDim.y + threadIdx.y;
+
+	if (x >= d_width || y >= rowEnd)
+		return;
+
+	const size_t flatIdx = static_cast<size_t>(y) * d_width + x;
+
+	if (!insideGrid(x, firstRow + y))
+	{
+		output[flatIdx] = 0;
+		return;
+	}
+
+	int neighbors = 0;
+
+	for (int dy = -1; dy <= 1; dy++)
+	{
+		const int ny = y + dy;
+
+		if (ny < 0 || ny >= rows)
+			continue;
+
+		for (int dx = -1; dx <= 1; dx++)
+		{
+			const int nx = x + dx;
+
+			if ((dx == 0 && dy == 0) || nx < 0 || nx >= d_width)
+				continue;
+
+			neighbors += input[static_cast<size_t>(ny) * d_width + nx];
+		}
+	}
+
+	const unsigned char cell = Rule::next(input[flatIdx], neighbors);
+
+	output[flatIdx] = cell;
+}
+
+// aktīvo flīžu režīmā viena flīze ir viena bloka apstrādātais apgabals šūnās
+constexpr int ACTIVE_TILE_W = 32;
+constexpr int ACTIVE_TILE_H = 8;
+
+// flīze ir aktīva, ja tā pati vai kāda no 8 kaimiņu flīzēm iepriekšējā paaudzē mainījās, pārējās flīzes nemainīsies
+// aktīvās flīzes tiek saspiestas darba sarakstā, un 'nextChanged' tiek notīrīts, lai golActiveTileKernel to aizpilda
+__global__ void buildTileWorklistKernel(const unsigned char *changed, unsigned char *nextChanged,
+										unsigned int *worklist, unsigned int *workCount, int tilesX, int tilesY)
+{
+	const int tx = blockIdx.x * blockDim.x + threadIdx.x;
+	const int ty = blockIdx.y * blockDim.y + threadIdx.y;
+
+	if (tx >= tilesX || ty >= tilesY)
+		return;
+
+	bool active = false;
+
+	for (int ny = max(ty - 1, 0); ny <= min(ty + 1, tilesY - 1); ny++)
+	{
+		for (int nx = max(tx - 1, 0); nx <= min(tx + 1, tilesX - 1); nx++)
+		{
+			active |= changed[ny * tilesX + nx] != 0;
+		}
+	}
+
+	const unsigned int tileIdx = ty * tilesX + tx;
+	nextChanged[tileIdx] = 0;
+
+	if (active)
+		worklist[atomicAdd(workCount, 1u)] = tileIdx;
+}
+
+// viena paaudze vienai darba saraksta flīzei uz bloku, flīzei tiek atzīmēts, vai tajā mainījās kāda šūna
+// izlaistās flīzes izejas buferī jau ir pareizas: tur ir aizpagājušās paaudzes šūnas, kas sakrīt ar pašreizējām
+template <typename Rule>
+__global__ void golActiveTileKernel(const unsigned char *input, unsigned char *output, const unsigned int *worklist,
+									unsigned char *changed, int tilesX)
+{
+	const unsigned int tileIdx = worklist[blockIdx.x];
+
+	const int x = (tileIdx % tilesX) * ACTIVE_TILE_W + threadIdx.x;
+	const int y = (tileIdx / tilesX) * ACTIVE_TILE_H + threadIdx.y;
+
+	bool cellChanged = false;
+
+	// ārpus režģa esošie pavedieni neatgriežas, jo visiem bloka pavedieniem jāsasniedz __syncthreads_or
+	if (x < d_width && y < d_height)
+	{
+		const size_t flatIdx = y * d_width + x;
+		const int neighbors = neighborCount(x, y, input);
+		const unsigned char cell = Rule::next(input[flatIdx], neighbors);
+
+		output[flatIdx] = cell;
+		cellChanged = cell != input[flatIdx];
+	}
+
+	if (__syncthreads_or(cellChanged) && threadIdx.x == 0 && threadIdx.y == 0)
+		changed[tileIdx] = 1;
+}
+
+// bitu pakotā režģa kaimiņu skaitīšana: katrs bits vārdā ir atsevišķa šūna, tāpēc summēšana notiek
+// ar bitu operāciju summatoriem visām 64 šūnām reizē (bit-sliced saskaitīšana)
+// 'above', 'row', 'below' ir šūnas vārds un tā kaimiņu vārdi pa kreisi un pa labi no attiecīgās rindas
+template <typename Rule>
+inline __device__ cuda::std::uint64_t golPackedWord(const cuda::std::uint64_t above[3],
+													const cuda::std::uint64_t row[3],
+													const cuda::std::uint64_t below[3])
+{
+	// kaimiņš pa kreisi šūnai x ir šūna x - 1, tātad bitus bīdām uz augšu un pirmajā bitā ieliekam
+	// kreisā vārda pēdējo bitu, kaimiņam pa labi otrādi
+	const cuda::std::uint64_t aW = (above[1] << 1) | (above[0] >> 63);
+	const cuda::std::uint64_t aE = (above[1] >> 1) | (above[2] << 63);
+	const cuda::std::uint64_t rW = (row[1] << 1) | (row[0] >> 63);
+	const cuda::std::uint64_t rE = (row[1] >> 1) | (row[2] << 63);
+	const cuda::std::uint64_t bW = (below[1] << 1) | (below[0] >> 63);
+	const cuda::std::uint64_t bE = (below[1] >> 1) | (below[2] << 63);
+
+	// katras rindas kaimiņu summa divos bitos (augšējai un apakšējai rindai 0..3, vidējai 0..2)
+	const cuda::std::uint64_t a0 = aW ^ above[1] ^ aE;
+	const cuda::std::uint64_t a1 = (aW & above[1]) | (aE & (aW ^ above[1]));
+	const cuda::std::uint64_t r0 = rW ^ rE;
+	const cuda::std::uint64_t r1 = rW & rE;
+	const cuda::std::uint64_t b0 = bW ^ below[1] ^ bE;
+	const cuda::std::uint64_t b1 = (bW & below[1]) | (bE & (bW ^ below[1]));
+
+	// visu trīs rindu summa četros bitos s0..s3 (0..8)
+	const cuda::std::uint64_t s0 = a0 ^ r0 ^ b0;
+	const cuda::std::uint64_t c0 = (a0 & r0) | (b0 & (a0 ^ r0));
+	const cuda::std::uint64_t x1 = a1 ^ r1 ^ b1;
+	const cuda::std::uint64_t y1 = (a1 & r1) | (b1 & (a1 ^ r1));
+	const cuda::std::uint64_t s1 = x1 ^ c0;
+	const cuda::std::uint64_t c1 = x1 & c0;
+	const cuda::std::uint64_t s2 = y1 ^ c1;
+	const cuda::std::uint64_t s3 = y1 & c1;
+
+	if constexpr (Rule::conway)
+	{
+		// šūna ir dzīva, ja kaimiņu ir 3, vai ja kaimiņu ir 2 un šūna jau bija dzīva
+		return ~s3 & ~s2 & s1 & (s0 | row[1]);
+	}
+	else
+	{
+		// katram likumā minētajam kaimiņu skaitam n bitu maska, kurās šūnās summa s0..s3 ir tieši n
+		cuda::std::uint64_t born = 0;
+		cuda::std::uint64_t survives = 0;
+
+#pragma unroll
+		for (unsigned n = 0; n <= 8; n++)
+		{
+			if (((Rule::birth | Rule::survival) >> n & 1u) == 0)
+				continue;
+
+			const cuda::std::uint64_t count = (n & 1 ? s0 : ~s0) & (n & 2 ? s1 : ~s1) & (n & 4 ? s2 : ~s2) &
+											  (n & 8 ? s3 : ~s3);
+
+			if (Rule::birth >> n & 1u)
+				born |= count;
+			if (Rule::survival >> n & 1u)
+				survives |= count;
+		}
+
+		return (row[1] & survives) | (~row[1] & born);
+	}
+}
+
+// ielādē rindas 'rowIdx' vārdu 'wordX' ar kaimiņu vārdiem, ārpus režģa esošie vārdi ir nulles (mirušas šūnas)
+// toroidālā režģī kreisā kaimiņa 63. bits ir rindas pēdējā šūna, bet rindas pirmā šūna tiek ielikta bitā tieši aiz
+// pēdējās šūnas (vai nākamā vārda 0. bitā, ja platums dalās ar 64), kur to kā kaimiņu nolasa golPackedWord
+template <typename Rule>
+inline __device__ void loadPackedRow(const cuda::std::uint64_t *input, size_t rowIdx, size_t wordX,
+									 cuda::std::uint64_t words[3])
+{
+	const size_t rowStart = rowIdx * d_wordsPerRow;
+	const bool hasLeft = wordX > 0;
+	const bool hasRight = wordX < d_wordsPerRow - 1;
+
+	words[0] = hasLeft ? input[rowStart + wordX - 1] : 0;
+	words[1] = input[rowStart + wordX];
+	words[2] = hasRight ? input[rowStart + wordX + 1] : 0;
+
+	if constexpr (Rule::wrap)
+	{
+		if (!hasLeft)
+		{
+			const size_t lastBit = (d_width - 1) % 64;
+			words[0] = ((input[rowStart + d_wordsPerRow - 1] >> lastBit) & 1) << 63;
+		}
+
+		if (!hasRight)
+		{
+			const cuda::std::uint64_t firstCell = input[rowStart] & 1;
+			const size_t tailBits = d_width % 64;
+
+			if (tailBits != 0)
+				words[1] |= firstCell << tailBits;
+			else
+				words[2] = firstCell;
+		}
+	}
+}
+
+template <typename Rule>
+__global__ void golPackedKernel(const cuda::std::uint64_t *input, cuda::std::uint64_t *output)
+{
+	const size_t wordX = blockIdx.x * blockDim.x + threadIdx.x;
+	const size_t y = blockIdx.y * blockDim.y + threadIdx.y;
+
+	if (wordX >= d_wordsPerRow || y >= d_height)
+		return;
+
+	const size_t flatIdx = y * d_wordsPerRow + wordX;
+
+	const bool hasRight = wordX < d_wordsPerRow - 1;
+
+	// ārpus režģa esošie vārdi ir nulles, tas atbilst mirušām šūnām aiz robežas
+	cuda::std::uint64_t above[3] = {0, 0, 0};
+	cuda::std::uint64_t row[3] = {0, 0, 0};
+	cuda::std::uint64_t below[3] = {0, 0, 0};
+
+	if (y > 0)
+		loadPackedRow<Rule>(input, y - 1, wordX, above);
+	else if (Rule::wrap)
+		loadPackedRow<Rule>(input, d_height - 1, wordX, above);
+
+	loadPackedRow<Rule>(input, y, wordX, row);
+
+	if (y < d_height - 1)
+		loadPackedRow<Rule>(input, y + 1, wordX, below);
+	else if (Rule::wrap)
+		loadPackedRow<Rule>(input, 0, wordX, below);
+
+	cuda::std::uint64_t cells = golPackedWord<Rule>(above, row, below);
+
+	// pēdējā vārda neizmantotajiem bitiem jāpaliek nullēm, citādi tie ietekmētu kaimiņus nākamajā solī
+	const size_t tailBits = d_width % 64;
+	if (!hasRight && tailBits != 0)
+	{
+		cells &= (cuda::std::uint64_t(1) << tailBits) - 1;
+	}
+
+	output[flatIdx] = cells;
+}
+
+// režģa paraksta kodola bloka izmērs un lielākais bloku skaits (pārējo nosedz cikls pa visu režģi)
+constexpr int SIGNATURE_BLOCK_SIZE = 256;
+constexpr size_t SIGNATURE_MAX_BLOCKS = 1024;
+
+// splitmix64 nobeigums, lai katram režģa elementam būtu neatkarīga 64 bitu jaucējvērtība
+inline __device__ cuda::std::uint64_t mixHash(cuda::std::uint64_t h)
+{
+	h ^= h >> 30;
+	h *= 0xBF58476D1CE4E5B9ull;
+	h ^= h >> 27;
+	h *= 0x94D049BB133111EBull;
+	return h ^ (h >> 31);
+}
+
+// aprēķina režģa parakstu (GridSignature): katrs pavediens summē savus elementus, bloks tos reducē koplietojamajā
+// atmiņā un pieskaita rezultātam ar atomāru operāciju, 'signature' pirms izsaukuma jābūt nullētam
+// 'Cell' ir unsigned char vai pakots vārds, abos gadījumos mirušie elementi ir 0 un parakstu neietekmē
+template <typename Cell>
+__global__ void gridSignatureKernel(const Cell *grid, size_t count, GridSignature *signature)
+{
+	__shared__ unsigned long long hashes[SIGNATURE_BLOCK_SIZE];
+	__shared__ unsigned long long populations[SIGNATURE_BLOCK_SIZE];
+
+	unsigned long long hash = 0;
+	unsigned long long population = 0;
+
+	for (size_t i = blockIdx.x * blockDim.x + threadIdx.x; i < count; i += static_cast<size_t>(gridDim.x) * blockDim.x)
+	{
+		const cuda::std::uint64_t value = grid[i];
+
+		if (value != 0)
+		{
+			hash += mixHash(i * 0x9E3779B97F4A7C15ull ^ value);
+			population += __popcll(value);
+		}
+	}
+
+	hashes[threadIdx.x] = hash;
+	populations[threadIdx.x] = population;
+
+	__syncthreads();
+
+	for (unsigned int stride = SIGNATURE_BLOCK_SIZE / 2; stride > 0; stride /= 2)
+	{
+		if (threadIdx.x < stride)
+		{
+			hashes[threadIdx.x] += hashes[threadIdx.x + stride];
+			populations[threadIdx.x] += populations[threadIdx.x + stride];
+		}
+
+		__syncthreads();
+	}
+
+	if (threadIdx.x == 0)
+	{
+		atomicAdd(reinterpret_cast<unsigned long long *>(&signature->hash), hashes[0]);
+		atomicAdd(reinterpret_cast<unsigned long long *>(&signature->population), populations[0]);
+	}
+}
+
+// kodola izsaukumu skaits vienā grafā un reizē notikumu (event) skaits vienā kopā,
+// pāra skaitlis, lai pēc grafa izpildes ievade un izvade atkal būtu sākotnējos buferos
+constexpr size_t GRAPH_LAUNCHES = 256;
+
+// iepriekš izveidoti notikumi, kas ierakstās straumē pirms katra kodola izsaukuma un pēc pēdējā
+struct StepEventPool
+{
+	std::vector<cudaEvent_t> events;
+
+	explicit StepEventPool(size_t launches) : events(launches + 1)
+	{
+		for (cudaEvent_t &event : events)
+		{
+			CUDA_CHECK(cudaEventCreate(&event));
+		}
+	}
+
+	~StepEventPool()
+	{
+		for (cudaEvent_t event : events)
+		{
+			cudaEventDestroy(event);
+		}
+	}
+
+	StepEventPool(const StepEventPool &) = delete;
+	StepEventPool &operator=(const StepEventPool &) = delete;
+
+	// sagaida pēdējo notikumu un ielogo pirmo 'launches' izsaukumu laikus
+	void readBack(size_t launches, double &totalTime, BenchmarkLogger &logger)
+	{
+		CUDA_CHECK(cudaEventSynchronize(events[launches]));
+
+		for (size_t i = 0; i < launches; i++)
+		{
+			float kernelExecTime = 0;
+			CUDA_CHECK(cudaEventElapsedTime(&kernelExecTime, events[i], events[i + 1]));
+			logger.log("kernel exec time", kernelExecTime);
+			totalTime += kernelExecTime;
+		}
+	}
+};
+
+// asinhronais režīms: GRAPH_LAUNCHES izsaukumi tiek vienreiz ierakstīti grafā un atskaņoti atkārtoti,
+// divi grafi ar atsevišķām notikumu kopām mainās pa kārtai, lai GPU strādā, kamēr tiek nolasīti iepriekšējie laiki
+// 'launch(gens, in, out, stream)' ierinda vienu kodola izsaukumu, beigās 'input' norāda uz pēdējo rezultātu
+template <typename Cell, typename Launch>
+void runStepsAsync(Launch launch, Cell *&input, Cell *&output, size_t steps, size_t blockSteps, double &totalTime,
+				   BenchmarkLogger &logger)
+{
+	const size_t fullLaunches = steps / blockSteps;
+	const size_t graphReplays = fullLaunches / GRAPH_LAUNCHES;
+	const size_t tailLaunches = fullLaunches % GRAPH_LAUNCHES + (steps % blockSteps != 0 ? 1 : 0);
+
+	cudaStream_t stream;
+	CUDA_CHECK(cudaStreamCreate(&stream));
+
+	auto start = std::chrono::steady_clock::now();
+
+	StepEventPool graphEvents[2] = {StepEventPool(graphReplays > 0 ? GRAPH_LAUNCHES : 0),
+									StepEventPool(graphReplays > 1 ? GRAPH_LAUNCHES : 0)};
+	cudaGraphExec_t graphExecs[2] = {nullptr, nullptr};
+
+	for (size_t g = 0; g < std::min<size_t>(graphReplays, 2); g++)
+	{
+		Cell *in = input;
+		Cell *out = output;
+
+		cudaGraph_t graph;
+		CUDA_CHECK(cudaStreamBeginCapture(stream, cudaStreamCaptureModeGlobal));
+
+		// parasts cudaEventRecord straumes ierakstīšanas laikā grafā mezglu neizveido un atstāj notikumu stāvoklī,
+		// kurā readBack to nevar sagaidīt, ar cudaEventRecordExternal notikumus ieraksta katrs grafa atskaņojums
+		for (size_t i = 0; i < GRAPH_LAUNCHES; i++)
+		{
+			CUDA_CHECK(cudaEventRecordWithFlags(graphEvents[g].events[i], stream, cudaEventRecordExternal));
+			launch(blockSteps, in, out, stream);
+			std::swap(in, out);
+		}
+		CUDA_CHECK(cudaEventRecordWithFlags(graphEvents[g].events[GRAPH_LAUNCHES], stream, cudaEventRecordExternal));
+
+		CUDA_CHECK(cudaStreamEndCapture(stream, &graph));
+		CUDA_CHECK(cudaGraphInstantiateWithFlags(&graphExecs[g], graph, 0));
+		CUDA_CHECK(cudaGraphDestroy(graph));
+	}
+
+	auto end = std::chrono::steady_clock::now();
+	logger.chronoLog("graph creation time", start, end);
+
+	// kamēr izpildās grafs 'r', nolasām grafa 'r - 1' laikus, tā notikumi tiks pārrakstīti tikai ar 'r + 1'
+	for (size_t r = 0; r < graphReplays; r++)
+	{
+		CUDA_CHECK(cudaGraphLaunch(graphExecs[r % 2], stream));
+
+		if (r > 0)
+		{
+			graphEvents[(r - 1) % 2].readBack(GRAPH_LAUNCHES, totalTime, logger);
+		}
+	}
+
+	// atlikušos izsaukumus, kas neaizpilda veselu grafu, ierindojam straumē tieši
+	StepEventPool tailEvents(tailLaunches);
+
+	for (size_t i = 0, step = graphReplays * GRAPH_LAUNCHES * blockSteps; i < tailLaunches; i++)
+	{
+		const size_t launchSteps = std::min(blockSteps, steps - step);
+
+		CUDA_CHECK(cudaEventRecord(tailEvents.events[i], stream));
+		launch(launchSteps, input, output, stream);
+		std::swap(input, output);
+
+		step += launchSteps;
+	}
+	CUDA_CHECK(cudaEventRecord(tailEvents.events[tailLaunches], stream));
+
+	CUDA_CHECK(cudaGetLastError());
+
+	if (graphReplays > 0)
+	{
+		graphEvents[(graphReplays - 1) % 2].readBack(GRAPH_LAUNCHES, totalTime, logger);
+	}
+	tailEvents.readBack(tailLaunches, totalTime, logger);
+
+	for (cudaGraphExec_t graphExec : graphExecs)
+	{
+		if (graphExec != nullptr)
+		{
+			CUDA_CHECK(cudaGraphExecDestroy(graphExec));
+		}
+	}
+	CUDA_CHECK(cudaStreamDestroy(stream));
+}
+
+// aktīvo flīžu režīms: katrā solī vispirms tiek sastādīts aktīvo flīžu darba saraksts, no ierīces tiek nolasīts
+// tikai tā garums (tas nosaka bloku skaitu), un tad tiek pārrēķinātas tikai saraksta flīzes
+// sākumā visas flīzes ir atzīmētas kā mainījušās, tāpēc pirmais solis aizpilda visu izejas buferi
+template <typename Rule>
+void runStepsActiveTiles(unsigned char *&input, unsigned char *&output, size_t width, size_t height, size_t steps,
+						 double &totalTime, BenchmarkLogger &logger)
+{
+	const int tilesX = static_cast<int>((width + ACTIVE_TILE_W - 1) / ACTIVE_TILE_W);
+	const int tilesY = static_cast<int>((height + ACTIVE_TILE_H - 1) / ACTIVE_TILE_H);
+	const size_t tileCount = static_cast<size_t>(tilesX) * tilesY;
+
+	unsigned char *changed = nullptr;
+	unsigned char *nextChanged = nullptr;
+	unsigned int *worklist = nullptr;
+	unsigned int *workCount = nullptr;
+	CUDA_CHECK(cudaMalloc(&changed, tileCount));
+	CUDA_CHECK(cudaMalloc(&nextChanged, tileCount));
+	CUDA_CHECK(cudaMalloc(&worklist, tileCount * sizeof(unsigned int)));
+	CUDA_CHECK(cudaMalloc(&workCount, sizeof(unsigned int)));
+
+	CUDA_CHECK(cudaMemset(changed, 1, tileCount));
+
+	cudaEvent_t startEvent, endEvent;
+	CUDA_CHECK(cudaEventCreate(&startEvent));
+	CUDA_CHECK(cudaEventCreate(&endEvent));
+
+	dim3 worklistBlockSize(32, 8);
+	dim3 worklistGridDim((tilesX + worklistBlockSize.x - 1) / worklistBlockSize.x,
+						 (tilesY + worklistBlockSize.y - 1) / worklistBlockSize.y);
+	dim3 tileBlockSize(ACTIVE_TILE_W, ACTIVE_TILE_H);
+
+	double activeTileSum = 0;
+
+	for (size_t step = 0; step < steps; step++)
+	{
+		CUDA_CHECK(cudaEventRecord(startEvent));
+
+		CUDA_CHECK(cudaMemset(workCount, 0, sizeof(unsigned int)));
+		buildTileWorklistKernel<<<worklistGridDim, worklistBlockSize>>>(changed, nextChanged, worklist, workCount,
+																		tilesX, tilesY);
+
+		unsigned int activeTiles = 0;
+		CUDA_CHECK(cudaMemcpy(&activeTiles, workCount, sizeof(unsigned int), cudaMemcpyDeviceToHost));
+
+		if (activeTiles > 0)
+		{
+			golActiveTileKernel<Rule><<<activeTiles, tileBlockSize>>>(input, output, worklist, nextChanged, tilesX);
+		}
+
+		CUDA_CHECK(cudaEventRecord(endEvent));
+		CUDA_CHECK(cudaEventSynchronize(endEvent));
+
+		CUDA_CHECK(cudaGetLastError());
+
+		float kernelExecTime = 0;
+		CUDA_CHECK(cudaEventElapsedTime(&kernelExecTime, startEvent, endEvent));
+		logger.log("kernel exec time", kernelExecTime);
+		totalTime += kernelExecTime;
+
+		const double activeFraction = static_cast<double>(activeTiles) / tileCount;
+		logger.log("active tile fraction", activeFraction);
+		activeTileSum += activeFraction;
+
+		std::swap(input, output);
+		std::swap(changed, nextChanged);
+	}
+
+	if (steps > 0)
+	{
+		logger.log("mean active tile fraction", activeTileSum / steps);
+	}
+
+	CUDA_CHECK(cudaEventDestroy(startEvent));
+	CUDA_CHECK(cudaEventDestroy(endEvent));
+	CUDA_CHECK(cudaFree(changed));
+	CUDA_CHECK(cudaFree(nextChanged));
+	CUDA_CHECK(cudaFree(worklist));
+	CUDA_CHECK(cudaFree(workCount));
+}
+
+// momentuzņēmumu gredzens: režģis tiek kopēts piespraustās atmiņas ligzdā atsevišķā straumē, kamēr kodoli turpina
+// darbu, un failā to ieraksta SnapshotWriter fona pavediens
+// ierīces buferi, no kura vēl notiek kopēšana, nedrīkst pārrakstīt, tāpēc pirms katra izsaukuma noklusējuma straume
+// sagaida attiecīgās kopēšanas notikumu (beforeLaunch)
+template <typename Cell>
+class SnapshotRing
+{
+  public:
+	SnapshotRing(const std::string &pathTemplate, size_t width, size_t height, size_t gridSize) : gridSize(gridSize)
+	{
+		std::vector<Cell *> slotBuffers(SNAPSHOT_SLOTS);
+
+		for (size_t slot = 0; slot < SNAPSHOT_SLOTS; slot++)
+		{
+			CUDA_CHECK(cudaMallocHost(&slotBuffers[slot], gridSize * sizeof(Cell)));
+			CUDA_CHECK(cudaEventCreateWithFlags(&copyEvents[slot], cudaEventDisableTiming));
+			slotSources[slot] = nullptr;
+		}
+
+		// noklusējuma (legacy) straume sinhronizējas ar visām bloķējošām straumēm, tāpēc kopēšanai vajag nebloķējošu
+		CUDA_CHECK(cudaStreamCreateWithFlags(&copyStream, cudaStreamNonBlocking));
+
+		writer = std::make_unique<SnapshotWriter<Cell>>(pathTemplate, width, height, gridSize, slotBuffers);
+		buffers = std::move(slotBuffers);
+	}
+
+	~SnapshotRing()
+	{
+		// rakstītājs izmanto ligzdas un notikumus, tāpēc tas jāaptur pirms to atbrīvošanas
+		writer.reset();
+
+		for (size_t slot = 0; slot < SNAPSHOT_SLOTS; slot++)
+		{
+			cudaFreeHost(buffers[slot]);
+			cudaEventDestroy(copyEvents[slot]);
+		}
+		cudaStreamDestroy(copyStream);
+	}
+
+	SnapshotRing(const SnapshotRing &) = delete;
+	SnapshotRing &operator=(const SnapshotRing &) = delete;
+
+	// noklusējuma straume gaida, līdz beidzas visas kopēšanas no 'output', pirms kodols to pārraksta
+	void beforeLaunch(const Cell *output)
+	{
+		for (size_t slot = 0; slot < SNAPSHOT_SLOTS; slot++)
+		{
+			if (slotSources[slot] == output)
+			{
+				CUDA_CHECK(cudaStreamWaitEvent(0, copyEvents[slot], 0));
+				slotSources[slot] = nullptr;
+			}
+		}
+	}
+
+	// 'grid' jau jābūt izrēķinātam, ja visas ligzdas ir aizņemtas, momentuzņēmums tiek izlaists
+	void capture(const Cell *grid, size_t generation)
+	{
+		size_t slot;
+		if (!writer->acquireSlot(slot))
+		{
+			return;
+		}
+
+		CUDA_CHECK(cudaMemcpyAsync(buffers[slot], grid, gridSize * sizeof(Cell), cudaMemcpyDeviceToHost, copyStream));
+		CUDA_CHECK(cudaEventRecord(copyEvents[slot], copyStream));
+		slotSources[slot] = grid;
+
+		cudaEvent_t copyEvent = copyEvents[slot];
+		writer->submit(slot, generation, [copyEvent]() { CUDA_CHECK(cudaEventSynchronize(copyEvent)); });
+	}
+
+	// sagaida visu momentuzņēmumu ierakstīšanu un ielogo to aizkavi un izlaisto momentuzņēmumu skaitu
+	void finish(BenchmarkLogger &logger)
+	{
+		writer->finish();
+
+		for (double lag : writer->lags())
+		{
+			logger.log("snapshot lag", lag);
+		}
+		logger.log("dropped snapshots", static_cast<double>(writer->dropped()));
+	}
+
+  private:
+	const size_t gridSize;
+	std::vector<Cell *> buffers;
+	cudaEvent_t copyEvents[SNAPSHOT_SLOTS];
+	const Cell *slotSources[SNAPSHOT_SLOTS]; // ierīces buferis, no kura ligzdā vēl var notikt kopēšana
+	cudaStream_t copyStream;
+	std::unique_ptr<SnapshotWriter<Cell>> writer;
+};
+
+// ierīces apzīmējums bloku izmēru kešatmiņai
+std::string tuningDeviceName()
+{
+	int device;
+	CUDA_CHECK(cudaGetDevice(&device));
+
+	cudaDeviceProp properties;
+	CUDA_CHECK(cudaGetDeviceProperties(&properties, device));
+
+	return std::string(properties.name) + " cc" + std::to_string(properties.major) + "." +
+		   std::to_string(properties.minor);
+}
+
+// vidējais viena 'launch' izsaukuma laiks milisekundēs pēc viena iesildīšanas izsaukuma
+// ja ierīce bloka izmēru nepieņem (par daudz pavedienu vai koplietojamās atmiņas), atgriež -1
+template <typename Launch>
+double timeKernelLaunches(Launch launch)
+{
+	launch();
+	if (cudaGetLastError() != cudaSuccess)
+		return -1;
+
+	cudaEvent_t startEvent, endEvent;
+	CUDA_CHECK(cudaEventCreate(&startEvent));
+	CUDA_CHECK(cudaEventCreate(&endEvent));
+
+	CUDA_CHECK(cudaEventRecord(startEvent));
+	for (size_t i = 0; i < AUTOTUNE_LAUNCHES; i++)
+	{
+		launch();
+	}
+	CUDA_CHECK(cudaEventRecord(endEvent));
+	CUDA_CHECK(cudaEventSynchronize(endEvent));
+	CUDA_CHECK(cudaGetLastError());
+
+	float time = 0;
+	CUDA_CHECK(cudaEventElapsedTime(&time, startEvent, endEvent));
+
+	CUDA_CHECK(cudaEventDestroy(startEvent));
+	CUDA_CHECK(cudaEventDestroy(endEvent));
+
+	return time / AUTOTUNE_LAUNCHES;
+}
+
+// izvades nolasīšanas daļas izmērs baitos, daļas tiek rakstītas failā, kamēr nākamās vēl tiek kopētas
+constexpr size_t READBACK_CHUNK_BYTES = 4 << 20;
+
+// viena režģa buferi vienā ierīcē un kodolu izsaukumi pa soļiem (golBackend.h saskarne) vienam likumam 'Rule'
+// 'Cell' ir unsigned char (viena šūna baitā) vai cuda::std::uint64_t (bitu pakots režģis, 64 šūnas vārdā)
+// GameOfLifeStep izmanto šos pašus buferus un izsaukumus, bet savos režīmos kodolus izsauc pats
+template <typename Cell, typename Rule>
+class CudaGolGrid : public GolBackend
+{
+  public:
+	static constexpr bool packed = std::is_same<Cell, cuda::std::uint64_t>::value;
+
+	// piespraustā atmiņa, no kuras ievade tiek pārsūtīta un kurā izvade tiek nolasīta
+	Cell *hostPinnedInput = nullptr;
+	Cell *hostPinnedOutput = nullptr;
+
+	// pēc katra izsaukuma buferi tiek samainīti, tāpēc pēdējais rezultāts vienmēr atrodas 'currentInput'
+	Cell *currentInput = nullptr;
+	Cell *currentOutput = nullptr;
+
+	explicit CudaGolGrid(BenchmarkLogger &logger) : logger(logger)
+	{
+	}
+
+	~CudaGolGrid() override
+	{
+		if (hostPinnedInput == nullptr)
+			return;
+
+		CUDA_CHECK(cudaEventDestroy(startEvent));
+		CUDA_CHECK(cudaEventDestroy(endEvent));
+		CUDA_CHECK(cudaFreeHost(hostPinnedInput));
+		CUDA_CHECK(cudaFreeHost(hostPinnedOutput));
+		CUDA_CHECK(cudaFree(currentInput));
+		CUDA_CHECK(cudaFree(currentOutput));
+	}
+
+	CudaGolGrid(const CudaGolGrid &) = delete;
+	CudaGolGrid &operator=(const CudaGolGrid &) = delete;
+
+	const char *platform() const override
+	{
+		return "CUDA";
+	}
+
+	void allocate(size_t width, size_t height, const GolOptions &options) override
+	{
+		this->width = width;
+		this->height = height;
+		this->options = options;
+
+		// pakotā režģī rindas elementi ir vārdi, nevis šūnas
+		rowElements = packed ? packedWordsPerRow(width) : width;
+		gridSize = rowElements * height;
+
+		auto start = std::chrono::steady_clock::now();
+
+		CUDA_CHECK(cudaMallocHost(&hostPinnedInput, gridSize * sizeof(Cell)));
+		CUDA_CHECK(cudaMallocHost(&hostPinnedOutput, gridSize * sizeof(Cell)));
+
+		CUDA_CHECK(cudaMemcpyToSymbol(d_width, &width, sizeof(size_t)));
+		CUDA_CHECK(cudaMemcpyToSymbol(d_height, &height, sizeof(size_t)));
+		CUDA_CHECK(cudaMemcpyToSymbol(d_wordsPerRow, &rowElements, sizeof(size_t)));
+
+		CUDA_CHECK(cudaMalloc(&currentInput, gridSize * sizeof(Cell)));
+		CUDA_CHECK(cudaMalloc(&currentOutput, gridSize * sizeof(Cell)));
+
+		CUDA_CHECK(cudaEventCreate(&startEvent));
+		CUDA_CHECK(cudaEventCreate(&endEvent));
+
+		auto end = std::chrono::steady_clock::now();
+
+		logger.chronoLog("buffer creation time", start, end);
+	}
+
+	size_t gridElements() const
+	{
+		return gridSize;
+	}
+
+	// 'cells' var būt arī pats 'hostPinnedInput', tad šūnas netiek kopētas
+	void upload(const void *cells) override
+	{
+		if (cells != hostPinnedInput)
+		{
+			std::memcpy(hostPinnedInput, cells, gridSize * sizeof(Cell));
+		}
+
+		CUDA_CHECK(cudaEventRecord(startEvent));
+		CUDA_CHECK(cudaMemcpy(currentInput, hostPinnedInput, gridSize * sizeof(Cell), cudaMemcpyHostToDevice));
+		CUDA_CHECK(cudaEventRecord(endEvent));
+		CUDA_CHECK(cudaEventSynchronize(endEvent));
+
+		float transferTime = 0;
+		CUDA_CHECK(cudaEventElapsedTime(&transferTime, startEvent, endEvent));
+		logger.log("host-to-device transfer time", transferTime);
+
+		timings.uploadMs += transferTime;
+	}
+
+	// bloka izmērs pēc noklusējuma ir 32x8, --autotune izmēra kandidātus uz augšupielādētā režģa un saglabā ātrāko
+	// mērījumu izsaukumi tikai lasa 'currentInput' un raksta 'currentOutput', tāpēc režģa stāvoklis nemainās
+	// step to izsauc pirms pirmā izsaukuma, ja tas nav izsaukts jau iepriekš
+	void tune()
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		TuningCache tuningCache(TuningCache::defaultFileName());
+		const std::string tuningDevice = tuningDeviceName();
+
+		auto tunedBlockSize = [&](const std::string &kernelName, auto launch) {
+			const LaunchShape shape = resolveLaunchShape(
+				tuningCache, tuningDevice, kernelName, options.autotune, LaunchShape{},
+				[&](LaunchShape candidate) {
+					const dim3 candidateBlock(static_cast<unsigned>(candidate.x), static_cast<unsigned>(candidate.y));
+					return timeKernelLaunches([&] { launch(candidateBlock); });
+				},
+				logger);
+
+			logger.log(kernelName + " block width", static_cast<double>(shape.x));
+			logger.log(kernelName + " block height", static_cast<double>(shape.y));
+
+			return dim3(static_cast<unsigned>(shape.x), static_cast<unsigned>(shape.y));
+		};
+
+		blockSize = tunedBlockSize(packed ? "golPackedKernel" : "golMultiStepKernel", [&](dim3 block) {
+			if constexpr (packed)
+			{
+				golPackedKernel<Rule><<<gridDimFor(block), block>>>(currentInput, currentOutput);
+			}
+			else
+			{
+				golMultiStepKernel<Rule><<<gridDimFor(block), block>>>(currentInput, currentOutput);
+			}
+		});
+		gridDim = gridDimFor(blockSize);
+
+		temporalGridDim = dim3(static_cast<unsigned>((width + TEMPORAL_TILE_W - 1) / TEMPORAL_TILE_W),
+							   static_cast<unsigned>((height + TEMPORAL_TILE_H - 1) / TEMPORAL_TILE_H));
+
+		// laika bloķēšanas kodola koplietojamās atmiņas apjoms atkarīgs no paaudžu skaita, tāpēc tas ir atslēgas daļa
+		temporalBlockSize = blockSize;
+		if (!packed && options.blockSteps > 1)
+		{
+			const int g = static_cast<int>(options.blockSteps);
+			const size_t sharedBytes = 2 * (TEMPORAL_TILE_W + 2 * g) * (TEMPORAL_TILE_H + 2 * g);
+
+			temporalBlockSize =
+				tunedBlockSize("golTemporalKernel k" + std::to_string(options.blockSteps), [&](dim3 block) {
+					if constexpr (!packed)
+					{
+						golTemporalKernel<Rule>
+							<<<temporalGridDim, block, sharedBytes>>>(currentInput, currentOutput, g);
+					}
+				});
+		}
+
+		tuned = true;
+
+		auto end = std::chrono::steady_clock::now();
+		logger.chronoLog("launch tuning time", start, end);
+	}
+
+	// viens kodola izsaukums, kas izrēķina 'gens' paaudzes no 'in' uz 'out'
+	void launchGenerations(size_t gens, const Cell *in, Cell *out, cudaStream_t stream)
+	{
+		if constexpr (packed)
+		{
+			golPackedKernel<Rule><<<gridDim, blockSize, 0, stream>>>(in, out);
+		}
+		else if (gens > 1)
+		{
+			const int g = static_cast<int>(gens);
+			const size_t sharedBytes = 2 * (TEMPORAL_TILE_W + 2 * g) * (TEMPORAL_TILE_H + 2 * g);
+
+			golTemporalKernel<Rule><<<temporalGridDim, temporalBlockSize, sharedBytes, stream>>>(in, out, g);
+		}
+		else
+		{
+			golMultiStepKernel<Rule><<<gridDim, blockSize, 0, stream>>>(in, out);
+		}
+	}
+
+	// katrs izsaukums tiek sagaidīts un tā laiks ielogots, pēdējais var izrēķināt mazāk par options.blockSteps paaudzēm
+	void step(size_t generations) override
+	{
+		if (!tuned)
+		{
+			tune();
+		}
+
+		for (size_t step = 0; step < generations;)
+		{
+			const size_t launchSteps = std::min(options.blockSteps, generations - step);
+
+			CUDA_CHECK(cudaEventRecord(startEvent));
+
+			launchGenerations(launchSteps, currentInput, currentOutput, 0);
+
+			CUDA_CHECK(cudaEventRecord(endEvent));
+			CUDA_CHECK(cudaEventSynchronize(endEvent));
+
+			CUDA_CHECK(cudaGetLastError());
+
+			float kernelExecTime = 0;
+			CUDA_CHECK(cudaEventElapsedTime(&kernelExecTime, startEvent, endEvent));
+			logger.log("kernel exec time", kernelExecTime);
+			timings.kernelMs += kernelExecTime;
+
+			std::swap(currentInput, currentOutput);
+			step += launchSteps;
+		}
+	}
+
+	void download(void *cells) override
+	{
+		CUDA_CHECK(cudaEventRecord(startEvent));
+		CUDA_CHECK(cudaMemcpy(hostPinnedOutput, currentInput, gridSize * sizeof(Cell), cudaMemcpyDeviceToHost));
+		CUDA_CHECK(cudaEventRecord(endEvent));
+		CUDA_CHECK(cudaEventSynchronize(endEvent));
+
+		float transferBackTime = 0;
+		CUDA_CHECK(cudaEventElapsedTime(&transferBackTime, startEvent, endEvent));
+		logger.log("device-to-host transfer time", transferBackTime);
+
+		timings.downloadMs += transferBackTime;
+
+		std::memcpy(cells, hostPinnedOutput, gridSize * sizeof(Cell));
+	}
+
+	// izvade tiek nolasīta pa rindu daļām: visas kopēšanas tiek ierindotas uzreiz, un, kamēr ierīce kopē nākamās
+	// daļas, resursdators jau formatē un raksta failā iepriekšējās tieši no piespraustās atmiņas
+	void downloadTo(GridFileWriter &writer)
+	{
+		const size_t rowsPerChunk = std::max<size_t>(1, READBACK_CHUNK_BYTES / (rowElements * sizeof(Cell)));
+		const size_t chunkCount = (height + rowsPerChunk - 1) / rowsPerChunk;
+
+		std::vector<cudaEvent_t> chunkEvents(chunkCount);
+
+		CUDA_CHECK(cudaEventRecord(startEvent));
+		for (size_t chunk = 0; chunk < chunkCount; chunk++)
+		{
+			const size_t offset = chunk * rowsPerChunk * rowElements;
+			const size_t rows = std::min(rowsPerChunk, height - chunk * rowsPerChunk);
+
+			CUDA_CHECK(cudaEventCreate(&chunkEvents[chunk]));
+			CUDA_CHECK(cudaMemcpyAsync(hostPinnedOutput + offset, currentInput + offset,
+									   rows * rowElements * sizeof(Cell), cudaMemcpyDeviceToHost));
+			CUDA_CHECK(cudaEventRecord(chunkEvents[chunk]));
+		}
+
+		for (size_t chunk = 0; chunk < chunkCount; chunk++)
+		{
+			const size_t rowBegin = chunk * rowsPerChunk;
+
+			CUDA_CHECK(cudaEventSynchronize(chunkEvents[chunk]));
+			writer.writeRows(hostPinnedOutput + rowBegin * rowElements, rowBegin,
+							 std::min(rowsPerChunk, height - rowBegin));
+		}
+
+		float transferBackTime = 0;
+		CUDA_CHECK(cudaEventElapsedTime(&transferBackTime, startEvent, chunkEvents.back()));
+
+		logger.log("device-to-host transfer time", transferBackTime);
+
+		timings.downloadMs += transferBackTime;
+
+		for (cudaEvent_t chunkEvent : chunkEvents)
+		{
+			CUDA_CHECK(cudaEventDestroy(chunkEvent));
+		}
+	}
+
+	GolTiming timing() const override
+	{
+		return timings;
+	}
+
+  private:
+	BenchmarkLogger &logger;
+	GolOptions options;
+
+	size_t width = 0;
+	size_t height = 0;
+	size_t rowElements = 0;
+	size_t gridSize = 0;
+
+	cudaEvent_t startEvent = nullptr;
+	cudaEvent_t endEvent = nullptr;
+
+	bool tuned = false;
+	dim3 blockSize;
+	dim3 gridDim;
+	dim3 temporalBlockSize;
+	dim3 temporalGridDim;
+
+	GolTiming timings;
+
+	dim3 gridDimFor(dim3 block) const
+	{
+		return dim3(static_cast<unsigned>((rowElements + block.x - 1) / block.x),
+					static_cast<unsigned>((height + block.y - 1) / block.y));
+	}
+};
+
+// režģis no faila tiek atkodēts tieši CudaGolGrid piespraustajā atmiņā, no kurienes notiek pārsūtīšana
+// 'blockSteps' > 1 nozīmē, ka katrs kodola izsaukums izrēķina līdz 'blockSteps' paaudzēm (tikai baitu režģim)
+// 'Rule' ir LifeRule, kuram katram likumam un robežas veidam tiek kompilēti savi kodoli
+// rezultāts no piespraustās atmiņas tiek nodots 'writer' pa rindu daļām, 'writer.finish()' izsauc izsaucējs
+template <typename Cell, typename Rule>
+void GameOfLifeStep(const MappedGridFile &gridFile, GridFileWriter &writer, size_t steps, const GolOptions &options,
+					BenchmarkLogger &logger)
+{
+	constexpr bool packed = std::is_same<Cell, cuda::std::uint64_t>::value;
+
+	const size_t width = gridFile.width();
+	const size_t height = gridFile.height();
+
+	CudaGolGrid<Cell, Rule> grid(logger);
+	grid.allocate(width, height, options);
+
+	auto start = std::chrono::steady_clock::now();
+
+	if constexpr (packed)
+	{
+		gridFile.decodePackedInto(grid.hostPinnedInput);
+	}
+	else
+	{
+		gridFile.decodeInto(grid.hostPinnedInput);
+	}
+
+	auto end = std::chrono::steady_clock::now();
+	logger.chronoLog("grid decode time", start, end);
+
+	start = std::chrono::steady_clock::now();
+
+	grid.upload(grid.hostPinnedInput);
+
+	end = std::chrono::steady_clock::now();
+	logger.chronoLog("total host-to-device transfer time", start, end);
+
+	grid.tune();
+
+	double totalTime = 0;
+
+	if (options.async)
+	{
+		runStepsAsync(
+			[&](size_t gens, const Cell *in, Cell *out, cudaStream_t stream) {
+				grid.launchGenerations(gens, in, out, stream);
+			},
+			grid.currentInput, grid.currentOutput, steps, options.blockSteps, totalTime, logger);
+	}
+	else if (options.activeTiles)
+	{
+		// aktīvo flīžu režīms ir pieejams tikai baitu režģim bez toroidālās robežas, to jau pārbaudīja parseGolOptions
+		if constexpr (!packed && !Rule::wrap)
+		{
+			runStepsActiveTiles<Rule>(grid.currentInput, grid.currentOutput, width, height, steps, totalTime, logger);
+		}
+	}
+	else
+	{
+		// ciklu meklēšanas režīmā pēc katra izsaukuma no ierīces tiek nolasīts tikai 16 baitu režģa paraksts
+		const bool detectCycles = options.cyclePeriod > 0;
+		CycleDetector cycleDetector(options.cyclePeriod);
+
+		const size_t gridSize = grid.gridElements();
+
+		GridSignature *deviceSignature = nullptr;
+		const unsigned int signatureBlocks =
+			static_cast<unsigned int>(std::clamp<size_t>((gridSize + SIGNATURE_BLOCK_SIZE - 1) / SIGNATURE_BLOCK_SIZE,
+														 1, SIGNATURE_MAX_BLOCKS));
+
+		auto readSignature = [&](const Cell *cells) {
+			CUDA_CHECK(cudaMemset(deviceSignature, 0, sizeof(GridSignature)));
+			gridSignatureKernel<<<signatureBlocks, SIGNATURE_BLOCK_SIZE>>>(cells, gridSize, deviceSignature);
+
+			GridSignature signature;
+			CUDA_CHECK(cudaMemcpy(&signature, deviceSignature, sizeof(GridSignature), cudaMemcpyDeviceToHost));
+			return signature;
+		};
+
+		if (detectCycles)
+		{
+			CUDA_CHECK(cudaMalloc(&deviceSignature, sizeof(GridSignature)));
+			cycleDetector.push(0, readSignature(grid.currentInput));
+		}
+
+		std::unique_ptr<SnapshotRing<Cell>> snapshots;
+		if (options.snapshotEvery > 0)
+		{
+			snapshots = std::make_unique<SnapshotRing<Cell>>(options.snapshotPath, width, height, gridSize);
+		}
+
+		// atrodot ciklu, 'targetSteps' samazinās līdz paaudzei, kurā režģis ir tāds pats kā pēc 'steps' paaudzēm
+		size_t targetSteps = steps;
+
+		for (size_t step = 0; step < targetSteps;)
+		{
+			// pēdējais izsaukums var izrēķināt mazāk paaudžu, ja 'steps' nedalās ar 'blockSteps'
+			// vai ja līdz nākamajam momentuzņēmumam atlicis mazāk paaudžu
+			size_t launchSteps = std::min(options.blockSteps, targetSteps - step);
+
+			if (snapshots)
+			{
+				launchSteps = std::min(launchSteps, options.snapshotEvery - step % options.snapshotEvery);
+				snapshots->beforeLaunch(grid.currentOutput);
+			}
+
+			// ne vairāk par 'blockSteps' paaudzēm, tātad viens kodola izsaukums
+			grid.step(launchSteps);
+
+			step += launchSteps;
+
+			if (snapshots && step % options.snapshotEvery == 0)
+			{
+				snapshots->capture(grid.currentInput, step);
+			}
+
+			if (detectCycles && targetSteps == steps)
+			{
+				auto signatureStart = std::chrono::steady_clock::now();
+				const size_t period = cycleDetector.push(step, readSignature(grid.currentInput));
+				auto signatureEnd = std::chrono::steady_clock::now();
+
+				logger.chronoLog("grid signature time", signatureStart, signatureEnd);
+
+				if (period > 0)
+				{
+					// režģis atkārtojas ik pēc 'period' paaudzēm, tāpēc atlikušo soļu skaitu var ņemt pēc moduļa
+					targetSteps = step + (steps - step) % period;
+
+					logger.log("stabilized at generation", static_cast<double>(step));
+					logger.log("stabilization period", static_cast<double>(period));
+
+					std::cout << "Grid repeats with period " << period << " at generation " << step << ", running "
+							  << targetSteps - step << " more generations\n";
+				}
+			}
+		}
+
+		if (detectCycles)
+		{
+			CUDA_CHECK(cudaFree(deviceSignature));
+		}
+
+		if (snapshots)
+		{
+			snapshots->finish(logger);
+		}
+
+		totalTime = grid.timing().kernelMs;
+	}
+
+	logger.log("total kernel exec time", totalTime);
+
+	start = std::chrono::steady_clock::now();
+
+	grid.downloadTo(writer);
+
+	end = std::chrono::steady_clock::now();
+	logger.chronoLog("total device-to-host transfer and write time", start, end);
+}
+
+// joslu skaits, kas vienlaikus atrodas ierīcē, katrai sava straume, piespraustie buferi un ierīces buferi
+constexpr size_t STREAM_SLOTS = 2;
+
+// straumēšanas režīms režģiem, kas neietilpst ierīces atmiņā: režģis glabājas resursdatora atmiņā un katrā
+// piegājienā tiek pa horizontālām joslām ar 'blockSteps' rindu apmali pārsūtīts uz ierīci, tur izrēķinātas līdz
+// 'blockSteps' paaudzēm un joslas iekšpuse pārsūtīta atpakaļ
+// kamēr viena josla tiek rēķināta, nākamā jau tiek kopēta citā straumē
+template <typename Rule>
+void GameOfLifeStreamed(const MappedGridFile &gridFile, std::vector<unsigned char> &outputGrid, size_t steps,
+						const GolOptions &options, BenchmarkLogger &logger)
 {
-	// ejam uz faila beigām uzreiz ar 'ate', lai noteiktu faila izmēru, pēc tam iesim uz sākumu
-	std::ifstream file(fileName, std::ios::ate | std::ios::binary);
+	const size_t width = gridFile.width();
+	const size_t height = gridFile.height();
+	const size_t halo = options.blockSteps;
+
+	if (width == 0 || height == 0)
+	{
+		outputGrid.clear();
+		return;
+	}
+
+	// katrai joslai ierīcē ir divi buferi (ping-pong) ar stripRows + 2 * halo rindām
+	const size_t budgetRows = options.streamMiB * 1024 * 1024 / (STREAM_SLOTS * 2 * width);
+	if (budgetRows <= 2 * halo)
+	{
+		throw std::runtime_error("--stream memory budget is too small for a single strip of this grid");
+	}
+
+	const size_t stripRows = std::min(budgetRows - 2 * halo, height);
+	const size_t bufferRows = stripRows + 2 * halo;
+	const size_t stripCount = (height + stripRows - 1) / stripRows;
 
-	if (!file.is_open())
+	std::cout << "Streaming " << stripCount << " strips of " << stripRows << " rows per pass\n";
+
+	auto start = std::chrono::steady_clock::now();
+
+	// pats režģis paliek parastajā resursdatora atmiņā, piesprausti ir tikai joslu starpbuferi
+	std::vector<unsigned char> currentGrid(width * height);
+	std::vector<unsigned char> nextGrid(width * height);
+
+	struct StripSlot
 	{
-		throw std::runtime_error("Failed to open file: " + fileName);
+		cudaStream_t stream;
+		cudaEvent_t done;
+		unsigned char *hostInput;
+		unsigned char *hostOutput;
+		unsigned char *deviceBuffers[2];
+		size_t pendingStrip = SIZE_MAX; // josla, kuras rezultāts vēl jāpārkopē uz nextGrid
+	};
+
+	StripSlot slots[STREAM_SLOTS];
+
+	for (StripSlot &slot : slots)
+	{
+		CUDA_CHECK(cudaStreamCreate(&slot.stream));
+		CUDA_CHECK(cudaEventCreate(&slot.done));
+		CUDA_CHECK(cudaMallocHost(&slot.hostInput, bufferRows * width));
+		CUDA_CHECK(cudaMallocHost(&slot.hostOutput, stripRows * width));
+		CUDA_CHECK(cudaMalloc(&slot.deviceBuffers[0], bufferRows * width));
+		CUDA_CHECK(cudaMalloc(&slot.deviceBuffers[1], bufferRows * width));
 	}
 
-	const size_t fileSize = file.tellg();
-	file.seekg(0, std::ios::beg);
+	CUDA_CHECK(cudaMemcpyToSymbol(d_width, &width, sizeof(size_t)));
+	CUDA_CHECK(cudaMemcpyToSymbol(d_height, &height, sizeof(size_t)));
+
+	auto end = std::chrono::steady_clock::now();
+	logger.chronoLog("buffer creation time", start, end);
+
+	start = std::chrono::steady_clock::now();
+	gridFile.decodeInto(currentGrid.data());
+	end = std::chrono::steady_clock::now();
+	logger.chronoLog("grid decode time", start, end);
+
+	dim3 blockSize(32, 8);
+	dim3 gridDim((width + blockSize.x - 1) / blockSize.x, (bufferRows + blockSize.y - 1) / blockSize.y);
+
+	// sagaida joslas rezultātu un pārkopē to nākamās paaudzes režģī
+	auto finishStrip = [&](StripSlot &slot) {
+		if (slot.pendingStrip == SIZE_MAX)
+		{
+			return;
+		}
 
-	std::vector<char> buffer(fileSize);
-	file.read(buffer.data(), fileSize);
-	file.close();
+		CUDA_CHECK(cudaEventSynchronize(slot.done));
 
-	std::vector<unsigned char> grid;
-	grid.reserve(fileSize);
+		const size_t rowBegin = slot.pendingStrip * stripRows;
+		const size_t rows = std::min(stripRows, height - rowBegin);
+		std::memcpy(nextGrid.data() + rowBegin * width, slot.hostOutput, rows * width);
 
-	size_t lineStartPos = 0;
+		slot.pendingStrip = SIZE_MAX;
+	};
 
-	width = 0;
-	height = 0;
+	double totalTime = 0;
 
-	for (size_t i = 0; i <= buffer.size(); ++i)
+	for (size_t step = 0; step < steps;)
 	{
-		if (i == buffer.size() || buffer[i] == '\n')
-		{
-			size_t lineLen = i - lineStartPos;
+		const size_t passGens = std::min(halo, steps - step);
 
-			if (lineLen == 0)
-			{
-				lineStartPos = i + 1;
-				continue;
-			}
+		auto passStart = std::chrono::steady_clock::now();
 
-			if (width == 0)
-			{
-				width = lineLen;
-			}
-			else if (lineLen != width)
+		for (size_t strip = 0; strip < stripCount; strip++)
+		{
+			StripSlot &slot = slots[strip % STREAM_SLOTS];
+			finishStrip(slot);
+
+			const size_t rowBegin = strip * stripRows;
+			const size_t rows = std::min(stripRows, height - rowBegin);
+			const long long firstRow = static_cast<long long>(rowBegin) - static_cast<long long>(halo);
+
+			// joslas rindas kopā ar apmali, rindas ārpus režģa aizpilda ar nullēm
+			const size_t validBegin = static_cast<size_t>(std::max(firstRow, 0LL));
+			const size_t validEnd = std::min(static_cast<size_t>(firstRow + bufferRows), height);
+			const size_t topPadding = validBegin - firstRow;
+			const size_t validRows = validEnd - validBegin;
+
+			std::memset(slot.hostInput, 0, topPadding * width);
+			std::memcpy(slot.hostInput + topPadding * width, currentGrid.data() + validBegin * width,
+						validRows * width);
+			std::memset(slot.hostInput + (topPadding + validRows) * width, 0,
+						(bufferRows - topPadding - validRows) * width);
+
+			CUDA_CHECK(cudaMemcpyAsync(slot.deviceBuffers[0], slot.hostInput, bufferRows * width,
+									   cudaMemcpyHostToDevice, slot.stream));
+
+			int current = 0;
+			for (size_t gen = 0; gen < passGens; gen++)
 			{
-				throw std::runtime_error("Invalid line length at line idx: " + std::to_string(height));
+				golStripKernel<Rule><<<gridDim, blockSize, 0, slot.stream>>>(slot.deviceBuffers[current],
+																	   slot.deviceBuffers[1 - current], firstRow,
+																	   static_cast<int>(bufferRows), 0,
+																	   static_cast<int>(bufferRows));
+				current = 1 - current;
 			}
 
-			for (size_t j = 0; j < width; ++j)
-			{
-				unsigned char val = static_cast<unsigned char>(buffer[lineStartPos + j] - '0');
-				grid.push_back(val);
-			}
+			CUDA_CHECK(cudaMemcpyAsync(slot.hostOutput, slot.deviceBuffers[current] + halo * width, rows * width,
+									   cudaMemcpyDeviceToHost, slot.stream));
+			CUDA_CHECK(cudaEventRecord(slot.done, slot.stream));
+
+			slot.pendingStrip = strip;
+		}
 
-			height++;
-			lineStartPos = i + 1;
+		for (StripSlot &slot : slots)
+		{
+			finishStrip(slot);
 		}
+
+		CUDA_CHECK(cudaGetLastError());
+
+		std::swap(currentGrid, nextGrid);
+		step += passGens;
+
+		auto passEnd = std::chrono::steady_clock::now();
+
+		std::chrono::duration<double, std::milli> passTime = passEnd - passStart;
+		logger.log("stream pass time", passTime.count());
+		totalTime += passTime.count();
 	}
 
-	return grid;
+	logger.log("total kernel exec time", totalTime);
+
+	outputGrid = std::move(currentGrid);
+
+	for (StripSlot &slot : slots)
+	{
+		CUDA_CHECK(cudaFree(slot.deviceBuffers[0]));
+		CUDA_CHECK(cudaFree(slot.deviceBuffers[1]));
+		CUDA_CHECK(cudaFreeHost(slot.hostInput));
+		CUDA_CHECK(cudaFreeHost(slot.hostOutput));
+		CUDA_CHECK(cudaEventDestroy(slot.done));
+		CUDA_CHECK(cudaStreamDestroy(slot.stream));
+	}
 }
 
-void writeGridToFile(std::vector<unsigned char> &grid, size_t width, size_t height, std::string fileName)
+// vairāku ierīču režīms: režģis tiek sadalīts horizontālās joslās pa vienai katrai ierīcei, katras joslas buferī ir
+// 'blockSteps' rindu apmale no kaimiņu joslām, kas tiek atjaunota pēc katrām 'blockSteps' paaudzēm
+// piegājiena pēdējā paaudzē vispirms tiek izrēķinātas joslas malu rindas, un, kamēr skaitļošanas straume rēķina
+// joslas iekšpusi, atsevišķa straume jau kopē malas uz kaimiņu ierīču apmalēm
+template <typename Rule>
+void GameOfLifeMultiDevice(const MappedGridFile &gridFile, std::vector<unsigned char> &outputGrid, size_t steps,
+						   const GolOptions &options, BenchmarkLogger &logger)
 {
-	std::ofstream file(fileName, std::ios::out | std::ios::binary);
-	if (!file.is_open())
+	const size_t width = gridFile.width();
+	const size_t height = gridFile.height();
+	const size_t halo = options.blockSteps;
+
+	if (width == 0 || height == 0)
 	{
-		throw std::runtime_error("Failed to open file: " + fileName);
+		outputGrid.clear();
+		return;
 	}
 
-	const size_t totalSize = (width + 1) * height; // +1, jo rindas beigās ir \n
+	int deviceCount;
+	CUDA_CHECK(cudaGetDeviceCount(&deviceCount));
+
+	size_t bandCount = options.devices == 0 ? deviceCount : std::min<size_t>(options.devices, deviceCount);
+
+	// katrā joslā jābūt vismaz 'halo' rindām, lai apmale nāktu tikai no tiešajiem kaimiņiem
+	bandCount = std::max<size_t>(1, std::min(bandCount, height / halo));
+
+	std::cout << "Splitting the grid into " << bandCount << " bands across " << deviceCount << " devices\n";
 
-	std::vector<char> buffer(totalSize);
+	auto start = std::chrono::steady_clock::now();
 
-	for (size_t h = 0; h < height; h++)
+	struct DeviceBand
+	{
+		int device;
+		size_t rowBegin; // pirmā joslai piederošā režģa rinda
+		size_t rows;
+		cudaStream_t computeStream;
+		cudaStream_t haloStream;
+		cudaEvent_t readyEvent; // pēdējās paaudzes izejas buferis vairs netiek rakstīts, kaimiņi var kopēt apmali
+		cudaEvent_t edgesEvent; // joslas malu rindas ir izrēķinātas
+		unsigned char *deviceBuffers[2];
+	};
+
+	std::vector<DeviceBand> bands(bandCount);
+
+	for (size_t i = 0; i < bandCount; i++)
 	{
-		size_t lineStart = h * (width + 1);
-		size_t gridRowStart = h * width;
+		DeviceBand &band = bands[i];
+		band.device = static_cast<int>(i);
+		band.rowBegin = i * height / bandCount;
+		band.rows = (i + 1) * height / bandCount - band.rowBegin;
+
+		const size_t bufferRows = band.rows + 2 * halo;
+
+		CUDA_CHECK(cudaSetDevice(band.device));
 
-		for (size_t w = 0; w < width; w++)
+		// tiešā kopēšana starp kaimiņu ierīcēm, ja tā ir pieejama, citādi cudaMemcpyPeerAsync kopē caur resursdatoru
+		for (size_t neighbor : {i - 1, i + 1})
 		{
-			buffer[lineStart + w] = '0' + grid[gridRowStart + w];
+			int canAccessPeer = 0;
+			if (neighbor < bandCount)
+			{
+				CUDA_CHECK(cudaDeviceCanAccessPeer(&canAccessPeer, band.device, static_cast<int>(neighbor)));
+			}
+
+			if (canAccessPeer)
+			{
+				cudaError_t peerResult = cudaDeviceEnablePeerAccess(static_cast<int>(neighbor), 0);
+				if (peerResult != cudaErrorPeerAccessAlreadyEnabled)
+				{
+					CUDA_CHECK(peerResult);
+				}
+			}
 		}
 
-		buffer[lineStart + width] = '\n';
-	}
+		CUDA_CHECK(cudaStreamCreateWithFlags(&band.computeStream, cudaStreamNonBlocking));
+		CUDA_CHECK(cudaStreamCreateWithFlags(&band.haloStream, cudaStreamNonBlocking));
+		CUDA_CHECK(cudaEventCreateWithFlags(&band.readyEvent, cudaEventDisableTiming));
+		CUDA_CHECK(cudaEventCreateWithFlags(&band.edgesEvent, cudaEventDisableTiming));
+		CUDA_CHECK(cudaMalloc(&band.deviceBuffers[0], bufferRows * width));
+		CUDA_CHECK(cudaMalloc(&band.deviceBuffers[1], bufferRows * width));
 
-	file.write(buffer.data(), totalSize);
+		// __constant__ mainīgie katrai ierīcei ir savi
+		CUDA_CHECK(cudaMemcpyToSymbol(d_width, &width, sizeof(size_t)));
+		CUDA_CHECK(cudaMemcpyToSymbol(d_height, &height, sizeof(size_t)));
+	}
 
-	file.close();
-}
+	auto end = std::chrono::steady_clock::now();
+	logger.chronoLog("buffer creation time", start, end);
 
-__constant__ size_t d_width;
-__constant__ size_t d_height;
+	start = std::chrono::steady_clock::now();
+	std::vector<unsigned char> grid(width * height);
+	gridFile.decodeInto(grid.data());
+	end = std::chrono::steady_clock::now();
+	logger.chronoLog("grid decode time", start, end);
 
-inline __device__ int neighborCount(int x, int y, const unsigned char *grid)
-{
-	int neighbors = 0;
+	start = std::chrono::steady_clock::now();
 
-	if (y > 0)
+	// katras joslas rindas kopā ar apmali, rindas ārpus režģa aizpilda ar nullēm
+	for (DeviceBand &band : bands)
 	{
-		if (x > 0)
-			neighbors += grid[(y - 1) * d_width + (x - 1)];
+		const size_t bufferRows = band.rows + 2 * halo;
+		const size_t validBegin = band.rowBegin >= halo ? band.rowBegin - halo : 0;
+		const size_t validEnd = std::min(band.rowBegin + band.rows + halo, height);
+		const size_t topPadding = validBegin + halo - band.rowBegin;
+
+		CUDA_CHECK(cudaSetDevice(band.device));
+		CUDA_CHECK(cudaMemset(band.deviceBuffers[0], 0, bufferRows * width));
+		CUDA_CHECK(cudaMemset(band.deviceBuffers[1], 0, bufferRows * width));
+		CUDA_CHECK(cudaMemcpy(band.deviceBuffers[0] + topPadding * width, grid.data() + validBegin * width,
+							  (validEnd - validBegin) * width, cudaMemcpyHostToDevice));
+	}
 
-		neighbors += grid[(y - 1) * d_width + x];
+	end = std::chrono::steady_clock::now();
+	logger.chronoLog("total host-to-device transfer time", start, end);
 
-		if (x < d_width - 1)
-			neighbors += grid[(y - 1) * d_width + (x + 1)];
-	}
+	dim3 blockSize(32, 8);
 
-	if (x > 0)
-		neighbors += grid[y * d_width + (x - 1)];
+	// palaiž golStripKernel joslas bufera rindām [rowBegin, rowEnd)
+	auto launchRows = [&](DeviceBand &band, int current, size_t rowBegin, size_t rowEnd) {
+		if (rowBegin >= rowEnd)
+		{
+			return;
+		}
 
-	if (x < d_width - 1)
-		neighbors += grid[y * d_width + (x + 1)];
+		const long long firstRow = static_cast<long long>(band.rowBegin) - static_cast<long long>(halo);
+		dim3 gridDim((width + blockSize.x - 1) / blockSize.x, (rowEnd - rowBegin + blockSize.y - 1) / blockSize.y);
 
-	if (y < d_height - 1)
+		golStripKernel<Rule><<<gridDim, blockSize, 0, band.computeStream>>>(
+			band.deviceBuffers[current], band.deviceBuffers[1 - current], firstRow,
+			static_cast<int>(band.rows + 2 * halo), static_cast<int>(rowBegin), static_cast<int>(rowEnd));
+	};
+
+	int current = 0;
+	double totalTime = 0;
+
+	for (size_t step = 0; step < steps;)
 	{
-		if (x > 0)
-			neighbors += grid[(y + 1) * d_width + (x - 1)];
+		const size_t passGens = std::min(halo, steps - step);
+		const int output = (current + static_cast<int>(passGens)) % 2;
 
-		neighbors += grid[(y + 1) * d_width + x];
+		auto passStart = std::chrono::steady_clock::now();
 
-		if (x < d_width - 1)
-			neighbors += grid[(y + 1) * d_width + (x + 1)];
-	}
+		for (DeviceBand &band : bands)
+		{
+			CUDA_CHECK(cudaSetDevice(band.device));
 
-	return neighbors;
-}
+			// piegājiena starpposma paaudzes rēķina visu buferi, apmales rindas ar katru paaudzi kļūst kļūdainas
+			int bandCurrent = current;
+			for (size_t gen = 0; gen + 1 < passGens; gen++)
+			{
+				launchRows(band, bandCurrent, 0, band.rows + 2 * halo);
+				bandCurrent = 1 - bandCurrent;
+			}
 
-__global__ void golMultiStepKernel(unsigned char *input, unsigned char *output)
-{
-	const int x = blockIdx.x * blockDim.x + threadIdx.x;
-	const int y = blockIdx.y * blockDim.y + threadIdx.y;
+			CUDA_CHECK(cudaEventRecord(band.readyEvent, band.computeStream));
 
-	if (x >= d_width || y >= d_height)
-		return;
+			// pēdējā paaudze rēķina tikai joslas rindas, malas pirms iekšpuses
+			const size_t edgeRows = std::min(halo, band.rows - halo);
+			launchRows(band, bandCurrent, halo, halo + edgeRows);
+			launchRows(band, bandCurrent, std::max(band.rows, halo + edgeRows), band.rows + halo);
+			CUDA_CHECK(cudaEventRecord(band.edgesEvent, band.computeStream));
+			launchRows(band, bandCurrent, halo + edgeRows, std::max(band.rows, halo + edgeRows));
+		}
 
-	const size_t flatIdx = y * d_width + x;
+		// joslas augšējās rindas kļūst par iepriekšējās joslas apakšējo apmali, apakšējās - par nākamās augšējo
+		for (size_t i = 0; i < bandCount; i++)
+		{
+			DeviceBand &band = bands[i];
+
+			CUDA_CHECK(cudaSetDevice(band.device));
+			CUDA_CHECK(cudaStreamWaitEvent(band.haloStream, band.edgesEvent, 0));
+
+			if (i > 0)
+			{
+				DeviceBand &above = bands[i - 1];
+				CUDA_CHECK(cudaStreamWaitEvent(band.haloStream, above.readyEvent, 0));
+				CUDA_CHECK(cudaMemcpyPeerAsync(above.deviceBuffers[output] + (above.rows + halo) * width, above.device,
+											   band.deviceBuffers[output] + halo * width, band.device, halo * width,
+											   band.haloStream));
+			}
+
+			if (i + 1 < bandCount)
+			{
+				DeviceBand &below = bands[i + 1];
+				CUDA_CHECK(cudaStreamWaitEvent(band.haloStream, below.readyEvent, 0));
+				CUDA_CHECK(cudaMemcpyPeerAsync(below.deviceBuffers[output], below.device,
+											   band.deviceBuffers[output] + band.rows * width, band.device,
+											   halo * width, band.haloStream));
+			}
+		}
+
+		for (DeviceBand &band : bands)
+		{
+			CUDA_CHECK(cudaSetDevice(band.device));
+			CUDA_CHECK(cudaStreamSynchronize(band.computeStream));
+			CUDA_CHECK(cudaStreamSynchronize(band.haloStream));
+			CUDA_CHECK(cudaGetLastError());
+		}
+
+		current = output;
+		step += passGens;
+
+		auto passEnd = std::chrono::steady_clock::now();
+
+		std::chrono::duration<double, std::milli> passTime = passEnd - passStart;
+		logger.log("multi-device pass time", passTime.count());
+		totalTime += passTime.count();
+	}
+
+	logger.log("total kernel exec time", totalTime);
 
-	int neighbors = neighborCount(x, y, input);
+	start = std::chrono::steady_clock::now();
 
-	unsigned char cell = 0;
-	if (input[flatIdx] == 1)
+	for (DeviceBand &band : bands)
 	{
-		if (neighbors == 2 || neighbors == 3)
-			cell = 1;
+		CUDA_CHECK(cudaSetDevice(band.device));
+		CUDA_CHECK(cudaMemcpy(grid.data() + band.rowBegin * width, band.deviceBuffers[current] + halo * width,
+							  band.rows * width, cudaMemcpyDeviceToHost));
 	}
-	else
+
+	end = std::chrono::steady_clock::now();
+	logger.chronoLog("total device-to-host transfer time", start, end);
+
+	outputGrid = std::move(grid);
+
+	for (DeviceBand &band : bands)
 	{
-		if (neighbors == 3)
-			cell = 1;
+		CUDA_CHECK(cudaSetDevice(band.device));
+		CUDA_CHECK(cudaFree(band.deviceBuffers[0]));
+		CUDA_CHECK(cudaFree(band.deviceBuffers[1]));
+		CUDA_CHECK(cudaEventDestroy(band.readyEvent));
+		CUDA_CHECK(cudaEventDestroy(band.edgesEvent));
+		CUDA_CHECK(cudaStreamDestroy(band.computeStream));
+		CUDA_CHECK(cudaStreamDestroy(band.haloStream));
 	}
 
-	output[flatIdx] = cell;
+	CUDA_CHECK(cudaSetDevice(0));
 }
 
-void GameOfLifeStep(std::vector<unsigned char> &grid, std::vector<unsigned char> &outputGrid, size_t width,
-					size_t height, size_t steps, BenchmarkLogger &logger)
+// ansambļa režīms: visi režģi tiek saspiesti vienā piespraustās atmiņas un vienā ierīces buferī, un katra paaudze
+// visiem režģiem ir viens kodola izsaukums (vai viens izsaukums uz ENSEMBLE_MAX_GRID_Z režģiem)
+// ar --async izsaukumi tiek ierakstīti CUDA grafos pa GRAPH_LAUNCHES paaudzēm, tāpat kā GameOfLifeStep
+// rezultāts tiek ierakstīts atpakaļ 'boards' šūnās
+template <typename Rule>
+void GameOfLifeEnsemble(std::vector<EnsembleBoard> &boards, size_t steps, const GolOptions &options,
+						BenchmarkLogger &logger)
 {
+	std::vector<EnsembleExtent> extents(boards.size());
+	size_t totalCells = 0;
+	size_t maxWidth = 0;
+	size_t maxHeight = 0;
 
-	size_t gridSize = width * height;
-	outputGrid.resize(gridSize);
+	for (size_t i = 0; i < boards.size(); i++)
+	{
+		extents[i] = {totalCells, static_cast<int>(boards[i].width), static_cast<int>(boards[i].height)};
+		totalCells += boards[i].cells.size();
+		maxWidth = std::max(maxWidth, boards[i].width);
+		maxHeight = std::max(maxHeight, boards[i].height);
+	}
 
 	auto start = std::chrono::steady_clock::now();
 
-	unsigned char *hostPinnedInput = nullptr;
-	unsigned char *hostPinnedOutput = nullptr;
-	CUDA_CHECK(cudaMallocHost(&hostPinnedInput, gridSize * sizeof(unsigned char)));
-	CUDA_CHECK(cudaMallocHost(&hostPinnedOutput, gridSize * sizeof(unsigned char)));
-
-	std::memcpy(hostPinnedInput, grid.data(), gridSize * sizeof(unsigned char));
-
-	CUDA_CHECK(cudaMemcpyToSymbol(d_width, &width, sizeof(size_t)));
-	CUDA_CHECK(cudaMemcpyToSymbol(d_height, &height, sizeof(size_t)));
+	unsigned char *hostPinned = nullptr;
+	CUDA_CHECK(cudaMallocHost(&hostPinned, totalCells));
 
 	unsigned char *deviceInput = nullptr;
 	unsigned char *deviceOutput = nullptr;
-	CUDA_CHECK(cudaMalloc(&deviceInput, gridSize * sizeof(unsigned char)));
-	CUDA_CHECK(cudaMalloc(&deviceOutput, gridSize * sizeof(unsigned char)));
+	EnsembleExtent *deviceExtents = nullptr;
+	CUDA_CHECK(cudaMalloc(&deviceInput, totalCells));
+	CUDA_CHECK(cudaMalloc(&deviceOutput, totalCells));
+	CUDA_CHECK(cudaMalloc(&deviceExtents, extents.size() * sizeof(EnsembleExtent)));
 
 	auto end = std::chrono::steady_clock::now();
-
 	logger.chronoLog("buffer creation time", start, end);
 
 	start = std::chrono::steady_clock::now();
 
+	for (size_t i = 0; i < boards.size(); i++)
+	{
+		std::memcpy(hostPinned + extents[i].offset, boards[i].cells.data(), boards[i].cells.size());
+	}
+
+	end = std::chrono::steady_clock::now();
+	logger.chronoLog("ensemble pack time", start, end);
+
+	start = std::chrono::steady_clock::now();
+
 	cudaEvent_t transferEvent, startEvent, endEvent;
 	CUDA_CHECK(cudaEventCreate(&transferEvent));
 	CUDA_CHECK(cudaEventCreate(&startEvent));
 	CUDA_CHECK(cudaEventCreate(&endEvent));
 
 	CUDA_CHECK(cudaEventRecord(startEvent));
-	CUDA_CHECK(cudaMemcpy(deviceInput, hostPinnedInput, gridSize * sizeof(unsigned char), cudaMemcpyHostToDevice));
+	CUDA_CHECK(cudaMemcpy(deviceInput, hostPinned, totalCells, cudaMemcpyHostToDevice));
+	CUDA_CHECK(cudaMemcpy(deviceExtents, extents.data(), extents.size() * sizeof(EnsembleExtent),
+						  cudaMemcpyHostToDevice));
 	CUDA_CHECK(cudaEventRecord(transferEvent));
 	CUDA_CHECK(cudaEventSynchronize(transferEvent));
 
@@ -238,51 +1905,99 @@ void GameOfLifeStep(std::vector<unsigned char> &grid, std::vector<unsigned char>
 	end = std::chrono::steady_clock::now();
 	logger.chronoLog("total host-to-device transfer time", start, end);
 
-	// lokālais bloka izmērs, šis likās diezgan ok
-	dim3 blockSize(32, 8);
-	dim3 gridDim((width + blockSize.x - 1) / blockSize.x, (height + blockSize.y - 1) / blockSize.y);
+	// mazu režģu ansamblī bloks netiek ņemts lielāks par lielāko režģi, lai neaizņemtu tukšus pavedienus
+	const LaunchShape shape;
+	dim3 blockSize(static_cast<unsigned>(shape.x), static_cast<unsigned>(shape.y));
+
+	while (blockSize.x > 1 && blockSize.x / 2 >= maxWidth)
+	{
+		blockSize.x /= 2;
+	}
+	while (blockSize.y > 1 && blockSize.y / 2 >= maxHeight)
+	{
+		blockSize.y /= 2;
+	}
+
+	logger.log("golEnsembleKernel block width", static_cast<double>(blockSize.x));
+	logger.log("golEnsembleKernel block height", static_cast<double>(blockSize.y));
+
+	const unsigned gridX = static_cast<unsigned>((maxWidth + blockSize.x - 1) / blockSize.x);
+	const unsigned gridY = static_cast<unsigned>((maxHeight + blockSize.y - 1) / blockSize.y);
+
+	// viena paaudze visiem režģiem, ansambļa režīmā 'gens' vienmēr ir 1
+	auto launchGeneration = [&](size_t, const unsigned char *in, unsigned char *out, cudaStream_t stream) {
+		for (size_t first = 0; first < boards.size(); first += ENSEMBLE_MAX_GRID_Z)
+		{
+			const unsigned count = static_cast<unsigned>(std::min(ENSEMBLE_MAX_GRID_Z, boards.size() - first));
+			golEnsembleKernel<Rule><<<dim3(gridX, gridY, count), blockSize, 0, stream>>>(in, out, deviceExtents,
+																						  static_cast<int>(first));
+		}
+	};
 
 	double totalTime = 0;
 
 	unsigned char *currentInput = deviceInput;
 	unsigned char *currentOutput = deviceOutput;
 
-	for (size_t step = 0; step < steps; step++)
+	if (options.async)
 	{
+		runStepsAsync(launchGeneration, currentInput, currentOutput, steps, 1, totalTime, logger);
+	}
+	else
+	{
+		for (size_t step = 0; step < steps; step++)
+		{
+			CUDA_CHECK(cudaEventRecord(startEvent));
 
-		CUDA_CHECK(cudaEventRecord(startEvent));
-
-		golMultiStepKernel<<<gridDim, blockSize>>>(currentInput, currentOutput);
+			launchGeneration(1, currentInput, currentOutput, 0);
 
-		CUDA_CHECK(cudaEventRecord(endEvent));
-		CUDA_CHECK(cudaEventSynchronize(endEvent));
+			CUDA_CHECK(cudaEventRecord(endEvent));
+			CUDA_CHECK(cudaEventSynchronize(endEvent));
 
-		CUDA_CHECK(cudaGetLastError());
+			CUDA_CHECK(cudaGetLastError());
 
-		float kernelExecTime = 0;
-		CUDA_CHECK(cudaEventElapsedTime(&kernelExecTime, startEvent, endEvent));
-		logger.log("kernel exec time", kernelExecTime);
-		totalTime += kernelExecTime;
+			float kernelExecTime = 0;
+			CUDA_CHECK(cudaEventElapsedTime(&kernelExecTime, startEvent, endEvent));
+			logger.log("kernel exec time", kernelExecTime);
+			totalTime += kernelExecTime;
 
-		std::swap(currentInput, currentOutput);
+			std::swap(currentInput, currentOutput);
+		}
 	}
 
 	logger.log("total kernel exec time", totalTime);
 
+	// visi režģi tiek izrēķināti vienos un tajos pašos izsaukumos, tāpēc katra režģa ātrums ir tā šūnu skaits
+	// pret kopējo kodolu laiku, un kopējais ātrums ir visu režģu šūnu summa pret to pašu laiku
+	logger.log("ensemble boards", static_cast<double>(boards.size()));
+
+	if (totalTime > 0)
+	{
+		const double seconds = totalTime / 1000.0;
+		logger.log("aggregate cells per second", static_cast<double>(totalCells) * steps / seconds);
+
+		for (const EnsembleBoard &board : boards)
+		{
+			logger.log(board.name + " cells per second", static_cast<double>(board.cells.size()) * steps / seconds);
+		}
+	}
+
 	start = std::chrono::steady_clock::now();
 
 	CUDA_CHECK(cudaEventRecord(startEvent));
-	// ņemot vērā pēdējo std::swap ar buferiem, pēdējā izeja atrodas input bufeŗi
-	CUDA_CHECK(cudaMemcpy(hostPinnedOutput, currentInput, gridSize * sizeof(unsigned char), cudaMemcpyDeviceToHost));
+	// ņemot vērā pēdējo std::swap ar buferiem, pēdējā izeja atrodas input buferī
+	CUDA_CHECK(cudaMemcpy(hostPinned, currentInput, totalCells, cudaMemcpyDeviceToHost));
 	CUDA_CHECK(cudaEventRecord(transferEvent));
 	CUDA_CHECK(cudaEventSynchronize(transferEvent));
 
 	float transferBackTime = 0;
 	CUDA_CHECK(cudaEventElapsedTime(&transferBackTime, startEvent, transferEvent));
-
 	logger.log("device-to-host transfer time", transferBackTime);
 
-	std::memcpy(outputGrid.data(), hostPinnedOutput, gridSize * sizeof(unsigned char));
+	for (size_t i = 0; i < boards.size(); i++)
+	{
+		std::memcpy(boards[i].cells.data(), hostPinned + extents[i].offset, boards[i].cells.size());
+	}
 
 	end = std::chrono::steady_clock::now();
 	logger.chronoLog("total device-to-host transfer time", start, end);
@@ -290,68 +2005,213 @@ void GameOfLifeStep(std::vector<unsigned char> &grid, std::vector<unsigned char>
 	CUDA_CHECK(cudaEventDestroy(transferEvent));
 	CUDA_CHECK(cudaEventDestroy(startEvent));
 	CUDA_CHECK(cudaEventDestroy(endEvent));
-	CUDA_CHECK(cudaFreeHost(hostPinnedInput));
-	CUDA_CHECK(cudaFreeHost(hostPinnedOutput));
+	CUDA_CHECK(cudaFreeHost(hostPinned));
 	CUDA_CHECK(cudaFree(deviceInput));
 	CUDA_CHECK(cudaFree(deviceOutput));
+	CUDA_CHECK(cudaFree(deviceExtents));
 }
 
-int main(int argc, char *argv[])
+struct RuleMasks
+{
+	unsigned birth;
+	unsigned survival;
+};
+
+// likumi, kuriem tiek kompilēti kodoli (katram ar mirušu un ar toroidālu robežu), citus --rule likumus šī versija
+// nepieņem, jo katrs likums pavairo kompilējamo kodolu skaitu
+constexpr RuleMasks COMPILED_RULES[] = {
+	{CONWAY_BIRTH_MASK, CONWAY_SURVIVAL_MASK}, // Conway B3/S23
+	{0x048, 0x00C},                            // HighLife B36/S23
+	{0x1C8, 0x1D8},                            // Day & Night B3678/S34678
+	{0x004, 0x000},                            // Seeds B2/S
+	{0x008, 0x1FF},                            // Life without Death B3/S012345678
+};
+
+// izsauc 'run' ar --rule un --wrap atbilstošu LifeRule vērtību, atgriež false, ja šis likums nav kompilēts
+template <size_t RuleIdx = 0, typename Run>
+bool withCompiledRule(const GolOptions &options, Run &&run)
+{
+	if constexpr (RuleIdx == std::size(COMPILED_RULES))
+	{
+		return false;
+	}
+	else
+	{
+		constexpr RuleMasks masks = COMPILED_RULES[RuleIdx];
+
+		if (options.birthMask != masks.birth || options.survivalMask != masks.survival)
+		{
+			return withCompiledRule<RuleIdx + 1>(options, run);
+		}
+
+		if (options.wrap)
+		{
+			run(LifeRule<masks.birth, masks.survival, true>{});
+		}
+		else
+		{
+			run(LifeRule<masks.birth, masks.survival, false>{});
+		}
+
+		return true;
+	}
+}
+
+// CUDA versija kopīgajam resursdatora cauruļvadam (golHost.h)
+struct CudaBackend
 {
-	if (argc == 5)
+	static constexpr const char *platform = "CUDA";
+	using PackedWord = cuda::std::uint64_t;
+
+	BenchmarkLogger &logger;
+
+	explicit CudaBackend(BenchmarkLogger &logger) : logger(logger)
 	{
-		const std::string inputFileName = argv[1];
-		const std::string outputFileName = argv[2];
-		const size_t gameSteps = std::stoll(argv[3]);
-		const std::string logFileName = argv[4];
+		CUDA_CHECK(cudaSetDevice(0));
+	}
 
-		BenchmarkLogger logger(logFileName, "CUDA");
+	static bool validate(const GolOptions &options)
+	{
+		// vektorizētais kodols gol_vec16 ir tikai OpenCL versijā
+		if (options.vectorized)
+		{
+			std::cerr << "--vectorized is only implemented by the OpenCL backend\n";
+			return false;
+		}
 
-		auto start = std::chrono::steady_clock::now();
+		if (!withCompiledRule(options, [](auto) {}))
+		{
+			std::cerr << "Rule " << ruleString(options.birthMask, options.survivalMask)
+					  << " is not compiled into this build, available rules:";
+			for (const RuleMasks &masks : COMPILED_RULES)
+			{
+				std::cerr << ' ' << ruleString(masks.birth, masks.survival);
+			}
+			std::cerr << '\n';
+			return false;
+		}
 
-		size_t width;
-		size_t height;
-		std::vector<unsigned char> grid = loadGridFromFile(inputFileName, width, height);
+		return true;
+	}
 
-		auto end = std::chrono::steady_clock::now();
+	template <typename Cell>
+	void run(const MappedGridFile &gridFile, GridFileWriter &writer, std::vector<Cell> &outputGrid, size_t steps,
+			 const GolOptions &options)
+	{
+		constexpr bool packed = std::is_same<Cell, cuda::std::uint64_t>::value;
 
-		logger.chronoLog("grid load time", start, end);
+		withCompiledRule(options, [&](auto rule) {
+			using Rule = decltype(rule);
 
-		std::vector<unsigned char> outputGrid;
+			if (options.streamMiB > 0)
+			{
+				// straumēšana ir pieejama tikai baitu režģim bez toroidālās robežas, to jau pārbaudīja parseGolOptions
+				if constexpr (!packed && !Rule::wrap)
+				{
+					GameOfLifeStreamed<Rule>(gridFile, outputGrid, steps, options, logger);
+				}
+			}
+			else if (options.devices != 1)
+			{
+				// arī vairāku ierīču režīms ir pieejams tikai baitu režģim bez toroidālās robežas
+				if constexpr (!packed && !Rule::wrap)
+				{
+					GameOfLifeMultiDevice<Rule>(gridFile, outputGrid, steps, options, logger);
+				}
+			}
+			else
+			{
+				GameOfLifeStep<Cell, Rule>(gridFile, writer, steps, options, logger);
+			}
+		});
+	}
 
-		auto cudaInitStart = std::chrono::steady_clock::now();
+	void runEnsemble(std::vector<EnsembleBoard> &boards, size_t steps, const GolOptions &options)
+	{
+		withCompiledRule(options, [&](auto rule) {
+			GameOfLifeEnsemble<decltype(rule)>(boards, steps, options, logger);
+		});
+	}
+};
 
+// soļu saskarne salīdzināšanas programmai: likums un režģa veids tiek izvēlēti allocate, kad zināmas opcijas
+class CudaGolBackend : public GolBackend
+{
+  public:
+	explicit CudaGolBackend(BenchmarkLogger &logger) : logger(logger)
+	{
 		CUDA_CHECK(cudaSetDevice(0));
+	}
 
-		auto cudaInitEnd = std::chrono::steady_clock::now();
+	const char *platform() const override
+	{
+		return CudaBackend::platform;
+	}
 
-		logger.chronoLog("cuda init time", cudaInitStart, cudaInitEnd);
+	void allocate(size_t width, size_t height, const GolOptions &options) override
+	{
+		// iemeslu izvada validate
+		if (!CudaBackend::validate(options))
+		{
+			throw std::runtime_error(std::string("Options not supported by the ") + platform() + " backend");
+		}
 
-		unsigned long long w = static_cast<unsigned long long>(width);
-		unsigned long long h = static_cast<unsigned long long>(height);
+		withCompiledRule(options, [&](auto rule) {
+			using Rule = decltype(rule);
 
-		std::cout << "Processing a " << width << "x" << height << " grid with " << gameSteps << " steps\n";
+			if (options.packed)
+			{
+				grid = std::make_unique<CudaGolGrid<cuda::std::uint64_t, Rule>>(logger);
+			}
+			else
+			{
+				grid = std::make_unique<CudaGolGrid<unsigned char, Rule>>(logger);
+			}
+		});
 
-		auto GoLStart = std::chrono::steady_clock::now();
+		grid->allocate(width, height, options);
+	}
 
-		GameOfLifeStep(grid, outputGrid, w, h, gameSteps, logger);
+	void upload(const void *cells) override
+	{
+		grid->upload(cells);
+	}
 
-		auto GoLEnd = std::chrono::steady_clock::now();
+	void step(size_t generations) override
+	{
+		grid->step(generations);
+	}
 
-		logger.chronoLog("total game of life time", GoLStart, GoLEnd);
+	void download(void *cells) override
+	{
+		grid->download(cells);
+	}
 
-		auto writeGridToFileStart = std::chrono::steady_clock::now();
+	GolTiming timing() const override
+	{
+		return grid->timing();
+	}
 
-		writeGridToFile(outputGrid, width, height, outputFileName);
+  private:
+	BenchmarkLogger &logger;
+	std::unique_ptr<GolBackend> grid;
+};
 
-		auto writeGridToFileEnd = std::chrono::steady_clock::now();
+std::unique_ptr<GolBackend> makeCudaGolBackend(BenchmarkLogger &logger)
+{
+	return std::make_unique<CudaGolBackend>(logger);
+}
 
-		logger.chronoLog("write output grid to file time", writeGridToFileStart, writeGridToFileEnd);
-	}
-	else
+// salīdzināšanas programma golcompare šo failu kompilē ar GOL_BACKEND_LIBRARY un izmanto tikai makeCudaGolBackend
+#ifndef GOL_BACKEND_LIBRARY
+int main(int argc, char *argv[])
+{
+	if (argc >= 5)
 	{
-		std::cout << "Correct program usage:\n"
-				  << "\t\t" << argv[0] << " <grid file path> <output grid file path> <game steps> <log file path>\n";
+		return runGolMain<CudaBackend>(argc, argv);
 	}
+
+	printGolUsage(argv[0]);
 	return 0;
 }
+#endif
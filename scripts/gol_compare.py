@@ -0,0 +1,47 @@
+# Skripts, kas palaiž salīdzināšanas programmu golcompare uz viena režģa, to vajadzības gadījumā uzģenerējot
+# golcompare pati vienā procesā izpilda visas iekompilētās versijas (CPU, OpenCL un CUDA vai HIP) uz viena un tā paša
+# režģa atmiņā, pārbauda, ka to izejas režģi sakrīt, un raksta vienu kopīgu CSV žurnālu
+# CUDA un HIP versijas vienā golcompare būvē nevar būt (golcompare/CMakeLists.txt), otrai vajadzīga otra būve
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+from gridfile_gen import generate_write_grid
+
+def main():
+    parser = argparse.ArgumentParser(description="Run the golcompare driver on one grid: every backend compiled into "
+                                                 "it runs on the same in-memory grid, the outputs are verified to "
+                                                 "match and one combined CSV is written.")
+    parser.add_argument("driver", help="GameOfLifeCompare executable")
+    parser.add_argument("--grid", help="grid file shared by all backends, a random grid is generated if omitted")
+    parser.add_argument("--size", type=int, default=4096, help="width and height of the generated random grid")
+    parser.add_argument("--steps", type=int, default=100, help="game steps per backend")
+    parser.add_argument("--log", default="gol_compare.csv", help="combined CSV log")
+    parser.add_argument("--extra", nargs=argparse.REMAINDER, default=[],
+                        help="options passed to the driver, for example --packed or --block-steps 4")
+
+    args = parser.parse_args()
+
+    driver = os.path.abspath(args.driver)
+    log_file = os.path.abspath(args.log)
+
+    # žurnāls tiek papildināts, tāpēc iepriekšējās palaišanas ieraksti tiek izdzēsti
+    if os.path.exists(log_file):
+        os.remove(log_file)
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        grid_file = os.path.abspath(args.grid) if args.grid else os.path.join(tmp_dir, "grid.txt")
+        if not args.grid:
+            generate_write_grid(args.size, args.size, grid_file)
+
+        # OpenCL versija meklē kernels/ direktoriju blakus programmai, tāpēc tā tiek palaista savā direktorijā
+        result = subprocess.run([driver, grid_file, str(args.steps), log_file] + args.extra,
+                                cwd=os.path.dirname(driver) or None)
+
+    sys.exit(result.returncode)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,114 @@
+# Skripts, kas pārveido Game of Life režģa failu starp teksta ('0'/'1' rindas) un bināro (.golb) formātu
+# Binārā formāta apraksts atrodas golcommon/gridIO.cpp (BinaryGridHeader)
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"GOLB"
+VERSION = 1
+ENCODING_RAW = 0
+ENCODING_ZSTD = 1
+
+# galvene: signatūra, versija, kodējums, platums, augstums, rindas gabalā, gabalu skaits
+HEADER = struct.Struct("<4sHHQQQQ")
+CHUNK_BYTES = 1 << 20
+CELLS_PER_WORD = 64
+
+
+def words_per_row(width):
+    return (width + CELLS_PER_WORD - 1) // CELLS_PER_WORD
+
+
+def pack_row(line, row_bytes):
+    # šūna x atrodas bitā x (mazākais bits ir kreisākā šūna), tāpēc rindu apgriež pirms int(..., 2)
+    return int(line[::-1], 2).to_bytes(row_bytes, "little") if line else bytes(row_bytes)
+
+
+def unpack_row(data, width):
+    return format(int.from_bytes(data, "little"), "0%db" % (len(data) * 8))[::-1][:width]
+
+
+def zstd_module():
+    try:
+        import zstandard
+    except ImportError:
+        sys.exit("Error: zstd chunks need the 'zstandard' Python package (pip install zstandard)")
+    return zstandard
+
+
+def text_to_binary(input_file, output_file, compress):
+    with open(input_file, "r") as f:
+        lines = [line.rstrip("\n") for line in f if line.strip("\n")]
+
+    width = len(lines[0]) if lines else 0
+    height = len(lines)
+
+    for idx, line in enumerate(lines):
+        if len(line) != width:
+            sys.exit("Error: invalid line length at line idx: %d" % idx)
+
+    row_bytes = words_per_row(width) * 8
+    rows_per_chunk = max(1, CHUNK_BYTES // max(1, row_bytes))
+    compressor = zstd_module().ZstdCompressor(level=1) if compress else None
+
+    chunks = []
+    for start in range(0, height, rows_per_chunk):
+        chunk = b"".join(pack_row(line, row_bytes) for line in lines[start:start + rows_per_chunk])
+        chunks.append(compressor.compress(chunk) if compressor else chunk)
+
+    with open(output_file, "wb") as f:
+        f.write(HEADER.pack(MAGIC, VERSION, ENCODING_ZSTD if compress else ENCODING_RAW, width, height,
+                            rows_per_chunk, len(chunks)))
+        f.write(struct.pack("<%dQ" % len(chunks), *(len(chunk) for chunk in chunks)))
+        for chunk in chunks:
+            f.write(chunk)
+
+
+def binary_to_text(input_file, output_file):
+    with open(input_file, "rb") as f:
+        data = f.read()
+
+    magic, version, encoding, width, height, rows_per_chunk, chunk_count = HEADER.unpack_from(data, 0)
+
+    if version != VERSION:
+        sys.exit("Error: unsupported binary grid version: %d" % version)
+
+    decompressor = zstd_module().ZstdDecompressor() if encoding == ENCODING_ZSTD else None
+    row_bytes = words_per_row(width) * 8
+
+    sizes = struct.unpack_from("<%dQ" % chunk_count, data, HEADER.size)
+    offset = HEADER.size + 8 * chunk_count
+
+    with open(output_file, "w", buffering=1024*1024) as f:
+        for chunk_idx, size in enumerate(sizes):
+            chunk = data[offset:offset + size]
+            offset += size
+
+            rows = min(rows_per_chunk, height - chunk_idx * rows_per_chunk)
+            if decompressor:
+                chunk = decompressor.decompress(chunk, max_output_size=rows * row_bytes)
+
+            for row in range(rows):
+                f.write(unpack_row(chunk[row * row_bytes:(row + 1) * row_bytes], width) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a Game Of Life grid between the text and binary formats. "
+                                                 "The direction is chosen by the input file's format.")
+    parser.add_argument("input_file", help="Text or binary grid file")
+    parser.add_argument("output_file", help="Path to the converted grid file")
+    parser.add_argument("--zstd", action="store_true", help="Compress binary chunks with zstd")
+
+    args = parser.parse_args()
+
+    with open(args.input_file, "rb") as f:
+        is_binary = f.read(len(MAGIC)) == MAGIC
+
+    if is_binary:
+        binary_to_text(args.input_file, args.output_file)
+    else:
+        text_to_binary(args.input_file, args.output_file, args.zstd)
+
+if __name__ == "__main__":
+    main()
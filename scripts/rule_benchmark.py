@@ -0,0 +1,68 @@
+# Skripts, kas salīdzina Game of Life kodolu izpildes laiku dažādiem --rule likumiem un --wrap robežai
+# Ar --baseline var norādīt programmu, kas kompilēta pirms likumu ieviešanas (Conway kodols bez šabloniem),
+# lai pārliecinātos, ka Conway likums ar mirušu robežu nav kļuvis lēnāks
+
+import argparse
+import csv
+import os
+import statistics
+import subprocess
+import tempfile
+
+from gridfile_gen import generate_write_grid
+
+RULES = ["B3/S23", "B36/S23", "B3678/S34678", "B2/S", "B3/S012345678"]
+
+def run_once(executable, grid_file, steps, options, cwd):
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        output_file = os.path.join(tmp_dir, "out.txt")
+        log_file = os.path.join(tmp_dir, "log.csv")
+
+        subprocess.run([executable, grid_file, output_file, str(steps), log_file] + options,
+                       cwd=cwd, check=True, stdout=subprocess.DEVNULL)
+
+        with open(log_file, newline="") as f:
+            for row in csv.DictReader(f):
+                if row["description"] == "total kernel exec time":
+                    return float(row["time_ms"])
+
+    raise RuntimeError("total kernel exec time missing from the log of " + executable)
+
+def measure(executable, grid_file, steps, options, repeats, cwd):
+    times = [run_once(executable, grid_file, steps, options, cwd) for _ in range(repeats)]
+    return statistics.median(times)
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark Life-like rules and boundary modes of a GoL backend.")
+    parser.add_argument("executable", help="GoL backend executable (GameOfLifeCuda, GameOfLifeHip or the OpenCL GameOfLife)")
+    parser.add_argument("--baseline", help="executable built before --rule/--wrap existed, run with no options")
+    parser.add_argument("--size", type=int, default=4096, help="width and height of the random grid")
+    parser.add_argument("--steps", type=int, default=200, help="game steps per run")
+    parser.add_argument("--repeats", type=int, default=5, help="runs per combination, the median is reported")
+    parser.add_argument("--cwd", default=None, help="working directory for the runs (OpenCL looks for kernels/)")
+    parser.add_argument("--extra", nargs=argparse.REMAINDER, default=[],
+                        help="options passed to every run, for example --packed or --block-steps 4")
+
+    args = parser.parse_args()
+
+    executable = os.path.abspath(args.executable)
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        grid_file = os.path.join(tmp_dir, "grid.txt")
+        generate_write_grid(args.size, args.size, grid_file)
+
+        print(f"{'rule':<16}{'boundary':<10}{'median ms':>12}")
+
+        if args.baseline:
+            baseline = measure(os.path.abspath(args.baseline), grid_file, args.steps, args.extra, args.repeats,
+                               args.cwd)
+            print(f"{'baseline':<16}{'dead':<10}{baseline:>12.3f}")
+
+        for rule in RULES:
+            for wrap in (False, True):
+                options = ["--rule", rule] + (["--wrap"] if wrap else []) + args.extra
+                time_ms = measure(executable, grid_file, args.steps, options, args.repeats, args.cwd)
+                print(f"{rule:<16}{'torus' if wrap else 'dead':<10}{time_ms:>12.3f}")
+
+if __name__ == "__main__":
+    main()
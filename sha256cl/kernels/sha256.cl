@@ -28,44 +28,24 @@ __constant uint h5 = 0x9b05688c;
 __constant uint h6 = 0x1f83d9ab;
 __constant uint h7 = 0x5be0cd19;
 
-int sha256(__constant uchar *input, uint length, uint *hash)
-{
-	// ar esošo implementāciju nebūs iespējams iegūt pareizu hešu,
-	// ja input garāks par šo garumu
-	if (length >= 54)
-	{
-		return -1;
-	}
+// garākā parole, kas kopā ar '1' bitu un 64 bitu garumu ietilpst vienā 512 bitu blokā (440 biti)
+#define SINGLE_BLOCK_MAX_LENGTH 55
 
+// apstrādā vienu 512 bitu bloku, 'state' sākumā satur h0-h7 vai iepriekšējā bloka rezultātu
+void sha256_process_chunk(uint *state, const uchar *chunk)
+{
 	uint w[64];
 
-	uchar chunked_input[64] = {0};
-
-	for (int i = 0; i < length; i++)
-	{
-		chunked_input[i] = input[i];
-	}
-
-	// pēc prasībām ir jāpieliek '1' bits, pārējās baita vērtības attiecīgi ir nulles, atbilstoši SHA mainīgā 'K'
-	chunked_input[length] = 0x80;
-
-	// padding galā jāpieliek ziņojuma garums kā 64 bitu big-endian skaitlis
-	ulong bitlen = (ulong)length * 8;
-	for (int i = 0; i < 8; i++)
-	{
-		chunked_input[63 - i] = (uchar)((bitlen >> (8 * i)) & 0xFF);
-	}
-
 	// iekopē visus 512 bitus iekš w masīva (512/32 = 16 vērtības)
 	// baiti jāieliek iekš 32 bitu vārdiem, lai pirmais baits būtu pirmais (skatoties no kreisās uz labo pusi),
 	// tas jāpabīda pa kreisi pa 24, nākamie pa 16, 8, 0
 	// attiecīgā solī nākamie 'mazāksvarīgie' biti ir nulles, tāpēc baitus šos baitus var konkatenēt ar OR (|) operatoru
 	for (int i = 0; i < 16; i++)
 	{
-		w[i] = (uint)chunked_input[i * 4 + 0] << 24;
-		w[i] |= (uint)chunked_input[i * 4 + 1] << 16;
-		w[i] |= (uint)chunked_input[i * 4 + 2] << 8;
-		w[i] |= (uint)chunked_input[i * 4 + 3];
+		w[i] = (uint)chunk[i * 4 + 0] << 24;
+		w[i] |= (uint)chunk[i * 4 + 1] << 16;
+		w[i] |= (uint)chunk[i * 4 + 2] << 8;
+		w[i] |= (uint)chunk[i * 4 + 3];
 	}
 
 	// aizpilda pārējas 'w' vērtības
@@ -74,14 +54,14 @@ int sha256(__constant uchar *input, uint length, uint *hash)
 		w[i] = w[i - 16] + SS0(w[i - 15]) + w[i - 7] + SS1(w[i - 2]);
 	}
 
-	uint a = h0;
-	uint b = h1;
-	uint c = h2;
-	uint d = h3;
-	uint e = h4;
-	uint f = h5;
-	uint g = h6;
-	uint h = h7;
+	uint a = state[0];
+	uint b = state[1];
+	uint c = state[2];
+	uint d = state[3];
+	uint e = state[4];
+	uint f = state[5];
+	uint g = state[6];
+	uint h = state[7];
 
 	for (int i = 0; i < 64; i++)
 	{
@@ -97,18 +77,172 @@ int sha256(__constant uchar *input, uint length, uint *hash)
 		a = temp1 + temp2;
 	}
 
-	hash[0] = a + h0;
-	hash[1] = b + h1;
-	hash[2] = c + h2;
-	hash[3] = d + h3;
-	hash[4] = e + h4;
-	hash[5] = f + h5;
-	hash[6] = g + h6;
-	hash[7] = h + h7;
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+	state[5] += f;
+	state[6] += g;
+	state[7] += h;
+}
+
+int sha256(__constant uchar *input, uint length, uint *hash)
+{
+	// garākas paroles apstrādā sha256_multi_block, resursdators tās šim kodolam nepadod
+	if (length > SINGLE_BLOCK_MAX_LENGTH)
+	{
+		return -1;
+	}
+
+	uchar chunked_input[64] = {0};
+
+	for (int i = 0; i < length; i++)
+	{
+		chunked_input[i] = input[i];
+	}
+
+	// pēc prasībām ir jāpieliek '1' bits, pārējās baita vērtības attiecīgi ir nulles, atbilstoši SHA mainīgā 'K'
+	chunked_input[length] = 0x80;
+
+	// padding galā jāpieliek ziņojuma garums kā 64 bitu big-endian skaitlis
+	ulong bitlen = (ulong)length * 8;
+	for (int i = 0; i < 8; i++)
+	{
+		chunked_input[63 - i] = (uchar)((bitlen >> (8 * i)) & 0xFF);
+	}
+
+	hash[0] = h0;
+	hash[1] = h1;
+	hash[2] = h2;
+	hash[3] = h3;
+	hash[4] = h4;
+	hash[5] = h5;
+	hash[6] = h6;
+	hash[7] = h7;
+
+	sha256_process_chunk(hash, chunked_input);
 
 	return 0;
 }
 
+// vairāku bloku variants parolēm, kas neietilpst vienā blokā, ziņojums tiek apstrādāts pa 512 bitu blokiem
+// '1' bits un ziņojuma garums nonāk pēdējā blokā vai, ja tur vairs neietilpst, arī priekšpēdējā
+void sha256_multi_block(__global const uchar *input, uint length, uint *hash)
+{
+	uchar chunk[64];
+
+	const ulong bitlen = (ulong)length * 8;
+	const uint block_count = (length + 8) / 64 + 1;
+
+	hash[0] = h0;
+	hash[1] = h1;
+	hash[2] = h2;
+	hash[3] = h3;
+	hash[4] = h4;
+	hash[5] = h5;
+	hash[6] = h6;
+	hash[7] = h7;
+
+	for (uint block = 0; block < block_count; block++)
+	{
+		// ziņojuma baiti, aiz tiem '1' bits un nulles
+		for (int i = 0; i < 64; i++)
+		{
+			uint pos = block * 64 + i;
+			chunk[i] = pos < length ? input[pos] : (pos == length ? 0x80 : 0);
+		}
+
+		// pēdējā bloka galā ziņojuma garums kā 64 bitu big-endian skaitlis
+		if (block == block_count - 1)
+		{
+			for (int i = 0; i < 8; i++)
+			{
+				chunk[63 - i] = (uchar)((bitlen >> (8 * i)) & 0xFF);
+			}
+		}
+
+		sha256_process_chunk(hash, chunk);
+	}
+}
+
+// priekšfiltra otrās pozīcijas reizinātājs, jāsakrīt ar BLOOM_MULTIPLIER no src/targetTable.h
+#define BLOOM_MULTIPLIER 0x9E3779B1u
+
+bool bloom_test(__global const uint *bloom, uint position)
+{
+	return (bloom[position >> 5] & (1u << (position & 31))) != 0;
+}
+
+// meklē hash tabulā un atgriež tā indeksu vai -1, tāpat kā TargetTable::find
+// ar priekšfiltru lielākā daļa nesakritību tiek noraidītas ar divām filtra nolasīšanām, tāpēc caurlaidspēja
+// gandrīz nav atkarīga no hash skaita, binārā meklēšana tiek veikta tikai tiem, kas izgājuši filtram cauri
+int find_target(const uint *hash, __global const uint *targets, uint target_count, __global const uint *bloom,
+				uint bloom_shift)
+{
+	uint first = hash[0];
+
+	if (bloom_shift != 0 &&
+		(!bloom_test(bloom, first >> bloom_shift) || !bloom_test(bloom, (first * BLOOM_MULTIPLIER) >> bloom_shift)))
+	{
+		return -1;
+	}
+
+	// pirmais hash, kura pirmais vārds nav mazāks par meklējamo
+	uint low = 0;
+	uint high = target_count;
+
+	while (low < high)
+	{
+		uint mid = (low + high) / 2;
+
+		if (targets[mid * 8] < first)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	for (uint t = low; t < target_count && targets[t * 8] == first; t++)
+	{
+		bool match = true;
+
+		for (int i = 1; i < 8; i++)
+		{
+			if (targets[t * 8 + i] != hash[i])
+			{
+				match = false;
+				break;
+			}
+		}
+
+		if (match)
+		{
+			return t;
+		}
+	}
+
+	return -1;
+}
+
+// pievieno atrasto paroli buferim, vieta tiek rezervēta ar atomāru saskaitīšanu, tāpēc var ierakstīt visas sakritības
+// atgriež rezervēto vietu, tā var būt ārpus bufera, ja buferis ir pilns
+uint append_match(uint pw_idx, int target_idx, __global uint2 *matches, uint match_capacity,
+				  __global atomic_uint *match_count)
+{
+	uint slot = atomic_fetch_add(match_count, 1);
+
+	if (slot < match_capacity)
+	{
+		matches[slot] = (uint2)(pw_idx, target_idx);
+	}
+
+	return slot;
+}
+
 size_t current_pw_size(__constant uint *offsets, uint password_count, uint char_count, uint idx)
 {
 	// paroļu buferis nesatur \0 simbolus, tāpēc jānosaka paroles garums pēc offsetiem
@@ -124,7 +258,9 @@ size_t current_pw_size(__constant uint *offsets, uint password_count, uint char_
 }
 
 __kernel void sha256_crack(__constant uchar *passwords, __constant uint *offsets, uint password_count, uint char_count,
-						   __constant uint *target_hash, __global atomic_int *cracked_idx)
+						   __global const uint *targets, uint target_count, __global const uint *bloom,
+						   uint bloom_shift, __global uint2 *matches, uint match_capacity,
+						   __global atomic_uint *match_count)
 {
 	size_t idx = get_global_id(0);
 
@@ -147,19 +283,196 @@ __kernel void sha256_crack(__constant uchar *passwords, __constant uint *offsets
 		return;
 	}
 
-	bool match = true;
+	int target_idx = find_target(hash, targets, target_count, bloom, bloom_shift);
 
-	for (int i = 0; i < 8; i++)
+	// sakritības tiek pievienotas kopīgajam buferim, tāpēc meklēšana turpinās arī pēc pirmās atrastās paroles
+	if (target_idx != -1)
+	{
+		append_match(idx, target_idx, matches, match_capacity, match_count);
+	}
+}
+
+// garo paroļu kodols, izsaukts atsevišķi katrai paroļu grupai [first_idx, first_idx + bucket_count) ar vienādu bloku
+// skaitu, tāpēc visi vienas darba grupas pavedieni izpilda vienādu bloku skaitu un nedivergē
+// garo paroļu buferis var būt lielāks par __constant atmiņu, tāpēc tas atrodas __global atmiņā
+__kernel void sha256_crack_multi_block(__global const uchar *passwords, __global const uint *offsets,
+									   uint password_count, uint char_count, uint first_idx, uint bucket_count,
+									   __global const uint *targets, uint target_count, __global const uint *bloom,
+									   uint bloom_shift, __global uint2 *matches, uint match_capacity,
+									   __global atomic_uint *match_count)
+{
+	size_t local_idx = get_global_id(0);
+
+	if (local_idx >= bucket_count)
+	{
+		return;
+	}
+
+	uint idx = first_idx + local_idx;
+
+	// pēdējai parolei nav nākamais offsets, tāpēc jāizmanto kopējais simbolu skaits
+	uint pw_size = (idx < password_count - 1 ? offsets[idx + 1] : char_count) - offsets[idx];
+
+	uint hash[8];
+
+	sha256_multi_block(passwords + offsets[idx], pw_size, hash);
+
+	int target_idx = find_target(hash, targets, target_count, bloom, bloom_shift);
+
+	if (target_idx != -1)
+	{
+		append_match(idx, target_idx, matches, match_capacity, match_count);
+	}
+}
+
+// neapstrādātu gabalu rindu sadalīšana: katra darba grupa apstrādā get_local_size(0) * SPLIT_BYTES_PER_ITEM baitu
+// gabala daļu, vispirms tiek saskaitīti rindu sākumi katrā daļā, tad daļu skaitiem tiek aprēķināta prefiksa summa un
+// visbeidzot katrs pavediens ieraksta savu rindu sākumus vietā, ko nosaka daļas un grupas prefiksa summas
+// (stream compaction)
+// darba grupas izmēru izvēlas resursdators (--autotune), tāpēc visi trīs kodoli jāizsauc ar vienu izmēru un 'scratch'
+// ir lokālās atmiņas arguments ar get_local_size(0) uint
+#define SPLIT_BYTES_PER_ITEM 16
+
+// rinda sākas gabala sākumā un aiz katra '\n', izņemot gabala beigas
+bool is_line_start(__global const uchar *chunk, uint pos, uint chunk_bytes)
+{
+	return pos < chunk_bytes && (pos == 0 || chunk[pos - 1] == '\n');
+}
+
+uint item_line_start_count(__global const uchar *chunk, uint chunk_bytes)
+{
+	uint begin = get_global_id(0) * SPLIT_BYTES_PER_ITEM;
+	uint count = 0;
+
+	for (uint pos = begin; pos < begin + SPLIT_BYTES_PER_ITEM; pos++)
+	{
+		count += is_line_start(chunk, pos, chunk_bytes);
+	}
+
+	return count;
+}
+
+// darba grupas ekskluzīvā prefiksa summa lokālajā atmiņā (Hillis-Steele), jāizsauc visiem grupas pavedieniem
+// 'total' saņem visu grupas vērtību summu
+uint group_exclusive_scan(uint value, __local uint *scratch, uint *total)
+{
+	uint t = get_local_id(0);
+
+	scratch[t] = value;
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for (uint offset = 1; offset < get_local_size(0); offset *= 2)
 	{
-		if (hash[i] != target_hash[i])
+		uint add = t >= offset ? scratch[t - offset] : 0;
+		barrier(CLK_LOCAL_MEM_FENCE);
+
+		scratch[t] += add;
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+
+	*total = scratch[get_local_size(0) - 1];
+	uint result = scratch[t] - value;
+
+	// 'scratch' drīkst pārrakstīt tikai tad, kad visi pavedieni ir nolasījuši rezultātu
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	return result;
+}
+
+__kernel void count_line_starts(__global const uchar *chunk, uint chunk_bytes, __global uint *tile_counts,
+								__local uint *scratch)
+{
+	uint total;
+	group_exclusive_scan(item_line_start_count(chunk, chunk_bytes), scratch, &total);
+
+	if (get_local_id(0) == 0)
+	{
+		tile_counts[get_group_id(0)] = total;
+	}
+}
+
+// viena darba grupa pārvērš daļu skaitus par to pirmās rindas indeksiem un ieraksta kopējo rindu skaitu
+__kernel void scan_tile_counts(__global uint *tile_counts, uint tile_count, __global uint *line_count,
+							   __local uint *scratch)
+{
+	uint carry = 0;
+
+	for (uint base = 0; base < tile_count; base += get_local_size(0))
+	{
+		uint idx = base + get_local_id(0);
+
+		uint total;
+		uint offset = group_exclusive_scan(idx < tile_count ? tile_counts[idx] : 0, scratch, &total);
+
+		if (idx < tile_count)
 		{
-			match = false;
-			break;
+			tile_counts[idx] = carry + offset;
 		}
+
+		carry += total;
 	}
 
-	if (match)
+	if (get_local_id(0) == 0)
 	{
-		atomic_store(cracked_idx, idx);
+		*line_count = carry;
+	}
+}
+
+__kernel void write_line_starts(__global const uchar *chunk, uint chunk_bytes, __global const uint *tile_offsets,
+								__global uint *line_starts, __local uint *scratch)
+{
+	uint total;
+	uint line_idx = group_exclusive_scan(item_line_start_count(chunk, chunk_bytes), scratch, &total);
+	line_idx += tile_offsets[get_group_id(0)];
+
+	uint begin = get_global_id(0) * SPLIT_BYTES_PER_ITEM;
+
+	for (uint pos = begin; pos < begin + SPLIT_BYTES_PER_ITEM; pos++)
+	{
+		if (is_line_start(chunk, pos, chunk_bytes))
+		{
+			line_starts[line_idx++] = pos;
+		}
+	}
+}
+
+// jaucē rindas tieši neapstrādātajā gabalā, rindu skaits tiek nolasīts no ierīces atmiņas, tāpēc NDRange ir fiksēta
+// izmēra un pavedieni apstrādā rindas ar soli, kas vienāds ar visu pavedienu skaitu
+// gabals var būt lielāks par __constant atmiņu, tāpēc visas rindas tiek jaucētas ar sha256_multi_block
+// sakritībai tiek saglabāts rindas indekss gabalā un rindas sākums, lai resursdators varētu nolasīt paroli
+__kernel void sha256_crack_lines(__global const uchar *chunk, uint chunk_bytes, __global const uint *line_starts,
+								 __global const uint *line_count, __global const uint *targets, uint target_count,
+								 __global const uint *bloom, uint bloom_shift, __global uint2 *matches,
+								 __global uint *match_starts, uint match_capacity, __global atomic_uint *match_count)
+{
+	uint count = *line_count;
+
+	for (uint idx = get_global_id(0); idx < count; idx += get_global_size(0))
+	{
+		uint start = line_starts[idx];
+
+		// rinda beidzas pirms nākamās rindas sākuma '\n', pēdējā rinda - gabala beigās vai pirms gala '\n'
+		uint end = idx + 1 < count ? line_starts[idx + 1] - 1 : chunk_bytes - (chunk[chunk_bytes - 1] == '\n');
+
+		if (end > start && chunk[end - 1] == '\r')
+		{
+			end--;
+		}
+
+		uint hash[8];
+
+		sha256_multi_block(chunk + start, end - start, hash);
+
+		int target_idx = find_target(hash, targets, target_count, bloom, bloom_shift);
+
+		if (target_idx != -1)
+		{
+			uint slot = append_match(idx, target_idx, matches, match_capacity, match_count);
+
+			if (slot < match_capacity)
+			{
+				match_starts[slot] = start;
+			}
+		}
 	}
 }
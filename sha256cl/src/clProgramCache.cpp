@@ -0,0 +1,257 @@
+#include "clProgramCache.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+// kešatmiņas faila formāts: signatūra, atslēgas garums un atslēga, ierīču skaits, katrai ierīcei binārā faila
+// garums un saturs, visi garumi ir uint64_t
+static const char CACHE_SIGNATURE[8] = {'C', 'L', 'P', 'C', 'A', 'C', 'H', '1'};
+
+// FNV-1a 64 bitu jaucējfunkcija, izmantota tikai faila nosaukumam, jo pati atslēga tiek pārbaudīta pilnībā
+static uint64_t fnv1a(const std::string &data)
+{
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (unsigned char c : data)
+	{
+		hash ^= c;
+		hash *= 0x100000001B3ull;
+	}
+	return hash;
+}
+
+static std::string deviceInfoString(cl_device_id device, cl_device_info param)
+{
+	size_t size = 0;
+	if (clGetDeviceInfo(device, param, 0, nullptr, &size) != CL_SUCCESS || size == 0)
+	{
+		return "";
+	}
+
+	std::string value(size, '\0');
+	clGetDeviceInfo(device, param, size, value.data(), nullptr);
+
+	// vērtība beidzas ar nulles simbolu
+	value.resize(value.find('\0'));
+	return value;
+}
+
+static void writeU64(std::ostream &out, uint64_t value)
+{
+	out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static bool readU64(std::istream &in, uint64_t &value)
+{
+	return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(value)));
+}
+
+ProgramCache::ProgramCache(std::string directory) : directory(std::move(directory))
+{
+}
+
+std::string ProgramCache::defaultDirectory()
+{
+	const char *directory = std::getenv("CL_PROGRAM_CACHE_DIR");
+	return directory != nullptr ? directory : "kernel_cache";
+}
+
+std::string ProgramCache::cacheKey(const std::vector<cl_device_id> &devices, const std::string &source,
+								   const std::string &buildOptions) const
+{
+	std::ostringstream key;
+
+	for (cl_device_id device : devices)
+	{
+		key << "device=" << deviceInfoString(device, CL_DEVICE_NAME) << '\n'
+			<< "driver=" << deviceInfoString(device, CL_DRIVER_VERSION) << '\n';
+	}
+
+	key << "options=" << buildOptions << '\n' << "source=" << std::hex << fnv1a(source) << '\n';
+
+	return key.str();
+}
+
+std::string ProgramCache::cacheFileName(const std::string &key) const
+{
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(fnv1a(key)));
+	return (std::filesystem::path(directory) / name).string();
+}
+
+bool ProgramCache::loadBinaries(const std::string &key, std::vector<std::vector<unsigned char>> &binaries) const
+{
+	std::ifstream file(cacheFileName(key), std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	char signature[sizeof(CACHE_SIGNATURE)];
+	uint64_t keySize;
+	if (!file.read(signature, sizeof(signature)) ||
+		!std::equal(signature, signature + sizeof(signature), CACHE_SIGNATURE) || !readU64(file, keySize) ||
+		keySize != key.size())
+	{
+		return false;
+	}
+
+	std::string storedKey(keySize, '\0');
+	uint64_t binaryCount;
+	if (!file.read(storedKey.data(), keySize) || storedKey != key || !readU64(file, binaryCount) ||
+		binaryCount != binaries.size())
+	{
+		return false;
+	}
+
+	for (std::vector<unsigned char> &binary : binaries)
+	{
+		uint64_t binarySize;
+		if (!readU64(file, binarySize) || binarySize == 0)
+		{
+			return false;
+		}
+
+		binary.resize(binarySize);
+		if (!file.read(reinterpret_cast<char *>(binary.data()), binarySize))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void ProgramCache::storeBinaries(const std::string &key, cl_program program, size_t deviceCount) const
+{
+	std::vector<size_t> binarySizes(deviceCount);
+	if (clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, deviceCount * sizeof(size_t), binarySizes.data(),
+						 nullptr) != CL_SUCCESS)
+	{
+		return;
+	}
+
+	std::vector<std::vector<unsigned char>> binaries(deviceCount);
+	std::vector<unsigned char *> binaryPointers(deviceCount);
+	for (size_t i = 0; i < deviceCount; i++)
+	{
+		// dažas implementācijas (ierīces bez bināro failu atbalsta) atgriež garumu 0, tad nav ko saglabāt
+		if (binarySizes[i] == 0)
+		{
+			return;
+		}
+
+		binaries[i].resize(binarySizes[i]);
+		binaryPointers[i] = binaries[i].data();
+	}
+
+	if (clGetProgramInfo(program, CL_PROGRAM_BINARIES, deviceCount * sizeof(unsigned char *), binaryPointers.data(),
+						 nullptr) != CL_SUCCESS)
+	{
+		return;
+	}
+
+	// kešatmiņa nav obligāta, tāpēc rakstīšanas kļūdas tiek klusi ignorētas
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+
+	// vispirms raksta pagaidu failā un tad pārsauc, lai vienlaicīgi palaistas programmas neredzētu pusi faila
+	const std::string fileName = cacheFileName(key);
+	const std::string tempFileName = fileName + ".tmp" + std::to_string(reinterpret_cast<uintptr_t>(program));
+
+	{
+		std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			return;
+		}
+
+		file.write(CACHE_SIGNATURE, sizeof(CACHE_SIGNATURE));
+		writeU64(file, key.size());
+		file.write(key.data(), key.size());
+		writeU64(file, deviceCount);
+
+		for (const std::vector<unsigned char> &binary : binaries)
+		{
+			writeU64(file, binary.size());
+			file.write(reinterpret_cast<const char *>(binary.data()), binary.size());
+		}
+
+		if (!file)
+		{
+			file.close();
+			std::filesystem::remove(tempFileName, error);
+			return;
+		}
+	}
+
+	std::filesystem::rename(tempFileName, fileName, error);
+	if (error)
+	{
+		std::filesystem::remove(tempFileName, error);
+	}
+}
+
+cl_program ProgramCache::buildProgram(cl_context context, const std::vector<cl_device_id> &devices,
+									  const std::string &source, const std::string &buildOptions, bool &cacheHit,
+									  cl_int &clResult)
+{
+	const cl_uint deviceCount = static_cast<cl_uint>(devices.size());
+	const std::string key = directory.empty() ? "" : cacheKey(devices, source, buildOptions);
+
+	cacheHit = false;
+
+	std::vector<std::vector<unsigned char>> binaries(devices.size());
+	if (!directory.empty() && loadBinaries(key, binaries))
+	{
+		std::vector<size_t> binarySizes;
+		std::vector<const unsigned char *> binaryPointers;
+		for (const std::vector<unsigned char> &binary : binaries)
+		{
+			binarySizes.push_back(binary.size());
+			binaryPointers.push_back(binary.data());
+		}
+
+		cl_program program = clCreateProgramWithBinary(context, deviceCount, devices.data(), binarySizes.data(),
+													   binaryPointers.data(), nullptr, &clResult);
+
+		// arī no binārā faila izveidota programma ir jāuzbūvē, bojāts vai nederīgs fails tiek kompilēts no jauna
+		if (clResult == CL_SUCCESS)
+		{
+			clResult = clBuildProgram(program, deviceCount, devices.data(), buildOptions.c_str(), nullptr, nullptr);
+			if (clResult == CL_SUCCESS)
+			{
+				cacheHit = true;
+				return program;
+			}
+
+			clReleaseProgram(program);
+		}
+	}
+
+	const char *sourceCstring = source.c_str();
+	const size_t sourceSize = source.length();
+
+	cl_program program = clCreateProgramWithSource(context, 1, &sourceCstring, &sourceSize, &clResult);
+	if (clResult != CL_SUCCESS)
+	{
+		return nullptr;
+	}
+
+	clResult = clBuildProgram(program, deviceCount, devices.data(), buildOptions.c_str(), nullptr, nullptr);
+	if (clResult != CL_SUCCESS)
+	{
+		clReleaseProgram(program);
+		return nullptr;
+	}
+
+	if (!directory.empty())
+	{
+		storeBinaries(key, program, devices.size());
+	}
+
+	return program;
+}
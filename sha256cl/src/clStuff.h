@@ -1,6 +1,7 @@
 #pragma once
 
 #include "benchmarkLogger.h"
+#include "clProgramCache.h"
 #include <CL/cl.h>
 #include <string>
 
@@ -35,6 +36,20 @@ class ClStuffContainer
 {
   private:
 	BenchmarkLogger &logger;
+	ProgramCache programCache;
+
+	// programmas iegūšana no bināro failu kešatmiņas vai kompilēšana no pirmkoda
+	cl_program buildProgram(const std::string &fileName)
+	{
+		bool cacheHit;
+		cl_program program = programCache.buildProgram(context, {device}, readKernelFile(fileName), "-cl-std=CL3.0",
+													   cacheHit, clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		logger.log("program cache hit", cacheHit ? 1 : 0);
+
+		return program;
+	}
 
   public:
 	cl_int clResult; // paredzēts openCL funkciju izsaukumu rezultātu saglabāšanai un pārbaudei
@@ -45,7 +60,7 @@ class ClStuffContainer
 	cl_context context;
 	cl_command_queue queue;
 
-	ClStuffContainer(BenchmarkLogger &logger) : logger(logger)
+	ClStuffContainer(BenchmarkLogger &logger) : logger(logger), programCache(ProgramCache::defaultDirectory())
 	{
 		clResult = clGetPlatformIDs(1, &platform, &numPlatforms);
 		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
@@ -74,18 +89,9 @@ class ClStuffContainer
 
 	cl_kernel loadAndCreateKernel(const std::string &fileName, const std::string &kernelName)
 	{
-		std::string kernelSource = readKernelFile(fileName);
-
-		const char *kernelSourceCstring = kernelSource.c_str();
-		size_t kernelSize = kernelSource.length();
-
 		auto start = std::chrono::steady_clock::now();
 
-		cl_program program = clCreateProgramWithSource(context, 1, &kernelSourceCstring, &kernelSize, &clResult);
-		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
-
-		clResult = clBuildProgram(program, 1, &device, "-cl-std=CL3.0", nullptr, nullptr);
-		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		cl_program program = buildProgram(fileName);
 
 		cl_kernel kernel = clCreateKernel(program, kernelName.c_str(), &clResult);
 		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
@@ -96,4 +102,19 @@ class ClStuffContainer
 
 		return kernel;
 	}
+
+	// uzbūvē programmu un saglabā tās bināro failu kešatmiņā, lai nākamās palaišanas to nekompilētu
+	void prewarmProgram(const std::string &fileName)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		cl_program program = buildProgram(fileName);
+
+		auto end = std::chrono::steady_clock::now();
+
+		logger.chronoLog("program prewarm time", start, end);
+
+		clResult = clReleaseProgram(program);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	}
 };
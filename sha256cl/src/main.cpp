@@ -1,6 +1,10 @@
 #include "benchmarkLogger.h"
 #include "clStuff.h"
+#include "launchTuning.h"
+#include "passwordBatchReader.h"
+#include "targetTable.h"
 #include <CL/cl.h>
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -85,254 +89,1122 @@ size_t current_pw_size(std::vector<cl_uint> &offsets, cl_uint password_count, cl
 	}
 }
 
-int hashCheck_v2_with_pinned_memory(ClStuffContainer &clStuffContainer, const std::string &pwFileName,
-									std::vector<cl_uint> &hash, std::string &foundPw, BenchmarkLogger &logger)
+// rindu sadalīšanas kodolu baiti uz pavedienu, jāsakrīt ar kernels/sha256.cl
+constexpr size_t SPLIT_BYTES_PER_ITEM = 16;
+
+// rindu sadalīšanas darba grupas izmērs, ja kešatmiņā tam nav ieraksta, un mazākais izmērs, kuram ir paredzēts
+// daļu skaitu buferis
+constexpr size_t SPLIT_DEFAULT_GROUP_SIZE = 256;
+constexpr size_t SPLIT_MIN_GROUP_SIZE = 64;
+
+// vienas gredzena ligzdas buferi un notikumi, katrai ligzdai savi, lai nākamās partijas kopēšana varētu notikt,
+// kamēr iepriekšējās partijas kodoli vēl izpildās
+struct ClBatchSlot
+{
+	// piespraustā atmiņa, kas ir kartēta visu laiku, tāpēc partijas starpā nav jāgaida uz map/unmap
+	cl_mem pinnedPasswordsHost = nullptr;
+	cl_mem pinnedOffsetsHost = nullptr;
+	cl_uchar *batchedKernelPasswords = nullptr;
+	cl_uint *batchedOffsets = nullptr;
+
+	cl_mem passwordsBuffer = nullptr;
+	cl_mem offsetsBuffer = nullptr;
+	cl_mem matchesBuffer = nullptr;
+	cl_mem longMatchesBuffer = nullptr;
+	cl_mem matchCountBuffer = nullptr;
+	cl_mem longMatchCountBuffer = nullptr;
+	cl_uint matchCounts[2] = {0, 0}; // īso un garo paroļu sakritību skaits, tiek nolasīts bez gaidīšanas
+
+	// rindu sadalīšanas buferi, tiek izveidoti tikai neapstrādātu gabalu režīmā
+	cl_mem tileCountsBuffer = nullptr;
+	cl_mem matchStartsBuffer = nullptr;
+	cl_mem lineCountBuffer = nullptr;
+	cl_uint lineCount = 0;
+
+	// garo paroļu buferi tiek izveidoti un palielināti tikai tad, kad tādas paroles parādās
+	cl_mem longPasswordsBuffer = nullptr;
+	cl_mem longOffsetsBuffer = nullptr;
+	size_t longBytesCapacity = 0;
+	size_t longCountCapacity = 0;
+
+	std::vector<cl_event> uploadEvents;
+	std::vector<cl_event> kernelEvents;
+	std::vector<cl_event> longEvents;
+	std::vector<cl_event> splitEvents;
+	cl_event countsReady = nullptr;
+};
+
+// nolasa ierīces atrasto paroļu buferi, ierakstu secība ir atkarīga no pavedienu izpildes secības
+std::vector<cl_uint2> readMatches(cl_command_queue queue, cl_mem matchesBuffer, cl_uint matchCount,
+								  cl_uint matchCapacity)
 {
-	// sha256 hash vērtībai jābūt 256 biti / 32 baiti
-	assert(hash.size() * sizeof(cl_uint) == 32);
+	std::vector<cl_uint2> matches(std::min(matchCount, matchCapacity));
 
-	cl_int clResult;
+	if (!matches.empty())
+	{
+		cl_int clResult = clEnqueueReadBuffer(queue, matchesBuffer, CL_TRUE, 0, matches.size() * sizeof(cl_uint2),
+											  matches.data(), 0, nullptr, nullptr);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	}
 
-	const size_t batchSize = 1 << 20;
+	return matches;
+}
 
-	std::ifstream file(pwFileName, std::ios::binary);
+// notikumu profilēšanas laiku summa milisekundēs, notikumi pēc tam tiek atbrīvoti
+double releaseProfiledEvents(std::vector<cl_event> &events)
+{
+	double totalTime = 0;
 
-	if (!file.is_open())
+	for (cl_event event : events)
 	{
-		throw std::runtime_error("Failed to open file: " + pwFileName);
+		cl_ulong start;
+		cl_ulong end;
+
+		clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(start), &start, nullptr);
+		clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_COMPLETE, sizeof(end), &end, nullptr);
+
+		totalTime += static_cast<double>(end - start);
+
+		clReleaseEvent(event);
 	}
 
-	auto hostPinnedMemStart = std::chrono::steady_clock::now();
+	events.clear();
 
-	cl_mem pinnedPasswordsHost = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
-												batchSize * 16 * sizeof(cl_uchar), nullptr, &clResult);
-	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	return totalTime / 1e6; // 1e6, lai dabūtu rezultātu milisekundēs
+}
 
-	cl_mem pinnedOffsetsHost = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
-											  batchSize * sizeof(cl_uint), nullptr, &clResult);
-	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+// ierīces apzīmējums darba grupu izmēru kešatmiņai
+std::string tuningDeviceName(cl_device_id device)
+{
+	char name[256] = {};
+	char driverVersion[256] = {};
+	clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(name) - 1, name, nullptr);
+	clGetDeviceInfo(device, CL_DRIVER_VERSION, sizeof(driverVersion) - 1, driverVersion, nullptr);
 
-	cl_uchar *batchedKernelPasswords =
-		(cl_uchar *)clEnqueueMapBuffer(clStuffContainer.queue, pinnedPasswordsHost, CL_TRUE, CL_MAP_WRITE, 0,
-									   batchSize * 16 * sizeof(cl_uchar), 0, nullptr, nullptr, &clResult);
+	return std::string(name) + " " + driverVersion;
+}
+
+// vidējais viena 'launch' izsaukuma laiks milisekundēs pēc viena iesildīšanas izsaukuma, 'launch(events)' ierindo
+// kodolus rindā 'queue', pievieno to notikumus 'events' un atgriež ierindošanas rezultātu
+// ja ierīce vai kodols darba grupas izmēru nepieņem, atgriež -1
+template <typename Launch>
+double timeKernelLaunches(cl_command_queue queue, Launch launch)
+{
+	std::vector<cl_event> events;
+
+	cl_int clResult = launch(events);
+	clFinish(queue);
+	releaseProfiledEvents(events);
+
+	if (clResult != CL_SUCCESS)
+	{
+		return -1;
+	}
+
+	for (size_t i = 0; i < AUTOTUNE_LAUNCHES; i++)
+	{
+		clResult = launch(events);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	}
+
+	clResult = clFinish(queue);
 	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
-	cl_uint *batchedOffsets =
-		(cl_uint *)clEnqueueMapBuffer(clStuffContainer.queue, pinnedOffsetsHost, CL_TRUE, CL_MAP_WRITE, 0,
-									  batchSize * sizeof(cl_uint), 0, nullptr, nullptr, &clResult);
+	return releaseProfiledEvents(events) / AUTOTUNE_LAUNCHES;
+}
+
+// partijas tiek apstrādātas konveijerā: PasswordBatchReader pavediens nolasa failu piespraustās atmiņas ligzdās,
+// kopēšana uz ierīci notiek atsevišķā rindā un kodoli savā rindā, tāpēc partijas n + 1 kopēšana un partijas
+// n + 2 nolasīšana notiek, kamēr tiek jaucēta partija n
+// ar 'deviceSplit' uz ierīci tiek kopēti neapstrādāti faila gabali, rindas un to offsetus atrod ierīce
+// kodolu darba grupu izmēri tiek ņemti no autotune.json, ar 'autotune' tie tiek izmērīti uz pirmās partijas, kurā
+// kodolam ir darbs, un saglabāti
+void hashCheck_v2_with_pinned_memory(ClStuffContainer &clStuffContainer, const std::string &pwFileName,
+									 const TargetTable &targets, std::vector<CrackedPassword> &cracked,
+									 bool deviceSplit, bool autotune, BenchmarkLogger &logger)
+{
+	cl_int clResult;
+
+	// partijas ierakstu un baitu limiti no ierīces atmiņas, nevis fiksēts rindu skaits
+	// OpenCL nepiedāvā brīvās atmiņas vaicājumu, tāpēc tiek izmantots kopējais ierīces atmiņas apjoms
+	cl_ulong deviceMemoryBytes;
+	cl_ulong maxAllocationBytes;
+	clGetDeviceInfo(clStuffContainer.device, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(cl_ulong), &deviceMemoryBytes, nullptr);
+	clGetDeviceInfo(clStuffContainer.device, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(cl_ulong), &maxAllocationBytes,
+					nullptr);
+
+	const BatchBudget budget = batchBudgetForDevice(deviceMemoryBytes, maxAllocationBytes);
+
+	logger.log("batch entry budget", budget.entries);
+	logger.log("batch byte budget", budget.bytes);
+
+	const size_t batchSize = budget.entries;
+	const size_t passwordsCapacity = budget.bytes;
+
+	// hash tabulā nav atkārtojumu, tāpēc katra parole var sakrist ar ne vairāk kā vienu hash
+	// un partijas sakritību skaits nevar pārsniegt paroļu skaitu partijā
+	// neapstrādātā gabalā var būt vairāk rindu, bet vairāk sakritību tajā var būt tikai ar atkārtotām parolēm
+	const cl_uint matchCapacity = batchSize;
+
+	// gabala rindu sākumiem vajag līdz vienam ierakstam uz baitu, tāpēc gabals ir ceturtdaļa no baitu limita
+	// un ierīces atmiņas patēriņš ir aptuveni tāds pats kā paroļu režīmā
+	const size_t rawChunkBytes = passwordsCapacity / 4;
+	const size_t minTileBytes = SPLIT_MIN_GROUP_SIZE * SPLIT_BYTES_PER_ITEM;
+	const size_t rawTileCount = (rawChunkBytes + minTileBytes - 1) / minTileBytes;
+
+	// kodoli izpildās konteinera rindā, kopēšanai tiek izveidota atsevišķa rinda
+	const cl_queue_properties queueProperties[] = {CL_QUEUE_PROPERTIES, CL_QUEUE_PROFILING_ENABLE, 0};
+
+	cl_command_queue copyQueue = clCreateCommandQueueWithProperties(clStuffContainer.context, clStuffContainer.device,
+																	queueProperties, &clResult);
 	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
+	auto hostPinnedMemStart = std::chrono::steady_clock::now();
+
+	std::vector<ClBatchSlot> slots(PASSWORD_BATCH_SLOTS);
+	std::vector<uint8_t *> passwordSlots(PASSWORD_BATCH_SLOTS, nullptr);
+	std::vector<uint32_t *> offsetSlots(PASSWORD_BATCH_SLOTS, nullptr);
+
+	// neapstrādāti gabali tiek rakstīti uz ierīci tieši no faila attēlojuma, tāpēc piespraustā atmiņa nav vajadzīga
+	for (size_t s = 0; s < slots.size() && !deviceSplit; s++)
+	{
+		ClBatchSlot &slot = slots[s];
+
+		slot.pinnedPasswordsHost = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
+												  passwordsCapacity * sizeof(cl_uchar), nullptr, &clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		slot.pinnedOffsetsHost = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
+												batchSize * sizeof(cl_uint), nullptr, &clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		// paroles tiek arī nolasītas, kad tiek atrasta sakritība
+		slot.batchedKernelPasswords = (cl_uchar *)clEnqueueMapBuffer(
+			copyQueue, slot.pinnedPasswordsHost, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0,
+			passwordsCapacity * sizeof(cl_uchar), 0, nullptr, nullptr, &clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		slot.batchedOffsets =
+			(cl_uint *)clEnqueueMapBuffer(copyQueue, slot.pinnedOffsetsHost, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0,
+										  batchSize * sizeof(cl_uint), 0, nullptr, nullptr, &clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		passwordSlots[s] = slot.batchedKernelPasswords;
+		offsetSlots[s] = slot.batchedOffsets;
+	}
+
 	auto hostPinnedMemEnd = std::chrono::steady_clock::now();
 
 	logger.chronoLog("host side pinned mem buffer creation time", hostPinnedMemStart, hostPinnedMemEnd);
 
-	std::string line;
-	size_t lineIdx = 0;
-	cl_int crackedIdx = -1;
-
 	cl_kernel kernel = clStuffContainer.loadAndCreateKernel("kernels/sha256.cl", "sha256_crack");
+	cl_kernel multiBlockKernel = clStuffContainer.loadAndCreateKernel("kernels/sha256.cl", "sha256_crack_multi_block");
 
 	size_t kernelWorkGroupSize;
 	clGetKernelWorkGroupInfo(kernel, clStuffContainer.device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(size_t),
 							 &kernelWorkGroupSize, nullptr);
 
+	size_t multiBlockWorkGroupSize;
+	clGetKernelWorkGroupInfo(multiBlockKernel, clStuffContainer.device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(size_t),
+							 &multiBlockWorkGroupSize, nullptr);
+
+	cl_kernel countKernel = nullptr;
+	cl_kernel scanKernel = nullptr;
+	cl_kernel writeKernel = nullptr;
+	cl_kernel linesKernel = nullptr;
+	size_t linesWorkGroupSize = 0;
+	size_t splitWorkGroupSize = 0;
+
+	if (deviceSplit)
+	{
+		countKernel = clStuffContainer.loadAndCreateKernel("kernels/sha256.cl", "count_line_starts");
+		scanKernel = clStuffContainer.loadAndCreateKernel("kernels/sha256.cl", "scan_tile_counts");
+		writeKernel = clStuffContainer.loadAndCreateKernel("kernels/sha256.cl", "write_line_starts");
+		linesKernel = clStuffContainer.loadAndCreateKernel("kernels/sha256.cl", "sha256_crack_lines");
+
+		clGetKernelWorkGroupInfo(linesKernel, clStuffContainer.device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(size_t),
+								 &linesWorkGroupSize, nullptr);
+
+		// visi trīs sadalīšanas kodoli tiek izsaukti ar vienu darba grupas izmēru
+		splitWorkGroupSize = SPLIT_DEFAULT_GROUP_SIZE;
+
+		for (cl_kernel splitKernel : {countKernel, scanKernel, writeKernel})
+		{
+			size_t maxWorkGroupSize;
+			clGetKernelWorkGroupInfo(splitKernel, clStuffContainer.device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(size_t),
+									 &maxWorkGroupSize, nullptr);
+
+			splitWorkGroupSize = std::min(splitWorkGroupSize, maxWorkGroupSize);
+		}
+
+		if (splitWorkGroupSize < SPLIT_MIN_GROUP_SIZE)
+		{
+			throw std::runtime_error("Device does not support " + std::to_string(SPLIT_MIN_GROUP_SIZE) +
+									 " work-item groups needed for line splitting");
+		}
+	}
+
 	auto deviceFixedBuffersAndDataStart = std::chrono::steady_clock::now();
 
-	cl_mem targetHashBuffer = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
-											 hash.size() * sizeof(cl_uint), hash.data(), &clResult);
+	// hash tabula un priekšfiltrs tiek nokopēti vienu reizi visam failam
+	cl_mem targetsBuffer = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+										  targets.words.size() * sizeof(cl_uint), (void *)targets.words.data(),
+										  &clResult);
 	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
-	cl_mem passwordsBuffer = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_ONLY,
-											batchSize * 16 * sizeof(cl_uchar), nullptr, &clResult);
-	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	// bez filtra kodolam tiek padots viena vārda buferis, kuru tas nenolasa
+	const std::vector<cl_uint> noBloom(1, 0);
+	const std::vector<cl_uint> &bloom = targets.bloom.empty() ? noBloom : targets.bloom;
 
-	cl_mem offsetsBuffer =
-		clCreateBuffer(clStuffContainer.context, CL_MEM_READ_ONLY, batchSize * sizeof(cl_uint), nullptr, &clResult);
+	cl_mem bloomBuffer = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+										bloom.size() * sizeof(cl_uint), (void *)bloom.data(), &clResult);
 	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
-	cl_mem crackedIdxBuffer =
-		clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE, sizeof(cl_int), nullptr, &clResult);
-	ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+	for (ClBatchSlot &slot : slots)
+	{
+		slot.passwordsBuffer = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_ONLY,
+											  passwordsCapacity * sizeof(cl_uchar), nullptr, &clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		// neapstrādātu gabalu režīmā offsetus raksta sadalīšanas kodols
+		slot.offsetsBuffer =
+			clCreateBuffer(clStuffContainer.context, deviceSplit ? CL_MEM_READ_WRITE : CL_MEM_READ_ONLY,
+						   (deviceSplit ? rawChunkBytes : batchSize) * sizeof(cl_uint), nullptr, &clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		slot.matchesBuffer = clCreateBuffer(clStuffContainer.context, CL_MEM_WRITE_ONLY,
+											matchCapacity * sizeof(cl_uint2), nullptr, &clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		slot.longMatchesBuffer = clCreateBuffer(clStuffContainer.context, CL_MEM_WRITE_ONLY,
+												matchCapacity * sizeof(cl_uint2), nullptr, &clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		slot.matchCountBuffer =
+			clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE, sizeof(cl_uint), nullptr, &clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		slot.longMatchCountBuffer =
+			clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE, sizeof(cl_uint), nullptr, &clResult);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		if (deviceSplit)
+		{
+			slot.tileCountsBuffer = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE,
+												   rawTileCount * sizeof(cl_uint), nullptr, &clResult);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			slot.matchStartsBuffer = clCreateBuffer(clStuffContainer.context, CL_MEM_WRITE_ONLY,
+													matchCapacity * sizeof(cl_uint), nullptr, &clResult);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			slot.lineCountBuffer =
+				clCreateBuffer(clStuffContainer.context, CL_MEM_READ_WRITE, sizeof(cl_uint), nullptr, &clResult);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		}
+	}
 
 	auto deviceFixedBuffersAndDataEnd = std::chrono::steady_clock::now();
 
 	logger.chronoLog("device side fixed buffers and data time", deviceFixedBuffersAndDataStart,
 					 deviceFixedBuffersAndDataEnd);
 
-	while (file)
-	{
-		auto pwBatchStart = std::chrono::steady_clock::now();
+	const cl_uint targetCount = targets.size();
+	const cl_uint bloomShift = targets.bloomShift;
+
+	TuningCache tuningCache(TuningCache::defaultFileName());
+	const std::string tuningDevice = tuningDeviceName(clStuffContainer.device);
 
-		size_t passwordsSize = 0;
-		uint currentOffset = 0;
-		size_t i = 0;
+	// katra kodola darba grupas izmērs, 0 - vēl nav izvēlēts, tas notiek pirmajā partijā, kurā kodolam ir darbs
+	// bez kešatmiņas ieraksta tiek ņemts kodola lielākais darba grupas izmērs, sadalīšanas kodoliem
+	// SPLIT_DEFAULT_GROUP_SIZE
+	size_t kernelLocalSize = 0;
+	size_t multiBlockLocalSize = 0;
+	size_t splitLocalSize = 0;
+	size_t linesLocalSize = 0;
 
-		for (; i < batchSize && std::getline(file, line); i++, lineIdx++)
+	// 'launch(localSize, events)' ierindo kodolus kodolu rindā ar darba grupas izmēru 'localSize'
+	auto tunedLocalSize = [&](const std::string &kernelName, size_t fallback, auto launch) {
+		auto start = std::chrono::steady_clock::now();
+
+		const LaunchShape shape = resolveLaunchShape(
+			tuningCache, tuningDevice, kernelName, autotune, LaunchShape{fallback, 1}, BLOCK_SIZE_CANDIDATES,
+			[&](LaunchShape candidate) {
+				return timeKernelLaunches(clStuffContainer.queue,
+										  [&](std::vector<cl_event> &events) { return launch(candidate.x, events); });
+			},
+			logger);
+
+		auto end = std::chrono::steady_clock::now();
+
+		if (autotune)
 		{
-			std::memcpy(batchedKernelPasswords + passwordsSize, line.data(), line.size());
-			batchedOffsets[i] = currentOffset;
+			logger.chronoLog(kernelName + " launch tuning time", start, end);
+		}
+
+		logger.log(kernelName + " work group size", static_cast<double>(shape.x));
 
-			passwordsSize += line.size();
-			currentOffset += line.size();
+		return shape.x;
+	};
+
+	// ierindo viendimensiju kodolu kodolu rindā un pievieno tā notikumu 'events', atgriež ierindošanas rezultātu
+	auto enqueueKernel = [&](cl_kernel enqueuedKernel, size_t globalSize, size_t localSize, cl_uint waitCount,
+							 const cl_event *waitList, std::vector<cl_event> &events) {
+		cl_event event;
+		const cl_int result = clEnqueueNDRangeKernel(clStuffContainer.queue, enqueuedKernel, 1, nullptr, &globalSize,
+													 &localSize, waitCount, waitList, &event);
+
+		if (result == CL_SUCCESS)
+		{
+			events.push_back(event);
 		}
 
-		auto pwBatchEnd = std::chrono::steady_clock::now();
+		return result;
+	};
+
+	// kodolu argumenti, kas nav atkarīgi no darba grupas izmēra, jau ir iestatīti
+	auto launchShort = [&](const PasswordBatch &batch, size_t localSize, cl_event uploadDone,
+						   std::vector<cl_event> &events) {
+		const size_t globalSize = ((batch.shortCount + localSize - 1) / localSize) * localSize;
+
+		return enqueueKernel(kernel, globalSize, localSize, 1, &uploadDone, events);
+	};
 
-		logger.chronoLog("pw batch loaded from file and processed", pwBatchStart, pwBatchEnd);
+	auto launchLong = [&](const PasswordBatch &batch, size_t localSize, cl_event uploadDone,
+						  std::vector<cl_event> &events) {
+		for (const LongBucketRange &range : batch.longRanges)
+		{
+			clResult = clSetKernelArg(multiBlockKernel, 4, sizeof(cl_uint), &range.first);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(multiBlockKernel, 5, sizeof(cl_uint), &range.count);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
-		auto bufferCreationStart = std::chrono::steady_clock::now();
+			const size_t globalSize = ((range.count + localSize - 1) / localSize) * localSize;
 
-		clEnqueueUnmapMemObject(clStuffContainer.queue, pinnedPasswordsHost, batchedKernelPasswords, 0, nullptr,
-								nullptr);
-		clEnqueueUnmapMemObject(clStuffContainer.queue, pinnedOffsetsHost, batchedOffsets, 0, nullptr, nullptr);
+			const cl_int result = enqueueKernel(multiBlockKernel, globalSize, localSize, 1, &uploadDone, events);
+			if (result != CL_SUCCESS)
+			{
+				return result;
+			}
+		}
 
-		clEnqueueCopyBuffer(clStuffContainer.queue, pinnedPasswordsHost, passwordsBuffer, 0, 0,
-							passwordsSize * sizeof(cl_uchar), 0, nullptr, nullptr);
-		clEnqueueCopyBuffer(clStuffContainer.queue, pinnedOffsetsHost, offsetsBuffer, 0, 0, i * sizeof(cl_uint), 0,
-							nullptr, nullptr);
+		return CL_SUCCESS;
+	};
 
-		crackedIdx = -1;
-		clEnqueueWriteBuffer(clStuffContainer.queue, crackedIdxBuffer, CL_TRUE, 0, sizeof(cl_int), &crackedIdx, 0,
-							 nullptr, nullptr);
+	// darba grupas izmērs nosaka daļas garumu un lokālās atmiņas apjomu, tāpēc tie tiek iestatīti katram izsaukumam
+	// kodolu rinda ir secīga, tāpēc tikai pirmajam kodolam jāgaida uz kopēšanu
+	auto launchSplit = [&](cl_uint chunkBytes, size_t localSize, cl_event uploadDone, std::vector<cl_event> &events) {
+		const size_t tileBytes = localSize * SPLIT_BYTES_PER_ITEM;
+		const cl_uint tileCount = (chunkBytes + tileBytes - 1) / tileBytes;
+		const size_t scratchBytes = localSize * sizeof(cl_uint);
 
-		batchedKernelPasswords =
-			(cl_uchar *)clEnqueueMapBuffer(clStuffContainer.queue, pinnedPasswordsHost, CL_TRUE, CL_MAP_WRITE, 0,
-										   batchSize * 16 * sizeof(cl_uchar), 0, nullptr, nullptr, &clResult);
+		clResult = clSetKernelArg(countKernel, 3, scratchBytes, nullptr);
 		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
-
-		batchedOffsets = (cl_uint *)clEnqueueMapBuffer(clStuffContainer.queue, pinnedOffsetsHost, CL_TRUE, CL_MAP_WRITE,
-													   0, batchSize * sizeof(cl_uint), 0, nullptr, nullptr, &clResult);
+		clResult = clSetKernelArg(scanKernel, 1, sizeof(cl_uint), &tileCount);
 		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(scanKernel, 3, scratchBytes, nullptr);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(writeKernel, 4, scratchBytes, nullptr);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		cl_int result = enqueueKernel(countKernel, tileCount * localSize, localSize, 1, &uploadDone, events);
+		if (result != CL_SUCCESS)
+		{
+			return result;
+		}
 
-		auto bufferCreationEnd = std::chrono::steady_clock::now();
+		result = enqueueKernel(scanKernel, localSize, localSize, 0, nullptr, events);
+		if (result != CL_SUCCESS)
+		{
+			return result;
+		}
+
+		return enqueueKernel(writeKernel, tileCount * localSize, localSize, 0, nullptr, events);
+	};
 
-		logger.chronoLog("kernel buffer creation time", bufferCreationStart, bufferCreationEnd);
+	// rindu skaits resursdatoram vēl nav zināms, NDRange ir paredzēta ierakstu limitam
+	auto launchLines = [&](size_t localSize, std::vector<cl_event> &events) {
+		const size_t globalSize = ((batchSize + localSize - 1) / localSize) * localSize;
 
-		cl_uint N = i;
-		cl_uint charCount = passwordsSize;
+		return enqueueKernel(linesKernel, globalSize, localSize, 0, nullptr, events);
+	};
 
-		clResult = clSetKernelArg(kernel, 0, sizeof(cl_mem), &passwordsBuffer);
+	// mērījumu izsaukumi pievieno sakritības, tāpēc pirms īstajiem izsaukumiem sakritību skaitītāji tiek notīrīti
+	auto resetTunedMatches = [&](ClBatchSlot &slot) {
+		const cl_uint zero = 0;
+
+		clResult = clEnqueueFillBuffer(clStuffContainer.queue, slot.matchCountBuffer, &zero, sizeof(cl_uint), 0,
+									   sizeof(cl_uint), 0, nullptr, nullptr);
 		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
-		clResult = clSetKernelArg(kernel, 1, sizeof(cl_mem), &offsetsBuffer);
+
+		clResult = clEnqueueFillBuffer(clStuffContainer.queue, slot.longMatchCountBuffer, &zero, sizeof(cl_uint), 0,
+									   sizeof(cl_uint), 0, nullptr, nullptr);
 		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
-		clResult = clSetKernelArg(kernel, 2, sizeof(cl_uint), &N);
+	};
+
+	// meklēšana beidzas, kad atrastas paroles visiem hash
+	std::vector<bool> targetFound(targetCount, false);
+	size_t foundCount = 0;
+
+	// ierīces aizņemtība visam konveijeram
+	double uploadTotalMs = 0;
+	double kernelTotalMs = 0;
+
+	// atzīmē jaunatrastos hash, lai meklēšanu varētu beigt, kad atrasti visi
+	auto markFound = [&](size_t crackedBefore) {
+		for (size_t c = crackedBefore; c < cracked.size(); c++)
+		{
+			if (!targetFound[cracked[c].targetIdx])
+			{
+				targetFound[cracked[c].targetIdx] = true;
+				foundCount++;
+			}
+		}
+	};
+
+	// ierindo partijas kopēšanu kopēšanas rindā un kodolus kodolu rindā, neko negaidot
+	auto submitBatch = [&](const PasswordBatch &batch) {
+		ClBatchSlot &slot = slots[batch.slot];
+
+		const size_t longCount = batch.longOffsets.size();
+
+		// iepriekšējā šīs ligzdas partija jau ir pabeigta, tāpēc buferus drīkst pārveidot
+		if (longCount > slot.longCountCapacity || batch.longPasswords.size() > slot.longBytesCapacity)
+		{
+			if (slot.longPasswordsBuffer != nullptr)
+			{
+				clReleaseMemObject(slot.longPasswordsBuffer);
+				clReleaseMemObject(slot.longOffsetsBuffer);
+			}
+
+			slot.longCountCapacity = std::max(longCount, slot.longCountCapacity * 2);
+			slot.longBytesCapacity = std::max(batch.longPasswords.size(), slot.longBytesCapacity * 2);
+
+			slot.longPasswordsBuffer = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_ONLY,
+													  slot.longBytesCapacity * sizeof(cl_uchar), nullptr, &clResult);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			slot.longOffsetsBuffer = clCreateBuffer(clStuffContainer.context, CL_MEM_READ_ONLY,
+													slot.longCountCapacity * sizeof(cl_uint), nullptr, &clResult);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		}
+
+		// rakstīšana no kartētas piespraustās atmiņas nebloķē, garās paroles tiek rakstītas no partijas vektoriem,
+		// kas nemainās, kamēr ligzda nav atbrīvota
+		const cl_uint zero = 0;
+		slot.uploadEvents.resize(2);
+
+		clResult = clEnqueueFillBuffer(copyQueue, slot.matchCountBuffer, &zero, sizeof(cl_uint), 0, sizeof(cl_uint), 0,
+									   nullptr, &slot.uploadEvents[0]);
 		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
-		clResult = clSetKernelArg(kernel, 3, sizeof(cl_uint), &charCount);
+
+		clResult = clEnqueueFillBuffer(copyQueue, slot.longMatchCountBuffer, &zero, sizeof(cl_uint), 0,
+									   sizeof(cl_uint), 0, nullptr, &slot.uploadEvents[1]);
 		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
-		clResult = clSetKernelArg(kernel, 4, sizeof(cl_mem), &targetHashBuffer);
+
+		if (batch.shortCount > 0)
+		{
+			slot.uploadEvents.resize(4);
+
+			clResult = clEnqueueWriteBuffer(copyQueue, slot.passwordsBuffer, CL_FALSE, 0,
+											batch.pwBytes * sizeof(cl_uchar), batch.passwords, 0, nullptr,
+											&slot.uploadEvents[2]);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			clResult = clEnqueueWriteBuffer(copyQueue, slot.offsetsBuffer, CL_FALSE, 0,
+											batch.shortCount * sizeof(cl_uint), batch.offsets, 0, nullptr,
+											&slot.uploadEvents[3]);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		}
+
+		if (longCount > 0)
+		{
+			const size_t first = slot.uploadEvents.size();
+			slot.uploadEvents.resize(first + 2);
+
+			clResult = clEnqueueWriteBuffer(copyQueue, slot.longPasswordsBuffer, CL_FALSE, 0,
+											batch.longPasswords.size() * sizeof(cl_uchar), batch.longPasswords.data(),
+											0, nullptr, &slot.uploadEvents[first]);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+			clResult = clEnqueueWriteBuffer(copyQueue, slot.longOffsetsBuffer, CL_FALSE, 0, longCount * sizeof(cl_uint),
+											batch.longOffsets.data(), 0, nullptr, &slot.uploadEvents[first + 1]);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		}
+
+		// rinda ir secīga, tāpēc pēdējā rakstīšana beidzas pēc visām iepriekšējām
+		clFlush(copyQueue);
+		const cl_event uploadDone = slot.uploadEvents.back();
+
+		cl_uint N = batch.shortCount;
+		cl_uint charCount = batch.pwBytes;
+
+		if (N > 0)
+		{
+			clResult = clSetKernelArg(kernel, 0, sizeof(cl_mem), &slot.passwordsBuffer);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(kernel, 1, sizeof(cl_mem), &slot.offsetsBuffer);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(kernel, 2, sizeof(cl_uint), &N);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(kernel, 3, sizeof(cl_uint), &charCount);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(kernel, 4, sizeof(cl_mem), &targetsBuffer);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(kernel, 5, sizeof(cl_uint), &targetCount);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(kernel, 6, sizeof(cl_mem), &bloomBuffer);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(kernel, 7, sizeof(cl_uint), &bloomShift);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(kernel, 8, sizeof(cl_mem), &slot.matchesBuffer);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(kernel, 9, sizeof(cl_uint), &matchCapacity);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(kernel, 10, sizeof(cl_mem), &slot.matchCountBuffer);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		}
+
+		if (longCount > 0)
+		{
+			cl_uint longN = longCount;
+			cl_uint longCharCount = batch.longPasswords.size();
+
+			clResult = clSetKernelArg(multiBlockKernel, 0, sizeof(cl_mem), &slot.longPasswordsBuffer);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(multiBlockKernel, 1, sizeof(cl_mem), &slot.longOffsetsBuffer);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(multiBlockKernel, 2, sizeof(cl_uint), &longN);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(multiBlockKernel, 3, sizeof(cl_uint), &longCharCount);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(multiBlockKernel, 6, sizeof(cl_mem), &targetsBuffer);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(multiBlockKernel, 7, sizeof(cl_uint), &targetCount);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(multiBlockKernel, 8, sizeof(cl_mem), &bloomBuffer);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(multiBlockKernel, 9, sizeof(cl_uint), &bloomShift);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(multiBlockKernel, 10, sizeof(cl_mem), &slot.longMatchesBuffer);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(multiBlockKernel, 11, sizeof(cl_uint), &matchCapacity);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+			clResult = clSetKernelArg(multiBlockKernel, 12, sizeof(cl_mem), &slot.longMatchCountBuffer);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		}
+
+		const bool tuneShort = kernelLocalSize == 0 && N > 0;
+		const bool tuneLong = multiBlockLocalSize == 0 && longCount > 0;
+
+		if (tuneShort)
+		{
+			kernelLocalSize = tunedLocalSize("sha256_crack", kernelWorkGroupSize,
+											 [&](size_t localSize, std::vector<cl_event> &events) {
+												 return launchShort(batch, localSize, uploadDone, events);
+											 });
+		}
+
+		if (tuneLong)
+		{
+			multiBlockLocalSize = tunedLocalSize("sha256_crack_multi_block", multiBlockWorkGroupSize,
+												 [&](size_t localSize, std::vector<cl_event> &events) {
+													 return launchLong(batch, localSize, uploadDone, events);
+												 });
+		}
+
+		if (autotune && (tuneShort || tuneLong))
+		{
+			resetTunedMatches(slot);
+		}
+
+		if (N > 0)
+		{
+			clResult = launchShort(batch, kernelLocalSize, uploadDone, slot.kernelEvents);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		}
+
+		// katrai grupai savs izsaukums, kopējais laiks ir visu izsaukumu profilēšanas laiku summa
+		if (longCount > 0)
+		{
+			clResult = launchLong(batch, multiBlockLocalSize, uploadDone, slot.longEvents);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		}
+
+		// skaitītāji tiek nolasīti kodolu rindā aiz kodoliem, rinda ir secīga, tāpēc pietiek ar otrās nolasīšanas
+		// notikumu
+		clResult = clEnqueueReadBuffer(clStuffContainer.queue, slot.matchCountBuffer, CL_FALSE, 0, sizeof(cl_uint),
+									   &slot.matchCounts[0], 1, &uploadDone, nullptr);
 		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
-		clResult = clSetKernelArg(kernel, 5, sizeof(cl_mem), &crackedIdxBuffer);
+
+		clResult = clEnqueueReadBuffer(clStuffContainer.queue, slot.longMatchCountBuffer, CL_FALSE, 0, sizeof(cl_uint),
+									   &slot.matchCounts[1], 1, &uploadDone, &slot.countsReady);
 		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
-		cl_event profilingEvent;
+		clFlush(clStuffContainer.queue);
+	};
+
+	// sagaida partijas kodolus, logo laikus un nolasa sakritības, pēc tam ligzdu var atdot lasītājam
+	auto finishBatch = [&](const PasswordBatch &batch) {
+		ClBatchSlot &slot = slots[batch.slot];
 
-		size_t localSize = kernelWorkGroupSize;
-		size_t globalSize = ((N + localSize - 1) / localSize) * localSize;
+		clWaitForEvents(1, &slot.countsReady);
+		clReleaseEvent(slot.countsReady);
 
-		clResult = clEnqueueNDRangeKernel(clStuffContainer.queue, kernel, 1, nullptr, &globalSize, &localSize, 0,
-										  nullptr, &profilingEvent);
+		logger.log("pw batch loaded from file and processed", batch.parseMs);
+
+		const double uploadMs = releaseProfiledEvents(slot.uploadEvents);
+		logger.log("kernel buffer creation time", uploadMs);
+
+		const double kernelExecMs = releaseProfiledEvents(slot.kernelEvents);
+
+		if (batch.shortCount > 0)
+		{
+			logger.log("kernel exec time", kernelExecMs);
+		}
+
+		// garo paroļu caurlaidspēja tiek logota atsevišķi, lai tā neietekmētu viena bloka kodola laikus
+		const double longExecMs = releaseProfiledEvents(slot.longEvents);
+
+		if (!batch.longOffsets.empty())
+		{
+			logger.log("long pw kernel exec time", longExecMs);
+			logger.log("long pw hashes per second", batch.longOffsets.size() / (longExecMs / 1000.0));
+		}
+
+		uploadTotalMs += uploadMs;
+		kernelTotalMs += kernelExecMs + longExecMs;
+
+		const size_t crackedBefore = cracked.size();
+
+		// sakritības tiek nolasītas kopēšanas rindā, jo kodolu rindā jau ir nākamās partijas kodoli
+		// indeksi ir relatīvi īso vai garo paroļu buferim
+		for (const cl_uint2 &match : readMatches(copyQueue, slot.matchesBuffer, slot.matchCounts[0], matchCapacity))
+		{
+			const cl_uint idx = match.s[0];
+			const cl_uint pwStart = batch.offsets[idx];
+			const cl_uint pwEnd = idx < batch.shortCount - 1 ? batch.offsets[idx + 1] : batch.pwBytes;
+
+			cracked.push_back(
+				{batch.shortLineIdx[idx], match.s[1],
+				 std::string(reinterpret_cast<const char *>(&batch.passwords[pwStart]), pwEnd - pwStart)});
+		}
+
+		for (const cl_uint2 &match :
+			 readMatches(copyQueue, slot.longMatchesBuffer, slot.matchCounts[1], matchCapacity))
+		{
+			const cl_uint idx = match.s[0];
+			const cl_uint pwStart = batch.longOffsets[idx];
+			const cl_uint pwEnd =
+				idx < batch.longOffsets.size() - 1 ? batch.longOffsets[idx + 1] : batch.longPasswords.size();
+
+			cracked.push_back(
+				{batch.longLineIdx[idx], match.s[1],
+				 std::string(reinterpret_cast<const char *>(&batch.longPasswords[pwStart]), pwEnd - pwStart)});
+		}
+
+		markFound(crackedBefore);
+	};
+
+	// neapstrādāta gabala kopēšana un rindu sadalīšana ierīcē: rindu sākumu skaitīšana pa daļām, daļu prefiksa summa,
+	// rindu sākumu ierakstīšana offsetu buferī un jaucēšana tieši gabalā
+	auto submitRawChunk = [&](const PasswordBatch &batch) {
+		ClBatchSlot &slot = slots[batch.slot];
+
+		// gabals tiek rakstīts no faila attēlojuma, kas paliek derīgs līdz funkcijas beigām, tāpēc rakstīšana nebloķē
+		const cl_uint zero = 0;
+		slot.uploadEvents.resize(3);
+
+		clResult = clEnqueueFillBuffer(copyQueue, slot.matchCountBuffer, &zero, sizeof(cl_uint), 0, sizeof(cl_uint), 0,
+									   nullptr, &slot.uploadEvents[0]);
 		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
-		cl_ulong start;
-		cl_ulong end;
+		clResult = clEnqueueFillBuffer(copyQueue, slot.lineCountBuffer, &zero, sizeof(cl_uint), 0, sizeof(cl_uint), 0,
+									   nullptr, &slot.uploadEvents[1]);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
-		clGetEventProfilingInfo(profilingEvent, CL_PROFILING_COMMAND_START, sizeof(start), &start, nullptr);
-		clGetEventProfilingInfo(profilingEvent, CL_PROFILING_COMMAND_COMPLETE, sizeof(end), &end, nullptr);
+		clResult = clEnqueueWriteBuffer(copyQueue, slot.passwordsBuffer, CL_FALSE, 0, batch.rawBytes * sizeof(cl_uchar),
+										batch.rawChunk, 0, nullptr, &slot.uploadEvents[2]);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
-		double kernelExecTime = static_cast<double>(end - start);
+		clFlush(copyQueue);
+		const cl_event uploadDone = slot.uploadEvents.back();
 
-		logger.log("kernel exec time", kernelExecTime / 1e6); // 1e6, lai dabūtu rezultātu milisekundēs
+		const cl_uint chunkBytes = batch.rawBytes;
 
-		clReleaseEvent(profilingEvent);
+		clResult = clSetKernelArg(countKernel, 0, sizeof(cl_mem), &slot.passwordsBuffer);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(countKernel, 1, sizeof(cl_uint), &chunkBytes);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(countKernel, 2, sizeof(cl_mem), &slot.tileCountsBuffer);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
-		clResult = clEnqueueReadBuffer(clStuffContainer.queue, crackedIdxBuffer, CL_TRUE, 0, sizeof(int), &crackedIdx,
-									   0, nullptr, nullptr);
+		clResult = clSetKernelArg(scanKernel, 0, sizeof(cl_mem), &slot.tileCountsBuffer);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(scanKernel, 2, sizeof(cl_mem), &slot.lineCountBuffer);
 		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
 
-		if (crackedIdx != -1)
+		clResult = clSetKernelArg(writeKernel, 0, sizeof(cl_mem), &slot.passwordsBuffer);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(writeKernel, 1, sizeof(cl_uint), &chunkBytes);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(writeKernel, 2, sizeof(cl_mem), &slot.tileCountsBuffer);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(writeKernel, 3, sizeof(cl_mem), &slot.offsetsBuffer);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		clResult = clSetKernelArg(linesKernel, 0, sizeof(cl_mem), &slot.passwordsBuffer);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(linesKernel, 1, sizeof(cl_uint), &chunkBytes);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(linesKernel, 2, sizeof(cl_mem), &slot.offsetsBuffer);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(linesKernel, 3, sizeof(cl_mem), &slot.lineCountBuffer);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(linesKernel, 4, sizeof(cl_mem), &targetsBuffer);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(linesKernel, 5, sizeof(cl_uint), &targetCount);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(linesKernel, 6, sizeof(cl_mem), &bloomBuffer);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(linesKernel, 7, sizeof(cl_uint), &bloomShift);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(linesKernel, 8, sizeof(cl_mem), &slot.matchesBuffer);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(linesKernel, 9, sizeof(cl_mem), &slot.matchStartsBuffer);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(linesKernel, 10, sizeof(cl_uint), &matchCapacity);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		clResult = clSetKernelArg(linesKernel, 11, sizeof(cl_mem), &slot.matchCountBuffer);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		// rindu sadalīšanas rezultāts nav atkarīgs no darba grupas izmēra, tāpēc sha256_crack_lines mērījumi izmanto
+		// pēdējā sadalīšanas mērījuma rindu sākumus
+		if (splitLocalSize == 0)
 		{
+			splitLocalSize = tunedLocalSize("sha256_line_split", splitWorkGroupSize,
+											[&](size_t localSize, std::vector<cl_event> &events) {
+												return launchSplit(chunkBytes, localSize, uploadDone, events);
+											});
 
-			cl_uint pwStart = batchedOffsets[crackedIdx];
-			size_t pwSize;
+			// no kešatmiņas nolasīts mazāks izmērs neietilpst daļu skaitu buferī
+			splitLocalSize = std::max(splitLocalSize, SPLIT_MIN_GROUP_SIZE);
+		}
+
+		if (linesLocalSize == 0)
+		{
+			linesLocalSize = tunedLocalSize("sha256_crack_lines", linesWorkGroupSize,
+											[&](size_t localSize, std::vector<cl_event> &events) {
+												return launchLines(localSize, events);
+											});
 
-			if (static_cast<cl_uint>(crackedIdx) < N - 1)
+			if (autotune)
 			{
-				pwSize = batchedOffsets[crackedIdx + 1] - pwStart;
+				resetTunedMatches(slot);
 			}
-			else
+		}
+
+		clResult = launchSplit(chunkBytes, splitLocalSize, uploadDone, slot.splitEvents);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		clResult = launchLines(linesLocalSize, slot.kernelEvents);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		clResult = clEnqueueReadBuffer(clStuffContainer.queue, slot.matchCountBuffer, CL_FALSE, 0, sizeof(cl_uint),
+									   &slot.matchCounts[0], 0, nullptr, nullptr);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		clResult = clEnqueueReadBuffer(clStuffContainer.queue, slot.lineCountBuffer, CL_FALSE, 0, sizeof(cl_uint),
+									   &slot.lineCount, 0, nullptr, &slot.countsReady);
+		ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+
+		clFlush(clStuffContainer.queue);
+	};
+
+	// gabala pirmās rindas indekss failā, rindu skaits gabalā kļūst zināms tikai pēc tā apstrādes
+	size_t rawLineIdx = 0;
+
+	auto finishRawChunk = [&](const PasswordBatch &batch) {
+		ClBatchSlot &slot = slots[batch.slot];
+
+		clWaitForEvents(1, &slot.countsReady);
+		clReleaseEvent(slot.countsReady);
+
+		logger.log("pw batch loaded from file and processed", batch.parseMs);
+
+		const double uploadMs = releaseProfiledEvents(slot.uploadEvents);
+		logger.log("kernel buffer creation time", uploadMs);
+
+		const double splitMs = releaseProfiledEvents(slot.splitEvents);
+		logger.log("line split time", splitMs);
+
+		const double kernelExecMs = releaseProfiledEvents(slot.kernelEvents);
+		logger.log("kernel exec time", kernelExecMs);
+
+		uploadTotalMs += uploadMs;
+		kernelTotalMs += splitMs + kernelExecMs;
+
+		const std::vector<cl_uint2> matches =
+			readMatches(copyQueue, slot.matchesBuffer, slot.matchCounts[0], matchCapacity);
+		std::vector<cl_uint> matchStarts(matches.size());
+
+		if (!matches.empty())
+		{
+			clResult = clEnqueueReadBuffer(copyQueue, slot.matchStartsBuffer, CL_TRUE, 0,
+										   matchStarts.size() * sizeof(cl_uint), matchStarts.data(), 0, nullptr,
+										   nullptr);
+			ASSERT(clResult == CL_SUCCESS, ClErrorCodesToString(clResult));
+		}
+
+		const size_t crackedBefore = cracked.size();
+
+		// parole tiek nolasīta no gabala tāpat kā ierīcē: līdz '\n' vai gabala beigām, bez '\r'
+		for (size_t m = 0; m < matches.size(); m++)
+		{
+			const uint8_t *line = batch.rawChunk + matchStarts[m];
+			const size_t maxLength = batch.rawBytes - matchStarts[m];
+			const void *newline = memchr(line, '\n', maxLength);
+
+			size_t length = newline != nullptr ? static_cast<const uint8_t *>(newline) - line : maxLength;
+
+			if (length > 0 && line[length - 1] == '\r')
 			{
-				pwSize = charCount - pwStart;
+				length--;
 			}
 
-			foundPw = std::string(reinterpret_cast<const char *>(&batchedKernelPasswords[pwStart]), pwSize);
+			cracked.push_back({rawLineIdx + matches[m].s[0], matches[m].s[1],
+							   std::string(reinterpret_cast<const char *>(line), length)});
+		}
+
+		rawLineIdx += slot.lineCount;
+
+		markFound(crackedBefore);
+	};
+
+	auto pipelineStart = std::chrono::steady_clock::now();
 
-			crackedIdx += (lineIdx - i); // indekss ir relatīvs batcham, tāpēc vajag offsetu pieskaitīt
+	MappedWordlist wordlist(pwFileName);
 
-			clReleaseMemObject(pinnedPasswordsHost);
-			clReleaseMemObject(pinnedOffsetsHost);
-			clReleaseMemObject(passwordsBuffer);
-			clReleaseMemObject(offsetsBuffer);
-			clReleaseMemObject(targetHashBuffer);
-			clReleaseMemObject(crackedIdxBuffer);
-			clReleaseKernel(kernel);
+	// OpenCL neļauj reģistrēt esošu atmiņu ierīcei, tāpēc gabali vienmēr tiek rakstīti no attēlojuma
+	PasswordBatchReader reader(wordlist, batchSize, deviceSplit ? rawChunkBytes : passwordsCapacity, passwordSlots,
+							   offsetSlots, deviceSplit ? BatchLayout::MappedRawChunks : BatchLayout::Passwords);
 
-			return crackedIdx;
+	// partija, kuras kodoli vēl var izpildīties, tās rezultāti tiek nolasīti pēc nākamās partijas ierindošanas
+	PasswordBatch *pending = nullptr;
+
+	while (foundCount < targetCount)
+	{
+		PasswordBatch *batch = reader.next();
+
+		if (batch == nullptr)
+		{
+			break; // failā vairs nekā nav
 		}
+
+		deviceSplit ? submitRawChunk(*batch) : submitBatch(*batch);
+
+		if (pending != nullptr)
+		{
+			deviceSplit ? finishRawChunk(*pending) : finishBatch(*pending);
+			reader.release(pending);
+		}
+
+		pending = batch;
+	}
+
+	if (pending != nullptr)
+	{
+		deviceSplit ? finishRawChunk(*pending) : finishBatch(*pending);
+		reader.release(pending);
+	}
+
+	reader.finish();
+
+	auto pipelineEnd = std::chrono::steady_clock::now();
+
+	// katra posma aizņemtība procentos no konveijera kopējā laika, ja kodoli ir tuvu 100%, tad konveijeru ierobežo
+	// jaucēšana, nevis faila apstrāde vai kopēšana, gaidīšanas laiki parāda, cik ilgi kodoli gaidīja uz partijām
+	const double pipelineMs = std::chrono::duration<double, std::milli>(pipelineEnd - pipelineStart).count();
+
+	logger.log("pipeline parse utilisation", 100.0 * reader.parseMs() / pipelineMs);
+	logger.log("pipeline upload utilisation", 100.0 * uploadTotalMs / pipelineMs);
+	logger.log("pipeline kernel utilisation", 100.0 * kernelTotalMs / pipelineMs);
+	logger.log("pipeline wait for parsed batch time", reader.consumerWaitMs());
+	logger.log("pipeline reader wait for free slot time", reader.readerWaitMs());
+
+	// kodoli sakritības pievieno jebkurā secībā, rezultāti tiek sakārtoti pēc rindas failā
+	std::sort(cracked.begin(), cracked.end(),
+			  [](const CrackedPassword &a, const CrackedPassword &b) { return a.lineIdx < b.lineIdx; });
+
+	for (ClBatchSlot &slot : slots)
+	{
+		if (slot.pinnedPasswordsHost == nullptr)
+		{
+			continue; // neapstrādātu gabalu režīmā piespraustās atmiņas nav
+		}
+
+		clEnqueueUnmapMemObject(copyQueue, slot.pinnedPasswordsHost, slot.batchedKernelPasswords, 0, nullptr, nullptr);
+		clEnqueueUnmapMemObject(copyQueue, slot.pinnedOffsetsHost, slot.batchedOffsets, 0, nullptr, nullptr);
 	}
 
-	file.close();
+	clFinish(copyQueue);
+
+	for (ClBatchSlot &slot : slots)
+	{
+		if (slot.pinnedPasswordsHost != nullptr)
+		{
+			clReleaseMemObject(slot.pinnedPasswordsHost);
+			clReleaseMemObject(slot.pinnedOffsetsHost);
+		}
+
+		clReleaseMemObject(slot.passwordsBuffer);
+		clReleaseMemObject(slot.offsetsBuffer);
+		clReleaseMemObject(slot.matchesBuffer);
+		clReleaseMemObject(slot.longMatchesBuffer);
+		clReleaseMemObject(slot.matchCountBuffer);
+		clReleaseMemObject(slot.longMatchCountBuffer);
+
+		if (slot.longPasswordsBuffer != nullptr)
+		{
+			clReleaseMemObject(slot.longPasswordsBuffer);
+			clReleaseMemObject(slot.longOffsetsBuffer);
+		}
+
+		if (slot.tileCountsBuffer != nullptr)
+		{
+			clReleaseMemObject(slot.tileCountsBuffer);
+			clReleaseMemObject(slot.matchStartsBuffer);
+			clReleaseMemObject(slot.lineCountBuffer);
+		}
+	}
+
+	clReleaseMemObject(targetsBuffer);
+	clReleaseMemObject(bloomBuffer);
+
+	clReleaseCommandQueue(copyQueue);
 
-	clReleaseMemObject(pinnedPasswordsHost);
-	clReleaseMemObject(pinnedOffsetsHost);
-	clReleaseMemObject(passwordsBuffer);
-	clReleaseMemObject(offsetsBuffer);
-	clReleaseMemObject(targetHashBuffer);
-	clReleaseMemObject(crackedIdxBuffer);
 	clReleaseKernel(kernel);
+	clReleaseKernel(multiBlockKernel);
 
-	return -1;
+	if (deviceSplit)
+	{
+		clReleaseKernel(countKernel);
+		clReleaseKernel(scanKernel);
+		clReleaseKernel(writeKernel);
+		clReleaseKernel(linesKernel);
+	}
 }
 
 int main(int argc, char *argv[])
 {
-	if (argc == 4)
+	// rindu sadalīšana ierīcē un darba grupu izmēru mērīšana, karodziņi ir pirms paroļu faila jebkurā secībā,
+	// pārējie argumenti paliek tādi paši
+	bool deviceSplit = false;
+	bool autotune = false;
+	int flagCount = 0;
+
+	for (; flagCount + 1 < argc; flagCount++)
+	{
+		const std::string flag = argv[flagCount + 1];
+
+		if (flag == "--device-split")
+			deviceSplit = true;
+		else if (flag == "--autotune")
+			autotune = true;
+		else
+			break;
+	}
+
+	char **args = argv + flagCount;
+	const int argCount = argc - flagCount;
+
+	if (argc == 3 && std::string(argv[1]) == "--prewarm-cache")
+	{
+		// kompilē kodolus un saglabā tos programmu kešatmiņā, lai pirmā īstā palaišana tos nekompilētu
+		BenchmarkLogger logger(argv[2], "OpenCL");
+
+		ClStuffContainer clStuffContainer(logger);
+		clStuffContainer.prewarmProgram("kernels/sha256.cl");
+
+		std::cout << "Program cache is ready.\n";
+		return 0;
+	}
+	else if (argCount == 4 || (argCount == 5 && std::string(args[2]) == "--targets"))
 	{
-		const std::string inputFileName = argv[1];
-		const std::string hexHash = argv[2];
-		const std::string logFileName = argv[3];
+		const bool multiTarget = argCount == 5;
+
+		const std::string inputFileName = args[1];
+		const std::string logFileName = args[argCount - 1];
+
+		// viens hash no komandrindas vai hash saraksts no faila, abos gadījumos tie tiek meklēti vienā tabulā
+		const std::vector<std::string> hexHashes =
+			multiTarget ? readHashFile(args[3]) : std::vector<std::string>{args[2]};
 
 		BenchmarkLogger logger(logFileName, "OpenCL");
 
 		ClStuffContainer clStuffContainer(logger);
 
-		std::vector<cl_uint> hash = hexStringToBytes(hexHash);
+		auto targetTableStart = std::chrono::steady_clock::now();
+
+		const TargetTable targets = buildTargetTable(hexHashes);
+
+		auto targetTableEnd = std::chrono::steady_clock::now();
+
+		logger.chronoLog("target table creation time", targetTableStart, targetTableEnd);
 
 		auto hashCheckStart = std::chrono::steady_clock::now();
 
-		std::string foundPw;
+		std::vector<CrackedPassword> cracked;
 
-		std::cout << "Starting search...\n";
+		std::cout << "Starting search for " << targets.size() << " hash(es)...\n";
 
-		int crackedIdx = hashCheck_v2_with_pinned_memory(clStuffContainer, inputFileName, hash, foundPw, logger);
+		hashCheck_v2_with_pinned_memory(clStuffContainer, inputFileName, targets, cracked, deviceSplit, autotune,
+										logger);
 
 		auto hashCheckEnd = std::chrono::steady_clock::now();
 
 		logger.chronoLog("hash check time", hashCheckStart, hashCheckEnd);
 
-		if (crackedIdx == -1)
+		if (cracked.empty())
 		{
 
 			std::cout << "No matching password found." << "\n";
 			return 0;
 		}
 
-		std::cout << "Password found index " << crackedIdx << ": " << foundPw << "\n";
+		for (const CrackedPassword &found : cracked)
+		{
+			std::cout << "Password found index " << found.lineIdx << ": " << found.password;
+
+			if (multiTarget)
+			{
+				std::cout << "\t" << targets.hex(found.targetIdx);
+			}
+
+			std::cout << "\n";
+		}
+
+		if (multiTarget)
+		{
+			std::cout << "Found " << cracked.size() << " passwords for " << targets.size() << " hashes\n";
+		}
+
 		return 0;
 	}
 	else
 	{
 		std::cout << "Correct program usage:\n"
-				  << "\t\t" << argv[0] << " <passwords file> <password hash> <log file>\n";
+				  << "\t\t" << argv[0] << " <passwords file> <password hash> <log file>\n"
+				  << "\tFor a list of hashes (one 64 hex character hash per line):\n"
+				  << "\t\t" << argv[0] << " <passwords file> --targets <hashes file> <log file>\n"
+				  << "\tTo upload raw file chunks and split lines on the device, start either form with:\n"
+				  << "\t\t" << argv[0] << " --device-split <passwords file> ...\n"
+				  << "\tTo time the kernel work group sizes on the first batches and store the fastest in "
+				  << "autotune.json (or GOL_AUTOTUNE_FILE), later runs reuse them, start either form with:\n"
+				  << "\t\t" << argv[0] << " --autotune <passwords file> ...\n"
+				  << "\tCompiled kernels are cached in " << ProgramCache::defaultDirectory()
+				  << " (set CL_PROGRAM_CACHE_DIR to change it, empty to disable), to fill the cache ahead of time:\n"
+				  << "\t\t" << argv[0] << " --prewarm-cache <log file>\n";
 		return -1;
 	}
 }
@@ -0,0 +1,688 @@
+// SHA 256 paroļu meklēšana uz CPU ar vairākiem pavedieniem un SIMD
+// https://en.wikipedia.org/wiki/SHA-2
+
+#include "benchmarkLogger.h"
+#include "sha256Simd.h"
+#include "sha256_cpu.h"
+#include "targetTable.h"
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// paroļu skaits vienā partijā, tāpat kā GPU versijās
+constexpr size_t BATCH_SIZE = 1 << 20;
+
+// paroļu skaits, ko pavediens paņem no partijas vienā reizē, starp tām pavediens pārbauda, vai visi hash jau atrasti
+constexpr size_t BATCH_CHUNK = 4096;
+
+// garo paroļu parasti ir maz un katra ir vairāki bloki, tāpēc tās tiek dalītas mazākos gabalos
+constexpr size_t LONG_BATCH_CHUNK = 256;
+
+// sakritība partijā: paroles indekss partijā un hash indekss tabulā, tāpat kā GPU versiju sakritību buferos
+struct BatchMatch
+{
+	uint32_t pwIdx;
+	uint32_t targetIdx;
+};
+
+static uint8_t parseHexByte(const std::string &hash, size_t offset)
+{
+	std::string byteString = hash.substr(offset, 2);
+	return static_cast<uint8_t>(std::stoi(byteString, nullptr, 16));
+}
+
+std::vector<uint8_t> hexStringToBytes(const std::string &hash)
+{
+	// 256 biti => 64 hex skaitļi
+	if (hash.size() != 64)
+	{
+		throw std::runtime_error("SHA-256 hash as a hex string must be exactly 64 characters!");
+	}
+
+	std::vector<uint8_t> result(32);
+
+	for (size_t i = 0; i < 32; i++)
+	{
+		result[i] = parseHexByte(hash, i * 2);
+	}
+
+	return result;
+}
+
+std::string parseBytesToHexString(const uint8_t *data, size_t length)
+{
+	std::ostringstream ss;
+
+	for (size_t i = 0; i < length; i++)
+	{
+		ss << std::hex << std::setw(2) << std::setfill('0') << (int)data[i];
+	}
+
+	return ss.str();
+}
+
+// nolasa nākamo partiju, paroles tiek ierakstītas pēc kārtas bez atdalītājiem, 'offsets' satur katras paroles sākumu
+// un beigās vēl vienu elementu ar kopējo baitu skaitu, tāpēc paroles garums vienmēr ir offsets[i + 1] - offsets[i]
+// paroles, kas neietilpst vienā blokā, paliek partijā, bet to indeksi tiek sagrupēti pēc bloku skaita 'longBuckets'
+// un pēc tam secīgi ierakstīti 'longIndices', lai vienā SIMD izsaukumā visām joslām būtu vienāds bloku skaits
+static size_t loadBatch(std::ifstream &file, std::vector<uint8_t> &passwords, std::vector<uint32_t> &offsets,
+						std::map<size_t, std::vector<uint32_t>> &longBuckets, std::vector<uint32_t> &longIndices)
+{
+	passwords.clear();
+	offsets.clear();
+	longIndices.clear();
+
+	for (auto &[blockCount, indices] : longBuckets)
+	{
+		indices.clear();
+	}
+
+	std::string line;
+
+	while (offsets.size() < BATCH_SIZE && std::getline(file, line))
+	{
+		// CRLF failos rindas beigās paliek '\r', tas netiek jaucēts, tāpat kā GPU versiju PasswordBatchReader
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+
+		if (line.size() > SHA256_MAX_MESSAGE_LENGTH)
+		{
+			longBuckets[sha256BlockCount(line.size())].push_back(static_cast<uint32_t>(offsets.size()));
+		}
+
+		offsets.push_back(static_cast<uint32_t>(passwords.size()));
+		passwords.insert(passwords.end(), line.begin(), line.end());
+	}
+
+	offsets.push_back(static_cast<uint32_t>(passwords.size()));
+
+	for (auto &[blockCount, indices] : longBuckets)
+	{
+		longIndices.insert(longIndices.end(), indices.begin(), indices.end());
+	}
+
+	return offsets.size() - 1;
+}
+
+// meklē joslu hash tabulā, atrastās paroles tiek pievienotas 'matches'
+static void matchLanes(const uint32_t (*states)[8], const size_t *indices, size_t lanes, const TargetTable &targets,
+					   std::vector<BatchMatch> &matches)
+{
+	for (size_t lane = 0; lane < lanes; lane++)
+	{
+		const int64_t targetIdx = targets.find(states[lane]);
+
+		if (targetIdx != -1)
+		{
+			matches.push_back({static_cast<uint32_t>(indices[lane]), static_cast<uint32_t>(targetIdx)});
+		}
+	}
+}
+
+// pārbauda partijas paroles [begin, end) pa SHA256_LANES reizē, visas sakritības tiek pievienotas 'matches'
+// paroles, kas neietilpst vienā blokā, tiek izlaistas, tās pārbauda findLongInRange
+static void findInRange(const uint8_t *passwords, const uint32_t *offsets, size_t begin, size_t end,
+						const TargetTable &targets, std::vector<BatchMatch> &matches)
+{
+	const uint8_t *messages[SHA256_LANES];
+	size_t lengths[SHA256_LANES];
+	size_t indices[SHA256_LANES];
+	uint32_t states[SHA256_LANES][8];
+	size_t lanes = 0;
+
+	for (size_t idx = begin; idx < end || lanes > 0; idx++)
+	{
+		if (idx < end)
+		{
+			const size_t length = offsets[idx + 1] - offsets[idx];
+			if (length > SHA256_MAX_MESSAGE_LENGTH)
+			{
+				continue;
+			}
+
+			messages[lanes] = passwords + offsets[idx];
+			lengths[lanes] = length;
+			indices[lanes] = idx;
+			lanes++;
+
+			if (lanes < SHA256_LANES)
+			{
+				continue;
+			}
+		}
+
+		// pēdējā grupā neaizpildītās joslas saņem tukšu ziņojumu, to rezultāts netiek meklēts
+		for (size_t lane = lanes; lane < SHA256_LANES; lane++)
+		{
+			messages[lane] = passwords;
+			lengths[lane] = 0;
+		}
+
+		sha256HashLanes(messages, lengths, states);
+		matchLanes(states, indices, lanes, targets, matches);
+
+		lanes = 0;
+	}
+}
+
+// pārbauda garās paroles longIndices[begin, end), kas sakārtotas pēc bloku skaita, joslās vienmēr ir paroles ar
+// vienādu bloku skaitu, tāpēc, mainoties bloku skaitam, nepilnā grupa tiek apstrādāta uzreiz
+static void findLongInRange(const uint8_t *passwords, const uint32_t *offsets, const uint32_t *longIndices,
+							size_t begin, size_t end, const TargetTable &targets, std::vector<BatchMatch> &matches)
+{
+	const uint8_t *messages[SHA256_LANES];
+	size_t lengths[SHA256_LANES];
+	size_t indices[SHA256_LANES];
+	uint32_t states[SHA256_LANES][8];
+	size_t lanes = 0;
+	size_t blockCount = 0;
+
+	for (size_t i = begin; i < end || lanes > 0; i++)
+	{
+		if (i < end)
+		{
+			const size_t idx = longIndices[i];
+			const size_t length = offsets[idx + 1] - offsets[idx];
+
+			if (lanes == 0 || sha256BlockCount(length) == blockCount)
+			{
+				messages[lanes] = passwords + offsets[idx];
+				lengths[lanes] = length;
+				indices[lanes] = idx;
+				blockCount = sha256BlockCount(length);
+				lanes++;
+
+				if (lanes < SHA256_LANES)
+				{
+					continue;
+				}
+			}
+			else
+			{
+				i--; // šī parole sāks nākamo grupu
+			}
+		}
+
+		// neaizpildītās joslas atkārto pirmo ziņojumu, to rezultāts netiek meklēts
+		for (size_t lane = lanes; lane < SHA256_LANES; lane++)
+		{
+			messages[lane] = messages[0];
+			lengths[lane] = lengths[0];
+		}
+
+		sha256HashLanesMultiBlock(messages, lengths, blockCount, states);
+		matchLanes(states, indices, lanes, targets, matches);
+
+		lanes = 0;
+	}
+}
+
+void hashCheck(const std::string &fileName, const TargetTable &targets, std::vector<CrackedPassword> &cracked,
+			   unsigned threadCount, BenchmarkLogger &logger)
+{
+	std::ifstream file(fileName, std::ios::binary);
+	if (!file.is_open())
+	{
+		throw std::runtime_error("Could not open file " + fileName);
+	}
+
+	auto bufferCreationStart = std::chrono::steady_clock::now();
+
+	// buferi tiek izmantoti atkārtoti visām partijām, clear() nesamazina to ietilpību
+	std::vector<uint8_t> passwords;
+	std::vector<uint32_t> offsets;
+	std::map<size_t, std::vector<uint32_t>> longBuckets; // atslēga ir bloku skaits
+	std::vector<uint32_t> longIndices;
+
+	passwords.reserve(BATCH_SIZE * 16);
+	offsets.reserve(BATCH_SIZE + 1);
+
+	auto bufferCreationEnd = std::chrono::steady_clock::now();
+
+	logger.chronoLog("host side buffer creation time", bufferCreationStart, bufferCreationEnd);
+
+	size_t batchFirstIdx = 0; // partijas pirmās paroles indekss failā
+	size_t batchCount = 0;
+	bool done = false;
+
+	std::atomic<size_t> nextChunk = 0;
+	std::atomic<size_t> nextLongChunk = 0;
+	std::atomic<int64_t> longNanoseconds = 0; // visu pavedienu kopējais garo paroļu apstrādes laiks
+	std::exception_ptr loadError;
+
+	// katrs pavediens sakritības krāj savā vektorā, tās tiek apvienotas partijas beigās
+	std::vector<std::vector<BatchMatch>> threadMatches(threadCount);
+
+	// meklēšana beidzas, kad atrastas paroles visiem hash, ar vienu hash tas notiek uzreiz pēc atrastās paroles
+	const size_t targetCount = targets.size();
+	std::vector<std::atomic<bool>> targetFound(targetCount);
+	std::atomic<size_t> foundCount = 0;
+
+	auto allFound = [&]() { return foundCount.load(std::memory_order_relaxed) == targetCount; };
+
+	auto batchStart = std::chrono::steady_clock::now();
+
+	auto loadNextBatch = [&]() {
+		auto pwBatchStart = std::chrono::steady_clock::now();
+
+		batchFirstIdx += batchCount;
+		batchCount = loadBatch(file, passwords, offsets, longBuckets, longIndices);
+
+		auto pwBatchEnd = std::chrono::steady_clock::now();
+
+		logger.chronoLog("pw batch loaded from file and processed", pwBatchStart, pwBatchEnd);
+
+		nextChunk = 0;
+		nextLongChunk = 0;
+		longNanoseconds = 0;
+		done = batchCount == 0;
+
+		batchStart = std::chrono::steady_clock::now();
+	};
+
+	loadNextBatch();
+
+	// izpildās vienu reizi pēc tam, kad visi pavedieni pabeiguši partiju, tāpēc nākamo partiju var ielādēt tajos pašos
+	// buferos un logeris netiek izsaukts paralēli, kad atrasti visi hash, jaunas partijas vairs netiek lasītas
+	auto onBatchDone = [&]() noexcept {
+		auto batchEnd = std::chrono::steady_clock::now();
+
+		logger.chronoLog("kernel exec time", batchStart, batchEnd);
+
+		// garās paroles pavedieni apstrādā pēc īsajām, viena pavediena vidējais laiks atbilst šīs daļas ilgumam
+		// un tiek logots atsevišķi, lai būtu redzama garo paroļu caurlaidspēja, ja partija netika pārtraukta
+		if (!longIndices.empty() && !allFound())
+		{
+			const double longExecMs = longNanoseconds.load() / 1e6 / threadCount;
+
+			logger.log("long pw kernel exec time", longExecMs);
+			logger.log("long pw hashes per second", longIndices.size() / (longExecMs / 1000.0));
+		}
+
+		try
+		{
+			// paroles jānokopē pirms nākamās partijas ielādes tajos pašos buferos
+			for (std::vector<BatchMatch> &matches : threadMatches)
+			{
+				for (const BatchMatch &match : matches)
+				{
+					const uint32_t pwStart = offsets[match.pwIdx];
+					const uint32_t pwSize = offsets[match.pwIdx + 1] - pwStart;
+
+					// indekss ir relatīvs partijai, tāpēc vajag offsetu pieskaitīt
+					cracked.push_back({batchFirstIdx + match.pwIdx, match.targetIdx,
+									   std::string(reinterpret_cast<const char *>(&passwords[pwStart]), pwSize)});
+				}
+
+				matches.clear();
+			}
+
+			if (allFound())
+			{
+				done = true;
+				return;
+			}
+
+			loadNextBatch();
+		}
+		catch (...)
+		{
+			loadError = std::current_exception();
+			done = true;
+		}
+	};
+
+	std::barrier batchBarrier(threadCount, onBatchDone);
+
+	// pavedieni ņem partijas gabalus no kopīga skaitītāja, tāpēc ātrāki pavedieni paņem vairāk gabalu
+	auto worker = [&](unsigned threadIdx) {
+		std::vector<BatchMatch> &matches = threadMatches[threadIdx];
+
+		// atzīmē jaunos atrastos hash, lai pavedieni varētu beigt, tiklīdz atrasti visi
+		auto markFound = [&](size_t firstNew) {
+			for (size_t m = firstNew; m < matches.size(); m++)
+			{
+				if (!targetFound[matches[m].targetIdx].exchange(true))
+				{
+					foundCount++;
+				}
+			}
+		};
+
+		while (!done)
+		{
+			for (size_t chunk = nextChunk.fetch_add(1); chunk * BATCH_CHUNK < batchCount;
+				 chunk = nextChunk.fetch_add(1))
+			{
+				// visi hash jau atrasti citos pavedienos, atlikušie gabali netiek apstrādāti
+				if (allFound())
+				{
+					break;
+				}
+
+				const size_t begin = chunk * BATCH_CHUNK;
+				const size_t end = std::min(begin + BATCH_CHUNK, batchCount);
+				const size_t firstNew = matches.size();
+
+				findInRange(passwords.data(), offsets.data(), begin, end, targets, matches);
+				markFound(firstNew);
+			}
+
+			auto longStart = std::chrono::steady_clock::now();
+
+			for (size_t chunk = nextLongChunk.fetch_add(1); chunk * LONG_BATCH_CHUNK < longIndices.size();
+				 chunk = nextLongChunk.fetch_add(1))
+			{
+				if (allFound())
+				{
+					break;
+				}
+
+				const size_t begin = chunk * LONG_BATCH_CHUNK;
+				const size_t end = std::min(begin + LONG_BATCH_CHUNK, longIndices.size());
+				const size_t firstNew = matches.size();
+
+				findLongInRange(passwords.data(), offsets.data(), longIndices.data(), begin, end, targets, matches);
+				markFound(firstNew);
+			}
+
+			auto longEnd = std::chrono::steady_clock::now();
+
+			longNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(longEnd - longStart).count();
+
+			batchBarrier.arrive_and_wait();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount - 1);
+
+	for (unsigned t = 1; t < threadCount; t++)
+	{
+		threads.emplace_back(worker, t);
+	}
+
+	worker(0);
+
+	for (std::thread &thread : threads)
+	{
+		thread.join();
+	}
+
+	if (loadError)
+	{
+		std::rethrow_exception(loadError);
+	}
+
+	// pavedieni sakritības atrod jebkurā secībā, rezultāti tiek sakārtoti pēc rindas failā
+	std::sort(cracked.begin(), cracked.end(),
+			  [](const CrackedPassword &a, const CrackedPassword &b) { return a.lineIdx < b.lineIdx; });
+
+	file.close();
+}
+
+void testSha(const std::string &password, const std::string hexExpectedHash)
+{
+	std::vector<uint8_t> expectedHash = hexStringToBytes(hexExpectedHash);
+
+	uint8_t calculatedHash[32];
+	cpu_sha256(reinterpret_cast<const uint8_t *>(password.data()), password.size(), calculatedHash);
+
+	// SIMD versijai parole tiek ielikta katrā joslā pēc kārtas, pārējās joslas satur citu paroli ar tādu pašu bloku
+	// skaitu, garām parolēm tiek izmantota vairāku bloku versija, sakrist drīkst tikai paroles joslas hash
+	uint32_t targetWords[8];
+	sha256DigestToWords(expectedHash.data(), targetWords);
+
+	const size_t blockCount = sha256BlockCount(password.size());
+	const std::string otherPassword =
+		sha256BlockCount(password.size() + 1) == blockCount ? password + "x" : password.substr(1) + "x";
+	bool simdOk = true;
+
+	for (size_t lane = 0; lane < SHA256_LANES; lane++)
+	{
+		const uint8_t *messages[SHA256_LANES];
+		size_t lengths[SHA256_LANES];
+
+		for (size_t i = 0; i < SHA256_LANES; i++)
+		{
+			const std::string &current = i == lane ? password : otherPassword;
+			messages[i] = reinterpret_cast<const uint8_t *>(current.data());
+			lengths[i] = current.size();
+		}
+
+		uint32_t states[SHA256_LANES][8];
+
+		if (password.size() <= SHA256_MAX_MESSAGE_LENGTH)
+		{
+			sha256HashLanes(messages, lengths, states);
+		}
+		else
+		{
+			sha256HashLanesMultiBlock(messages, lengths, blockCount, states);
+		}
+
+		for (size_t i = 0; i < SHA256_LANES; i++)
+		{
+			simdOk &= std::equal(targetWords, targetWords + 8, states[i]) == (i == lane);
+		}
+	}
+
+	std::cout << "Expected:\t" << hexExpectedHash << "\nActual:\t\t" << parseBytesToHexString(calculatedHash, 32)
+			  << "\n" << sha256SimdName() << " lanes:\t" << (simdOk ? "match" : "MISMATCH") << '\n';
+}
+
+// salīdzina SIMD versiju ar cpu_sha256 uz nejaušiem ziņojumiem ar garumu līdz 'maxLength', vairāku bloku versijai
+// visām joslām tiek izvēlēts viens bloku skaits, tāpat kā grupējot garās paroles
+// ziņojumu pirmais baits ir joslas numurs, lai vienāds ziņojums nevarētu sakrist vairākās joslās reizē,
+// tukšais ziņojums tiek pārbaudīts testSha
+void testShaRandom(size_t count, size_t maxLength)
+{
+	std::mt19937 rng(12345);
+	std::uniform_int_distribution<int> byteDist(0, 255);
+	std::uniform_int_distribution<size_t> lengthDist(1, maxLength);
+
+	size_t failures = 0;
+
+	for (size_t n = 0; n < count; n++)
+	{
+		std::vector<uint8_t> data[SHA256_LANES];
+		const uint8_t *messages[SHA256_LANES];
+		size_t lengths[SHA256_LANES];
+
+		const size_t firstLength = lengthDist(rng);
+		const size_t blockCount = sha256BlockCount(firstLength);
+
+		for (size_t lane = 0; lane < SHA256_LANES; lane++)
+		{
+			size_t length = lane == 0 ? firstLength : lengthDist(rng);
+			while (sha256BlockCount(length) != blockCount)
+			{
+				length = lengthDist(rng);
+			}
+
+			data[lane].resize(length + 1);
+			for (uint8_t &byte : data[lane])
+			{
+				byte = static_cast<uint8_t>(byteDist(rng));
+			}
+			data[lane][0] = static_cast<uint8_t>(lane);
+
+			messages[lane] = data[lane].data();
+			lengths[lane] = data[lane].size() - 1;
+		}
+
+		const size_t targetLane = n % SHA256_LANES;
+
+		uint8_t digest[32];
+		cpu_sha256(messages[targetLane], lengths[targetLane], digest);
+
+		uint32_t targetWords[8];
+		sha256DigestToWords(digest, targetWords);
+
+		uint32_t states[SHA256_LANES][8];
+
+		if (blockCount == 1)
+		{
+			sha256HashLanes(messages, lengths, states);
+		}
+		else
+		{
+			sha256HashLanesMultiBlock(messages, lengths, blockCount, states);
+		}
+
+		for (size_t lane = 0; lane < SHA256_LANES; lane++)
+		{
+			if (std::equal(targetWords, targetWords + 8, states[lane]) != (lane == targetLane))
+			{
+				failures++;
+				break;
+			}
+		}
+	}
+
+	std::cout << "Random messages up to " << maxLength << ":\t" << count << " tested, " << failures
+			  << " mismatches\n";
+}
+
+// argumentu skaits līdz žurnāla failam ieskaitot, ar --targets hash faila nosaukums ir papildu arguments
+static int hashArgCount(char *argv[])
+{
+	return std::string(argv[2]) == "--targets" ? 5 : 4;
+}
+
+int main(int argc, char *argv[])
+{
+	try
+	{
+		// testu palaišana
+		if (argc == 2 && std::string(argv[1]) == "--test")
+		{
+			std::cout << "SHA Tests\n";
+
+			testSha("", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+			testSha("123456", "8d969eef6ecad3c29a3a629280e686cf0c3f5d5a86aff3ca12020c923adc6c92");
+
+			// NIST testa vektori ar 56 un 112 baitu ziņojumiem, kas neietilpst vienā blokā
+			testSha("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+					"248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+			testSha("abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrs"
+					"mnopqrstnopqrstu",
+					"cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1");
+			testSha(std::string(200, 'a'), "c2a908d98f5df987ade41b5fce213067efbcc21ef2240212a41e54b5e7c28ae5");
+
+			testShaRandom(10000, SHA256_MAX_MESSAGE_LENGTH);
+			testShaRandom(2000, 300);
+
+			std::cout << "Hash Converison Tests\n";
+
+			std::string testHexHash = "8d969eef6ecad3c29a3a629280e686cf0c3f5d5a86aff3ca12020c923adc6c92";
+			auto hexbytes = hexStringToBytes(testHexHash);
+			std::cout << "Original hash:\t\t" << testHexHash << "\nRoundtrip converted: \t"
+					  << parseBytesToHexString(hexbytes.data(), hexbytes.size()) << '\n';
+
+			std::cout << "Tests complete\n";
+		}
+		else if (argc >= 4 && (argc == hashArgCount(argv) || (argc == hashArgCount(argv) + 2 &&
+															   std::string(argv[hashArgCount(argv)]) == "--threads")))
+		{
+			const bool multiTarget = std::string(argv[2]) == "--targets";
+
+			const std::string inputFileName = argv[1];
+			const std::string logFileName = argv[hashArgCount(argv) - 1];
+
+			// 0 vai nenorādīts nozīmē visus pieejamos kodolus
+			unsigned threadCount =
+				argc > hashArgCount(argv) ? static_cast<unsigned>(std::stoul(argv[hashArgCount(argv) + 1])) : 0;
+			if (threadCount == 0)
+			{
+				threadCount = std::max(1u, std::thread::hardware_concurrency());
+			}
+
+			// viens hash no komandrindas vai hash saraksts no faila, abos gadījumos tie tiek meklēti vienā tabulā
+			const std::vector<std::string> hexHashes =
+				multiTarget ? readHashFile(argv[3]) : std::vector<std::string>{argv[2]};
+
+			BenchmarkLogger logger(logFileName, "CPU");
+
+			auto targetTableStart = std::chrono::steady_clock::now();
+
+			const TargetTable targets = buildTargetTable(hexHashes);
+
+			auto targetTableEnd = std::chrono::steady_clock::now();
+
+			logger.chronoLog("target table creation time", targetTableStart, targetTableEnd);
+
+			std::vector<CrackedPassword> cracked;
+
+			std::cout << "Starting search for " << targets.size() << " hash(es) on " << threadCount << " threads ("
+					  << sha256SimdName() << ")...\n";
+
+			auto hashCheckStart = std::chrono::steady_clock::now();
+
+			hashCheck(inputFileName, targets, cracked, threadCount, logger);
+
+			auto hashCheckEnd = std::chrono::steady_clock::now();
+
+			logger.chronoLog("hash check time", hashCheckStart, hashCheckEnd);
+
+			for (const CrackedPassword &found : cracked)
+			{
+				std::cout << "Password found at index " << found.lineIdx << ": " << found.password;
+
+				if (multiTarget)
+				{
+					std::cout << "\t" << targets.hex(found.targetIdx);
+				}
+
+				std::cout << "\n";
+			}
+
+			if (multiTarget)
+			{
+				std::cout << "Found " << cracked.size() << " passwords for " << targets.size() << " hashes\n";
+			}
+			else if (cracked.empty())
+			{
+				std::cout << "No matching password found." << "\n";
+			}
+		}
+		else
+		{
+			std::cout << "Correct program usage:\n"
+					  << "\tRunning tests:\n"
+					  << "\t\t" << argv[0] << " --test\n"
+					  << "\tCPU Password cracking:\n"
+					  << "\t\t" << argv[0] << " <passwords file> <password hash> <log file> [--threads <n>]\n"
+					  << "\tFor a list of hashes (one 64 hex character hash per line):\n"
+					  << "\t\t" << argv[0]
+					  << " <passwords file> --targets <hashes file> <log file> [--threads <n>]\n"
+					  << "\t\t--threads <n>\t\tnumber of worker threads (default: all hardware threads)\n";
+
+			return -1;
+		}
+	}
+	catch (const std::runtime_error &e)
+	{
+		std::cerr << "Error! " << e.what() << std::endl;
+
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,326 @@
+// vairāku ziņojumu SHA256 aprēķins uz CPU, algoritma skaidrojumus skatīt sha256cuda/src/kernel.cu failā
+
+#include "sha256Simd.h"
+#include <cstring>
+
+#ifdef SHA256CPU_USE_SHANI
+#include <immintrin.h>
+#endif
+
+// pirmie 32 biti kv. saknei no pirmajiem 8 pirmskaitļiem 2 - 19 (no daļas aiz komata)
+static constexpr uint32_t initialState[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+											 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+// pirmie 32 biti no kubsaknēm pirmajiem 64 pirmskaitļiem 2 - 311
+alignas(16) static constexpr uint32_t roundConstants[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+const char *sha256SimdName()
+{
+#if defined(SHA256CPU_USE_SHANI)
+	return "SHA-NI";
+#elif defined(__AVX512F__)
+	return "AVX-512";
+#elif defined(__AVX2__)
+	return "AVX2";
+#else
+	return "SSE2";
+#endif
+}
+
+static inline uint32_t loadBigEndian(const uint8_t *bytes)
+{
+	return (uint32_t(bytes[0]) << 24) | (uint32_t(bytes[1]) << 16) | (uint32_t(bytes[2]) << 8) | uint32_t(bytes[3]);
+}
+
+void sha256DigestToWords(const uint8_t *digest, uint32_t *words)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		words[i] = loadBigEndian(digest + i * 4);
+	}
+}
+
+// ziņojums ar padding vienā 512 bitu blokā: ziņojums, '1' bits, nulles un ziņojuma garums bitos beigās
+// garums nepārsniedz 440 bitus, tāpēc pietiek ar pēdējiem diviem baitiem
+static inline void padBlock(uint8_t *block, const uint8_t *message, size_t length)
+{
+	std::memset(block, 0, 64);
+	std::memcpy(block, message, length);
+	block[length] = 0b10000000;
+	block[62] = static_cast<uint8_t>((length * 8) >> 8);
+	block[63] = static_cast<uint8_t>(length * 8);
+}
+
+// ziņojuma bloks ar indeksu 'blockIdx' no 'blockCount': ziņojuma daļa, '1' bits tajā blokā, kurā ziņojums beidzas,
+// un pēdējā blokā ziņojuma garums bitos kā 64 bitu big-endian skaitlis
+static inline void padMessageBlock(uint8_t *block, const uint8_t *message, size_t length, size_t blockIdx,
+								   size_t blockCount)
+{
+	const size_t blockStart = blockIdx * 64;
+
+	std::memset(block, 0, 64);
+
+	if (blockStart < length)
+	{
+		std::memcpy(block, message + blockStart, length - blockStart < 64 ? length - blockStart : 64);
+	}
+
+	if (length >= blockStart && length < blockStart + 64)
+	{
+		block[length - blockStart] = 0b10000000;
+	}
+
+	if (blockIdx == blockCount - 1)
+	{
+		const uint64_t bitLength = uint64_t(length) * 8;
+		for (int i = 0; i < 8; i++)
+		{
+			block[63 - i] = static_cast<uint8_t>(bitLength >> (i * 8));
+		}
+	}
+}
+
+#ifdef SHA256CPU_USE_SHANI
+
+// visu joslu bloku apstrāde ar SHA-NI, stāvoklis instrukcijām jāglabā kā ABEF un CDGH vārdu pāri
+// viena ziņojuma raundi ir secīgi atkarīgi cits no cita, tāpēc joslas tiek apstrādātas pārmaiņus, lai procesors
+// varētu izpildīt vairāku ziņojumu sha256rnds2 instrukcijas vienlaicīgi
+static void sha256ShaNiBlocks(uint32_t (*states)[8], const uint8_t (*blocks)[64])
+{
+	// baitu secība katrā 32 bitu vārdā jāapgriež, lai iegūtu big-endian vārdus
+	const __m128i byteSwapMask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+	__m128i state0[SHA256_LANES], state1[SHA256_LANES];
+	__m128i savedState0[SHA256_LANES], savedState1[SHA256_LANES];
+
+	// 'msg[lane][g % 4]' satur w[4g .. 4g + 3], nākamie vārdi tiek aprēķināti no iepriekšējiem četriem
+	__m128i msg[SHA256_LANES][4];
+
+	for (size_t lane = 0; lane < SHA256_LANES; lane++)
+	{
+		const __m128i tmp =
+			_mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&states[lane][0])), 0xB1); // CDAB
+		state1[lane] =
+			_mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&states[lane][4])), 0x1B); // EFGH
+		state0[lane] = _mm_alignr_epi8(tmp, state1[lane], 8);    // ABEF
+		state1[lane] = _mm_blend_epi16(state1[lane], tmp, 0xF0); // CDGH
+
+		savedState0[lane] = state0[lane];
+		savedState1[lane] = state1[lane];
+	}
+
+#pragma GCC unroll 16
+	for (int g = 0; g < 16; g++)
+	{
+		const __m128i roundConstant = _mm_load_si128(reinterpret_cast<const __m128i *>(&roundConstants[g * 4]));
+
+		for (size_t lane = 0; lane < SHA256_LANES; lane++)
+		{
+			__m128i *w = msg[lane];
+
+			if (g < 4)
+			{
+				w[g] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks[lane] + g * 16)),
+										byteSwapMask);
+			}
+			else
+			{
+				const __m128i w9 = _mm_alignr_epi8(w[(g + 3) & 3], w[(g + 2) & 3], 4);
+				w[g & 3] = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(w[g & 3], w[(g + 1) & 3]), w9),
+												w[(g + 3) & 3]);
+			}
+
+			// katra sha256rnds2 instrukcija izpilda divus raundus
+			__m128i roundInput = _mm_add_epi32(w[g & 3], roundConstant);
+			state1[lane] = _mm_sha256rnds2_epu32(state1[lane], state0[lane], roundInput);
+			roundInput = _mm_shuffle_epi32(roundInput, 0x0E);
+			state0[lane] = _mm_sha256rnds2_epu32(state0[lane], state1[lane], roundInput);
+		}
+	}
+
+	for (size_t lane = 0; lane < SHA256_LANES; lane++)
+	{
+		const __m128i tmp = _mm_shuffle_epi32(_mm_add_epi32(state0[lane], savedState0[lane]), 0x1B); // FEBA
+		const __m128i dchg = _mm_shuffle_epi32(_mm_add_epi32(state1[lane], savedState1[lane]), 0xB1); // DCHG
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(&states[lane][0]), _mm_blend_epi16(tmp, dchg, 0xF0)); // DCBA
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(&states[lane][4]), _mm_alignr_epi8(dchg, tmp, 8));    // HGFE
+	}
+}
+
+void sha256HashLanes(const uint8_t *const *messages, const size_t *lengths, uint32_t (*states)[8])
+{
+	uint8_t blocks[SHA256_LANES][64];
+
+	for (size_t lane = 0; lane < SHA256_LANES; lane++)
+	{
+		padBlock(blocks[lane], messages[lane], lengths[lane]);
+		std::memcpy(states[lane], initialState, sizeof(initialState));
+	}
+
+	sha256ShaNiBlocks(states, blocks);
+}
+
+void sha256HashLanesMultiBlock(const uint8_t *const *messages, const size_t *lengths, size_t blockCount,
+							   uint32_t (*states)[8])
+{
+	uint8_t blocks[SHA256_LANES][64];
+
+	for (size_t lane = 0; lane < SHA256_LANES; lane++)
+	{
+		std::memcpy(states[lane], initialState, sizeof(initialState));
+	}
+
+	for (size_t block = 0; block < blockCount; block++)
+	{
+		for (size_t lane = 0; lane < SHA256_LANES; lane++)
+		{
+			padMessageBlock(blocks[lane], messages[lane], lengths[lane], block, blockCount);
+		}
+
+		sha256ShaNiBlocks(states, blocks);
+	}
+}
+
+#else
+
+// GCC/Clang vektoru paplašinājums: katra josla ir cita ziņojuma 32 bitu vārds, operatori darbojas uz visām joslām
+// reizē un kompilators tos pārvērš AVX-512 / AVX2 / SSE2 instrukcijās (AVX-512 rotācijām ir sava instrukcija)
+typedef uint32_t ShaWords __attribute__((vector_size(SHA256_LANES * sizeof(uint32_t))));
+
+static inline ShaWords rotr(ShaWords x, int n)
+{
+	return (x >> n) | (x << (32 - n));
+}
+
+// visu joslu bloki tiek transponēti tā, ka w[i] satur i-to vārdu no katra ziņojuma
+static inline void loadLaneWords(ShaWords *w, const uint8_t (*blocks)[64])
+{
+	for (int i = 0; i < 16; i++)
+	{
+		for (size_t lane = 0; lane < SHA256_LANES; lane++)
+		{
+			w[i][lane] = loadBigEndian(blocks[lane] + i * 4);
+		}
+	}
+}
+
+// viena bloka 64 raundi visām joslām, 'state' tiek papildināts ar bloka rezultātu
+// always_inline, lai viena bloka gadījumā kompilators stāvokli paturētu reģistros
+static inline __attribute__((always_inline)) void sha256CompressLanes(ShaWords *state, ShaWords *w)
+{
+	ShaWords a = state[0];
+	ShaWords b = state[1];
+	ShaWords c = state[2];
+	ShaWords d = state[3];
+	ShaWords e = state[4];
+	ShaWords f = state[5];
+	ShaWords g = state[6];
+	ShaWords h = state[7];
+
+	// 'w' tiek lietots kā 16 vārdu gredzenveida buferis: w[i % 16] pirms pārrēķina satur w[i - 16]
+#pragma GCC unroll 64
+	for (int i = 0; i < 64; i++)
+	{
+		if (i >= 16)
+		{
+			const ShaWords w15 = w[(i + 1) & 15];
+			const ShaWords w2 = w[(i + 14) & 15];
+			w[i & 15] += (rotr(w15, 7) ^ rotr(w15, 18) ^ (w15 >> 3)) + w[(i + 9) & 15] +
+						 (rotr(w2, 17) ^ rotr(w2, 19) ^ (w2 >> 10));
+		}
+
+		const ShaWords temp1 =
+			h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + roundConstants[i] + w[i & 15];
+		const ShaWords temp2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+		h = g;
+		g = f;
+		f = e;
+		e = d + temp1;
+		d = c;
+		c = b;
+		b = a;
+		a = temp1 + temp2;
+	}
+
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+	state[5] += f;
+	state[6] += g;
+	state[7] += h;
+}
+
+// transponē stāvokli atpakaļ, lai katras joslas hash būtu 8 secīgi vārdi, ko var meklēt hash tabulā
+static inline void storeLaneStates(const ShaWords *state, uint32_t (*states)[8])
+{
+	for (size_t lane = 0; lane < SHA256_LANES; lane++)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			states[lane][i] = state[i][lane];
+		}
+	}
+}
+
+void sha256HashLanes(const uint8_t *const *messages, const size_t *lengths, uint32_t (*states)[8])
+{
+	uint8_t blocks[SHA256_LANES][64];
+	ShaWords w[16];
+	ShaWords state[8];
+
+	for (size_t lane = 0; lane < SHA256_LANES; lane++)
+	{
+		padBlock(blocks[lane], messages[lane], lengths[lane]);
+	}
+
+	loadLaneWords(w, blocks);
+
+	for (int i = 0; i < 8; i++)
+	{
+		state[i] = ShaWords{} + initialState[i];
+	}
+
+	sha256CompressLanes(state, w);
+
+	storeLaneStates(state, states);
+}
+
+// katram blokam visas joslas tiek apstrādātas reizē, tāpēc visiem ziņojumiem jābūt ar vienādu bloku skaitu
+void sha256HashLanesMultiBlock(const uint8_t *const *messages, const size_t *lengths, size_t blockCount,
+							   uint32_t (*states)[8])
+{
+	uint8_t blocks[SHA256_LANES][64];
+	ShaWords w[16];
+	ShaWords state[8];
+
+	for (int i = 0; i < 8; i++)
+	{
+		state[i] = ShaWords{} + initialState[i];
+	}
+
+	for (size_t block = 0; block < blockCount; block++)
+	{
+		for (size_t lane = 0; lane < SHA256_LANES; lane++)
+		{
+			padMessageBlock(blocks[lane], messages[lane], lengths[lane], block, blockCount);
+		}
+
+		loadLaneWords(w, blocks);
+		sha256CompressLanes(state, w);
+	}
+
+	storeLaneStates(state, states);
+}
+
+#endif
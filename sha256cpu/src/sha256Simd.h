@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// vairāku ziņojumu SHA256 aprēķins uz CPU: katra SIMD vektora josla apstrādā savu ziņojumu (multi-buffer),
+// ar SHA-NI ziņojumi tiek apstrādāti ar procesora SHA256 instrukcijām, divi ziņojumi pārmaiņus
+// mērījumos multi-buffer ar AVX2 / AVX-512 bija ātrāks par SHA-NI, tāpēc SHA-NI tiek izmantots tikai procesoros bez
+// AVX2 vai ar SHA256CPU_PREFER_SHANI, SHA-NI ceļš vārdu secības maiņai un stāvokļa pārkārtošanai izmanto arī
+// SSSE3 / SSE4.1 instrukcijas, tāpēc bez tām (piemēram, būvējot tikai ar -msha) tiek izvēlēts multi-buffer ceļš
+#if defined(__SHA__) && defined(__SSE4_1__) && (defined(SHA256CPU_PREFER_SHANI) || !defined(__AVX2__))
+#define SHA256CPU_USE_SHANI
+constexpr size_t SHA256_LANES = 2;
+#elif defined(__AVX512F__)
+constexpr size_t SHA256_LANES = 16;
+#elif defined(__AVX2__)
+constexpr size_t SHA256_LANES = 8;
+#else
+constexpr size_t SHA256_LANES = 4;
+#endif
+
+// garākais ziņojums, kas kopā ar padding ietilpst vienā 512 bitu blokā (440 biti)
+constexpr size_t SHA256_MAX_MESSAGE_LENGTH = 440 / 8;
+
+// 512 bitu bloku skaits ziņojumam ar padding
+constexpr size_t sha256BlockCount(size_t length)
+{
+	return (length + 8) / 64 + 1;
+}
+
+// aprēķina hash 'SHA256_LANES' ziņojumiem, 'states' katrai joslai satur hash kā 8 big-endian vārdus
+// ziņojumi nedrīkst būt garāki par SHA256_MAX_MESSAGE_LENGTH, neizmantotajām joslām garums var būt 0
+void sha256HashLanes(const uint8_t *const *messages, const size_t *lengths, uint32_t (*states)[8]);
+
+// tas pats garākiem ziņojumiem, visiem joslu ziņojumiem jābūt ar 'blockCount' blokiem (sha256BlockCount),
+// tāpēc garās paroles pirms tam jāsagrupē pēc bloku skaita, neizmantoto joslu rezultāts nav definēts
+void sha256HashLanesMultiBlock(const uint8_t *const *messages, const size_t *lengths, size_t blockCount,
+							   uint32_t (*states)[8]);
+
+// 32 baitu hash kā 8 big-endian vārdi, tādā formā sha256HashLanes atgriež joslu hash
+void sha256DigestToWords(const uint8_t *digest, uint32_t *words);
+
+// instrukciju kopa, ar kuru nokompilēts sha256HashLanes (logošanai)
+const char *sha256SimdName();
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// priekšfiltrs tiek veidots tikai lielākiem hash sarakstiem, mazākiem binārā meklēšana ir tikai dažas nolasīšanas
+constexpr size_t BLOOM_MIN_TARGETS = 256;
+
+// filtra biti uz vienu hash un filtra izmēra robežas (2^16 - 2^28 biti jeb 8 KiB - 32 MiB)
+constexpr size_t BLOOM_BITS_PER_TARGET = 16;
+constexpr uint32_t BLOOM_MIN_LOG2_BITS = 16;
+constexpr uint32_t BLOOM_MAX_LOG2_BITS = 28;
+
+// filtrs izmanto tikai hash pirmo vārdu: pirmā pozīcija ir tā augstākie biti, otrā - augstākie biti reizinājumam ar
+// šo konstanti (zelta griezums), kodoliem pozīcijas jāaprēķina tieši tāpat
+constexpr uint32_t BLOOM_MULTIPLIER = 0x9E3779B1u;
+
+// meklējamo hash tabula, kas uz ierīci tiek nokopēta vienu reizi
+// katrs hash ir 8 big-endian 32 bitu vārdi, hash ir unikāli un sakārtoti augošā secībā, tāpēc pietiek ar bināro
+// meklēšanu pēc pirmā vārda un pārējo vārdu salīdzināšanu
+struct TargetTable
+{
+	std::vector<uint32_t> words;
+	std::vector<uint32_t> bloom; // priekšfiltra biti, tukšs, ja filtrs netiek lietots
+	uint32_t bloomShift = 0;     // 32 - log2(filtra bitu skaits), 0 nozīmē, ka filtrs netiek lietots
+
+	size_t size() const
+	{
+		return words.size() / 8;
+	}
+
+	// hash ar indeksu 'idx' kā 64 hex simbolu teksts
+	std::string hex(size_t idx) const;
+
+	// hash indekss tabulā vai -1, tāda pati meklēšana kā kodolos
+	int64_t find(const uint32_t *digestWords) const;
+};
+
+// atrasta parole: rindas indekss failā, hash indekss tabulā un pati parole
+struct CrackedPassword
+{
+	size_t lineIdx;
+	size_t targetIdx;
+	std::string password;
+};
+
+// nolasa hash sarakstu, katrā rindā viens 64 hex simbolu hash, tukšās rindas tiek izlaistas
+std::vector<std::string> readHashFile(const std::string &fileName);
+
+// izveido sakārtotu tabulu bez atkārtojumiem un, ja hash ir vismaz BLOOM_MIN_TARGETS, arī priekšfiltru
+TargetTable buildTargetTable(const std::vector<std::string> &hexHashes);
@@ -2,6 +2,10 @@
 // https://en.wikipedia.org/wiki/SHA-2
 
 #include "benchmarkLogger.h"
+#include "launchTuning.h"
+#include "passwordBatchReader.h"
+#include "targetTable.h"
+#include <algorithm>
 #include <assert.h>
 #include <cassert>
 #include <chrono>
@@ -13,6 +17,7 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <stdio.h>
 #include <stdlib.h>
@@ -52,6 +57,12 @@ inline void gpuAssert(cudaError_t code, const char *file, int line, bool abort =
 #define CH(x, y, z) ((x & y) ^ (~x & z))
 #define MAJ(x, y, z) ((x & y) ^ (x & z) ^ (y & z))
 
+// 512 bitu bloku skaits ziņojumam ar padding, '1' bits un garums aizņem vismaz 9 baitus
+__host__ __device__ inline size_t sha256BlockCount(size_t length)
+{
+	return (length + 8) / 64 + 1;
+}
+
 // pirmie 32 biti kv. saknei no pirmajiem 8 pirmskaitļiem 2 - 19 (no daļas aiz komata)
 __device__ cuda::std::uint32_t h0 = 0x6a09e667;
 __device__ cuda::std::uint32_t h1 = 0xbb67ae85;
@@ -131,15 +142,23 @@ __device__ void sha256ProcessChunk(cuda::std::uint32_t *state, cuda::std::uint8_
 	state[7] += h;
 }
 
-__device__ void sha256(const cuda::std::uint8_t *input, cuda::std::uint64_t length, cuda::std::uint8_t *output)
+// 'state' apstrādes beigās satur hash kā 8 big-endian vārdus, tādā formā tie tiek meklēti hash tabulā
+__device__ void sha256(const cuda::std::uint8_t *input, cuda::std::uint64_t length, cuda::std::uint32_t *state)
 {
 	// vienkāršības pēc apstrādāsim viena bloka ietvaros, tāpēc, ņemot vērā ziņojuma garumu un padding,
 	// ziņojuma garums nedrīkst būt lielāks par 440 bitiem, lai viss ietilpstu vienā 512 bitu blokā
 	// https://crypto.stackexchange.com/questions/54852/what-happens-if-a-sha-256-input-is-too-long-longer-than-512-bits
-	bool lengthOk = length <= (440 / 8);
+	bool lengthOk = length <= SINGLE_BLOCK_MAX_LENGTH;
 	assert(lengthOk);
 
-	cuda::std::uint32_t state[8] = {h0, h1, h2, h3, h4, h5, h6, h7};
+	state[0] = h0;
+	state[1] = h1;
+	state[2] = h2;
+	state[3] = h3;
+	state[4] = h4;
+	state[5] = h5;
+	state[6] = h6;
+	state[7] = h7;
 
 	cuda::std::uint8_t chunk[64];
 
@@ -166,8 +185,51 @@ __device__ void sha256(const cuda::std::uint8_t *input, cuda::std::uint64_t leng
 	}
 
 	sha256ProcessChunk(state, chunk);
+}
+
+// vairāku bloku variants parolēm, kas neietilpst vienā blokā, ziņojums tiek apstrādāts pa 512 bitu blokiem
+// '1' bits un ziņojuma garums nonāk pēdējā blokā vai, ja tur vairs neietilpst, arī priekšpēdējā
+__device__ void sha256MultiBlock(const cuda::std::uint8_t *input, cuda::std::uint64_t length,
+								 cuda::std::uint32_t *state)
+{
+	state[0] = h0;
+	state[1] = h1;
+	state[2] = h2;
+	state[3] = h3;
+	state[4] = h4;
+	state[5] = h5;
+	state[6] = h6;
+	state[7] = h7;
 
-	// sadalām 32 bitu vērtības 4ās 8 bitu un ierakstām output masīvā
+	cuda::std::uint8_t chunk[64];
+
+	const cuda::std::uint64_t blockCount = sha256BlockCount(length);
+
+	for (cuda::std::uint64_t block = 0; block < blockCount; block++)
+	{
+		// ziņojuma baiti, aiz tiem '1' bits un nulles
+		for (int i = 0; i < 64; i++)
+		{
+			cuda::std::uint64_t pos = block * 64 + i;
+			chunk[i] = pos < length ? input[pos] : (pos == length ? 0b10000000 : 0);
+		}
+
+		// pēdējā bloka galā ziņojuma garums kā 64 bitu big-endian skaitlis
+		if (block == blockCount - 1)
+		{
+			for (int i = 1; i <= 8; i++)
+			{
+				chunk[64 - i] = ((length * 8) >> ((i - 1) * 8)) & 0xFF;
+			}
+		}
+
+		sha256ProcessChunk(state, chunk);
+	}
+}
+
+// sadalām 32 bitu vērtības 4ās 8 bitu un ierakstām output masīvā
+__device__ void stateToBytes(const cuda::std::uint32_t *state, cuda::std::uint8_t *output)
+{
 	for (int i = 0; i < 8; i++)
 	{
 		cuda::std::uint32_t currentStateValue = state[i];
@@ -179,17 +241,77 @@ __device__ void sha256(const cuda::std::uint8_t *input, cuda::std::uint64_t leng
 	}
 }
 
-__device__ bool compareHashes(const cuda::std::uint8_t *h1, const cuda::std::uint8_t *h2)
+__device__ bool bloomTest(const cuda::std::uint32_t *bloom, cuda::std::uint32_t position)
+{
+	return (bloom[position >> 5] & (1u << (position & 31))) != 0;
+}
+
+// meklē hash tabulā un atgriež tā indeksu vai -1, tāpat kā TargetTable::find
+// ar priekšfiltru lielākā daļa nesakritību tiek noraidītas ar divām filtra nolasīšanām, tāpēc caurlaidspēja
+// gandrīz nav atkarīga no hash skaita, binārā meklēšana tiek veikta tikai tiem, kas izgājuši filtram cauri
+__device__ int findTarget(const cuda::std::uint32_t *state, const cuda::std::uint32_t *targets, uint targetCount,
+						  const cuda::std::uint32_t *bloom, uint bloomShift)
 {
-	for (int i = 0; i < 32; i++)
+	const cuda::std::uint32_t first = state[0];
+
+	if (bloomShift != 0 &&
+		(!bloomTest(bloom, first >> bloomShift) || !bloomTest(bloom, (first * BLOOM_MULTIPLIER) >> bloomShift)))
+	{
+		return -1;
+	}
+
+	// pirmais hash, kura pirmais vārds nav mazāks par meklējamo
+	uint low = 0;
+	uint high = targetCount;
+
+	while (low < high)
 	{
-		if (h1[i] != h2[i])
+		uint mid = (low + high) / 2;
+
+		if (targets[mid * 8] < first)
+		{
+			low = mid + 1;
+		}
+		else
 		{
-			return false;
+			high = mid;
 		}
 	}
 
-	return true;
+	for (uint t = low; t < targetCount && targets[t * 8] == first; t++)
+	{
+		bool match = true;
+
+		for (int i = 1; i < 8; i++)
+		{
+			if (targets[t * 8 + i] != state[i])
+			{
+				match = false;
+				break;
+			}
+		}
+
+		if (match)
+		{
+			return t;
+		}
+	}
+
+	return -1;
+}
+
+// pievieno atrasto paroli buferim, vieta tiek rezervēta ar atomicAdd, tāpēc var ierakstīt visas sakritības
+// atgriež rezervēto vietu, tā var būt ārpus bufera, ja buferis ir pilns
+__device__ uint appendMatch(uint pwIdx, int targetIdx, uint2 *matches, uint matchCapacity, uint *matchCount)
+{
+	uint slot = atomicAdd(matchCount, 1);
+
+	if (slot < matchCapacity)
+	{
+		matches[slot] = make_uint2(pwIdx, targetIdx);
+	}
+
+	return slot;
 }
 
 __device__ size_t current_pw_size(const uint *offsets, uint password_count, uint char_count, int idx)
@@ -221,7 +343,8 @@ __host__ size_t h_current_pw_size(std::vector<uint> &offsets, uint password_coun
 }
 
 __global__ void kernel(const cuda::std::uint8_t *passwords, const uint *offsets, uint pwCount, uint charCount,
-					   const cuda::std::uint8_t *targetHash, int *resultIndex)
+					   const cuda::std::uint32_t *targets, uint targetCount, const cuda::std::uint32_t *bloom,
+					   uint bloomShift, uint2 *matches, uint matchCapacity, uint *matchCount)
 {
 	int idx = blockIdx.x * blockDim.x + threadIdx.x;
 
@@ -234,18 +357,209 @@ __global__ void kernel(const cuda::std::uint8_t *passwords, const uint *offsets,
 
 	size_t pwLength = current_pw_size(offsets, pwCount, charCount, idx);
 
-	cuda::std::uint8_t hash[32];
+	cuda::std::uint32_t hash[8];
 
 	sha256(password, pwLength, hash);
 
-	// ja hashi sakrīt, tad ierakstām paroles indeksu iekš 'resultIndex',
-	// tā kā tā mainīgā adrese atrodas device kopīgajā atmiņā, jālieto atomiska funkcija
-	if (compareHashes(targetHash, hash))
+	int targetIdx = findTarget(hash, targets, targetCount, bloom, bloomShift);
+
+	// sakritības tiek pievienotas kopīgajam buferim, tāpēc meklēšana turpinās arī pēc pirmās atrastās paroles
+	if (targetIdx != -1)
+	{
+		appendMatch(idx, targetIdx, matches, matchCapacity, matchCount);
+	}
+}
+
+// garo paroļu kodols, izsaukts atsevišķi katrai paroļu grupai [firstIdx, firstIdx + bucketCount) ar vienādu bloku
+// skaitu, tāpēc visi warp pavedieni izpilda vienādu bloku skaitu un nedivergē
+__global__ void kernelMultiBlock(const cuda::std::uint8_t *passwords, const uint *offsets, uint pwCount, uint charCount,
+								 uint firstIdx, uint bucketCount, const cuda::std::uint32_t *targets, uint targetCount,
+								 const cuda::std::uint32_t *bloom, uint bloomShift, uint2 *matches, uint matchCapacity,
+								 uint *matchCount)
+{
+	int idx = blockIdx.x * blockDim.x + threadIdx.x;
+
+	if (idx >= bucketCount)
+	{
+		return;
+	}
+
+	idx += firstIdx;
+
+	const cuda::std::uint8_t *password = passwords + offsets[idx];
+
+	size_t pwLength = current_pw_size(offsets, pwCount, charCount, idx);
+
+	cuda::std::uint32_t hash[8];
+
+	sha256MultiBlock(password, pwLength, hash);
+
+	int targetIdx = findTarget(hash, targets, targetCount, bloom, bloomShift);
+
+	if (targetIdx != -1)
 	{
-		// ja resultIndex glabājas vērtība -1, tad aizstāj to ar idx
-		// ar šo tiek arī reizē nodrošināts, ka ja kāds pavediens vēlāk tomēr nonāk līdz šim stāvoklim,
-		// tad modifikācija netiks veikta, jo tajā brīdī jau 'resultIndex' != -1
-		atomicCAS(resultIndex, -1, idx);
+		appendMatch(idx, targetIdx, matches, matchCapacity, matchCount);
+	}
+}
+
+// neapstrādātu gabalu rindu sadalīšana: katrs bloks apstrādā blockDim.x * SPLIT_BYTES_PER_THREAD baitu gabala daļu,
+// vispirms tiek saskaitīti rindu sākumi katrā daļā, tad daļu skaitiem tiek aprēķināta prefiksa summa un visbeidzot
+// katrs pavediens ieraksta savu rindu sākumus vietā, ko nosaka daļas un bloka prefiksa summas (stream compaction)
+// bloka izmērs tiek izvēlēts resursdatorā (--autotune), tāpēc koplietojamā atmiņa ir dinamiska, blockDim.x uint
+constexpr int SPLIT_BYTES_PER_THREAD = 16;
+
+// rinda sākas gabala sākumā un aiz katra '\n', izņemot gabala beigas
+__device__ bool isLineStart(const cuda::std::uint8_t *chunk, uint pos, uint chunkBytes)
+{
+	return pos < chunkBytes && (pos == 0 || chunk[pos - 1] == '\n');
+}
+
+__device__ uint threadLineStartCount(const cuda::std::uint8_t *chunk, uint chunkBytes)
+{
+	const uint begin = (blockIdx.x * blockDim.x + threadIdx.x) * SPLIT_BYTES_PER_THREAD;
+	uint count = 0;
+
+	for (uint pos = begin; pos < begin + SPLIT_BYTES_PER_THREAD; pos++)
+	{
+		count += isLineStart(chunk, pos, chunkBytes);
+	}
+
+	return count;
+}
+
+// bloka ekskluzīvā prefiksa summa koplietojamā atmiņā (Hillis-Steele), jāizsauc visiem bloka pavedieniem
+// 'total' saņem visu bloka vērtību summu
+__device__ uint blockExclusiveScan(uint value, uint *scratch, uint &total)
+{
+	const uint t = threadIdx.x;
+
+	scratch[t] = value;
+	__syncthreads();
+
+	for (uint offset = 1; offset < blockDim.x; offset *= 2)
+	{
+		uint add = t >= offset ? scratch[t - offset] : 0;
+		__syncthreads();
+
+		scratch[t] += add;
+		__syncthreads();
+	}
+
+	total = scratch[blockDim.x - 1];
+	const uint result = scratch[t] - value;
+
+	// 'scratch' drīkst pārrakstīt tikai tad, kad visi pavedieni ir nolasījuši rezultātu
+	__syncthreads();
+
+	return result;
+}
+
+__global__ void countLineStarts(const cuda::std::uint8_t *chunk, uint chunkBytes, uint *tileCounts)
+{
+	extern __shared__ uint scratch[];
+
+	uint total;
+	blockExclusiveScan(threadLineStartCount(chunk, chunkBytes), scratch, total);
+
+	if (threadIdx.x == 0)
+	{
+		tileCounts[blockIdx.x] = total;
+	}
+}
+
+// viens bloks pārvērš daļu skaitus par to pirmās rindas indeksiem un ieraksta kopējo rindu skaitu
+__global__ void scanTileCounts(uint *tileCounts, uint tileCount, uint *lineCount)
+{
+	extern __shared__ uint scratch[];
+
+	uint carry = 0;
+
+	for (uint base = 0; base < tileCount; base += blockDim.x)
+	{
+		const uint idx = base + threadIdx.x;
+
+		uint total;
+		const uint offset = blockExclusiveScan(idx < tileCount ? tileCounts[idx] : 0, scratch, total);
+
+		if (idx < tileCount)
+		{
+			tileCounts[idx] = carry + offset;
+		}
+
+		carry += total;
+	}
+
+	if (threadIdx.x == 0)
+	{
+		*lineCount = carry;
+	}
+}
+
+__global__ void writeLineStarts(const cuda::std::uint8_t *chunk, uint chunkBytes, const uint *tileOffsets,
+								uint *lineStarts)
+{
+	extern __shared__ uint scratch[];
+
+	uint total;
+	uint lineIdx = blockExclusiveScan(threadLineStartCount(chunk, chunkBytes), scratch, total);
+	lineIdx += tileOffsets[blockIdx.x];
+
+	const uint begin = (blockIdx.x * blockDim.x + threadIdx.x) * SPLIT_BYTES_PER_THREAD;
+
+	for (uint pos = begin; pos < begin + SPLIT_BYTES_PER_THREAD; pos++)
+	{
+		if (isLineStart(chunk, pos, chunkBytes))
+		{
+			lineStarts[lineIdx++] = pos;
+		}
+	}
+}
+
+// jaucē rindas tieši neapstrādātajā gabalā, rindu skaits tiek nolasīts no ierīces atmiņas, tāpēc režģis ir fiksēta
+// izmēra un pavedieni apstrādā rindas ar soli, kas vienāds ar visu pavedienu skaitu
+// garās rindas tiek jaucētas ar vairāku bloku funkciju tajā pašā kodolā, tās ir retas, tāpēc divergence ir neliela
+// sakritībai tiek saglabāts rindas indekss gabalā un rindas sākums, lai resursdators varētu nolasīt paroli
+__global__ void kernelLines(const cuda::std::uint8_t *chunk, uint chunkBytes, const uint *lineStarts,
+							const uint *lineCount, const cuda::std::uint32_t *targets, uint targetCount,
+							const cuda::std::uint32_t *bloom, uint bloomShift, uint2 *matches, uint *matchStarts,
+							uint matchCapacity, uint *matchCount)
+{
+	const uint count = *lineCount;
+
+	for (uint idx = blockIdx.x * blockDim.x + threadIdx.x; idx < count; idx += gridDim.x * blockDim.x)
+	{
+		const uint start = lineStarts[idx];
+
+		// rinda beidzas pirms nākamās rindas sākuma '\n', pēdējā rinda - gabala beigās vai pirms gala '\n'
+		uint end = idx + 1 < count ? lineStarts[idx + 1] - 1 : chunkBytes - (chunk[chunkBytes - 1] == '\n');
+
+		if (end > start && chunk[end - 1] == '\r')
+		{
+			end--;
+		}
+
+		cuda::std::uint32_t hash[8];
+
+		if (end - start <= SINGLE_BLOCK_MAX_LENGTH)
+		{
+			sha256(chunk + start, end - start, hash);
+		}
+		else
+		{
+			sha256MultiBlock(chunk + start, end - start, hash);
+		}
+
+		int targetIdx = findTarget(hash, targets, targetCount, bloom, bloomShift);
+
+		if (targetIdx != -1)
+		{
+			uint slot = appendMatch(idx, targetIdx, matches, matchCapacity, matchCount);
+
+			if (slot < matchCapacity)
+			{
+				matchStarts[slot] = start;
+			}
+		}
 	}
 }
 
@@ -285,39 +599,184 @@ std::string parseBytesToHexString(const uint8_t *data, size_t length)
 	return ss.str();
 }
 
-void hashCheck(const std::string &fileName, std::vector<uint8_t> &hash, int *cracked_idx, bool useGpu,
-			   std::string &foundPw, BenchmarkLogger &logger)
+// vienas gredzena ligzdas ierīces buferi un notikumi, katrai ligzdai savi, lai nākamās partijas kopēšana varētu
+// notikt, kamēr iepriekšējās partijas kodoli vēl izpildās
+struct DeviceBatchSlot
+{
+	cuda::std::uint8_t *d_passwords = nullptr;
+	uint *d_offsets = nullptr;
+	uint2 *d_matches = nullptr;
+	uint2 *d_longMatches = nullptr;
+	uint *d_matchCounts = nullptr; // MATCH_COUNTERS skaitītāji
+	uint *h_matchCountsPinned = nullptr;
+
+	// tikai neapstrādātu gabalu režīmā, rindu sākumi tiek glabāti d_offsets
+	uint *d_tileCounts = nullptr;
+	uint *d_matchStarts = nullptr;
+
+	// garo paroļu buferi tiek izveidoti un palielināti tikai tad, kad tādas paroles parādās
+	uint8_t *h_longPasswordsPinned = nullptr;
+	uint *h_longOffsetsPinned = nullptr;
+	cuda::std::uint8_t *d_longPasswords = nullptr;
+	uint *d_longOffsets = nullptr;
+	size_t longBytesCapacity = 0;
+	size_t longCountCapacity = 0;
+
+	cudaEvent_t copyStart, copyStop, kernelStart, splitStop, kernelStop, longStop, countsReady;
+};
+
+// īso paroļu sakritību skaits, garo paroļu sakritību skaits un rindu skaits neapstrādātā gabalā
+constexpr int MATCH_COUNTERS = 3;
+
+// lielākais fails, kura attēlojums tiek reģistrēts ierīcei, reģistrācija piesprauž visu failu operatīvajā atmiņā
+constexpr size_t MAX_REGISTERED_WORDLIST_BYTES = size_t(4) << 30;
+
+// nolasa ierīces atrasto paroļu buferi, ierakstu secība ir atkarīga no pavedienu izpildes secības
+std::vector<uint2> readMatches(const uint2 *d_matches, uint matchCount, uint matchCapacity)
 {
-	assert(*cracked_idx == -1); // te sākumā jau jābūt vērtībai -1, padota no main
+	std::vector<uint2> matches(std::min(matchCount, matchCapacity));
 
-	if (!useGpu)
+	if (!matches.empty())
 	{
-		return;
+		CUDA_CHECK(cudaMemcpy(matches.data(), d_matches, matches.size() * sizeof(uint2), cudaMemcpyDeviceToHost));
 	}
 
-	const int batchSize =
-		1 << 20; // 1D režģiem cuda limitācija ir 2^31, bet šeit limitējošais faktors būs atmiņa parolēm
+	return matches;
+}
 
-	std::ifstream file(fileName, std::ios::binary);
-	if (!file.is_open())
+// ierīces apzīmējums bloku izmēru kešatmiņai
+std::string tuningDeviceName()
+{
+	int device;
+	CUDA_CHECK(cudaGetDevice(&device));
+
+	cudaDeviceProp properties;
+	CUDA_CHECK(cudaGetDeviceProperties(&properties, device));
+
+	return std::string(properties.name) + " cc" + std::to_string(properties.major) + "." +
+		   std::to_string(properties.minor);
+}
+
+// vidējais viena 'launch' izsaukuma laiks straumē 'stream' milisekundēs pēc viena iesildīšanas izsaukuma
+// ja ierīce bloka izmēru nepieņem (par daudz pavedienu vai reģistru), atgriež -1
+template <typename Launch>
+double timeKernelLaunches(cudaStream_t stream, Launch launch)
+{
+	launch();
+	if (cudaGetLastError() != cudaSuccess)
+		return -1;
+
+	cudaEvent_t startEvent, endEvent;
+	CUDA_CHECK(cudaEventCreate(&startEvent));
+	CUDA_CHECK(cudaEventCreate(&endEvent));
+
+	CUDA_CHECK(cudaEventRecord(startEvent, stream));
+	for (size_t i = 0; i < AUTOTUNE_LAUNCHES; i++)
 	{
-		throw std::runtime_error("Could not open file " + fileName);
+		launch();
 	}
+	CUDA_CHECK(cudaEventRecord(endEvent, stream));
+	CUDA_CHECK(cudaEventSynchronize(endEvent));
+	CUDA_CHECK(cudaGetLastError());
 
-	std::string line;
-	size_t lineIdx = 0;
+	float time = 0;
+	CUDA_CHECK(cudaEventElapsedTime(&time, startEvent, endEvent));
+
+	CUDA_CHECK(cudaEventDestroy(startEvent));
+	CUDA_CHECK(cudaEventDestroy(endEvent));
+
+	return time / AUTOTUNE_LAUNCHES;
+}
+
+// kodolu bloka izmērs, ja kešatmiņā tam nav ieraksta
+constexpr int DEFAULT_BLOCK_THREADS = 256;
+
+// mazākais rindu sadalīšanas bloka izmērs, d_tileCounts ir paredzēts tik mazām daļām
+constexpr int SPLIT_MIN_THREADS = 64;
+
+// partijas tiek apstrādātas konveijerā: PasswordBatchReader pavediens nolasa failu piespraustās atmiņas ligzdās,
+// kopēšana uz ierīci notiek atsevišķā straumē un kodoli savā straumē, tāpēc partijas n + 1 kopēšana un partijas
+// n + 2 nolasīšana notiek, kamēr tiek jaucēta partija n
+// ar 'deviceSplit' uz ierīci tiek kopēti neapstrādāti faila gabali, rindas un to offsetus atrod ierīce
+// kodolu bloku izmēri tiek ņemti no autotune.json, ar 'autotune' tie tiek izmērīti uz pirmās partijas, kurā kodolam
+// ir darbs, un saglabāti
+void hashCheck(const std::string &fileName, const TargetTable &targets, std::vector<CrackedPassword> &cracked,
+			   bool useGpu, bool deviceSplit, bool autotune, BenchmarkLogger &logger)
+{
+	if (!useGpu)
+	{
+		return;
+	}
 
 	CUDA_CHECK(cudaSetDevice(0));
 
+	// partijas ierakstu un baitu limiti no ierīces brīvās atmiņas, nevis fiksēts rindu skaits
+	size_t deviceFreeBytes;
+	size_t deviceTotalBytes;
+	CUDA_CHECK(cudaMemGetInfo(&deviceFreeBytes, &deviceTotalBytes));
+
+	const BatchBudget budget = batchBudgetForDevice(deviceFreeBytes, deviceFreeBytes);
+
+	logger.log("batch entry budget", budget.entries);
+	logger.log("batch byte budget", budget.bytes);
+
+	// 1D režģiem cuda limitācija ir 2^31, bet šeit limitējošais faktors ir atmiņa parolēm
+	const size_t batchSize = budget.entries;
+	const size_t passwordsCapacity = budget.bytes;
+
+	// hash tabulā nav atkārtojumu, tāpēc katra parole var sakrist ar ne vairāk kā vienu hash
+	// un partijas sakritību skaits nevar pārsniegt paroļu skaitu partijā
+	// neapstrādātā gabalā var būt vairāk rindu, bet vairāk sakritību tajā var būt tikai ar atkārtotām parolēm
+	const uint matchCapacity = batchSize;
+
+	// gabala rindu sākumiem vajag līdz vienam ierakstam uz baitu, tāpēc gabals ir ceturtdaļa no baitu limita
+	// un ierīces atmiņas patēriņš ir aptuveni tāds pats kā paroļu režīmā
+	const size_t rawChunkBytes = passwordsCapacity / 4;
+	const size_t minTileBytes = SPLIT_MIN_THREADS * SPLIT_BYTES_PER_THREAD;
+	const size_t rawTileCount = (rawChunkBytes + minTileBytes - 1) / minTileBytes;
+
+	// fails tiek attēlots pirms lasītāja izveides, lai attēlojumu varētu reģistrēt ierīcei
+	MappedWordlist wordlist(fileName);
+
+	// reģistrētu attēlojumu ierīce kopē tieši ar DMA, citādi lasītājs gabalus pārkopē piespraustajā atmiņā
+	bool wordlistRegistered = false;
+
+	if (deviceSplit && wordlist.size() > 0 && wordlist.size() <= MAX_REGISTERED_WORDLIST_BYTES)
+	{
+		wordlistRegistered = cudaHostRegister(const_cast<uint8_t *>(wordlist.data()), wordlist.size(),
+											  cudaHostRegisterReadOnly) == cudaSuccess;
+
+		// ja izpildlaiks neatbalsta tikai lasāmas atmiņas reģistrāciju, kļūda tiek notīrīta un gabali tiek kopēti
+		if (!wordlistRegistered)
+		{
+			cudaGetLastError();
+		}
+
+		logger.log("wordlist registered for DMA", wordlistRegistered);
+	}
+
 	auto hostPinnedMemStart = std::chrono::steady_clock::now();
 
 	// pinnota host side atmiņa, jo paroles un offseti eksistē gan uz CPU, gan GPU
-	// data transfer optimizācija
-	uint8_t *h_passwordsPinned = nullptr;
-	uint *h_offsetsPinned = nullptr;
+	// data transfer optimizācija, katrai gredzena ligzdai savs buferis
+	std::vector<uint8_t *> h_passwordsPinned(PASSWORD_BATCH_SLOTS, nullptr);
+	std::vector<uint32_t *> h_offsetsPinned(PASSWORD_BATCH_SLOTS, nullptr);
+	std::vector<DeviceBatchSlot> slots(PASSWORD_BATCH_SLOTS);
 
-	CUDA_CHECK(cudaMallocHost(&h_passwordsPinned, batchSize * 16 * sizeof(uint8_t)));
-	CUDA_CHECK(cudaMallocHost(&h_offsetsPinned, batchSize * sizeof(uint)));
+	for (size_t slot = 0; slot < PASSWORD_BATCH_SLOTS; slot++)
+	{
+		if (!deviceSplit)
+		{
+			CUDA_CHECK(cudaMallocHost(&h_passwordsPinned[slot], passwordsCapacity * sizeof(uint8_t)));
+			CUDA_CHECK(cudaMallocHost(&h_offsetsPinned[slot], batchSize * sizeof(uint)));
+		}
+		else if (!wordlistRegistered)
+		{
+			CUDA_CHECK(cudaMallocHost(&h_passwordsPinned[slot], rawChunkBytes * sizeof(uint8_t)));
+		}
+
+		CUDA_CHECK(cudaMallocHost(&slots[slot].h_matchCountsPinned, MATCH_COUNTERS * sizeof(uint)));
+	}
 
 	auto hostPinnedMemEnd = std::chrono::steady_clock::now();
 
@@ -325,124 +784,521 @@ void hashCheck(const std::string &fileName, std::vector<uint8_t> &hash, int *cra
 
 	auto deviceFixedBuffersAndDataStart = std::chrono::steady_clock::now();
 
-	cuda::std::uint8_t *d_hash;
-	int *d_crackedIdx;
-	cuda::std::uint8_t *d_passwords;
-	uint *d_offsets;
+	cuda::std::uint32_t *d_targets;
+	cuda::std::uint32_t *d_bloom = nullptr;
 
-	CUDA_CHECK(cudaMalloc(&d_hash, 32));
-	CUDA_CHECK(cudaMemcpy(d_hash, hash.data(), 32, cudaMemcpyHostToDevice));
-	CUDA_CHECK(cudaMalloc(&d_crackedIdx, sizeof(int)));
+	// hash tabula un priekšfiltrs tiek nokopēti vienu reizi visam failam
+	CUDA_CHECK(cudaMalloc(&d_targets, targets.words.size() * sizeof(cuda::std::uint32_t)));
+	CUDA_CHECK(cudaMemcpy(d_targets, targets.words.data(), targets.words.size() * sizeof(cuda::std::uint32_t),
+						  cudaMemcpyHostToDevice));
+
+	if (!targets.bloom.empty())
+	{
+		CUDA_CHECK(cudaMalloc(&d_bloom, targets.bloom.size() * sizeof(cuda::std::uint32_t)));
+		CUDA_CHECK(cudaMemcpy(d_bloom, targets.bloom.data(), targets.bloom.size() * sizeof(cuda::std::uint32_t),
+							  cudaMemcpyHostToDevice));
+	}
+
+	for (DeviceBatchSlot &slot : slots)
+	{
+		CUDA_CHECK(cudaMalloc(&slot.d_passwords, passwordsCapacity * sizeof(cuda::std::uint8_t)));
+		CUDA_CHECK(cudaMalloc(&slot.d_offsets, (deviceSplit ? rawChunkBytes : batchSize) * sizeof(uint)));
+		CUDA_CHECK(cudaMalloc(&slot.d_matches, matchCapacity * sizeof(uint2)));
+		CUDA_CHECK(cudaMalloc(&slot.d_longMatches, matchCapacity * sizeof(uint2)));
+		CUDA_CHECK(cudaMalloc(&slot.d_matchCounts, MATCH_COUNTERS * sizeof(uint)));
+
+		if (deviceSplit)
+		{
+			CUDA_CHECK(cudaMalloc(&slot.d_tileCounts, rawTileCount * sizeof(uint)));
+			CUDA_CHECK(cudaMalloc(&slot.d_matchStarts, matchCapacity * sizeof(uint)));
+		}
 
-	cudaEvent_t start, stop;
-	CUDA_CHECK(cudaEventCreate(&start));
-	CUDA_CHECK(cudaEventCreate(&stop));
+		CUDA_CHECK(cudaEventCreate(&slot.copyStart));
+		CUDA_CHECK(cudaEventCreate(&slot.copyStop));
+		CUDA_CHECK(cudaEventCreate(&slot.kernelStart));
+		CUDA_CHECK(cudaEventCreate(&slot.splitStop));
+		CUDA_CHECK(cudaEventCreate(&slot.kernelStop));
+		CUDA_CHECK(cudaEventCreate(&slot.longStop));
+		CUDA_CHECK(cudaEventCreateWithFlags(&slot.countsReady, cudaEventDisableTiming));
+	}
 
-	CUDA_CHECK(cudaMalloc(&d_passwords, batchSize * 16 * sizeof(cuda::std::uint8_t)));
-	CUDA_CHECK(cudaMalloc(&d_offsets, batchSize * sizeof(uint)));
+	// bez cudaStreamNonBlocking noklusētās straumes cudaMemcpy gaidītu arī uz nākamās partijas kodoliem
+	cudaStream_t copyStream, computeStream;
+	CUDA_CHECK(cudaStreamCreateWithFlags(&copyStream, cudaStreamNonBlocking));
+	CUDA_CHECK(cudaStreamCreateWithFlags(&computeStream, cudaStreamNonBlocking));
 
 	auto deviceFixedBuffersAndDataEnd = std::chrono::steady_clock::now();
 
 	logger.chronoLog("device side fixed buffers and data time", deviceFixedBuffersAndDataStart,
 					 deviceFixedBuffersAndDataEnd);
 
-	while (file)
-	{
-		auto pwBatchStart = std::chrono::steady_clock::now();
+	const uint targetCount = targets.size();
+
+	TuningCache tuningCache(TuningCache::defaultFileName());
+	const std::string tuningDevice = tuningDeviceName();
+
+	// katra kodola bloka izmērs, 0 - vēl nav izvēlēts, tas notiek pirmajā partijā, kurā kodolam ir darbs
+	int kernelThreads = 0;
+	int multiBlockThreads = 0;
+	int splitThreads = 0;
+	int linesThreads = 0;
+
+	// 'launch(threads)' ierindo kodolu skaitļošanas straumē ar bloka izmēru 'threads'
+	auto tunedBlockSize = [&](const std::string &kernelName, auto launch) {
+		auto start = std::chrono::steady_clock::now();
+
+		const LaunchShape shape = resolveLaunchShape(
+			tuningCache, tuningDevice, kernelName, autotune, LaunchShape{DEFAULT_BLOCK_THREADS, 1},
+			BLOCK_SIZE_CANDIDATES,
+			[&](LaunchShape candidate) {
+				return timeKernelLaunches(computeStream, [&] { launch(static_cast<int>(candidate.x)); });
+			},
+			logger);
 
-		int currentOffset = 0;
-		size_t i = 0;
-		size_t pwBytes = 0;
+		auto end = std::chrono::steady_clock::now();
 
-		for (; i < batchSize && std::getline(file, line); i++, lineIdx++)
+		if (autotune)
 		{
-			memcpy(h_passwordsPinned + pwBytes, line.data(), line.size());
-			h_offsetsPinned[i] = currentOffset;
+			logger.chronoLog(kernelName + " launch tuning time", start, end);
+		}
+
+		logger.log(kernelName + " block size", static_cast<double>(shape.x));
+
+		return static_cast<int>(shape.x);
+	};
 
-			pwBytes += line.size();
-			currentOffset += line.size();
+	auto launchShort = [&](DeviceBatchSlot &slot, const PasswordBatch &batch, int threads) {
+		int numBlocks = (batch.shortCount + threads - 1) / threads;
+
+		kernel<<<numBlocks, threads, 0, computeStream>>>(
+			slot.d_passwords, slot.d_offsets, static_cast<uint>(batch.shortCount), static_cast<uint>(batch.pwBytes),
+			d_targets, targetCount, d_bloom, targets.bloomShift, slot.d_matches, matchCapacity,
+			&slot.d_matchCounts[0]);
+	};
+
+	auto launchLong = [&](DeviceBatchSlot &slot, const PasswordBatch &batch, int threads) {
+		for (const LongBucketRange &range : batch.longRanges)
+		{
+			int numBlocks = (range.count + threads - 1) / threads;
+
+			kernelMultiBlock<<<numBlocks, threads, 0, computeStream>>>(
+				slot.d_longPasswords, slot.d_longOffsets, static_cast<uint>(batch.longOffsets.size()),
+				static_cast<uint>(batch.longPasswords.size()), range.first, range.count, d_targets, targetCount,
+				d_bloom, targets.bloomShift, slot.d_longMatches, matchCapacity, &slot.d_matchCounts[1]);
+		}
+	};
+
+	// bloka izmērs nosaka daļas garumu, tāpēc visi trīs sadalīšanas kodoli tiek izsaukti ar vienu izmēru
+	auto launchSplit = [&](DeviceBatchSlot &slot, uint chunkBytes, int threads) {
+		const uint tileBytes = threads * SPLIT_BYTES_PER_THREAD;
+		const uint tileCount = (chunkBytes + tileBytes - 1) / tileBytes;
+		const size_t scratchBytes = threads * sizeof(uint);
+
+		countLineStarts<<<tileCount, threads, scratchBytes, computeStream>>>(slot.d_passwords, chunkBytes,
+																			 slot.d_tileCounts);
+		scanTileCounts<<<1, threads, scratchBytes, computeStream>>>(slot.d_tileCounts, tileCount,
+																	&slot.d_matchCounts[2]);
+		writeLineStarts<<<tileCount, threads, scratchBytes, computeStream>>>(slot.d_passwords, chunkBytes,
+																			 slot.d_tileCounts, slot.d_offsets);
+	};
+
+	// rindu skaits resursdatoram vēl nav zināms, režģis ir paredzēts ierakstu limitam
+	auto launchLines = [&](DeviceBatchSlot &slot, uint chunkBytes, int threads) {
+		int numBlocks = (batchSize + threads - 1) / threads;
+
+		kernelLines<<<numBlocks, threads, 0, computeStream>>>(
+			slot.d_passwords, chunkBytes, slot.d_offsets, &slot.d_matchCounts[2], d_targets, targetCount, d_bloom,
+			targets.bloomShift, slot.d_matches, slot.d_matchStarts, matchCapacity, &slot.d_matchCounts[0]);
+	};
+
+	// mērījumu izsaukumi pievieno sakritības, tāpēc pirms īstajiem izsaukumiem sakritību skaitītāji tiek notīrīti
+	auto resetTunedMatches = [&](DeviceBatchSlot &slot) {
+		CUDA_CHECK(cudaMemsetAsync(slot.d_matchCounts, 0, 2 * sizeof(uint), computeStream));
+	};
+
+	// meklēšana beidzas, kad atrastas paroles visiem hash
+	std::vector<bool> targetFound(targetCount, false);
+	size_t foundCount = 0;
+
+	auto markFound = [&](size_t crackedBefore) {
+		for (size_t c = crackedBefore; c < cracked.size(); c++)
+		{
+			if (!targetFound[cracked[c].targetIdx])
+			{
+				targetFound[cracked[c].targetIdx] = true;
+				foundCount++;
+			}
 		}
+	};
+
+	// ierīces aizņemtība visam konveijeram
+	double uploadTotalMs = 0;
+	double kernelTotalMs = 0;
 
-		if (i == 0)
+	// ierindo partijas kopēšanu kopēšanas straumē un kodolus skaitļošanas straumē, neko negaidot
+	auto submitBatch = [&](const PasswordBatch &batch) {
+		DeviceBatchSlot &slot = slots[batch.slot];
+
+		const size_t longCount = batch.longOffsets.size();
+
+		// iepriekšējā šīs ligzdas partija jau ir pabeigta, tāpēc buferus drīkst pārveidot
+		if (longCount > slot.longCountCapacity || batch.longPasswords.size() > slot.longBytesCapacity)
 		{
-			break; // visdrīzāk nav jēgas turpināt, jo failā vairs nekā nav
+			cudaFreeHost(slot.h_longPasswordsPinned);
+			cudaFreeHost(slot.h_longOffsetsPinned);
+			cudaFree(slot.d_longPasswords);
+			cudaFree(slot.d_longOffsets);
+
+			slot.longCountCapacity = std::max(longCount, slot.longCountCapacity * 2);
+			slot.longBytesCapacity = std::max(batch.longPasswords.size(), slot.longBytesCapacity * 2);
+
+			CUDA_CHECK(cudaMallocHost(&slot.h_longPasswordsPinned, slot.longBytesCapacity * sizeof(uint8_t)));
+			CUDA_CHECK(cudaMallocHost(&slot.h_longOffsetsPinned, slot.longCountCapacity * sizeof(uint)));
+			CUDA_CHECK(cudaMalloc(&slot.d_longPasswords, slot.longBytesCapacity * sizeof(cuda::std::uint8_t)));
+			CUDA_CHECK(cudaMalloc(&slot.d_longOffsets, slot.longCountCapacity * sizeof(uint)));
 		}
 
-		auto pwBatchEnd = std::chrono::steady_clock::now();
+		// garās paroles ir retas, tās tiek pārkopētas piespraustajā atmiņā, lai arī to kopēšana būtu asinhrona
+		if (longCount > 0)
+		{
+			memcpy(slot.h_longPasswordsPinned, batch.longPasswords.data(), batch.longPasswords.size());
+			memcpy(slot.h_longOffsetsPinned, batch.longOffsets.data(), longCount * sizeof(uint));
+		}
 
-		logger.chronoLog("pw batch loaded from file and processed", pwBatchStart, pwBatchEnd);
+		CUDA_CHECK(cudaEventRecord(slot.copyStart, copyStream));
 
-		auto bufferCreationStart = std::chrono::steady_clock::now();
+		CUDA_CHECK(cudaMemsetAsync(slot.d_matchCounts, 0, MATCH_COUNTERS * sizeof(uint), copyStream));
+		CUDA_CHECK(cudaMemcpyAsync(slot.d_passwords, batch.passwords, batch.pwBytes * sizeof(cuda::std::uint8_t),
+								   cudaMemcpyHostToDevice, copyStream));
+		CUDA_CHECK(cudaMemcpyAsync(slot.d_offsets, batch.offsets, batch.shortCount * sizeof(uint),
+								   cudaMemcpyHostToDevice, copyStream));
 
-		*cracked_idx = -1;
-		CUDA_CHECK(cudaMemcpy(d_crackedIdx, cracked_idx, sizeof(int), cudaMemcpyHostToDevice));
+		if (longCount > 0)
+		{
+			CUDA_CHECK(cudaMemcpyAsync(slot.d_longPasswords, slot.h_longPasswordsPinned,
+									   batch.longPasswords.size() * sizeof(cuda::std::uint8_t), cudaMemcpyHostToDevice,
+									   copyStream));
+			CUDA_CHECK(cudaMemcpyAsync(slot.d_longOffsets, slot.h_longOffsetsPinned, longCount * sizeof(uint),
+									   cudaMemcpyHostToDevice, copyStream));
+		}
+
+		CUDA_CHECK(cudaEventRecord(slot.copyStop, copyStream));
+
+		// kodoli sāk izpildīties tikai pēc šīs partijas kopēšanas
+		CUDA_CHECK(cudaStreamWaitEvent(computeStream, slot.copyStop, 0));
 
-		CUDA_CHECK(
-			cudaMemcpy(d_passwords, h_passwordsPinned, pwBytes * sizeof(cuda::std::uint8_t), cudaMemcpyHostToDevice));
-		CUDA_CHECK(cudaMemcpy(d_offsets, h_offsetsPinned, i * sizeof(uint), cudaMemcpyHostToDevice));
+		const bool tuneShort = kernelThreads == 0 && batch.shortCount > 0;
+		const bool tuneLong = multiBlockThreads == 0 && longCount > 0;
+
+		if (tuneShort)
+		{
+			kernelThreads = tunedBlockSize("sha256 kernel", [&](int threads) { launchShort(slot, batch, threads); });
+		}
 
-		auto bufferCreationEnd = std::chrono::steady_clock::now();
+		if (tuneLong)
+		{
+			multiBlockThreads = tunedBlockSize("sha256 kernelMultiBlock",
+											   [&](int threads) { launchLong(slot, batch, threads); });
+		}
 
-		logger.chronoLog("kernel buffer creation time", bufferCreationStart, bufferCreationEnd);
+		if (autotune && (tuneShort || tuneLong))
+		{
+			resetTunedMatches(slot);
+		}
 
-		int numThreads = 256;
-		int numBlocks = (i + numThreads - 1) / numThreads;
+		CUDA_CHECK(cudaEventRecord(slot.kernelStart, computeStream));
 
-		CUDA_CHECK(cudaEventRecord(start));
+		if (batch.shortCount > 0)
+		{
+			launchShort(slot, batch, kernelThreads);
+		}
 
-		kernel<<<numBlocks, numThreads>>>(d_passwords, d_offsets, static_cast<uint>(i), static_cast<uint>(pwBytes),
-										  d_hash, d_crackedIdx);
+		CUDA_CHECK(cudaEventRecord(slot.kernelStop, computeStream));
 
-		CUDA_CHECK(cudaEventRecord(stop));
+		if (longCount > 0)
+		{
+			launchLong(slot, batch, multiBlockThreads);
+		}
+
+		CUDA_CHECK(cudaEventRecord(slot.longStop, computeStream));
 		CUDA_CHECK(cudaGetLastError());
-		CUDA_CHECK(cudaDeviceSynchronize());
 
-		float kernelExecMs = 0;
-		CUDA_CHECK(cudaEventElapsedTime(&kernelExecMs, start, stop));
-		logger.log("kernel exec time", kernelExecMs);
+		CUDA_CHECK(cudaMemcpyAsync(slot.h_matchCountsPinned, slot.d_matchCounts, MATCH_COUNTERS * sizeof(uint),
+								   cudaMemcpyDeviceToHost, computeStream));
+		CUDA_CHECK(cudaEventRecord(slot.countsReady, computeStream));
+	};
+
+	// neapstrādāta gabala kopēšana un rindu sadalīšana ierīcē: rindu sākumu skaitīšana pa daļām, daļu prefiksa summa,
+	// rindu sākumu ierakstīšana d_offsets un jaucēšana tieši gabalā
+	auto submitRawChunk = [&](const PasswordBatch &batch) {
+		DeviceBatchSlot &slot = slots[batch.slot];
 
-		CUDA_CHECK(cudaMemcpy(cracked_idx, d_crackedIdx, sizeof(int), cudaMemcpyDeviceToHost));
+		CUDA_CHECK(cudaEventRecord(slot.copyStart, copyStream));
 
-		if (*cracked_idx != -1)
+		CUDA_CHECK(cudaMemsetAsync(slot.d_matchCounts, 0, MATCH_COUNTERS * sizeof(uint), copyStream));
+		CUDA_CHECK(cudaMemcpyAsync(slot.d_passwords, batch.rawChunk, batch.rawBytes * sizeof(cuda::std::uint8_t),
+								   cudaMemcpyHostToDevice, copyStream));
+
+		CUDA_CHECK(cudaEventRecord(slot.copyStop, copyStream));
+
+		CUDA_CHECK(cudaStreamWaitEvent(computeStream, slot.copyStop, 0));
+
+		const uint chunkBytes = batch.rawBytes;
+
+		// rindu sadalīšanas rezultāts nav atkarīgs no bloka izmēra, tāpēc kernelLines mērījumi izmanto pēdējā
+		// sadalīšanas mērījuma rindu sākumus
+		if (splitThreads == 0)
 		{
-			if (static_cast<uint>(*cracked_idx) >= i)
-			{
-				*cracked_idx = -1;
-				continue;
-			}
+			splitThreads = tunedBlockSize("sha256 line split",
+										  [&](int threads) { launchSplit(slot, chunkBytes, threads); });
+
+			// no kešatmiņas nolasīts mazāks izmērs neietilpst d_tileCounts
+			splitThreads = std::max(splitThreads, SPLIT_MIN_THREADS);
+		}
 
-			uint pwStart = h_offsetsPinned[*cracked_idx];
-			size_t pwSize;
+		if (linesThreads == 0)
+		{
+			linesThreads = tunedBlockSize("sha256 kernelLines",
+										  [&](int threads) { launchLines(slot, chunkBytes, threads); });
 
-			if (static_cast<uint>(*cracked_idx) < i - 1)
+			if (autotune)
 			{
-				pwSize = h_offsetsPinned[*cracked_idx + 1] - pwStart;
+				resetTunedMatches(slot);
 			}
+		}
+
+		CUDA_CHECK(cudaEventRecord(slot.kernelStart, computeStream));
+
+		launchSplit(slot, chunkBytes, splitThreads);
+
+		CUDA_CHECK(cudaEventRecord(slot.splitStop, computeStream));
+
+		launchLines(slot, chunkBytes, linesThreads);
+
+		CUDA_CHECK(cudaEventRecord(slot.kernelStop, computeStream));
+		CUDA_CHECK(cudaGetLastError());
+
+		CUDA_CHECK(cudaMemcpyAsync(slot.h_matchCountsPinned, slot.d_matchCounts, MATCH_COUNTERS * sizeof(uint),
+								   cudaMemcpyDeviceToHost, computeStream));
+		CUDA_CHECK(cudaEventRecord(slot.countsReady, computeStream));
+	};
+
+	// sagaida partijas kodolus, logo laikus un nolasa sakritības, pēc tam ligzdu var atdot lasītājam
+	auto finishBatch = [&](const PasswordBatch &batch) {
+		DeviceBatchSlot &slot = slots[batch.slot];
+
+		CUDA_CHECK(cudaEventSynchronize(slot.countsReady));
+
+		logger.log("pw batch loaded from file and processed", batch.parseMs);
+
+		float uploadMs = 0;
+		CUDA_CHECK(cudaEventElapsedTime(&uploadMs, slot.copyStart, slot.copyStop));
+		logger.log("kernel buffer creation time", uploadMs);
+
+		float kernelExecMs = 0;
+		CUDA_CHECK(cudaEventElapsedTime(&kernelExecMs, slot.kernelStart, slot.kernelStop));
+
+		if (batch.shortCount > 0)
+		{
+			logger.log("kernel exec time", kernelExecMs);
+		}
+
+		// garo paroļu caurlaidspēja tiek logota atsevišķi, lai tā neietekmētu viena bloka kodola laikus
+		float longExecMs = 0;
+		CUDA_CHECK(cudaEventElapsedTime(&longExecMs, slot.kernelStop, slot.longStop));
 
-			// pēdējai parolei nav nākamais offsets, tāpēc jāizmanto kopējais simbolu skaits
-			else
+		if (!batch.longOffsets.empty())
+		{
+			logger.log("long pw kernel exec time", longExecMs);
+			logger.log("long pw hashes per second", batch.longOffsets.size() / (longExecMs / 1000.0));
+		}
+
+		uploadTotalMs += uploadMs;
+		kernelTotalMs += kernelExecMs + longExecMs;
+
+		const size_t crackedBefore = cracked.size();
+
+		// indeksi ir relatīvi īso vai garo paroļu buferim
+		for (const uint2 &match : readMatches(slot.d_matches, slot.h_matchCountsPinned[0], matchCapacity))
+		{
+			uint pwStart = batch.offsets[match.x];
+			uint pwEnd = match.x < batch.shortCount - 1 ? batch.offsets[match.x + 1] : batch.pwBytes;
+
+			cracked.push_back(
+				{batch.shortLineIdx[match.x], match.y,
+				 std::string(reinterpret_cast<const char *>(&batch.passwords[pwStart]), pwEnd - pwStart)});
+		}
+
+		for (const uint2 &match : readMatches(slot.d_longMatches, slot.h_matchCountsPinned[1], matchCapacity))
+		{
+			uint pwStart = batch.longOffsets[match.x];
+			uint pwEnd = match.x < batch.longOffsets.size() - 1 ? batch.longOffsets[match.x + 1]
+																: batch.longPasswords.size();
+
+			cracked.push_back(
+				{batch.longLineIdx[match.x], match.y,
+				 std::string(reinterpret_cast<const char *>(&batch.longPasswords[pwStart]), pwEnd - pwStart)});
+		}
+
+		markFound(crackedBefore);
+	};
+
+	// gabala pirmās rindas indekss failā, rindu skaits gabalā kļūst zināms tikai pēc tā apstrādes
+	size_t rawLineIdx = 0;
+
+	auto finishRawChunk = [&](const PasswordBatch &batch) {
+		DeviceBatchSlot &slot = slots[batch.slot];
+
+		CUDA_CHECK(cudaEventSynchronize(slot.countsReady));
+
+		logger.log("pw batch loaded from file and processed", batch.parseMs);
+
+		float uploadMs = 0;
+		CUDA_CHECK(cudaEventElapsedTime(&uploadMs, slot.copyStart, slot.copyStop));
+		logger.log("kernel buffer creation time", uploadMs);
+
+		float splitMs = 0;
+		CUDA_CHECK(cudaEventElapsedTime(&splitMs, slot.kernelStart, slot.splitStop));
+		logger.log("line split time", splitMs);
+
+		float kernelExecMs = 0;
+		CUDA_CHECK(cudaEventElapsedTime(&kernelExecMs, slot.splitStop, slot.kernelStop));
+		logger.log("kernel exec time", kernelExecMs);
+
+		uploadTotalMs += uploadMs;
+		kernelTotalMs += splitMs + kernelExecMs;
+
+		const std::vector<uint2> matches = readMatches(slot.d_matches, slot.h_matchCountsPinned[0], matchCapacity);
+		std::vector<uint> matchStarts(matches.size());
+
+		if (!matches.empty())
+		{
+			CUDA_CHECK(cudaMemcpy(matchStarts.data(), slot.d_matchStarts, matchStarts.size() * sizeof(uint),
+								  cudaMemcpyDeviceToHost));
+		}
+
+		const size_t crackedBefore = cracked.size();
+
+		// parole tiek nolasīta no gabala tāpat kā ierīcē: līdz '\n' vai gabala beigām, bez '\r'
+		for (size_t m = 0; m < matches.size(); m++)
+		{
+			const uint8_t *line = batch.rawChunk + matchStarts[m];
+			const size_t maxLength = batch.rawBytes - matchStarts[m];
+			const void *newline = memchr(line, '\n', maxLength);
+
+			size_t length = newline != nullptr ? static_cast<const uint8_t *>(newline) - line : maxLength;
+
+			if (length > 0 && line[length - 1] == '\r')
 			{
-				pwSize = pwBytes - pwStart;
+				length--;
 			}
 
-			foundPw = std::string(reinterpret_cast<const char *>(&h_passwordsPinned[pwStart]), pwSize);
+			cracked.push_back(
+				{rawLineIdx + matches[m].x, matches[m].y, std::string(reinterpret_cast<const char *>(line), length)});
+		}
 
-			*cracked_idx += (lineIdx - i); // indekss ir relatīvs batcham, tāpēc vajag offsetu pieskaitīt
+		rawLineIdx += slot.h_matchCountsPinned[2];
 
-			break;
+		markFound(crackedBefore);
+	};
+
+	auto pipelineStart = std::chrono::steady_clock::now();
+
+	BatchLayout layout = BatchLayout::Passwords;
+
+	if (deviceSplit)
+	{
+		layout = wordlistRegistered ? BatchLayout::MappedRawChunks : BatchLayout::RawChunks;
+	}
+
+	PasswordBatchReader reader(wordlist, batchSize, deviceSplit ? rawChunkBytes : passwordsCapacity, h_passwordsPinned,
+							   h_offsetsPinned, layout);
+
+	// partija, kuras kodoli vēl var izpildīties, tās rezultāti tiek nolasīti pēc nākamās partijas ierindošanas
+	PasswordBatch *pending = nullptr;
+
+	while (foundCount < targetCount)
+	{
+		PasswordBatch *batch = reader.next();
+
+		if (batch == nullptr)
+		{
+			break; // failā vairs nekā nav
 		}
+
+		deviceSplit ? submitRawChunk(*batch) : submitBatch(*batch);
+
+		if (pending != nullptr)
+		{
+			deviceSplit ? finishRawChunk(*pending) : finishBatch(*pending);
+			reader.release(pending);
+		}
+
+		pending = batch;
+	}
+
+	if (pending != nullptr)
+	{
+		deviceSplit ? finishRawChunk(*pending) : finishBatch(*pending);
+		reader.release(pending);
 	}
 
-	cudaFree(d_passwords);
-	cudaFree(d_offsets);
-	cudaFree(d_hash);
-	cudaFree(d_crackedIdx);
-	cudaEventDestroy(start);
-	cudaEventDestroy(stop);
-	cudaFreeHost(h_passwordsPinned);
-	cudaFreeHost(h_offsetsPinned);
+	reader.finish();
+
+	auto pipelineEnd = std::chrono::steady_clock::now();
+
+	// katra posma aizņemtība procentos no konveijera kopējā laika, ja kodoli ir tuvu 100%, tad konveijeru ierobežo
+	// jaucēšana, nevis faila apstrāde vai kopēšana, gaidīšanas laiki parāda, cik ilgi kodoli gaidīja uz partijām
+	const double pipelineMs = std::chrono::duration<double, std::milli>(pipelineEnd - pipelineStart).count();
 
-	file.close();
+	logger.log("pipeline parse utilisation", 100.0 * reader.parseMs() / pipelineMs);
+	logger.log("pipeline upload utilisation", 100.0 * uploadTotalMs / pipelineMs);
+	logger.log("pipeline kernel utilisation", 100.0 * kernelTotalMs / pipelineMs);
+	logger.log("pipeline wait for parsed batch time", reader.consumerWaitMs());
+	logger.log("pipeline reader wait for free slot time", reader.readerWaitMs());
+
+	// kodoli sakritības pievieno jebkurā secībā, rezultāti tiek sakārtoti pēc rindas failā
+	std::sort(cracked.begin(), cracked.end(),
+			  [](const CrackedPassword &a, const CrackedPassword &b) { return a.lineIdx < b.lineIdx; });
+
+	for (DeviceBatchSlot &slot : slots)
+	{
+		cudaFree(slot.d_passwords);
+		cudaFree(slot.d_offsets);
+		cudaFree(slot.d_matches);
+		cudaFree(slot.d_longMatches);
+		cudaFree(slot.d_matchCounts);
+		cudaFree(slot.d_tileCounts);
+		cudaFree(slot.d_matchStarts);
+		cudaFree(slot.d_longPasswords);
+		cudaFree(slot.d_longOffsets);
+		cudaFreeHost(slot.h_matchCountsPinned);
+		cudaFreeHost(slot.h_longPasswordsPinned);
+		cudaFreeHost(slot.h_longOffsetsPinned);
+		cudaEventDestroy(slot.copyStart);
+		cudaEventDestroy(slot.copyStop);
+		cudaEventDestroy(slot.kernelStart);
+		cudaEventDestroy(slot.splitStop);
+		cudaEventDestroy(slot.kernelStop);
+		cudaEventDestroy(slot.longStop);
+		cudaEventDestroy(slot.countsReady);
+	}
+
+	for (size_t slot = 0; slot < PASSWORD_BATCH_SLOTS; slot++)
+	{
+		cudaFreeHost(h_passwordsPinned[slot]);
+		cudaFreeHost(h_offsetsPinned[slot]);
+	}
+
+	cudaStreamDestroy(copyStream);
+	cudaStreamDestroy(computeStream);
+
+	if (wordlistRegistered)
+	{
+		cudaHostUnregister(const_cast<uint8_t *>(wordlist.data()));
+	}
+	cudaFree(d_targets);
+	cudaFree(d_bloom);
 }
 
 // sha funkcijas testa device kodols
@@ -455,7 +1311,18 @@ __global__ void testKernel(const cuda::std::uint8_t *input, cuda::std::uint64_t
 		return;
 	}
 
-	sha256(input, length, calculatedHash);
+	cuda::std::uint32_t state[8];
+
+	if (length <= SINGLE_BLOCK_MAX_LENGTH)
+	{
+		sha256(input, length, state);
+	}
+	else
+	{
+		sha256MultiBlock(input, length, state);
+	}
+
+	stateToBytes(state, calculatedHash);
 }
 
 void testSha(const std::string &password, const std::string hexExpectedHash)
@@ -503,6 +1370,27 @@ void testSha(const std::string &password, const std::string hexExpectedHash)
 
 int main(int argc, char *argv[])
 {
+	// rindu sadalīšana ierīcē un bloku izmēru mērīšana, karodziņi ir pirms paroļu faila jebkurā secībā,
+	// pārējie argumenti paliek tādi paši
+	bool deviceSplit = false;
+	bool autotune = false;
+	int flagCount = 0;
+
+	for (; flagCount + 1 < argc; flagCount++)
+	{
+		const std::string flag = argv[flagCount + 1];
+
+		if (flag == "--device-split")
+			deviceSplit = true;
+		else if (flag == "--autotune")
+			autotune = true;
+		else
+			break;
+	}
+
+	char **args = argv + flagCount;
+	const int argCount = argc - flagCount;
+
 	try
 	{
 		// testu palaišana
@@ -513,6 +1401,14 @@ int main(int argc, char *argv[])
 			testSha("", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
 			testSha("123456", "8d969eef6ecad3c29a3a629280e686cf0c3f5d5a86aff3ca12020c923adc6c92");
 
+			// NIST testa vektori ar 2 blokiem (56 un 112 baiti) un 4 bloku ziņojums
+			testSha("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+					"248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+			testSha("abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmn"
+					"hijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu",
+					"cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1");
+			testSha(std::string(200, 'a'), "c2a908d98f5df987ade41b5fce213067efbcc21ef2240212a41e54b5e7c28ae5");
+
 			std::cout << "Hash Converison Tests\n";
 
 			std::string testHexHash = "8d969eef6ecad3c29a3a629280e686cf0c3f5d5a86aff3ca12020c923adc6c92";
@@ -522,38 +1418,59 @@ int main(int argc, char *argv[])
 
 			std::cout << "Tests complete\n";
 		}
-		else if (argc == 4)
+		else if (argCount == 4 || (argCount == 5 && std::string(args[2]) == "--targets"))
 		{
-			const std::string inputFileName = argv[1];
-			const std::string hexHash = argv[2];
-			const std::string logFileName = argv[3];
+			const bool multiTarget = argCount == 5;
+
+			const std::string inputFileName = args[1];
+			const std::string logFileName = args[argCount - 1];
 
-			std::vector<uint8_t> hash = hexStringToBytes(hexHash);
+			// viens hash no komandrindas vai hash saraksts no faila, abos gadījumos tie tiek meklēti vienā tabulā
+			const std::vector<std::string> hexHashes =
+				multiTarget ? readHashFile(args[3]) : std::vector<std::string>{args[2]};
 
 			BenchmarkLogger logger(logFileName, "CUDA");
 
-			std::string foundPw;
+			auto targetTableStart = std::chrono::steady_clock::now();
+
+			const TargetTable targets = buildTargetTable(hexHashes);
+
+			auto targetTableEnd = std::chrono::steady_clock::now();
+
+			logger.chronoLog("target table creation time", targetTableStart, targetTableEnd);
 
-			std::cout << "Starting search...\n";
+			std::cout << "Starting search for " << targets.size() << " hash(es)...\n";
 
-			int cracked_idx = -1;
+			std::vector<CrackedPassword> cracked;
 
 			auto hashCheckStart = std::chrono::steady_clock::now();
 
-			hashCheck(inputFileName, hash, &cracked_idx, true, foundPw, logger);
+			hashCheck(inputFileName, targets, cracked, true, deviceSplit, autotune, logger);
 
 			auto hashCheckEnd = std::chrono::steady_clock::now();
 
 			logger.chronoLog("hash check time", hashCheckStart, hashCheckEnd);
 
-			if (cracked_idx != -1)
+			for (const CrackedPassword &found : cracked)
 			{
-				std::cout << "Password found at index " << cracked_idx << ": " << foundPw << "\n";
+				std::cout << "Password found at index " << found.lineIdx << ": " << found.password;
+
+				if (multiTarget)
+				{
+					std::cout << "\t" << targets.hex(found.targetIdx);
+				}
+
+				std::cout << "\n";
 			}
-			else
+
+			if (cracked.empty())
 			{
 				std::cout << "No matching password found." << "\n";
 			}
+			else if (multiTarget)
+			{
+				std::cout << "Found " << cracked.size() << " passwords for " << targets.size() << " hashes\n";
+			}
 		}
 		else
 		{
@@ -561,7 +1478,14 @@ int main(int argc, char *argv[])
 					  << "\tRunning tests:\n"
 					  << "\t\t" << argv[0] << " --test\n"
 					  << "\tGPU Password cracking:\n"
-					  << "\t\t" << argv[0] << " <passwords file> <password hash> <log file>\n";
+					  << "\t\t" << argv[0] << " <passwords file> <password hash> <log file>\n"
+					  << "\tGPU Password cracking for a list of hashes (one 64 hex character hash per line):\n"
+					  << "\t\t" << argv[0] << " <passwords file> --targets <hashes file> <log file>\n"
+					  << "\tTo upload raw file chunks and split lines on the GPU, start either form with:\n"
+					  << "\t\t" << argv[0] << " --device-split <passwords file> ...\n"
+					  << "\tTo time the kernel block sizes on the first batches and store the fastest in autotune.json "
+					  << "(or GOL_AUTOTUNE_FILE), later runs reuse them, start either form with:\n"
+					  << "\t\t" << argv[0] << " --autotune <passwords file> ...\n";
 
 			return -1;
 		}
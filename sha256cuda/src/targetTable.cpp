@@ -0,0 +1,167 @@
+// meklējamo hash tabula un priekšfiltrs vairāku hash meklēšanai vienā paroļu faila caurskatē
+
+#include "targetTable.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+static std::array<uint32_t, 8> parseHexHash(const std::string &hexHash)
+{
+	// 256 biti => 64 hex skaitļi
+	if (hexHash.size() != 64 ||
+		!std::all_of(hexHash.begin(), hexHash.end(), [](unsigned char c) { return std::isxdigit(c) != 0; }))
+	{
+		throw std::runtime_error("SHA-256 hash as a hex string must be exactly 64 hex characters: " + hexHash);
+	}
+
+	std::array<uint32_t, 8> words;
+
+	for (size_t i = 0; i < 8; i++)
+	{
+		words[i] = static_cast<uint32_t>(std::stoul(hexHash.substr(i * 8, 8), nullptr, 16));
+	}
+
+	return words;
+}
+
+static inline bool bloomTest(const std::vector<uint32_t> &bloom, uint32_t position)
+{
+	return (bloom[position >> 5] & (1u << (position & 31))) != 0;
+}
+
+static inline void bloomSet(std::vector<uint32_t> &bloom, uint32_t position)
+{
+	bloom[position >> 5] |= 1u << (position & 31);
+}
+
+std::string TargetTable::hex(size_t idx) const
+{
+	std::ostringstream ss;
+	ss << std::hex << std::setfill('0');
+
+	for (size_t i = 0; i < 8; i++)
+	{
+		ss << std::setw(8) << words[idx * 8 + i];
+	}
+
+	return ss.str();
+}
+
+int64_t TargetTable::find(const uint32_t *digestWords) const
+{
+	const uint32_t first = digestWords[0];
+
+	if (bloomShift != 0 &&
+		(!bloomTest(bloom, first >> bloomShift) || !bloomTest(bloom, (first * BLOOM_MULTIPLIER) >> bloomShift)))
+	{
+		return -1;
+	}
+
+	// pirmais hash, kura pirmais vārds nav mazāks par meklējamo
+	size_t low = 0;
+	size_t high = size();
+
+	while (low < high)
+	{
+		const size_t mid = (low + high) / 2;
+
+		if (words[mid * 8] < first)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	for (size_t t = low; t < size() && words[t * 8] == first; t++)
+	{
+		if (std::equal(digestWords + 1, digestWords + 8, words.begin() + t * 8 + 1))
+		{
+			return static_cast<int64_t>(t);
+		}
+	}
+
+	return -1;
+}
+
+std::vector<std::string> readHashFile(const std::string &fileName)
+{
+	std::ifstream file(fileName);
+
+	if (!file.is_open())
+	{
+		throw std::runtime_error("Could not open file " + fileName);
+	}
+
+	std::vector<std::string> hashes;
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		// Windows rindu beigas
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+
+		if (!line.empty())
+		{
+			hashes.push_back(line);
+		}
+	}
+
+	if (hashes.empty())
+	{
+		throw std::runtime_error("Hash file " + fileName + " does not contain any hashes");
+	}
+
+	return hashes;
+}
+
+TargetTable buildTargetTable(const std::vector<std::string> &hexHashes)
+{
+	std::vector<std::array<uint32_t, 8>> hashes;
+	hashes.reserve(hexHashes.size());
+
+	for (const std::string &hexHash : hexHashes)
+	{
+		hashes.push_back(parseHexHash(hexHash));
+	}
+
+	std::sort(hashes.begin(), hashes.end());
+	hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+
+	TargetTable table;
+	table.words.reserve(hashes.size() * 8);
+
+	for (const std::array<uint32_t, 8> &hash : hashes)
+	{
+		table.words.insert(table.words.end(), hash.begin(), hash.end());
+	}
+
+	if (hashes.size() >= BLOOM_MIN_TARGETS)
+	{
+		uint32_t log2Bits = BLOOM_MIN_LOG2_BITS;
+		while (log2Bits < BLOOM_MAX_LOG2_BITS && (size_t(1) << log2Bits) < hashes.size() * BLOOM_BITS_PER_TARGET)
+		{
+			log2Bits++;
+		}
+
+		table.bloomShift = 32 - log2Bits;
+		table.bloom.assign((size_t(1) << log2Bits) / 32, 0);
+
+		for (const std::array<uint32_t, 8> &hash : hashes)
+		{
+			bloomSet(table.bloom, hash[0] >> table.bloomShift);
+			bloomSet(table.bloom, (hash[0] * BLOOM_MULTIPLIER) >> table.bloomShift);
+		}
+	}
+
+	return table;
+}
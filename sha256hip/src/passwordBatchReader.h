@@ -0,0 +1,627 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// partiju (ligzdu) skaits gredzenā: kamēr viena partija tiek jaucēta, nākamā tiek kopēta uz ierīci
+// un vēl nākamā tiek nolasīta no faila
+constexpr size_t PASSWORD_BATCH_SLOTS = 3;
+
+// garākā parole, kas kopā ar '1' bitu un 64 bitu garumu ietilpst vienā SHA256 blokā (440 biti)
+constexpr size_t SINGLE_BLOCK_MAX_LENGTH = 440 / 8;
+
+// cik faila baitu tiek indeksēts vienā piegājienā, rindu beigu pozīcijas aizņem ~8 baitus uz rindu
+constexpr size_t NEWLINE_INDEX_WINDOW_BYTES = 16 << 20;
+
+// mazākais indeksējamais apjoms vienam pavedienam, mazākiem gabaliem pavedieni maksā vairāk nekā ietaupa
+constexpr size_t MIN_INDEX_BYTES_PER_THREAD = 1 << 20;
+
+// vienas partijas ierakstu (rindu) un īso paroļu baitu limits
+struct BatchBudget
+{
+	size_t entries;
+	size_t bytes;
+};
+
+// partijas limiti no ierīces atmiņas: gredzena ligzdām tiek atvēlēta astotā daļa no brīvās atmiņas
+// vienai ligzdai ierīcē vajag īso paroļu baitus, offsetus (4 B), divus sakritību buferus (2 x 8 B) un garo paroļu
+// buferus, kas var sasniegt tikpat baitu kā īsās paroles, baitu limits ir 32 baiti uz ierakstu, lai partijas
+// nebeigtos agrāk arī sarakstiem ar garākām parolēm
+// 'maxAllocationBytes' ir lielākais viena bufera izmērs (OpenCL CL_DEVICE_MAX_MEM_ALLOC_SIZE)
+inline BatchBudget batchBudgetForDevice(size_t deviceMemoryBytes, size_t maxAllocationBytes)
+{
+	constexpr size_t BYTES_PER_ENTRY = 32;
+	constexpr size_t DEVICE_BYTES_PER_ENTRY = 2 * BYTES_PER_ENTRY + sizeof(uint32_t) + 2 * 2 * sizeof(uint32_t);
+
+	// apakšējā robeža saglabā kodolu noslodzi mazām ierīcēm, augšējā ierobežo piespraustās host atmiņas apjomu
+	constexpr size_t MIN_ENTRIES = 1 << 16;
+	constexpr size_t MAX_ENTRIES = 1 << 21;
+
+	size_t entries = deviceMemoryBytes / 8 / PASSWORD_BATCH_SLOTS / DEVICE_BYTES_PER_ENTRY;
+	entries = std::min(entries, maxAllocationBytes / BYTES_PER_ENTRY);
+	entries = std::clamp<size_t>(entries, MIN_ENTRIES, MAX_ENTRIES);
+	entries &= ~size_t(1023); // kodolu režģiem ērts skaits
+
+	return {entries, entries * BYTES_PER_ENTRY};
+}
+
+// vienas garo paroļu grupas novietojums partijas garo paroļu buferī
+struct LongBucketRange
+{
+	size_t blockCount;
+	uint32_t first;
+	uint32_t count;
+};
+
+// kā partija tiek nodota ierīcei
+enum class BatchLayout
+{
+	Passwords,       // paroles bez rindu beigām un to offseti ligzdas buferos, garās paroles atsevišķi
+	RawChunks,       // neapstrādāti faila gabali, kas nokopēti ligzdas paroļu buferī, rindas sadala ierīce
+	MappedRawChunks, // tas pats, tikai gabali netiek kopēti, 'rawChunk' norāda tieši attēlotajā failā
+};
+
+// paroļu fails, kas attēlots atmiņā ar mmap, attēlojumu var reģistrēt ierīces tiešai piekļuvei (DMA),
+// pirms to sāk lasīt PasswordBatchReader
+class MappedWordlist
+{
+  public:
+	explicit MappedWordlist(const std::string &fileName)
+	{
+		const int fd = open(fileName.c_str(), O_RDONLY);
+
+		if (fd < 0)
+		{
+			throw std::runtime_error("Could not open file " + fileName);
+		}
+
+		struct stat fileStat;
+		if (fstat(fd, &fileStat) != 0)
+		{
+			close(fd);
+			throw std::runtime_error("Could not stat file " + fileName);
+		}
+
+		fileSize = static_cast<size_t>(fileStat.st_size);
+
+		// tukšu failu nevar attēlot, tam vienkārši nav rindu
+		if (fileSize > 0)
+		{
+			void *mapped = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+			if (mapped == MAP_FAILED)
+			{
+				close(fd);
+				throw std::runtime_error("Could not map file " + fileName);
+			}
+
+			// fails tiek lasīts vienu reizi no sākuma līdz beigām
+			madvise(mapped, fileSize, MADV_SEQUENTIAL);
+
+			mappedData = static_cast<const uint8_t *>(mapped);
+		}
+
+		// attēlojums paliek spēkā arī pēc faila deskriptora aizvēršanas
+		close(fd);
+	}
+
+	~MappedWordlist()
+	{
+		if (mappedData != nullptr)
+		{
+			munmap(const_cast<uint8_t *>(mappedData), fileSize);
+		}
+	}
+
+	MappedWordlist(const MappedWordlist &) = delete;
+	MappedWordlist &operator=(const MappedWordlist &) = delete;
+
+	// nullptr tukšam failam
+	const uint8_t *data() const
+	{
+		return mappedData;
+	}
+
+	size_t size() const
+	{
+		return fileSize;
+	}
+
+  private:
+	const uint8_t *mappedData = nullptr;
+	size_t fileSize = 0;
+};
+
+// viena nolasīta partija: īsās paroles ir ligzdas buferos (parasti piespraustā atmiņa), garās paroles, kas
+// neietilpst vienā blokā, ir sagrupētas pēc bloku skaita, lai katrā kodola izsaukumā visiem pavedieniem būtu vienāds
+// bloku skaits
+struct PasswordBatch
+{
+	size_t slot = 0;
+
+	uint8_t *passwords = nullptr;
+	uint32_t *offsets = nullptr;
+	size_t shortCount = 0;
+	size_t pwBytes = 0;
+	std::vector<size_t> shortLineIdx; // īso paroļu indeksi failā, garās paroles no partijas ir izņemtas
+
+	std::vector<uint8_t> longPasswords;
+	std::vector<uint32_t> longOffsets;
+	std::vector<size_t> longLineIdx;
+	std::vector<LongBucketRange> longRanges;
+
+	// tikai neapstrādātiem gabaliem: gabals sākas ar rindas sākumu un beidzas aiz '\n' (vai faila beigās),
+	// rindu skaits gabalā kļūst zināms tikai ierīcē
+	const uint8_t *rawChunk = nullptr;
+	size_t rawBytes = 0;
+
+	double parseMs = 0; // faila nolasīšanas un paroļu sadalīšanas laiks
+};
+
+// fona pavediens, kas nolasa paroļu failu partijās, lai faila apstrāde notiktu vienlaicīgi ar kopēšanu un kodoliem
+// rindu beigas tiek atrastas ar memchr (glibc to vektorizē ar SSE2/AVX2) vairākos pavedienos, paroles no attēlojuma
+// tiek kopētas uzreiz ligzdas buferī, rindas beigās '\r' tiek noņemts (CRLF faili)
+// partija beidzas, kad sasniegts 'batchSize' ierakstu vai 'passwordsCapacity' baitu limits
+// neapstrādātu gabalu režīmā rindas netiek meklētas, gabals ir līdz 'passwordsCapacity' baitiem līdz pēdējam '\n'
+// partijas tiek atdotas un jāatbrīvo faila secībā, ligzdas buferus piešķir izsaucējs,
+// tie jāatbrīvo tikai pēc finish()
+class PasswordBatchReader
+{
+  public:
+	PasswordBatchReader(const MappedWordlist &wordlist, size_t batchSize, size_t passwordsCapacity,
+						const std::vector<uint8_t *> &passwordSlots, const std::vector<uint32_t *> &offsetSlots,
+						BatchLayout layout = BatchLayout::Passwords)
+		: data(wordlist.data()), fileSize(wordlist.size()), batchSize(batchSize), passwordsCapacity(passwordsCapacity),
+		  layout(layout), slots(passwordSlots.size())
+	{
+		assert(passwordSlots.size() == offsetSlots.size() && passwordSlots.size() >= 2);
+
+		for (size_t slot = 0; slot < slots.size(); slot++)
+		{
+			slots[slot].slot = slot;
+			slots[slot].passwords = passwordSlots[slot];
+			slots[slot].offsets = offsetSlots[slot];
+			slots[slot].shortLineIdx.resize(batchSize);
+		}
+
+		readerThread = std::thread(&PasswordBatchReader::run, this);
+	}
+
+	~PasswordBatchReader()
+	{
+		if (readerThread.joinable())
+		{
+			stop();
+		}
+	}
+
+	PasswordBatchReader(const PasswordBatchReader &) = delete;
+	PasswordBatchReader &operator=(const PasswordBatchReader &) = delete;
+
+	// nākamā partija faila secībā, gaida, ja lasītājs to vēl nav sagatavojis, nullptr nozīmē faila beigas vai kļūdu
+	PasswordBatch *next()
+	{
+		auto waitStart = std::chrono::steady_clock::now();
+
+		std::unique_lock<std::mutex> lock(mutex);
+		batchReady.wait(lock, [this] { return produced > consumed || endOfFile; });
+
+		std::chrono::duration<double, std::milli> waited = std::chrono::steady_clock::now() - waitStart;
+		consumerWaitTotalMs += waited.count();
+
+		if (produced == consumed)
+		{
+			return nullptr;
+		}
+
+		return &slots[consumed++ % slots.size()];
+	}
+
+	// atdod ligzdu lasītājam, drīkst izsaukt tikai tad, kad ierīce vairs nelasa ligzdas buferus
+	void release(PasswordBatch *batch)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			assert(batch->slot == released % slots.size());
+			(void)batch;
+
+			released++;
+		}
+
+		slotFree.notify_one();
+	}
+
+	// aptur lasītāju (arī pirms faila beigām, ja visi hash jau atrasti), pārmet lasītāja kļūdu, ja tāda bija
+	void finish()
+	{
+		stop();
+
+		if (readerError)
+		{
+			std::rethrow_exception(readerError);
+		}
+	}
+
+	// kopējais faila apstrādes laiks, laiks, ko lasītājs gaidīja uz brīvu ligzdu, un laiks, ko next() gaidīja uz
+	// partiju, derīgi pēc finish()
+	double parseMs() const
+	{
+		return parseTotalMs;
+	}
+
+	double readerWaitMs() const
+	{
+		return readerWaitTotalMs;
+	}
+
+	double consumerWaitMs() const
+	{
+		return consumerWaitTotalMs;
+	}
+
+  private:
+	// paroles ar vienādu bloku skaitu, kamēr tiek lasīta partija
+	struct LongPasswordBucket
+	{
+		std::vector<uint8_t> bytes;
+		std::vector<uint32_t> offsets;
+		std::vector<size_t> lineIdx;
+	};
+
+	// 512 bitu bloku skaits ziņojumam ar padding
+	static size_t blockCount(size_t length)
+	{
+		return (length + 8) / 64 + 1;
+	}
+
+	// atrod rindu beigas nākamajā faila logā, katrs pavediens meklē savā loga daļā, rezultāti tiek savienoti secībā
+	// pēdējai faila rindai bez '\n' beigas ir faila beigas
+	void indexNextWindow()
+	{
+		const size_t from = indexedEnd;
+		const size_t to = std::min(from + NEWLINE_INDEX_WINDOW_BYTES, fileSize);
+
+		const size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+		const size_t threadCount =
+			std::clamp<size_t>((to - from) / MIN_INDEX_BYTES_PER_THREAD, 1, std::min(hardwareThreads, size_t(16)));
+
+		indexChunks.resize(threadCount);
+
+		auto findNewlines = [&](size_t threadIdx) {
+			const size_t begin = from + (to - from) * threadIdx / threadCount;
+			const size_t end = from + (to - from) * (threadIdx + 1) / threadCount;
+
+			std::vector<size_t> &found = indexChunks[threadIdx];
+			found.clear();
+
+			for (size_t pos = begin; pos < end;)
+			{
+				const void *newline = std::memchr(data + pos, '\n', end - pos);
+
+				if (newline == nullptr)
+				{
+					break;
+				}
+
+				found.push_back(static_cast<const uint8_t *>(newline) - data);
+				pos = found.back() + 1;
+			}
+		};
+
+		std::vector<std::thread> threads;
+		std::vector<std::exception_ptr> errors(threadCount);
+
+		for (size_t t = 1; t < threadCount; t++)
+		{
+			threads.emplace_back([&, t] {
+				try
+				{
+					findNewlines(t);
+				}
+				catch (...)
+				{
+					errors[t] = std::current_exception();
+				}
+			});
+		}
+
+		findNewlines(0);
+
+		for (std::thread &thread : threads)
+		{
+			thread.join();
+		}
+
+		for (const std::exception_ptr &error : errors)
+		{
+			if (error)
+			{
+				std::rethrow_exception(error);
+			}
+		}
+
+		lineEnds.clear();
+		nextLine = 0;
+
+		for (const std::vector<size_t> &found : indexChunks)
+		{
+			lineEnds.insert(lineEnds.end(), found.begin(), found.end());
+		}
+
+		indexedEnd = to;
+
+		const size_t lastLineStart = lineEnds.empty() ? lineStart : lineEnds.back() + 1;
+
+		if (indexedEnd == fileSize && lastLineStart < fileSize)
+		{
+			lineEnds.push_back(fileSize);
+		}
+	}
+
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+
+		slotFree.notify_one();
+		readerThread.join();
+	}
+
+	// nolasa nākamo partiju ligzdā, atgriež false, ja failā vairs nav rindu
+	bool fill(PasswordBatch &batch)
+	{
+		batch.shortCount = 0;
+		batch.pwBytes = 0;
+		batch.longPasswords.clear();
+		batch.longOffsets.clear();
+		batch.longLineIdx.clear();
+		batch.longRanges.clear();
+
+		for (auto &[blocks, bucket] : longBuckets)
+		{
+			bucket.bytes.clear();
+			bucket.offsets.clear();
+			bucket.lineIdx.clear();
+		}
+
+		// partija beidzas, kad sasniegts ierakstu limits, nākamā īsā parole vairs neietilpst buferī
+		// vai garo paroļu partijā ir sakrājies tikpat daudz baitu, cik ir īso paroļu buferī
+		size_t i = 0;
+		size_t longBatchBytes = 0;
+
+		while (i < batchSize && longBatchBytes < passwordsCapacity)
+		{
+			if (nextLine == lineEnds.size())
+			{
+				if (indexedEnd == fileSize)
+				{
+					break;
+				}
+
+				// logs var nesaturēt nevienu rindas beigu, ja rinda ir garāka par logu
+				indexNextWindow();
+				continue;
+			}
+
+			const size_t lineEnd = lineEnds[nextLine];
+			const uint8_t *password = data + lineStart;
+			size_t length = lineEnd - lineStart;
+
+			if (length > 0 && password[length - 1] == '\r')
+			{
+				length--;
+			}
+
+			if (length <= SINGLE_BLOCK_MAX_LENGTH)
+			{
+				if (batch.pwBytes + length > passwordsCapacity)
+				{
+					break;
+				}
+
+				std::memcpy(batch.passwords + batch.pwBytes, password, length);
+				batch.offsets[batch.shortCount] = static_cast<uint32_t>(batch.pwBytes);
+				batch.shortLineIdx[batch.shortCount] = lineIdx;
+
+				batch.shortCount++;
+				batch.pwBytes += length;
+			}
+			else
+			{
+				LongPasswordBucket &bucket = longBuckets[blockCount(length)];
+
+				bucket.offsets.push_back(static_cast<uint32_t>(bucket.bytes.size()));
+				bucket.bytes.insert(bucket.bytes.end(), password, password + length);
+				bucket.lineIdx.push_back(lineIdx);
+
+				longBatchBytes += length;
+			}
+
+			lineStart = lineEnd + 1;
+			nextLine++;
+			lineIdx++;
+			i++;
+		}
+
+		// garo paroļu grupas pēc kārtas vienā buferī, katrai grupai būs savs kodola izsaukums
+		for (auto &[blocks, bucket] : longBuckets)
+		{
+			if (bucket.offsets.empty())
+			{
+				continue;
+			}
+
+			const size_t first = batch.longOffsets.size();
+
+			for (uint32_t offset : bucket.offsets)
+			{
+				batch.longOffsets.push_back(static_cast<uint32_t>(batch.longPasswords.size() + offset));
+			}
+
+			batch.longPasswords.insert(batch.longPasswords.end(), bucket.bytes.begin(), bucket.bytes.end());
+			batch.longLineIdx.insert(batch.longLineIdx.end(), bucket.lineIdx.begin(), bucket.lineIdx.end());
+			batch.longRanges.push_back(
+				{blocks, static_cast<uint32_t>(first), static_cast<uint32_t>(bucket.offsets.size())});
+		}
+
+		return i > 0;
+	}
+
+	// nākamais neapstrādātais gabals, rinda, kas gabalā neietilpst pilnībā, tiek pārnesta uz nākamo gabalu
+	bool fillRaw(PasswordBatch &batch)
+	{
+		batch.shortCount = 0;
+		batch.pwBytes = 0;
+
+		if (lineStart == fileSize)
+		{
+			return false;
+		}
+
+		size_t end = std::min(lineStart + passwordsCapacity, fileSize);
+
+		if (end < fileSize)
+		{
+			const void *newline = memrchr(data + lineStart, '\n', end - lineStart);
+
+			if (newline == nullptr)
+			{
+				throw std::runtime_error("Line at byte " + std::to_string(lineStart) + " does not fit in a " +
+										 std::to_string(passwordsCapacity) + " byte raw chunk");
+			}
+
+			end = static_cast<const uint8_t *>(newline) - data + 1;
+		}
+
+		batch.rawBytes = end - lineStart;
+
+		if (layout == BatchLayout::RawChunks)
+		{
+			std::memcpy(batch.passwords, data + lineStart, batch.rawBytes);
+			batch.rawChunk = batch.passwords;
+		}
+		else
+		{
+			batch.rawChunk = data + lineStart;
+		}
+
+		lineStart = end;
+
+		return true;
+	}
+
+	void run()
+	{
+		for (;;)
+		{
+			PasswordBatch *batch;
+
+			{
+				auto waitStart = std::chrono::steady_clock::now();
+
+				std::unique_lock<std::mutex> lock(mutex);
+				slotFree.wait(lock, [this] { return produced - released < slots.size() || stopping; });
+
+				std::chrono::duration<double, std::milli> waited = std::chrono::steady_clock::now() - waitStart;
+				readerWaitTotalMs += waited.count();
+
+				if (stopping)
+				{
+					return;
+				}
+
+				batch = &slots[produced % slots.size()];
+			}
+
+			bool filled = false;
+
+			try
+			{
+				auto parseStart = std::chrono::steady_clock::now();
+
+				filled = layout == BatchLayout::Passwords ? fill(*batch) : fillRaw(*batch);
+
+				std::chrono::duration<double, std::milli> parsed = std::chrono::steady_clock::now() - parseStart;
+				batch->parseMs = parsed.count();
+				parseTotalMs += batch->parseMs;
+			}
+			catch (...)
+			{
+				readerError = std::current_exception();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				if (filled)
+				{
+					produced++;
+				}
+				else
+				{
+					endOfFile = true;
+				}
+			}
+
+			batchReady.notify_one();
+
+			if (!filled)
+			{
+				return;
+			}
+		}
+	}
+
+	const uint8_t *data;
+	const size_t fileSize;
+	const size_t batchSize;
+	const size_t passwordsCapacity;
+	const BatchLayout layout;
+
+	// izmanto tikai lasītāja pavediens
+	std::vector<size_t> lineEnds; // indeksētā loga rindu beigu pozīcijas failā
+	std::vector<std::vector<size_t>> indexChunks;
+	size_t nextLine = 0;   // nākamās neapstrādātās rindas indekss lineEnds
+	size_t lineStart = 0;  // nākamās neapstrādātās rindas sākums failā
+	size_t indexedEnd = 0; // faila daļa līdz šai pozīcijai ir indeksēta
+	size_t lineIdx = 0;
+	std::map<size_t, LongPasswordBucket> longBuckets; // atslēga ir bloku skaits
+
+	std::vector<PasswordBatch> slots;
+
+	// partijas tiek aizpildītas, atdotas un atbrīvotas pēc kārtas, tāpēc ligzda ir skaitītājs modulo ligzdu skaits
+	std::mutex mutex;
+	std::condition_variable batchReady;
+	std::condition_variable slotFree;
+	size_t produced = 0;
+	size_t consumed = 0;
+	size_t released = 0;
+	bool endOfFile = false;
+	bool stopping = false;
+
+	double parseTotalMs = 0;
+	double readerWaitTotalMs = 0;
+	double consumerWaitTotalMs = 0;
+	std::exception_ptr readerError;
+
+	std::thread readerThread;
+};